@@ -0,0 +1,289 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Job.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "Logger.h"
+#include "Assets/EntityDefinitionManager.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/IOUtils.h"
+#include "IO/MappedFile.h"
+#include "IO/NodeWriter.h"
+#include "IO/MapFileSerializer.h"
+#include "IO/WorldReader.h"
+#include "Model/AssortNodesVisitor.h"
+#include "Model/CollectMatchingIssuesVisitor.h"
+#include "Model/EmptyBrushEntityIssueGenerator.h"
+#include "Model/EntityLinkSourceIssueGenerator.h"
+#include "Model/EntityLinkTargetIssueGenerator.h"
+#include "Model/Issue.h"
+#include "Model/IssueGenerator.h"
+#include "Model/MissingEntityClassnameIssueGenerator.h"
+#include "Model/MissingEntityDefinitionIssueGenerator.h"
+#include "Model/NodeVisitor.h"
+#include "Model/NonIntegerPlanePointsIssueGenerator.h"
+#include "Model/NonIntegerVerticesIssueGenerator.h"
+#include "Model/PointEntityWithBrushesIssueGenerator.h"
+#include "Model/World.h"
+#include "Model/WorldBoundsIssueGenerator.h"
+
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+namespace TrenchBroom {
+    namespace Batch {
+        Settings::Settings(const BBox3& i_worldBounds, const Model::MapFormat::Type i_defaultFormat) :
+        worldBounds(i_worldBounds),
+        defaultFormat(i_defaultFormat),
+        outputFormat(Model::MapFormat::Unknown),
+        entityDefinitions(NULL) {}
+
+        bool Settings::convert() const {
+            return outputFormat != Model::MapFormat::Unknown;
+        }
+
+        Job::Issue::Issue(const size_t i_line, const String& i_check, const String& i_description) :
+        line(i_line),
+        check(i_check),
+        description(i_description) {}
+        
+        bool Job::Issue::operator<(const Issue& other) const {
+            if (line != other.line)
+                return line < other.line;
+            return check < other.check;
+        }
+
+        class Job::CollectMessages : public Logger {
+        private:
+            StringList& m_messages;
+        public:
+            CollectMessages(StringList& messages) :
+            m_messages(messages) {}
+        private:
+            void doLog(const LogLevel level, const String& message) {
+                if (level != LogLevel_Debug && !message.empty())
+                    m_messages.push_back(message);
+            }
+            
+            void doLog(const LogLevel level, const wxString& message) {
+                doLog(level, message.ToStdString());
+            }
+        };
+        
+        class Job::SetEntityDefinitions : public Model::NodeVisitor {
+        private:
+            const Assets::EntityDefinitionManager& m_manager;
+        public:
+            SetEntityDefinitions(const Assets::EntityDefinitionManager& manager) :
+            m_manager(manager) {}
+        private:
+            void doVisit(Model::World* world)   { handle(world); }
+            void doVisit(Model::Layer* layer)   {}
+            void doVisit(Model::Group* group)   {}
+            void doVisit(Model::Entity* entity) { handle(entity); }
+            void doVisit(Model::Brush* brush)   {}
+            void handle(Model::AttributableNode* attributable) {
+                Assets::EntityDefinition* definition = m_manager.definition(attributable);
+                attributable->setDefinition(definition);
+            }
+        };
+        
+        const size_t Job::MemoryPerFileByte = 24;
+
+        Job::Job(const IO::Path& path) :
+        m_path(path),
+        m_fileSize(0),
+        m_success(false),
+        m_format(Model::MapFormat::Unknown),
+        m_entityCount(0),
+        m_brushCount(0),
+        m_milliseconds(0.0) {
+            const wxULongLong size = wxFileName::GetSize(m_path.asString());
+            if (size != wxInvalidSize)
+                m_fileSize = static_cast<size_t>(size.GetValue());
+        }
+
+        const IO::Path& Job::path() const {
+            return m_path;
+        }
+        
+        size_t Job::fileSize() const {
+            return m_fileSize;
+        }
+
+        size_t Job::estimatedMemory() const {
+            return m_fileSize * MemoryPerFileByte;
+        }
+
+        void Job::run(const Settings& settings) {
+            wxStopWatch stopWatch;
+            try {
+                process(settings);
+                m_success = true;
+            } catch (const std::exception& e) {
+                m_error = e.what();
+            } catch (...) {
+                m_error = "Unknown error";
+            }
+            m_milliseconds = stopWatch.TimeInMicro().ToDouble() / 1000.0;
+        }
+
+        bool Job::success() const {
+            return m_success;
+        }
+        
+        const String& Job::error() const {
+            return m_error;
+        }
+
+        const String& Job::gameName() const {
+            return m_gameName;
+        }
+
+        Model::MapFormat::Type Job::format() const {
+            return m_format;
+        }
+        
+        const IO::Path& Job::outputPath() const {
+            return m_outputPath;
+        }
+
+        size_t Job::entityCount() const {
+            return m_entityCount;
+        }
+        
+        size_t Job::brushCount() const {
+            return m_brushCount;
+        }
+        
+        const Job::IssueList& Job::issues() const {
+            return m_issues;
+        }
+        
+        const StringList& Job::messages() const {
+            return m_messages;
+        }
+
+        double Job::milliseconds() const {
+            return m_milliseconds;
+        }
+
+        void Job::process(const Settings& settings) {
+            detectFormat(settings);
+            
+            const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(m_path));
+            
+            CollectMessages logger(m_messages);
+            IO::WorldReader reader(file->begin(), file->end(), NULL, &logger);
+            
+            const std::auto_ptr<Model::World> world(reader.read(m_format, settings.worldBounds));
+            processWorld(world.get(), settings);
+        }
+
+        void Job::detectFormat(const Settings& settings) {
+            const IO::OpenFile file(m_path, false);
+            m_gameName = IO::readGameComment(file.file());
+            m_format = Model::mapFormat(IO::readFormatComment(file.file()));
+            if (m_format == Model::MapFormat::Unknown)
+                m_format = settings.defaultFormat;
+        }
+
+        void Job::processWorld(Model::World* world, const Settings& settings) {
+            if (settings.entityDefinitions != NULL) {
+                SetEntityDefinitions visitor(*settings.entityDefinitions);
+                world->acceptAndRecurse(visitor);
+            }
+            
+            registerIssueGenerators(world, settings);
+            collectIssues(world);
+            countNodes(world);
+            
+            if (settings.convert())
+                writeWorld(world, settings);
+        }
+
+        void Job::registerIssueGenerators(Model::World* world, const Settings& settings) const {
+            world->registerIssueGenerator(new Model::MissingEntityClassnameIssueGenerator());
+            // without entity definitions, every entity would be reported
+            if (settings.entityDefinitions != NULL)
+                world->registerIssueGenerator(new Model::MissingEntityDefinitionIssueGenerator());
+            world->registerIssueGenerator(new Model::EmptyBrushEntityIssueGenerator());
+            world->registerIssueGenerator(new Model::PointEntityWithBrushesIssueGenerator());
+            world->registerIssueGenerator(new Model::EntityLinkSourceIssueGenerator());
+            world->registerIssueGenerator(new Model::EntityLinkTargetIssueGenerator());
+            world->registerIssueGenerator(new Model::NonIntegerPlanePointsIssueGenerator());
+            world->registerIssueGenerator(new Model::NonIntegerVerticesIssueGenerator());
+            world->registerIssueGenerator(new Model::WorldBoundsIssueGenerator(settings.worldBounds));
+        }
+
+        struct AllIssues {
+            bool operator()(const Model::Issue* issue) const { return true; }
+        };
+
+        void Job::collectIssues(Model::World* world) {
+            const Model::IssueGeneratorList& generators = world->registeredIssueGenerators();
+            
+            typedef std::map<Model::IssueType, String> CheckMap;
+            CheckMap checks;
+            
+            Model::IssueGeneratorList::const_iterator gIt, gEnd;
+            for (gIt = generators.begin(), gEnd = generators.end(); gIt != gEnd; ++gIt) {
+                const Model::IssueGenerator* generator = *gIt;
+                checks[generator->type()] = generator->description();
+            }
+            
+            Model::CollectMatchingIssuesVisitor<AllIssues> visitor(generators);
+            world->acceptAndRecurse(visitor);
+            
+            const Model::IssueList& issues = visitor.issues();
+            Model::IssueList::const_iterator iIt, iEnd;
+            for (iIt = issues.begin(), iEnd = issues.end(); iIt != iEnd; ++iIt) {
+                const Model::Issue* issue = *iIt;
+                m_issues.push_back(Issue(issue->lineNumber(), checks[issue->type()], issue->description()));
+            }
+            
+            std::sort(m_issues.begin(), m_issues.end());
+        }
+
+        void Job::countNodes(Model::World* world) {
+            Model::AssortNodesVisitor visitor;
+            world->acceptAndRecurse(visitor);
+            m_entityCount = visitor.entities().size();
+            m_brushCount = visitor.brushes().size();
+        }
+
+        void Job::writeWorld(Model::World* world, const Settings& settings) {
+            const IO::Path outputPath = settings.outputDirectory + m_path.lastComponent();
+            
+            IO::OpenFile file(outputPath, true);
+            FILE* stream = file.file();
+            const size_t commentLines = IO::writeGameComment(stream, m_gameName, Model::formatName(settings.outputFormat));
+            
+            IO::NodeWriter writer(world, IO::MapFileSerializer::create(settings.outputFormat, stream, commentLines + 1));
+            writer.writeMap();
+            m_outputPath = outputPath;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Job
+#define TrenchBroom_Job
+
+#include "StringUtils.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "IO/Path.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class EntityDefinitionManager;
+    }
+    
+    namespace Batch {
+        // The settings shared by all jobs of a batch run. They are not modified while the jobs are running.
+        struct Settings {
+            BBox3 worldBounds;
+            Model::MapFormat::Type defaultFormat;
+            Model::MapFormat::Type outputFormat;
+            IO::Path outputDirectory;
+            const Assets::EntityDefinitionManager* entityDefinitions;
+            
+            Settings(const BBox3& i_worldBounds, Model::MapFormat::Type i_defaultFormat);
+            
+            bool convert() const;
+        };
+        
+        // Loads, validates and optionally converts a single map file and records the outcome.
+        class Job {
+        public:
+            typedef std::vector<Job*> List;
+            
+            struct Issue {
+                size_t line;
+                String check;
+                String description;
+                
+                Issue(size_t i_line, const String& i_check, const String& i_description);
+                bool operator<(const Issue& other) const;
+            };
+            
+            typedef std::vector<Issue> IssueList;
+        private:
+            class CollectMessages;
+            class SetEntityDefinitions;
+            
+            // A rough estimate of the peak memory needed to load a map relative to the size of its file.
+            static const size_t MemoryPerFileByte;
+            
+            IO::Path m_path;
+            size_t m_fileSize;
+            
+            bool m_success;
+            String m_error;
+            String m_gameName;
+            Model::MapFormat::Type m_format;
+            IO::Path m_outputPath;
+            size_t m_entityCount;
+            size_t m_brushCount;
+            IssueList m_issues;
+            StringList m_messages;
+            double m_milliseconds;
+        public:
+            Job(const IO::Path& path);
+            
+            const IO::Path& path() const;
+            size_t fileSize() const;
+            size_t estimatedMemory() const;
+            
+            // Must not be called concurrently for the same job. Never throws, errors are recorded in the job.
+            void run(const Settings& settings);
+            
+            bool success() const;
+            const String& error() const;
+            const String& gameName() const;
+            Model::MapFormat::Type format() const;
+            const IO::Path& outputPath() const;
+            size_t entityCount() const;
+            size_t brushCount() const;
+            const IssueList& issues() const;
+            const StringList& messages() const;
+            double milliseconds() const;
+        private:
+            void process(const Settings& settings);
+            void detectFormat(const Settings& settings);
+            void processWorld(Model::World* world, const Settings& settings);
+            void registerIssueGenerators(Model::World* world, const Settings& settings) const;
+            void collectIssues(Model::World* world);
+            void countNodes(Model::World* world);
+            void writeWorld(Model::World* world, const Settings& settings);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_Job) */
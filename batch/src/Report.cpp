@@ -0,0 +1,134 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Report.h"
+
+#include "Model/MapFormat.h"
+
+#include <cstdio>
+#include <ostream>
+
+namespace TrenchBroom {
+    namespace Batch {
+        Report::Report(const String& buildId, const Job::List& jobs) :
+        m_buildId(buildId),
+        m_jobs(jobs) {}
+        
+        size_t Report::failedCount() const {
+            size_t count = 0;
+            Job::List::const_iterator it, end;
+            for (it = m_jobs.begin(), end = m_jobs.end(); it != end; ++it) {
+                if (!(*it)->success())
+                    ++count;
+            }
+            return count;
+        }
+        
+        size_t Report::issueCount() const {
+            size_t count = 0;
+            Job::List::const_iterator it, end;
+            for (it = m_jobs.begin(), end = m_jobs.end(); it != end; ++it)
+                count += (*it)->issues().size();
+            return count;
+        }
+
+        void Report::write(std::ostream& stream) const {
+            stream << "{\n";
+            stream << "  \"build\": " << quoted(m_buildId) << ",\n";
+            stream << "  \"files\": " << m_jobs.size() << ",\n";
+            stream << "  \"failed\": " << failedCount() << ",\n";
+            stream << "  \"issues\": " << issueCount() << ",\n";
+            
+            stream << "  \"results\": [";
+            for (size_t i = 0; i < m_jobs.size(); ++i) {
+                stream << (i == 0 ? "\n" : ",\n");
+                writeJob(stream, *m_jobs[i]);
+            }
+            stream << "\n  ]\n";
+            stream << "}\n";
+        }
+
+        void Report::writeJob(std::ostream& stream, const Job& job) const {
+            stream << "    {\n";
+            stream << "      \"path\": " << quoted(job.path().asString()) << ",\n";
+            stream << "      \"bytes\": " << job.fileSize() << ",\n";
+            stream << "      \"success\": " << (job.success() ? "true" : "false") << ",\n";
+            if (!job.success())
+                stream << "      \"error\": " << quoted(job.error()) << ",\n";
+            stream << "      \"game\": " << quoted(job.gameName()) << ",\n";
+            stream << "      \"format\": " << quoted(Model::formatName(job.format())) << ",\n";
+            if (!job.outputPath().isEmpty())
+                stream << "      \"output\": " << quoted(job.outputPath().asString()) << ",\n";
+            stream << "      \"entities\": " << job.entityCount() << ",\n";
+            stream << "      \"brushes\": " << job.brushCount() << ",\n";
+            stream << "      \"ms\": " << job.milliseconds() << ",\n";
+            
+            const StringList& messages = job.messages();
+            stream << "      \"messages\": [";
+            for (size_t i = 0; i < messages.size(); ++i)
+                stream << (i == 0 ? "\n" : ",\n") << "        " << quoted(messages[i]);
+            stream << (messages.empty() ? "],\n" : "\n      ],\n");
+            
+            const Job::IssueList& issues = job.issues();
+            stream << "      \"issues\": [";
+            for (size_t i = 0; i < issues.size(); ++i) {
+                const Job::Issue& issue = issues[i];
+                stream << (i == 0 ? "\n" : ",\n");
+                stream << "        { \"line\": " << issue.line
+                       << ", \"check\": " << quoted(issue.check)
+                       << ", \"description\": " << quoted(issue.description) << " }";
+            }
+            stream << (issues.empty() ? "]\n" : "\n      ]\n");
+            stream << "    }";
+        }
+
+        String Report::quoted(const String& str) {
+            StringStream result;
+            result << '"';
+            for (size_t i = 0; i < str.size(); ++i) {
+                const char c = str[i];
+                switch (c) {
+                    case '"':
+                        result << "\\\"";
+                        break;
+                    case '\\':
+                        result << "\\\\";
+                        break;
+                    case '\n':
+                        result << "\\n";
+                        break;
+                    case '\t':
+                        result << "\\t";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char buffer[8];
+                            std::sprintf(buffer, "\\u%04x", static_cast<unsigned int>(c));
+                            result << buffer;
+                        } else {
+                            result << c;
+                        }
+                        break;
+                }
+            }
+            result << '"';
+            return result.str();
+        }
+    }
+}
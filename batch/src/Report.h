@@ -0,0 +1,49 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Report
+#define TrenchBroom_Report
+
+#include "StringUtils.h"
+#include "Job.h"
+
+#include <iosfwd>
+
+namespace TrenchBroom {
+    namespace Batch {
+        // Writes the outcome of the given jobs as JSON.
+        class Report {
+        private:
+            String m_buildId;
+            const Job::List& m_jobs;
+        public:
+            Report(const String& buildId, const Job::List& jobs);
+            
+            size_t failedCount() const;
+            size_t issueCount() const;
+            
+            void write(std::ostream& stream) const;
+        private:
+            void writeJob(std::ostream& stream, const Job& job) const;
+            static String quoted(const String& str);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_Report) */
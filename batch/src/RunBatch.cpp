@@ -0,0 +1,211 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Job.h"
+#include "Report.h"
+#include "WorkerPool.h"
+#include "CollectionUtils.h"
+#include "Color.h"
+#include "Exceptions.h"
+#include "ParallelTaskRunner.h"
+#include "Assets/EntityDefinitionManager.h"
+#include "IO/DefParser.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/EntityDefinitionLoader.h"
+#include "IO/FgdParser.h"
+#include "IO/MappedFile.h"
+#include "IO/ParserStatus.h"
+#include "IO/Path.h"
+#include "Model/MapFormat.h"
+#include "Version.h"
+
+#include <wx/wx.h>
+#include <wx/cmdline.h>
+#include <wx/config.h>
+#include <wx/fileconf.h>
+#include <wx/init.h>
+
+#include <clocale>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+using namespace TrenchBroom;
+
+static const wxCmdLineEntryDesc CmdLineDesc[] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",        "show this help", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "f", "format",      "format of map files without a format comment (default Standard)", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "c", "convert",     "convert the map files to the given format", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "o", "output",      "directory to write the converted map files to", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "d", "definitions", "entity definition file (fgd or def) to check the entities against", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "j", "jobs",        "number of map files to process concurrently (default: number of CPUs)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "m", "memory",      "memory budget for concurrently processed map files in MB (default 2048)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "r", "report",      "write the report to the given file instead of stdout", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, "s", "strict",      "fail if any issues are found", wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_PARAM,  NULL, NULL,         "map file", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE, NULL, NULL, NULL, wxCMD_LINE_VAL_NONE, 0 }
+};
+
+class DefinitionLoader : public IO::EntityDefinitionLoader {
+private:
+    Assets::EntityDefinitionList doLoadEntityDefinitions(IO::ParserStatus& status, const IO::Path& path) const {
+        const String extension = path.extension();
+        const Color defaultColor(0.6f, 0.6f, 0.6f, 1.0f);
+        
+        const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
+        if (StringUtils::caseInsensitiveEqual("fgd", extension)) {
+            IO::FgdParser parser(file->begin(), file->end(), defaultColor);
+            return parser.parseDefinitions(status);
+        } else if (StringUtils::caseInsensitiveEqual("def", extension)) {
+            IO::DefParser parser(file->begin(), file->end(), defaultColor);
+            return parser.parseDefinitions(status);
+        }
+        throw FileFormatException("Unknown entity definition format: '" + path.asString() + "'");
+    }
+};
+
+class SilentParserStatus : public IO::ParserStatus {
+public:
+    SilentParserStatus() :
+    ParserStatus(NULL) {}
+private:
+    void doProgress(const double progress) {}
+};
+
+static size_t sizeOption(const wxCmdLineParser& parser, const wxString& name, const size_t defaultValue) {
+    long value;
+    if (!parser.Found(name, &value))
+        return defaultValue;
+    return value < 0 ? 0 : static_cast<size_t>(value);
+}
+
+static String stringOption(const wxCmdLineParser& parser, const wxString& name, const String& defaultValue) {
+    wxString value;
+    if (!parser.Found(name, &value))
+        return defaultValue;
+    return value.ToStdString();
+}
+
+static Model::MapFormat::Type formatOption(const wxCmdLineParser& parser, const wxString& name, const String& defaultValue) {
+    const String formatName = stringOption(parser, name, defaultValue);
+    const Model::MapFormat::Type format = Model::mapFormat(formatName);
+    if (format == Model::MapFormat::Unknown)
+        throw Exception("Unknown map format: '" + formatName + "'");
+    return format;
+}
+
+static Batch::Job::List createJobs(const wxCmdLineParser& parser, const Batch::Settings& settings) {
+    Batch::Job::List jobs;
+    std::set<IO::Path> outputNames;
+    
+    for (size_t i = 0; i < parser.GetParamCount(); ++i) {
+        const IO::Path path(parser.GetParam(i).ToStdString());
+        if (settings.convert() && !outputNames.insert(path.lastComponent()).second) {
+            VectorUtils::clearAndDelete(jobs);
+            throw Exception("Cannot convert several map files named '" + path.lastComponent().asString() + "' into the same directory");
+        }
+        jobs.push_back(new Batch::Job(path));
+    }
+    
+    return jobs;
+}
+
+static bool runBatch(const wxCmdLineParser& parser) {
+    // the same world bounds that the editor uses
+    const BBox3 worldBounds(-16384.0, 16384.0);
+    Batch::Settings settings(worldBounds, formatOption(parser, "format", "Standard"));
+    
+    if (parser.Found("convert")) {
+        settings.outputFormat = formatOption(parser, "convert", "");
+        settings.outputDirectory = IO::Path(stringOption(parser, "output", ""));
+        if (settings.outputDirectory.isEmpty())
+            throw Exception("An output directory is required to convert map files");
+        if (!IO::Disk::directoryExists(IO::Disk::fixPath(settings.outputDirectory)))
+            throw FileSystemException("Output directory does not exist: " + settings.outputDirectory.asString());
+    }
+    
+    Assets::EntityDefinitionManager entityDefinitions;
+    const String definitionPath = stringOption(parser, "definitions", "");
+    if (!definitionPath.empty()) {
+        SilentParserStatus status;
+        entityDefinitions.loadDefinitions(IO::Path(definitionPath), DefinitionLoader(), status);
+        settings.entityDefinitions = &entityDefinitions;
+    }
+    
+    // open the report file first so that we don't process all maps only to fail at the end
+    const String reportPath = stringOption(parser, "report", "");
+    std::ofstream reportFile;
+    if (!reportPath.empty()) {
+        reportFile.open(reportPath.c_str());
+        if (!reportFile.is_open())
+            throw FileSystemException("Cannot open file: " + reportPath);
+    }
+    
+    const size_t workerCount = sizeOption(parser, "jobs", ParallelTaskRunner::defaultThreadCount());
+    const size_t memoryBudget = sizeOption(parser, "memory", 2048) * 1024 * 1024;
+    
+    Batch::Job::List jobs = createJobs(parser, settings);
+    const Batch::WorkerPool pool(workerCount, memoryBudget);
+    pool.run(jobs, settings);
+    
+    const Batch::Report report(BUILD_ID, jobs);
+    if (reportPath.empty())
+        report.write(std::cout);
+    else
+        report.write(reportFile);
+    
+    const bool success = report.failedCount() == 0 && (!parser.Found("strict") || report.issueCount() == 0);
+    VectorUtils::clearAndDelete(jobs);
+    return success;
+}
+
+int main(int argc, char **argv) {
+    wxInitializer initializer(argc, argv);
+    if (!initializer.IsOk()) {
+        std::cerr << "Failed to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+    
+    // use an empty file config so that we always use the default preferences
+    wxConfig::Set(new wxFileConfig("TrenchBroom-Batch"));
+    
+    // set the locale to US so that we can parse floats attribute
+    std::setlocale(LC_NUMERIC, "C");
+    
+    int result = 0;
+    wxCmdLineParser parser(CmdLineDesc, argc, argv);
+    parser.SetSwitchChars("-");
+    
+    const int parseResult = parser.Parse();
+    if (parseResult != 0) {
+        // -1 means that the help was shown
+        result = parseResult == -1 ? 0 : 1;
+    } else {
+        try {
+            result = runBatch(parser) ? 0 : 2;
+        } catch (const Exception& e) {
+            std::cerr << "Batch failed: " << e.what() << std::endl;
+            result = 1;
+        }
+    }
+    
+    delete wxConfig::Set(NULL);
+    return result;
+}
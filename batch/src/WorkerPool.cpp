@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorkerPool.h"
+
+#include <wx/thread.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Batch {
+        class WorkerPool::Queue {
+        private:
+            const Job::List& m_jobs;
+            const Settings& m_settings;
+            const size_t m_memoryBudget;
+            size_t m_next;
+            size_t m_finished;
+            size_t m_runningCount;
+            size_t m_runningMemory;
+            wxMutex m_mutex;
+            wxCondition m_condition;
+        public:
+            Queue(const Job::List& jobs, const Settings& settings, const size_t memoryBudget) :
+            m_jobs(jobs),
+            m_settings(settings),
+            m_memoryBudget(memoryBudget),
+            m_next(0),
+            m_finished(0),
+            m_runningCount(0),
+            m_runningMemory(0),
+            m_condition(m_mutex) {}
+            
+            void runAll() {
+                Job* job = acquire();
+                while (job != NULL) {
+                    job->run(m_settings);
+                    release(job);
+                    job = acquire();
+                }
+            }
+        private:
+            Job* acquire() {
+                wxMutexLocker lock(m_mutex);
+                while (m_next < m_jobs.size() && !fits(m_jobs[m_next]))
+                    m_condition.Wait();
+                
+                if (m_next >= m_jobs.size())
+                    return NULL;
+                
+                Job* job = m_jobs[m_next++];
+                ++m_runningCount;
+                m_runningMemory += job->estimatedMemory();
+                return job;
+            }
+            
+            bool fits(const Job* job) const {
+                return m_runningCount == 0 || m_runningMemory + job->estimatedMemory() <= m_memoryBudget;
+            }
+            
+            void release(const Job* job) {
+                wxMutexLocker lock(m_mutex);
+                assert(m_runningCount > 0);
+                --m_runningCount;
+                m_runningMemory -= job->estimatedMemory();
+                ++m_finished;
+                
+                std::cerr << "[" << m_finished << "/" << m_jobs.size() << "] " << job->path().asString() << ": ";
+                if (job->success())
+                    std::cerr << job->issues().size() << " issue(s)" << std::endl;
+                else
+                    std::cerr << job->error() << std::endl;
+                
+                m_condition.Broadcast();
+            }
+        };
+        
+        class WorkerPool::Worker : public wxThread {
+        private:
+            Queue& m_queue;
+        public:
+            Worker(Queue& queue) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_queue(queue) {}
+        private:
+            ExitCode Entry() {
+                m_queue.runAll();
+                return static_cast<ExitCode>(0);
+            }
+        };
+
+        WorkerPool::WorkerPool(const size_t workerCount, const size_t memoryBudget) :
+        m_workerCount(std::max(workerCount, static_cast<size_t>(1))),
+        m_memoryBudget(memoryBudget) {}
+        
+        void WorkerPool::run(const Job::List& jobs, const Settings& settings) const {
+            Queue queue(jobs, settings, m_memoryBudget);
+            
+            typedef std::vector<Worker*> WorkerList;
+            WorkerList workers;
+            
+            // the calling thread is one of the workers
+            const size_t workerCount = std::min(m_workerCount, jobs.size()) - (jobs.empty() ? 0 : 1);
+            for (size_t i = 0; i < workerCount; ++i) {
+                Worker* worker = new Worker(queue);
+                if (worker->Run() != wxTHREAD_NO_ERROR) {
+                    delete worker;
+                    break;
+                }
+                workers.push_back(worker);
+            }
+            
+            queue.runAll();
+            
+            WorkerList::const_iterator it, end;
+            for (it = workers.begin(), end = workers.end(); it != end; ++it) {
+                Worker* worker = *it;
+                worker->Wait();
+                delete worker;
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_WorkerPool
+#define TrenchBroom_WorkerPool
+
+#include "Job.h"
+
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace Batch {
+        /*
+         Runs jobs on a bounded number of threads. A job is only started if the estimated memory of all running jobs
+         including the new one stays within the memory budget. A job that exceeds the budget on its own is run once no
+         other job is running.
+         */
+        class WorkerPool {
+        private:
+            class Queue;
+            class Worker;
+            
+            size_t m_workerCount;
+            size_t m_memoryBudget;
+        public:
+            WorkerPool(size_t workerCount, size_t memoryBudget);
+            
+            // Runs the given jobs in order and returns when all of them have finished. Prints the progress to stderr.
+            void run(const Job::List& jobs, const Settings& settings) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_WorkerPool) */
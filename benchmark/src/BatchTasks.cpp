@@ -0,0 +1,91 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchTasks.h"
+
+#include "Workload.h"
+#include "CollectionUtils.h"
+#include "WorkerPool.h"
+#include "IO/IOUtils.h"
+
+#include <wx/filename.h>
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        Task::List createBatchTasks() {
+            Task::List tasks;
+            tasks.push_back(new ProcessMapFilesTask(1));
+            tasks.push_back(new ProcessMapFilesTask(4));
+            return tasks;
+        }
+        
+        ProcessMapFilesTask::ProcessMapFilesTask(const size_t workerCount) :
+        Task(taskName(workerCount)),
+        m_workerCount(workerCount),
+        m_directory(IO::Path(wxFileName::GetTempDir().ToStdString()) + IO::Path("TrenchBroom-Benchmark")) {}
+        
+        ProcessMapFilesTask::~ProcessMapFilesTask() {
+            VectorUtils::clearAndDelete(m_jobs);
+        }
+
+        String ProcessMapFilesTask::taskName(const size_t workerCount) {
+            StringStream name;
+            name << "processMapFiles" << workerCount;
+            return name.str();
+        }
+        
+        void ProcessMapFilesTask::doSetUp(const Workload& workload) {
+            wxFileName::Mkdir((m_directory + IO::Path("output")).asString(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+            
+            for (size_t i = 0; i < FileCount; ++i) {
+                StringStream fileName;
+                fileName << "map" << i << ".map";
+                
+                const IO::Path path = m_directory + IO::Path(fileName.str());
+                {
+                    const IO::OpenFile file(path, true);
+                    std::fwrite(workload.data().data(), 1, workload.data().size(), file.file());
+                }
+                m_jobs.push_back(new Batch::Job(path));
+            }
+        }
+        
+        void ProcessMapFilesTask::doRun(const Workload& workload) {
+            Batch::Settings settings(workload.worldBounds(), workload.format());
+            settings.outputFormat = workload.format();
+            settings.outputDirectory = m_directory + IO::Path("output");
+            
+            const Batch::WorkerPool pool(m_workerCount, std::numeric_limits<size_t>::max());
+            pool.run(m_jobs, settings);
+            
+            Batch::Job::List::const_iterator it, end;
+            for (it = m_jobs.begin(), end = m_jobs.end(); it != end; ++it)
+                assert((*it)->success());
+        }
+        
+        void ProcessMapFilesTask::doTearDown() {
+            VectorUtils::clearAndDelete(m_jobs);
+            wxFileName::Rmdir(m_directory.asString(), wxPATH_RMDIR_RECURSIVE);
+        }
+    }
+}
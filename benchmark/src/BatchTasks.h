@@ -0,0 +1,55 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BatchTasks
+#define TrenchBroom_BatchTasks
+
+#include "Job.h"
+#include "Task.h"
+#include "IO/Path.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        // Creates the tasks that run the jobs of the batch tool on copies of the workload. The caller takes ownership.
+        Task::List createBatchTasks();
+        
+        /*
+         Writes copies of the workload to separate map files, then validates and converts all of them with a worker
+         pool of the given size, as the batch tool does.
+         */
+        class ProcessMapFilesTask : public Task {
+        private:
+            static const size_t FileCount = 8;
+            size_t m_workerCount;
+            IO::Path m_directory;
+            Batch::Job::List m_jobs;
+        public:
+            ProcessMapFilesTask(size_t workerCount);
+            ~ProcessMapFilesTask();
+        private:
+            static String taskName(size_t workerCount);
+            
+            void doSetUp(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDown();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_BatchTasks) */
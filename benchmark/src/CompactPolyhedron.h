@@ -0,0 +1,501 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_CompactPolyhedron
+#define TrenchBroom_CompactPolyhedron
+
+#include "Algorithms.h"
+#include "Polyhedron.h"
+#include "VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <map>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+/*
+ An immutable copy of a closed polyhedron that keeps each element type in one contiguous array and refers to other
+ elements by 32 bit indices instead of pointers.
+ 
+ The half edges of a face are stored consecutively in counter clockwise order, so a face boundary is an index range
+ and the next half edge is implied. Every half edge stores the index of its origin vertex and of its twin. The plane
+ of every face is computed once when the polyhedron is compacted. Use polyhedron() to obtain an editable copy again.
+ */
+template <typename T, typename FP, typename VP>
+class CompactPolyhedron {
+public:
+    typedef uint32_t Index;
+    typedef Polyhedron<T,FP,VP> LinkedPolyhedron;
+    
+    struct FaceHit {
+        Index face;
+        T distance;
+        
+        FaceHit(Index i_face, T i_distance);
+        FaceHit();
+        bool isMatch() const;
+    };
+    
+    static const Index NoIndex;
+private:
+    typedef Vec<T,3> V;
+    
+    struct HalfEdge {
+        Index origin;
+        Index twin;
+        
+        HalfEdge(Index i_origin);
+    };
+    
+    struct Edge {
+        Index first;
+        Index second;
+        
+        Edge(Index i_first, Index i_second);
+    };
+    
+    struct Face {
+        Index first;
+        Index count;
+        
+        Face(Index i_first, Index i_count);
+    };
+    
+    typename V::List m_positions;
+    std::vector<typename VP::Type> m_vertexPayloads;
+    std::vector<HalfEdge> m_halfEdges;
+    std::vector<Edge> m_edges;
+    std::vector<Face> m_faces;
+    std::vector<Plane<T,3> > m_planes;
+    std::vector<typename FP::Type> m_facePayloads;
+    BBox<T,3> m_bounds;
+public:
+    CompactPolyhedron();
+    explicit CompactPolyhedron(const LinkedPolyhedron& polyhedron);
+    CompactPolyhedron(const LinkedPolyhedron& polyhedron, const typename LinkedPolyhedron::Callback& callback);
+private:
+    void compact(const LinkedPolyhedron& polyhedron, const typename LinkedPolyhedron::Callback& callback);
+public:
+    LinkedPolyhedron polyhedron() const;
+public: // Accessors
+    size_t vertexCount() const;
+    size_t edgeCount() const;
+    size_t halfEdgeCount() const;
+    size_t faceCount() const;
+    bool empty() const;
+    const BBox<T,3>& bounds() const;
+    
+    // The number of bytes allocated by this polyhedron, including the object itself.
+    size_t memoryUsage() const;
+    
+    const V& position(Index vertex) const;
+    typename VP::Type vertexPayload(Index vertex) const;
+    
+    Index halfEdgeOrigin(Index halfEdge) const;
+    Index halfEdgeDestination(Index halfEdge) const;
+    Index halfEdgeTwin(Index halfEdge) const;
+    Index halfEdgeNext(Index halfEdge) const;
+    Index halfEdgeFace(Index halfEdge) const;
+    
+    Index edgeFirstEdge(Index edge) const;
+    Index edgeSecondEdge(Index edge) const;
+    Index edgeFirstVertex(Index edge) const;
+    Index edgeSecondVertex(Index edge) const;
+    V edgeVector(Index edge) const;
+    
+    Index faceFirstEdge(Index face) const;
+    size_t faceVertexCount(Index face) const;
+    Index faceVertex(Index face, size_t i) const;
+    typename V::List faceVertexPositions(Index face) const;
+    const Plane<T,3>& facePlane(Index face) const;
+    typename FP::Type facePayload(Index face) const;
+public: // geometrical queries
+    FaceHit pickFace(const Ray<T,3>& ray) const;
+    T intersectFaceWithRay(Index face, const Ray<T,3>& ray) const;
+    bool contains(const V& point) const;
+    bool contains(const CompactPolyhedron& other) const;
+private:
+    class GetHalfEdgeOrigin;
+};
+
+template <typename T, typename FP, typename VP>
+const typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::NoIndex = std::numeric_limits<Index>::max();
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::FaceHit::FaceHit(const Index i_face, const T i_distance) : face(i_face), distance(i_distance) {}
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::FaceHit::FaceHit() : face(NoIndex), distance(Math::nan<T>()) {}
+
+template <typename T, typename FP, typename VP>
+bool CompactPolyhedron<T,FP,VP>::FaceHit::isMatch() const { return face != NoIndex; }
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::HalfEdge::HalfEdge(const Index i_origin) : origin(i_origin), twin(NoIndex) {}
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::Edge::Edge(const Index i_first, const Index i_second) : first(i_first), second(i_second) {}
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::Face::Face(const Index i_first, const Index i_count) : first(i_first), count(i_count) {}
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::CompactPolyhedron() {}
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::CompactPolyhedron(const LinkedPolyhedron& polyhedron) {
+    const typename LinkedPolyhedron::Callback callback;
+    compact(polyhedron, callback);
+}
+
+template <typename T, typename FP, typename VP>
+CompactPolyhedron<T,FP,VP>::CompactPolyhedron(const LinkedPolyhedron& polyhedron, const typename LinkedPolyhedron::Callback& callback) {
+    compact(polyhedron, callback);
+}
+
+template <typename T, typename FP, typename VP>
+void CompactPolyhedron<T,FP,VP>::compact(const LinkedPolyhedron& polyhedron, const typename LinkedPolyhedron::Callback& callback) {
+    typedef typename LinkedPolyhedron::Vertex Vertex;
+    typedef typename LinkedPolyhedron::HalfEdge HalfEdge;
+    typedef typename LinkedPolyhedron::Edge Edge;
+    typedef typename LinkedPolyhedron::Face Face;
+    
+    assert(polyhedron.polyhedron() && polyhedron.closed());
+    
+    typedef std::map<const Vertex*, Index> VertexIndices;
+    typedef std::map<const HalfEdge*, Index> HalfEdgeIndices;
+    VertexIndices vertexIndices;
+    HalfEdgeIndices halfEdgeIndices;
+    
+    m_positions.reserve(polyhedron.vertexCount());
+    m_vertexPayloads.reserve(polyhedron.vertexCount());
+    
+    const Vertex* firstVertex = polyhedron.vertices().front();
+    const Vertex* currentVertex = firstVertex;
+    m_bounds.min = m_bounds.max = firstVertex->position();
+    do {
+        vertexIndices[currentVertex] = static_cast<Index>(m_positions.size());
+        m_bounds.mergeWith(currentVertex->position());
+        m_positions.push_back(currentVertex->position());
+        m_vertexPayloads.push_back(currentVertex->payload());
+        currentVertex = currentVertex->next();
+    } while (currentVertex != firstVertex);
+    
+    m_halfEdges.reserve(2 * polyhedron.edgeCount());
+    m_faces.reserve(polyhedron.faceCount());
+    m_planes.reserve(polyhedron.faceCount());
+    m_facePayloads.reserve(polyhedron.faceCount());
+    
+    const Face* firstFace = polyhedron.faces().front();
+    const Face* currentFace = firstFace;
+    do {
+        const Index first = static_cast<Index>(m_halfEdges.size());
+        const HalfEdge* firstEdge = currentFace->boundary().front();
+        const HalfEdge* currentEdge = firstEdge;
+        do {
+            halfEdgeIndices[currentEdge] = static_cast<Index>(m_halfEdges.size());
+            m_halfEdges.push_back(typename CompactPolyhedron::HalfEdge(vertexIndices[currentEdge->origin()]));
+            currentEdge = currentEdge->next();
+        } while (currentEdge != firstEdge);
+        
+        m_faces.push_back(typename CompactPolyhedron::Face(first, static_cast<Index>(m_halfEdges.size()) - first));
+        m_planes.push_back(callback.plane(currentFace));
+        m_facePayloads.push_back(currentFace->payload());
+        currentFace = currentFace->next();
+    } while (currentFace != firstFace);
+    
+    m_edges.reserve(polyhedron.edgeCount());
+    
+    const Edge* firstEdge = polyhedron.edges().front();
+    const Edge* currentEdge = firstEdge;
+    do {
+        const Index first = halfEdgeIndices[currentEdge->firstEdge()];
+        const Index second = halfEdgeIndices[currentEdge->secondEdge()];
+        m_halfEdges[first].twin = second;
+        m_halfEdges[second].twin = first;
+        m_edges.push_back(typename CompactPolyhedron::Edge(first, second));
+        currentEdge = currentEdge->next();
+    } while (currentEdge != firstEdge);
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::LinkedPolyhedron CompactPolyhedron<T,FP,VP>::polyhedron() const {
+    LinkedPolyhedron result;
+    if (empty())
+        return result;
+    
+    typename LinkedPolyhedron::FaceIndexList faces(m_faces.size());
+    for (size_t i = 0; i < m_faces.size(); ++i) {
+        const Face& face = m_faces[i];
+        faces[i].reserve(face.count);
+        for (Index j = 0; j < face.count; ++j)
+            faces[i].push_back(m_halfEdges[face.first + j].origin);
+    }
+    
+    // cannot fail because the topology was taken from a valid polyhedron
+    if (!result.setTopology(m_positions, faces))
+        return result;
+    
+    // setTopology creates the vertices and faces in the given order
+    typename LinkedPolyhedron::Vertex* currentVertex = result.vertices().front();
+    for (size_t i = 0; i < m_vertexPayloads.size(); ++i) {
+        currentVertex->setPayload(m_vertexPayloads[i]);
+        currentVertex = currentVertex->next();
+    }
+    
+    typename LinkedPolyhedron::Face* currentFace = result.faces().front();
+    for (size_t i = 0; i < m_facePayloads.size(); ++i) {
+        currentFace->setPayload(m_facePayloads[i]);
+        currentFace = currentFace->next();
+    }
+    
+    return result;
+}
+
+template <typename T, typename FP, typename VP>
+size_t CompactPolyhedron<T,FP,VP>::vertexCount() const {
+    return m_positions.size();
+}
+
+template <typename T, typename FP, typename VP>
+size_t CompactPolyhedron<T,FP,VP>::edgeCount() const {
+    return m_edges.size();
+}
+
+template <typename T, typename FP, typename VP>
+size_t CompactPolyhedron<T,FP,VP>::halfEdgeCount() const {
+    return m_halfEdges.size();
+}
+
+template <typename T, typename FP, typename VP>
+size_t CompactPolyhedron<T,FP,VP>::faceCount() const {
+    return m_faces.size();
+}
+
+template <typename T, typename FP, typename VP>
+bool CompactPolyhedron<T,FP,VP>::empty() const {
+    return m_faces.empty();
+}
+
+template <typename T, typename FP, typename VP>
+const BBox<T,3>& CompactPolyhedron<T,FP,VP>::bounds() const {
+    return m_bounds;
+}
+
+template <typename T, typename FP, typename VP>
+size_t CompactPolyhedron<T,FP,VP>::memoryUsage() const {
+    return (sizeof(CompactPolyhedron) +
+            m_positions.capacity() * sizeof(V) +
+            m_vertexPayloads.capacity() * sizeof(typename VP::Type) +
+            m_halfEdges.capacity() * sizeof(HalfEdge) +
+            m_edges.capacity() * sizeof(Edge) +
+            m_faces.capacity() * sizeof(Face) +
+            m_planes.capacity() * sizeof(Plane<T,3>) +
+            m_facePayloads.capacity() * sizeof(typename FP::Type));
+}
+
+template <typename T, typename FP, typename VP>
+const typename CompactPolyhedron<T,FP,VP>::V& CompactPolyhedron<T,FP,VP>::position(const Index vertex) const {
+    assert(vertex < m_positions.size());
+    return m_positions[vertex];
+}
+
+template <typename T, typename FP, typename VP>
+typename VP::Type CompactPolyhedron<T,FP,VP>::vertexPayload(const Index vertex) const {
+    assert(vertex < m_vertexPayloads.size());
+    return m_vertexPayloads[vertex];
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::halfEdgeOrigin(const Index halfEdge) const {
+    assert(halfEdge < m_halfEdges.size());
+    return m_halfEdges[halfEdge].origin;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::halfEdgeDestination(const Index halfEdge) const {
+    return halfEdgeOrigin(halfEdgeNext(halfEdge));
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::halfEdgeTwin(const Index halfEdge) const {
+    assert(halfEdge < m_halfEdges.size());
+    return m_halfEdges[halfEdge].twin;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::halfEdgeNext(const Index halfEdge) const {
+    const Face& face = m_faces[halfEdgeFace(halfEdge)];
+    const Index next = halfEdge + 1;
+    return next < face.first + face.count ? next : face.first;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::halfEdgeFace(const Index halfEdge) const {
+    assert(halfEdge < m_halfEdges.size());
+    
+    // the faces are sorted by the index of their first half edge
+    size_t lower = 0;
+    size_t upper = m_faces.size();
+    while (upper - lower > 1) {
+        const size_t middle = (lower + upper) / 2;
+        if (m_faces[middle].first <= halfEdge)
+            lower = middle;
+        else
+            upper = middle;
+    }
+    return static_cast<Index>(lower);
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::edgeFirstEdge(const Index edge) const {
+    assert(edge < m_edges.size());
+    return m_edges[edge].first;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::edgeSecondEdge(const Index edge) const {
+    assert(edge < m_edges.size());
+    return m_edges[edge].second;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::edgeFirstVertex(const Index edge) const {
+    return halfEdgeOrigin(edgeFirstEdge(edge));
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::edgeSecondVertex(const Index edge) const {
+    return halfEdgeOrigin(edgeSecondEdge(edge));
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::V CompactPolyhedron<T,FP,VP>::edgeVector(const Index edge) const {
+    return position(edgeSecondVertex(edge)) - position(edgeFirstVertex(edge));
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::faceFirstEdge(const Index face) const {
+    assert(face < m_faces.size());
+    return m_faces[face].first;
+}
+
+template <typename T, typename FP, typename VP>
+size_t CompactPolyhedron<T,FP,VP>::faceVertexCount(const Index face) const {
+    assert(face < m_faces.size());
+    return m_faces[face].count;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::Index CompactPolyhedron<T,FP,VP>::faceVertex(const Index face, const size_t i) const {
+    assert(i < faceVertexCount(face));
+    return m_halfEdges[m_faces[face].first + i].origin;
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::V::List CompactPolyhedron<T,FP,VP>::faceVertexPositions(const Index face) const {
+    const size_t count = faceVertexCount(face);
+    typename V::List result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        result.push_back(position(faceVertex(face, i)));
+    return result;
+}
+
+template <typename T, typename FP, typename VP>
+const Plane<T,3>& CompactPolyhedron<T,FP,VP>::facePlane(const Index face) const {
+    assert(face < m_planes.size());
+    return m_planes[face];
+}
+
+template <typename T, typename FP, typename VP>
+typename FP::Type CompactPolyhedron<T,FP,VP>::facePayload(const Index face) const {
+    assert(face < m_facePayloads.size());
+    return m_facePayloads[face];
+}
+
+template <typename T, typename FP, typename VP>
+typename CompactPolyhedron<T,FP,VP>::FaceHit CompactPolyhedron<T,FP,VP>::pickFace(const Ray<T,3>& ray) const {
+    for (Index i = 0; i < m_faces.size(); ++i) {
+        const T distance = intersectFaceWithRay(i, ray);
+        if (!Math::isnan(distance))
+            return FaceHit(i, distance);
+    }
+    return FaceHit();
+}
+
+template <typename T, typename FP, typename VP>
+class CompactPolyhedron<T,FP,VP>::GetHalfEdgeOrigin {
+private:
+    const typename V::List& m_positions;
+public:
+    GetHalfEdgeOrigin(const typename V::List& positions) :
+    m_positions(positions) {}
+    
+    const V& operator()(const HalfEdge& halfEdge) const {
+        return m_positions[halfEdge.origin];
+    }
+};
+
+template <typename T, typename FP, typename VP>
+T CompactPolyhedron<T,FP,VP>::intersectFaceWithRay(const Index face, const Ray<T,3>& ray) const {
+    const Plane<T,3>& plane = facePlane(face);
+    
+    // only the front side of a face can be hit
+    const T dot = plane.normal.dot(ray.direction);
+    if (!Math::neg(dot))
+        return Math::nan<T>();
+    
+    const HalfEdge* begin = &m_halfEdges[m_faces[face].first];
+    const HalfEdge* end = begin + m_faces[face].count;
+    return intersectPolygonWithRay(ray, plane, begin, end, GetHalfEdgeOrigin(m_positions));
+}
+
+template <typename T, typename FP, typename VP>
+bool CompactPolyhedron<T,FP,VP>::contains(const V& point) const {
+    if (!bounds().contains(point))
+        return false;
+    
+    for (size_t i = 0; i < m_planes.size(); ++i) {
+        if (m_planes[i].pointStatus(point) == Math::PointStatus::PSAbove)
+            return false;
+    }
+    return true;
+}
+
+template <typename T, typename FP, typename VP>
+bool CompactPolyhedron<T,FP,VP>::contains(const CompactPolyhedron& other) const {
+    if (!bounds().contains(other.bounds()))
+        return false;
+    
+    for (size_t i = 0; i < other.m_positions.size(); ++i) {
+        if (!contains(other.m_positions[i]))
+            return false;
+    }
+    return true;
+}
+
+#endif /* TrenchBroom_CompactPolyhedron */
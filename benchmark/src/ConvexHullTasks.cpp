@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ConvexHullTasks.h"
+
+#include "Polyhedron.h"
+
+#include <cstdlib>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        Task::List createConvexHullTasks(const size_t maxPointCount) {
+            // adding points one by one is quadratic in the number of hull vertices, so it is only measured up to here
+            static const size_t MaxIncrementalPointCount = 1000;
+            
+            Task::List tasks;
+            for (size_t pointCount = 8; pointCount <= maxPointCount; pointCount = pointCount < 100 ? 100 : pointCount * 10) {
+                tasks.push_back(new ConvexHullTask(ConvexHullTask::Shape_Sphere, ConvexHullTask::Mode_Batch, pointCount));
+                tasks.push_back(new ConvexHullTask(ConvexHullTask::Shape_Box, ConvexHullTask::Mode_Batch, pointCount));
+                if (pointCount <= MaxIncrementalPointCount) {
+                    tasks.push_back(new ConvexHullTask(ConvexHullTask::Shape_Sphere, ConvexHullTask::Mode_Incremental, pointCount));
+                    tasks.push_back(new ConvexHullTask(ConvexHullTask::Shape_Box, ConvexHullTask::Mode_Incremental, pointCount));
+                }
+            }
+            return tasks;
+        }
+        
+        ConvexHullTask::ConvexHullTask(const Shape shape, const Mode mode, const size_t pointCount) :
+        Task(taskName(shape, mode, pointCount)),
+        m_shape(shape),
+        m_mode(mode),
+        m_pointCount(pointCount),
+        m_result(0) {}
+        
+        String ConvexHullTask::taskName(const Shape shape, const Mode mode, const size_t pointCount) {
+            StringStream name;
+            name << "convexHull";
+            name << (shape == Shape_Sphere ? "Sphere" : "Box");
+            name << (mode == Mode_Batch ? "Batch" : "Incremental");
+            name << pointCount;
+            return name.str();
+        }
+        
+        static FloatType random(const FloatType min, const FloatType max) {
+            return min + (max - min) * static_cast<FloatType>(std::rand()) / static_cast<FloatType>(RAND_MAX);
+        }
+        
+        void ConvexHullTask::doSetUp(const Workload& workload) {
+            // the same points for every iteration
+            std::srand(static_cast<unsigned int>(m_pointCount));
+            
+            m_points.clear();
+            m_points.reserve(m_pointCount);
+            
+            if (m_shape == Shape_Box) {
+                const Vec3::List corners = bBoxVertices(BBox3(-512.0, 512.0));
+                m_points.insert(m_points.end(), corners.begin(), corners.end());
+            }
+            
+            while (m_points.size() < m_pointCount) {
+                const Vec3 point(random(-512.0, 512.0), random(-512.0, 512.0), random(-512.0, 512.0));
+                if (m_shape == Shape_Box)
+                    m_points.push_back(point);
+                else if (!point.null())
+                    m_points.push_back(point.normalized() * 512.0);
+            }
+        }
+        
+        void ConvexHullTask::doRun(const Workload& workload) {
+            Polyhedron3 hull;
+            if (m_mode == Mode_Batch) {
+                hull.addPoints(m_points);
+            } else {
+                Vec3::List::const_iterator it, end;
+                for (it = m_points.begin(), end = m_points.end(); it != end; ++it)
+                    hull.addPoint(*it);
+            }
+            m_result = hull.vertexCount();
+        }
+        
+        void ConvexHullTask::doTearDown() {
+            m_points.clear();
+        }
+    }
+}
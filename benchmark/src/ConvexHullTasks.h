@@ -0,0 +1,69 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ConvexHullTasks
+#define TrenchBroom_ConvexHullTasks
+
+#include "Task.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         Creates the convex hull tasks for 8 up to the given number of points. These tasks generate their own points
+         and do not depend on the workload. The caller takes ownership of the tasks.
+         */
+        Task::List createConvexHullTasks(size_t maxPointCount);
+        
+        // Builds the convex hull of a fixed set of generated points.
+        class ConvexHullTask : public Task {
+        public:
+            typedef enum {
+                // all points lie on a sphere, so every point is a vertex of the hull
+                Shape_Sphere,
+                // the corners of a cube and random points within it, as when merging many brushes
+                Shape_Box
+            } Shape;
+            
+            typedef enum {
+                // adds all points with Polyhedron::addPoints
+                Mode_Batch,
+                // adds the points one by one with Polyhedron::addPoint
+                Mode_Incremental
+            } Mode;
+        private:
+            Shape m_shape;
+            Mode m_mode;
+            size_t m_pointCount;
+            Vec3::List m_points;
+            size_t m_result;
+        public:
+            ConvexHullTask(Shape shape, Mode mode, size_t pointCount);
+        private:
+            static String taskName(Shape shape, Mode mode, size_t pointCount);
+            
+            void doSetUp(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDown();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_ConvexHullTasks) */
@@ -0,0 +1,69 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryLayouts.h"
+
+#include "Model/Brush.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        AllocatorUsage::AllocatorUsage() :
+        liveBlocks(0),
+        liveBytes(0),
+        chunkBytes(0) {}
+        
+        template <typename T>
+        static void addAllocatorUsage(AllocatorUsage& usage) {
+            const typename T::Statistics statistics = T::statistics();
+            usage.liveBlocks += statistics.liveBlocks;
+            usage.liveBytes += statistics.liveBlocks * sizeof(T);
+            usage.chunkBytes += statistics.bytes;
+        }
+        
+        Model::BrushGeometry* copyGeometry(const Model::Brush* brush) {
+            Vec3::List positions;
+            positions.reserve(brush->vertexCount());
+            
+            const Model::Brush::VertexList vertices = brush->vertices();
+            Model::Brush::VertexList::const_iterator it, end;
+            for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
+                positions.push_back((*it)->position());
+            
+            return new Model::BrushGeometry(positions);
+        }
+        
+        size_t memoryUsage(const Model::BrushGeometry& geometry) {
+            // the elements are allocated from pools, so there is no per allocation overhead
+            return (sizeof(Model::BrushGeometry) +
+                    geometry.vertexCount() * sizeof(Model::BrushVertex) +
+                    geometry.edgeCount() * sizeof(Model::BrushEdge) +
+                    2 * geometry.edgeCount() * sizeof(Model::BrushHalfEdge) +
+                    geometry.faceCount() * sizeof(Model::BrushFaceGeometry));
+        }
+        
+        AllocatorUsage geometryAllocatorUsage() {
+            AllocatorUsage usage;
+            addAllocatorUsage<Model::BrushVertex>(usage);
+            addAllocatorUsage<Model::BrushEdge>(usage);
+            addAllocatorUsage<Model::BrushHalfEdge>(usage);
+            addAllocatorUsage<Model::BrushFaceGeometry>(usage);
+            return usage;
+        }
+    }
+}
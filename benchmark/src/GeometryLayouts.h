@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_GeometryLayouts
+#define TrenchBroom_GeometryLayouts
+
+#include "CompactPolyhedron.h"
+#include "TrenchBroom.h"
+#include "Model/BrushGeometry.h"
+#include "Model/ModelTypes.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        typedef CompactPolyhedron<FloatType, BrushFacePayload, BrushVertexPayload> CompactBrushGeometry;
+        
+        struct AllocatorUsage {
+            size_t liveBlocks;
+            size_t liveBytes;
+            size_t chunkBytes;
+            
+            AllocatorUsage();
+        };
+        
+        // Returns a copy of the geometry of the given brush that is built from its vertices.
+        Model::BrushGeometry* copyGeometry(const Model::Brush* brush);
+        
+        // Returns the number of bytes allocated by the given geometry, including the object itself.
+        size_t memoryUsage(const Model::BrushGeometry& geometry);
+        
+        // Returns the combined statistics of the allocators of the brush geometry elements.
+        AllocatorUsage geometryAllocatorUsage();
+    }
+}
+
+#endif /* defined(TrenchBroom_GeometryLayouts) */
@@ -0,0 +1,201 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapGenerator.h"
+
+#include <cmath>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        static const String TextureNames[] = { "base_wall", "base_floor", "metal1_2", "rock_1732", "skill_ground", "city6_8" };
+        static const size_t TextureCount = sizeof(TextureNames) / sizeof(TextureNames[0]);
+        
+        static String targetName(const size_t index) {
+            StringStream str;
+            str << "t" << index;
+            return str.str();
+        }
+
+        String MapGenerator::grid(const size_t size) {
+            static const FloatType CubeSize = 32.0;
+            static const FloatType Spacing = 64.0;
+            
+            MapGenerator generator(1);
+            generator.beginEntity("worldspawn");
+            
+            const FloatType offset = -Spacing * static_cast<FloatType>(size) / 2.0;
+            for (size_t x = 0; x < size; ++x) {
+                for (size_t y = 0; y < size; ++y) {
+                    for (size_t z = 0; z < size; ++z) {
+                        const Vec3 min(offset + static_cast<FloatType>(x) * Spacing,
+                                       offset + static_cast<FloatType>(y) * Spacing,
+                                       offset + static_cast<FloatType>(z) * Spacing);
+                        const Vec3 max = min + Vec3(CubeSize, CubeSize, CubeSize);
+                        generator.cuboid(BBox3(min, max), TextureNames[(x + y + z) % TextureCount]);
+                    }
+                }
+            }
+            
+            generator.endEntity();
+            return generator.str();
+        }
+        
+        String MapGenerator::detail(const size_t count, const unsigned int seed) {
+            MapGenerator generator(seed);
+            generator.beginEntity("worldspawn");
+            
+            // roughly one brush per 48^3 units so that the brushes overlap a lot
+            const FloatType extent = 48.0 * std::ceil(std::pow(static_cast<FloatType>(count), 1.0 / 3.0)) / 2.0;
+            const BBox3 region(Vec3(-extent, -extent, -extent), Vec3(extent, extent, extent));
+            
+            for (size_t i = 0; i < count; ++i) {
+                const Vec3 center = generator.random(region).rounded();
+                const FloatType radius = std::floor(generator.random(24.0, 48.0));
+                const size_t sides = 3 + generator.random(6);
+                const FloatType angle = generator.random(0.0, Math::Constants<FloatType>::twoPi());
+                const FloatType height = std::floor(generator.random(48.0, 96.0));
+                const Vec2 slope(std::floor(generator.random(-16.0, 16.0)), std::floor(generator.random(-16.0, 16.0)));
+                generator.prism(center, radius, sides, angle, height, slope, TextureNames[generator.random(TextureCount)]);
+            }
+            
+            generator.endEntity();
+            return generator.str();
+        }
+        
+        String MapGenerator::entities(const size_t count, const unsigned int seed) {
+            static const size_t ChainLength = 8;
+            static const String PointClassnames[] = { "light", "info_null", "trigger_relay" };
+            static const size_t PointClassnameCount = sizeof(PointClassnames) / sizeof(PointClassnames[0]);
+            
+            MapGenerator generator(seed);
+            
+            const FloatType extent = 64.0 * std::ceil(std::sqrt(static_cast<FloatType>(count))) / 2.0;
+            const BBox3 region(Vec3(-extent, -extent, 0.0), Vec3(extent, extent, 256.0));
+            
+            generator.beginEntity("worldspawn");
+            generator.cuboid(BBox3(Vec3(-extent, -extent, -16.0), Vec3(extent, extent, 0.0)), TextureNames[1]);
+            generator.endEntity();
+            
+            for (size_t i = 0; i < count; ++i) {
+                const Vec3 position = generator.random(region).rounded();
+                
+                if (i % 4 == 3) {
+                    generator.beginEntity("func_door");
+                } else {
+                    generator.beginEntity(PointClassnames[i % PointClassnameCount]);
+                    generator.attribute("origin", position.asString());
+                }
+                
+                generator.attribute("targetname", targetName(i));
+                if ((i + 1) % ChainLength != 0 && i + 1 < count)
+                    generator.attribute("target", targetName(i + 1));
+                
+                if (i % 4 == 3)
+                    generator.cuboid(BBox3(position, position + Vec3(32.0, 16.0, 64.0)), TextureNames[i % TextureCount]);
+                generator.endEntity();
+            }
+            
+            return generator.str();
+        }
+
+        MapGenerator::MapGenerator(const unsigned int seed) :
+        m_random(seed) {
+            m_stream.precision(17);
+        }
+
+        void MapGenerator::beginEntity(const String& classname) {
+            m_stream << "{\n";
+            attribute("classname", classname);
+        }
+        
+        void MapGenerator::attribute(const String& name, const String& value) {
+            m_stream << "\"" << name << "\" \"" << value << "\"\n";
+        }
+        
+        void MapGenerator::endEntity() {
+            m_stream << "}\n";
+        }
+
+        void MapGenerator::cuboid(const BBox3& bounds, const String& textureName) {
+            const Vec3& min = bounds.min;
+            const Vec3& max = bounds.max;
+            
+            m_stream << "{\n";
+            face(min, min + Vec3::PosY, min + Vec3::PosZ, textureName);
+            face(max, max + Vec3::PosZ, max + Vec3::PosY, textureName);
+            face(min, min + Vec3::PosZ, min + Vec3::PosX, textureName);
+            face(max, max + Vec3::PosX, max + Vec3::PosZ, textureName);
+            face(min, min + Vec3::PosX, min + Vec3::PosY, textureName);
+            face(max, max + Vec3::PosY, max + Vec3::PosX, textureName);
+            m_stream << "}\n";
+        }
+        
+        void MapGenerator::prism(const Vec3& center, const FloatType radius, const size_t sides, const FloatType angle, const FloatType height, const Vec2& slope, const String& textureName) {
+            const FloatType bottom = center.z();
+            const FloatType top = bottom + height;
+
+            Vec3::List ring;
+            ring.reserve(sides);
+            for (size_t i = 0; i < sides; ++i) {
+                const FloatType a = angle + Math::Constants<FloatType>::twoPi() * static_cast<FloatType>(i) / static_cast<FloatType>(sides);
+                ring.push_back(Vec3(center.x() + radius * std::cos(a), center.y() + radius * std::sin(a), bottom).rounded());
+            }
+            
+            m_stream << "{\n";
+            for (size_t i = 0; i < sides; ++i) {
+                const Vec3& p1 = ring[i];
+                const Vec3& p3 = ring[(i + 1) % sides];
+                face(p1, p1 + Vec3::PosZ, p3, textureName);
+            }
+            
+            const Vec3 bottomPoint(center.x(), center.y(), bottom);
+            face(bottomPoint, bottomPoint + Vec3::PosX, bottomPoint + Vec3::PosY, textureName);
+            
+            const Vec3 topPoint(center.x(), center.y(), top);
+            face(topPoint, topPoint + Vec3(0.0, 64.0, slope.y()), topPoint + Vec3(64.0, 0.0, slope.x()), textureName);
+            m_stream << "}\n";
+        }
+        
+        void MapGenerator::face(const Vec3& p1, const Vec3& p2, const Vec3& p3, const String& textureName) {
+            m_stream << "( " << p1.asString() << " ) ( " << p2.asString() << " ) ( " << p3.asString() << " ) " << textureName << " 0 0 0 1 1\n";
+        }
+
+        FloatType MapGenerator::random(const FloatType min, const FloatType max) {
+            // a linear congruential generator, which is good enough for placing brushes and independent of the platform
+            m_random = m_random * 1103515245u + 12345u;
+            const FloatType unit = static_cast<FloatType>((m_random >> 8) & 0xFFFFFF) / static_cast<FloatType>(0x1000000);
+            return min + unit * (max - min);
+        }
+        
+        size_t MapGenerator::random(const size_t count) {
+            return std::min(static_cast<size_t>(random(0.0, static_cast<FloatType>(count))), count - 1);
+        }
+
+        Vec3 MapGenerator::random(const BBox3& bounds) {
+            const FloatType x = random(bounds.min.x(), bounds.max.x());
+            const FloatType y = random(bounds.min.y(), bounds.max.y());
+            const FloatType z = random(bounds.min.z(), bounds.max.z());
+            return Vec3(x, y, z);
+        }
+
+        String MapGenerator::str() const {
+            return m_stream.str();
+        }
+    }
+}
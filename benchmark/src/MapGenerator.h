@@ -0,0 +1,64 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapGenerator
+#define TrenchBroom_MapGenerator
+
+#include "StringUtils.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         Generates synthetic maps in the standard map format. The generated maps only depend on the given sizes and
+         seeds, so that results can be compared between runs.
+         */
+        class MapGenerator {
+        private:
+            StringStream m_stream;
+            unsigned int m_random;
+        public:
+            // A grid of size * size * size axis aligned cubes in the worldspawn entity.
+            static String grid(size_t size);
+            // The given number of small prisms with slanted tops densely packed in the worldspawn entity.
+            static String detail(size_t count, unsigned int seed = 1);
+            // The given number of point and brush entities that are linked in short chains.
+            static String entities(size_t count, unsigned int seed = 1);
+        private:
+            MapGenerator(unsigned int seed);
+            
+            void beginEntity(const String& classname);
+            void attribute(const String& name, const String& value);
+            void endEntity();
+            
+            void cuboid(const BBox3& bounds, const String& textureName);
+            void prism(const Vec3& center, FloatType radius, size_t sides, FloatType angle, FloatType height, const Vec2& slope, const String& textureName);
+            void face(const Vec3& p1, const Vec3& p2, const Vec3& p3, const String& textureName);
+            
+            FloatType random(FloatType min, FloatType max);
+            size_t random(size_t count);
+            Vec3 random(const BBox3& bounds);
+            
+            String str() const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapGenerator) */
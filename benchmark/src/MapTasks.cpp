@@ -0,0 +1,509 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapTasks.h"
+#include "PrintfMapSerializer.h"
+
+#include "Workload.h"
+#include "CollectionUtils.h"
+#include "ParallelTaskRunner.h"
+#include "IO/MapFileSerializer.h"
+#include "IO/MapFileSplicer.h"
+#include "IO/NodeWriter.h"
+#include "IO/StandardMapParser.h"
+#include "IO/WorldReader.h"
+#include "Model/AssortNodesVisitor.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/ComputeNodeBoundsVisitor.h"
+#include "Model/Entity.h"
+#include "Model/PickResult.h"
+#include "Model/Snapshot.h"
+#include "Model/TransformObjectVisitor.h"
+#include "Model/World.h"
+#include "Renderer/BrushRenderer.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        Task::List createMapTasks() {
+            Task::List tasks;
+            tasks.push_back(new ParseMapTask(false));
+            tasks.push_back(new ParseMapTask(true));
+            tasks.push_back(new TokenizeMapTask(false));
+            tasks.push_back(new TokenizeMapTask(true));
+            tasks.push_back(new BuildBrushGeometryTask());
+            tasks.push_back(new PickTask(false));
+            tasks.push_back(new PickTask(true));
+            tasks.push_back(new TraverseLinkedGeometryTask());
+            tasks.push_back(new TraverseCompactGeometryTask());
+            tasks.push_back(new VertexQueriesTask());
+            tasks.push_back(new CollectBrushVerticesTask());
+            
+            const Model::MapFormat::Type formats[] = { Model::MapFormat::Standard, Model::MapFormat::Quake2, Model::MapFormat::Valve, Model::MapFormat::Hexen2 };
+            for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+                tasks.push_back(new WriteMapFileTask(formats[i], false));
+                tasks.push_back(new WriteMapFileTask(formats[i], true));
+            }
+            
+            tasks.push_back(new SaveMapTask(false));
+            tasks.push_back(new SaveMapTask(true));
+            tasks.push_back(new TransformUndoRedoTask());
+            return tasks;
+        }
+
+        ParseMapTask::ParseMapTask(const bool deferBrushGeometry) :
+        Task(deferBrushGeometry ? "parseMapDeferred" : "parseMap"),
+        m_deferBrushGeometry(deferBrushGeometry),
+        m_world(NULL) {}
+        
+        void ParseMapTask::doRun(const Workload& workload) {
+            m_world = workload.createWorld(m_deferBrushGeometry);
+        }
+        
+        void ParseMapTask::doTearDown() {
+            delete m_world;
+            m_world = NULL;
+        }
+
+        TokenizeMapTask::TokenizeMapTask(const bool copyNumbers) :
+        Task(copyNumbers ? "tokenizeMapCopy" : "tokenizeMap"),
+        m_copyNumbers(copyNumbers),
+        m_result(0.0) {}
+        
+        void TokenizeMapTask::doRun(const Workload& workload) {
+            typedef IO::QuakeMapTokenizer::Token Token;
+            
+            double result = 0.0;
+            IO::QuakeMapTokenizer tokenizer(workload.data());
+            for (Token token = tokenizer.nextToken(); token.type() != IO::QuakeMapToken::Eof; token = tokenizer.nextToken()) {
+                if (token.type() & (IO::QuakeMapToken::Integer | IO::QuakeMapToken::Decimal)) {
+                    if (m_copyNumbers)
+                        result += std::atof(token.data().c_str());
+                    else
+                        result += token.toFloat<double>();
+                }
+            }
+            m_result = result;
+        }
+        
+        WorldTask::WorldTask(const String& name) :
+        Task(name),
+        m_world(NULL) {}
+        
+        Model::World* WorldTask::world() const {
+            assert(m_world != NULL);
+            return m_world;
+        }
+        
+        Model::BrushList WorldTask::brushes() const {
+            Model::CollectBrushesVisitor visitor;
+            world()->acceptAndRecurse(visitor);
+            return visitor.brushes();
+        }
+
+        void WorldTask::doSetUp(const Workload& workload) {
+            m_world = workload.createWorld();
+            doSetUpWorld(workload);
+        }
+        
+        void WorldTask::doTearDown() {
+            doTearDownWorld();
+            delete m_world;
+            m_world = NULL;
+        }
+        
+        void WorldTask::doSetUpWorld(const Workload& workload) {}
+        void WorldTask::doTearDownWorld() {}
+
+        BuildBrushGeometryTask::BuildBrushGeometryTask() :
+        WorldTask("buildBrushGeometry") {}
+        
+        void BuildBrushGeometryTask::doSetUpWorld(const Workload& workload) {
+            const Model::BrushList brushes = this->brushes();
+            m_faces.reserve(brushes.size());
+            m_brushes.reserve(brushes.size());
+            
+            Model::BrushList::const_iterator bIt, bEnd;
+            for (bIt = brushes.begin(), bEnd = brushes.end(); bIt != bEnd; ++bIt) {
+                const Model::BrushFaceList& faces = (*bIt)->faces();
+                
+                Model::BrushFaceList clones;
+                clones.reserve(faces.size());
+                
+                Model::BrushFaceList::const_iterator fIt, fEnd;
+                for (fIt = faces.begin(), fEnd = faces.end(); fIt != fEnd; ++fIt)
+                    clones.push_back((*fIt)->clone());
+                m_faces.push_back(clones);
+            }
+        }
+        
+        void BuildBrushGeometryTask::doRun(const Workload& workload) {
+            // the brushes take ownership of the faces
+            BrushFaceLists::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                m_brushes.push_back(world()->createBrush(workload.worldBounds(), *it));
+            m_faces.clear();
+        }
+        
+        void BuildBrushGeometryTask::doTearDownWorld() {
+            BrushFaceLists::iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                VectorUtils::clearAndDelete(*it);
+            m_faces.clear();
+            VectorUtils::clearAndDelete(m_brushes);
+        }
+
+        PickTask::PickTask(const bool firstBrushOnly) :
+        WorldTask(firstBrushOnly ? "pickFirstBrush" : "pick"),
+        m_firstBrushOnly(firstBrushOnly) {}
+        
+        void PickTask::doSetUpWorld(const Workload& workload) {
+            Model::ComputeNodeBoundsVisitor visitor;
+            world()->acceptAndRecurse(visitor);
+            const BBox3 bounds = visitor.bounds().expanded(64.0);
+            const Vec3 size = bounds.size();
+            
+            // every ray enters the map bounds from above and leaves them at the opposite side of the bottom
+            m_rays.reserve(RayGridSize * RayGridSize);
+            for (size_t i = 0; i < RayGridSize; ++i) {
+                for (size_t j = 0; j < RayGridSize; ++j) {
+                    const FloatType u = (static_cast<FloatType>(i) + 0.5) / static_cast<FloatType>(RayGridSize);
+                    const FloatType v = (static_cast<FloatType>(j) + 0.5) / static_cast<FloatType>(RayGridSize);
+                    const Vec3 origin(bounds.min.x() + u * size.x(), bounds.min.y() + v * size.y(), bounds.max.z());
+                    const Vec3 target(bounds.max.x() - v * size.x(), bounds.max.y() - u * size.y(), bounds.min.z());
+                    m_rays.push_back(Ray3(origin, (target - origin).normalized()));
+                }
+            }
+        }
+        
+        void PickTask::doRun(const Workload& workload) {
+            std::vector<Ray3>::const_iterator it, end;
+            for (it = m_rays.begin(), end = m_rays.end(); it != end; ++it) {
+                Model::PickResult pickResult = m_firstBrushOnly ? Model::PickResult::firstByDistance(m_editorContext, Model::Brush::BrushHit, 1) : Model::PickResult::byDistance(m_editorContext);
+                world()->pick(*it, pickResult);
+            }
+        }
+        
+        void PickTask::doTearDownWorld() {
+            m_rays.clear();
+        }
+
+        // Returns two rays that hit the given bounds through their center, one from above and one from the side.
+        static void geometryRays(const BBox3& bounds, Ray3 (&rays)[2]) {
+            const Vec3 center = bounds.center();
+            const Vec3 size = bounds.size();
+            rays[0] = Ray3(center + Vec3(0.0, 0.0, size.z()), Vec3::NegZ);
+            rays[1] = Ray3(center + Vec3(size.x(), 0.0, 0.0), Vec3::NegX);
+        }
+        
+        TraverseLinkedGeometryTask::TraverseLinkedGeometryTask() :
+        WorldTask("traverseLinkedGeometry"),
+        m_result(0) {}
+        
+        void TraverseLinkedGeometryTask::doSetUpWorld(const Workload& workload) {
+            const Model::BrushList brushes = this->brushes();
+            m_geometries.reserve(brushes.size());
+            
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                m_geometries.push_back(copyGeometry(*it));
+        }
+        
+        void TraverseLinkedGeometryTask::doRun(const Workload& workload) {
+            size_t result = 0;
+            for (size_t i = 0; i < m_geometries.size(); ++i) {
+                const Model::BrushGeometry& geometry = *m_geometries[i];
+                
+                Ray3 rays[2];
+                geometryRays(geometry.bounds(), rays);
+                for (size_t j = 0; j < 2; ++j) {
+                    if (geometry.pickFace(rays[j]).isMatch())
+                        ++result;
+                }
+                
+                const Model::BrushFaceGeometry* firstFace = geometry.faces().front();
+                const Model::BrushFaceGeometry* currentFace = firstFace;
+                do {
+                    const Model::BrushHalfEdge* firstEdge = currentFace->boundary().front();
+                    const Model::BrushHalfEdge* currentEdge = firstEdge;
+                    do {
+                        if (currentEdge->origin()->position().z() > 0.0)
+                            ++result;
+                        currentEdge = currentEdge->next();
+                    } while (currentEdge != firstEdge);
+                    currentFace = currentFace->next();
+                } while (currentFace != firstFace);
+                
+                if (i + 1 < m_geometries.size() && geometry.contains(m_geometries[i + 1]->bounds().center()))
+                    ++result;
+            }
+            m_result = result;
+        }
+        
+        void TraverseLinkedGeometryTask::doTearDownWorld() {
+            VectorUtils::clearAndDelete(m_geometries);
+        }
+        
+        TraverseCompactGeometryTask::TraverseCompactGeometryTask() :
+        WorldTask("traverseCompactGeometry"),
+        m_result(0) {}
+        
+        void TraverseCompactGeometryTask::doSetUpWorld(const Workload& workload) {
+            const Model::BrushList brushes = this->brushes();
+            m_geometries.reserve(brushes.size());
+            
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                const std::auto_ptr<Model::BrushGeometry> geometry(copyGeometry(*it));
+                m_geometries.push_back(CompactBrushGeometry(*geometry));
+            }
+        }
+        
+        void TraverseCompactGeometryTask::doRun(const Workload& workload) {
+            typedef CompactBrushGeometry::Index Index;
+            
+            size_t result = 0;
+            for (size_t i = 0; i < m_geometries.size(); ++i) {
+                const CompactBrushGeometry& geometry = m_geometries[i];
+                
+                Ray3 rays[2];
+                geometryRays(geometry.bounds(), rays);
+                for (size_t j = 0; j < 2; ++j) {
+                    if (geometry.pickFace(rays[j]).isMatch())
+                        ++result;
+                }
+                
+                for (Index face = 0; face < geometry.faceCount(); ++face) {
+                    const size_t vertexCount = geometry.faceVertexCount(face);
+                    for (size_t j = 0; j < vertexCount; ++j) {
+                        if (geometry.position(geometry.faceVertex(face, j)).z() > 0.0)
+                            ++result;
+                    }
+                }
+                
+                if (i + 1 < m_geometries.size() && geometry.contains(m_geometries[i + 1].bounds().center()))
+                    ++result;
+            }
+            m_result = result;
+        }
+        
+        void TraverseCompactGeometryTask::doTearDownWorld() {
+            m_geometries.clear();
+        }
+
+        VertexQueriesTask::VertexQueriesTask() :
+        WorldTask("vertexQueries"),
+        m_result(0) {}
+        
+        void VertexQueriesTask::doSetUpWorld(const Workload& workload) {
+            const Model::BrushList brushes = this->brushes();
+            m_queries.reserve(brushes.size());
+            
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                Model::Brush* brush = *it;
+                const Model::BrushEdge* edge = *brush->edges().begin();
+                
+                Vec3::List facePositions;
+                const Model::BrushFace::VertexList faceVertices = brush->faces().front()->vertices();
+                Model::BrushFace::VertexList::const_iterator vIt, vEnd;
+                for (vIt = faceVertices.begin(), vEnd = faceVertices.end(); vIt != vEnd; ++vIt)
+                    facePositions.push_back((*vIt)->position());
+                
+                Query query;
+                query.brush = brush;
+                query.vertex = (*brush->vertices().begin())->position();
+                query.edge = Edge3(edge->firstVertex()->position(), edge->secondVertex()->position());
+                query.face = Polygon3(static_cast<const Vec3::List&>(facePositions));
+                m_queries.push_back(query);
+            }
+        }
+        
+        void VertexQueriesTask::doRun(const Workload& workload) {
+            const BBox3& worldBounds = workload.worldBounds();
+            const Vec3 delta(4.0, 2.0, 1.0);
+            
+            size_t result = 0;
+            std::vector<Query>::const_iterator it, end;
+            for (it = m_queries.begin(), end = m_queries.end(); it != end; ++it) {
+                const Query& query = *it;
+                Model::Brush* brush = query.brush;
+                
+                result += brush->canMoveVertices(worldBounds, Vec3::List(1, query.vertex), delta);
+                result += brush->canMoveEdges(worldBounds, Edge3::List(1, query.edge), delta);
+                result += brush->canSplitEdge(worldBounds, query.edge, delta);
+                result += brush->canMoveFaces(worldBounds, Polygon3::List(1, query.face), delta);
+                result += brush->canSplitFace(worldBounds, query.face, delta);
+            }
+            m_result = result;
+        }
+        
+        void VertexQueriesTask::doTearDownWorld() {
+            m_queries.clear();
+        }
+        
+        CollectBrushVerticesTask::CollectBrushVerticesTask() :
+        WorldTask("collectBrushVertices"),
+        m_renderer(NULL) {}
+        
+        void CollectBrushVerticesTask::doSetUpWorld(const Workload& workload) {
+            m_renderer = new Renderer::BrushRenderer(false);
+            m_brushes = brushes();
+        }
+        
+        void CollectBrushVerticesTask::doRun(const Workload& workload) {
+            m_renderer->setBrushes(m_brushes);
+            m_renderer->prepare();
+        }
+        
+        void CollectBrushVerticesTask::doTearDownWorld() {
+            delete m_renderer;
+            m_renderer = NULL;
+            m_brushes.clear();
+        }
+
+        WriteMapFileTask::WriteMapFileTask(const Model::MapFormat::Type format, const bool printf) :
+        WorldTask("writeMapFile" + Model::formatName(format) + (printf ? "Printf" : "")),
+        m_format(format),
+        m_printf(printf) {}
+        
+        void WriteMapFileTask::doRun(const Workload& workload) {
+            FILE* file = std::tmpfile();
+            assert(file != NULL);
+            {
+                IO::NodeSerializer::Ptr serializer(m_printf ? new PrintfMapSerializer(m_format, file) : IO::MapFileSerializer::create(m_format, file).release());
+                IO::NodeWriter writer(world(), serializer);
+                writer.writeMap();
+            }
+            std::fclose(file);
+        }
+
+        static String readFile(FILE* file) {
+            String result;
+            std::rewind(file);
+            
+            char buffer[65536];
+            size_t count;
+            while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, count);
+            return result;
+        }
+        
+        static void writeMapFile(Model::World* world, FILE* file, const IO::MapFileSplicer* splicer) {
+            IO::NodeWriter writer(world, file, 1, splicer);
+            writer.writeMap();
+        }
+        
+        SaveMapTask::SaveMapTask(const bool incremental) :
+        WorldTask(incremental ? "saveMapIncremental" : "saveMap"),
+        m_incremental(incremental),
+        m_splicer(NULL) {}
+        
+        void SaveMapTask::doSetUpWorld(const Workload& workload) {
+            if (!m_incremental)
+                return;
+            
+            FILE* file = std::tmpfile();
+            assert(file != NULL);
+            writeMapFile(world(), file, NULL);
+            
+            const String text = readFile(file);
+            std::fclose(file);
+            
+            m_splicer = new IO::MapFileSplicer();
+            m_splicer->record(text.data(), text.data() + text.size(), world());
+            
+            const Model::BrushList brushes = this->brushes();
+            Model::NodeList changedBrushes;
+            for (size_t i = 0; i < brushes.size(); i += ChangedBrushInterval)
+                changedBrushes.push_back(brushes[i]);
+            m_splicer->nodesDidChange(changedBrushes);
+        }
+        
+        void SaveMapTask::doRun(const Workload& workload) {
+            FILE* file = std::tmpfile();
+            assert(file != NULL);
+            writeMapFile(world(), file, m_splicer);
+            
+            // the document records the written file to splice it on the next save
+            if (m_incremental) {
+                const String text = readFile(file);
+                m_splicer->record(text.data(), text.data() + text.size(), world());
+            }
+            std::fclose(file);
+        }
+        
+        void SaveMapTask::doTearDownWorld() {
+            delete m_splicer;
+            m_splicer = NULL;
+        }
+
+        TransformUndoRedoTask::TransformUndoRedoTask() :
+        WorldTask("transformUndoRedo") {}
+        
+        void TransformUndoRedoTask::doSetUpWorld(const Workload& workload) {
+            Model::CollectObjectsVisitor visitor;
+            world()->acceptAndRecurse(visitor);
+            
+            const Model::BrushList& brushes = visitor.brushes();
+            m_nodes.insert(m_nodes.end(), brushes.begin(), brushes.end());
+            
+            // brush entities are transformed by transforming their brushes
+            const Model::EntityList& entities = visitor.entities();
+            Model::EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Model::Entity* entity = *it;
+                if (!entity->hasChildren())
+                    m_nodes.push_back(entity);
+            }
+            
+            Model::ComputeNodeBoundsVisitor boundsVisitor;
+            world()->acceptAndRecurse(boundsVisitor);
+            const Vec3 center = boundsVisitor.bounds().center().rounded();
+            m_transformation = translationMatrix(center) * Mat4x4::Rot90ZCW * translationMatrix(-center);
+        }
+        
+        void TransformUndoRedoTask::doRun(const Workload& workload) {
+            Model::Snapshot* snapshot = new Model::Snapshot(m_nodes.begin(), m_nodes.end());
+            transform(workload);
+            
+            snapshot->restoreNodes(workload.worldBounds());
+            delete snapshot;
+            
+            snapshot = new Model::Snapshot(m_nodes.begin(), m_nodes.end());
+            transform(workload);
+            delete snapshot;
+        }
+        
+        void TransformUndoRedoTask::doTearDownWorld() {
+            m_nodes.clear();
+        }
+
+        void TransformUndoRedoTask::transform(const Workload& workload) {
+            Model::TransformObjectVisitor visitor(m_transformation, true, workload.worldBounds());
+            Model::Node::accept(m_nodes.begin(), m_nodes.end(), visitor);
+            visitor.transformBrushes(ParallelTaskRunner());
+        }
+    }
+}
@@ -0,0 +1,238 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapTasks
+#define TrenchBroom_MapTasks
+
+#include "GeometryLayouts.h"
+#include "Task.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/EditorContext.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapFileSplicer;
+    }
+    
+    namespace Renderer {
+        class BrushRenderer;
+    }
+    
+    namespace Benchmark {
+        // Creates all tasks that are run on every workload. The caller takes ownership of the tasks.
+        Task::List createMapTasks();
+        
+        // Parses the workload with a MapReader, optionally building the brush geometry in a batch after reading.
+        class ParseMapTask : public Task {
+        private:
+            bool m_deferBrushGeometry;
+            Model::World* m_world;
+        public:
+            ParseMapTask(bool deferBrushGeometry);
+        private:
+            void doRun(const Workload& workload);
+            void doTearDown();
+        };
+        
+        /*
+         Tokenizes the workload and converts all numbers, either directly from the token or from a copy of it with
+         std::atof as the parser did before.
+         */
+        class TokenizeMapTask : public Task {
+        private:
+            bool m_copyNumbers;
+            double m_result;
+        public:
+            TokenizeMapTask(bool copyNumbers);
+        private:
+            void doRun(const Workload& workload);
+        };
+        
+        // Base class for tasks that operate on the parsed workload.
+        class WorldTask : public Task {
+        private:
+            Model::World* m_world;
+        protected:
+            WorldTask(const String& name);
+            
+            Model::World* world() const;
+            Model::BrushList brushes() const;
+        private:
+            void doSetUp(const Workload& workload);
+            void doTearDown();
+            
+            virtual void doSetUpWorld(const Workload& workload);
+            virtual void doTearDownWorld();
+        };
+        
+        // Builds the geometry of every brush from its faces.
+        class BuildBrushGeometryTask : public WorldTask {
+        private:
+            typedef std::vector<Model::BrushFaceList> BrushFaceLists;
+            BrushFaceLists m_faces;
+            Model::BrushList m_brushes;
+        public:
+            BuildBrushGeometryTask();
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        /*
+         Picks the world with a fixed fan of rays that cross the map bounds. Either all hits are collected, as the map
+         views do when the mouse moves, or only the first brush hit, as the 3D view does when it places new objects.
+         */
+        class PickTask : public WorldTask {
+        private:
+            static const size_t RayGridSize = 32;
+            Model::EditorContext m_editorContext;
+            std::vector<Ray3> m_rays;
+            bool m_firstBrushOnly;
+        public:
+            PickTask(bool firstBrushOnly);
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        /*
+         Traverses copies of all brush geometries in the pointer linked layout. Every geometry is picked with two rays
+         through its center, the boundaries of all of its faces are walked, and it is tested whether it contains the
+         center of the next geometry.
+         */
+        class TraverseLinkedGeometryTask : public WorldTask {
+        private:
+            std::vector<Model::BrushGeometry*> m_geometries;
+            size_t m_result;
+        public:
+            TraverseLinkedGeometryTask();
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        // Performs the same traversal as TraverseLinkedGeometryTask on compact copies of the brush geometries.
+        class TraverseCompactGeometryTask : public WorldTask {
+        private:
+            std::vector<CompactBrushGeometry> m_geometries;
+            size_t m_result;
+        public:
+            TraverseCompactGeometryTask();
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        /*
+         Asks every brush whether one of its vertices, edges and faces can be moved and split, as the vertex tool does
+         for every selected brush while a handle is dragged.
+         */
+        class VertexQueriesTask : public WorldTask {
+        private:
+            struct Query {
+                Model::Brush* brush;
+                Vec3 vertex;
+                Edge3 edge;
+                Polygon3 face;
+            };
+            
+            std::vector<Query> m_queries;
+            size_t m_result;
+        public:
+            VertexQueriesTask();
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        // Collects the vertices and indices that are uploaded to the GPU when rendering all brushes.
+        class CollectBrushVerticesTask : public WorldTask {
+        private:
+            Renderer::BrushRenderer* m_renderer;
+            Model::BrushList m_brushes;
+        public:
+            CollectBrushVerticesTask();
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        /*
+         Writes the world to a new temporary file in the given format, either with the serializer that the document
+         uses or with one std::fprintf call per line as before.
+         */
+        class WriteMapFileTask : public WorldTask {
+        private:
+            Model::MapFormat::Type m_format;
+            bool m_printf;
+        public:
+            WriteMapFileTask(Model::MapFormat::Type format, bool printf);
+        private:
+            void doRun(const Workload& workload);
+        };
+        
+        /*
+         Writes the world to a new temporary file as the document does when it is saved. An incremental save copies
+         the text of all but every hundredth brush from the previously written file and records the new file again.
+         */
+        class SaveMapTask : public WorldTask {
+        private:
+            static const size_t ChangedBrushInterval = 100;
+            bool m_incremental;
+            IO::MapFileSplicer* m_splicer;
+        public:
+            SaveMapTask(bool incremental);
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+        };
+        
+        /*
+         Rotates all brushes and point entities around the center of the map, undoes the rotation and redoes it
+         again in the same way as the transform command does.
+         */
+        class TransformUndoRedoTask : public WorldTask {
+        private:
+            Model::NodeList m_nodes;
+            Mat4x4 m_transformation;
+        public:
+            TransformUndoRedoTask();
+        private:
+            void doSetUpWorld(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDownWorld();
+            
+            void transform(const Workload& workload);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapTasks) */
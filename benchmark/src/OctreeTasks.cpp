@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OctreeTasks.h"
+
+#include <cstdlib>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        // the same world bounds and minimum node size as in the spatial index of the world
+        static const BBox3 WorldBounds(-16384.0, 16384.0);
+        static const FloatType MinNodeSize = 64.0;
+        
+        // the objects are spread over a region of the world that is about as large as a big map
+        static const FloatType MapExtent = 8192.0;
+        
+        // the number of steps and the offset per step of the update task
+        static const size_t UpdateSteps = 8;
+        static const FloatType UpdateStep = 8.0;
+        
+        // the number of rays and boxes of the query task
+        static const size_t QueryCount = 10000;
+        
+        Task::List createOctreeTasks(const size_t objectCount) {
+            Task::List tasks;
+            if (objectCount > 0) {
+                tasks.push_back(new OctreeTask(OctreeTask::Operation_Insert, objectCount));
+                tasks.push_back(new OctreeTask(OctreeTask::Operation_Update, objectCount));
+                tasks.push_back(new OctreeTask(OctreeTask::Operation_Query, objectCount));
+            }
+            return tasks;
+        }
+        
+        OctreeTask::OctreeTask(const Operation operation, const size_t objectCount) :
+        Task(taskName(operation, objectCount)),
+        m_operation(operation),
+        m_objectCount(objectCount),
+        m_octree(NULL),
+        m_result(0) {}
+        
+        OctreeTask::~OctreeTask() {
+            delete m_octree;
+        }
+        
+        String OctreeTask::taskName(const Operation operation, const size_t objectCount) {
+            StringStream name;
+            name << "octree";
+            switch (operation) {
+                case Operation_Insert:
+                    name << "Insert";
+                    break;
+                case Operation_Update:
+                    name << "Update";
+                    break;
+                case Operation_Query:
+                    name << "Query";
+                    break;
+            }
+            name << objectCount;
+            return name.str();
+        }
+        
+        static FloatType random(const FloatType min, const FloatType max) {
+            return min + (max - min) * static_cast<FloatType>(std::rand()) / static_cast<FloatType>(RAND_MAX);
+        }
+        
+        void OctreeTask::doSetUp(const Workload& workload) {
+            // the same objects for every iteration
+            std::srand(static_cast<unsigned int>(m_objectCount));
+            
+            m_bounds.clear();
+            m_bounds.reserve(m_objectCount);
+            for (size_t i = 0; i < m_objectCount; ++i) {
+                // mostly small brushes and some large ones, such as floors and walls
+                const FloatType maxSize = i % 50 == 0 ? 1024.0 : 128.0;
+                const Vec3 min(random(-MapExtent, MapExtent), random(-MapExtent, MapExtent), random(-MapExtent, MapExtent));
+                const Vec3 size(random(8.0, maxSize), random(8.0, maxSize), random(8.0, maxSize));
+                m_bounds.push_back(BBox3(min, min + size));
+            }
+            
+            delete m_octree;
+            m_octree = new ObjectTree(WorldBounds, MinNodeSize);
+            if (m_operation != Operation_Insert) {
+                for (size_t i = 0; i < m_bounds.size(); ++i)
+                    m_octree->addObject(m_bounds[i], &m_bounds[i]);
+            }
+            m_result = 0;
+        }
+        
+        void OctreeTask::doRun(const Workload& workload) {
+            switch (m_operation) {
+                case Operation_Insert:
+                    for (size_t i = 0; i < m_bounds.size(); ++i)
+                        m_octree->addObject(m_bounds[i], &m_bounds[i]);
+                    break;
+                case Operation_Update:
+                    for (size_t step = 0; step < UpdateSteps; ++step) {
+                        const Vec3 delta(UpdateStep, UpdateStep / 2.0, 0.0);
+                        for (size_t i = 0; i < m_bounds.size(); ++i) {
+                            m_bounds[i].translate(delta);
+                            m_octree->updateObject(m_bounds[i], &m_bounds[i]);
+                        }
+                    }
+                    break;
+                case Operation_Query:
+                    for (size_t i = 0; i < QueryCount; ++i) {
+                        const Vec3 origin(random(-MapExtent, MapExtent), random(-MapExtent, MapExtent), random(-MapExtent, MapExtent));
+                        const Vec3 direction = Vec3(random(-1.0, 1.0), random(-1.0, 1.0), random(-1.0, 1.0)).normalized();
+                        m_result += m_octree->findObjects(Ray3(origin, direction)).size();
+                        m_result += m_octree->findObjects(BBox3(origin, origin + Vec3(256.0, 256.0, 256.0))).size();
+                    }
+                    break;
+            }
+        }
+        
+        void OctreeTask::doTearDown() {
+            delete m_octree;
+            m_octree = NULL;
+            m_bounds.clear();
+        }
+    }
+}
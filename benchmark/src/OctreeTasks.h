@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_OctreeTasks
+#define TrenchBroom_OctreeTasks
+
+#include "Task.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/Octree.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         Creates the octree tasks on the given number of objects. These tasks generate the bounds of their objects and
+         do not depend on the workload. The caller takes ownership of the tasks.
+         */
+        Task::List createOctreeTasks(size_t objectCount);
+        
+        // Runs one operation on an octree that is filled with brush sized boxes, as in the spatial index of the world.
+        class OctreeTask : public Task {
+        public:
+            typedef enum {
+                // inserts all objects into an empty octree
+                Operation_Insert,
+                // moves all objects in small steps, as when dragging a selection
+                Operation_Update,
+                // picks with rays and finds the objects in boxes
+                Operation_Query
+            } Operation;
+        private:
+            typedef std::vector<BBox3> BoundsList;
+            typedef Model::Octree<FloatType, const BBox3*> ObjectTree;
+            
+            Operation m_operation;
+            size_t m_objectCount;
+            BoundsList m_bounds;
+            ObjectTree* m_octree;
+            size_t m_result;
+        public:
+            OctreeTask(Operation operation, size_t objectCount);
+            ~OctreeTask();
+        private:
+            static String taskName(Operation operation, size_t objectCount);
+            
+            void doSetUp(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDown();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_OctreeTasks) */
@@ -0,0 +1,112 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrintfMapSerializer.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/Node.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        PrintfMapSerializer::PrintfMapSerializer(const Model::MapFormat::Type format, FILE* stream) :
+        m_format(format),
+        m_stream(stream),
+        m_line(1) {
+            assert(m_stream != NULL);
+        }
+        
+        void PrintfMapSerializer::doBeginEntity(const Model::Node* node) {
+            m_startLineStack.push_back(m_line);
+            std::fprintf(m_stream, "{\n");
+            ++m_line;
+        }
+        
+        void PrintfMapSerializer::doEndEntity(Model::Node* node) {
+            std::fprintf(m_stream, "}\n");
+            ++m_line;
+            setFilePosition(node);
+        }
+        
+        void PrintfMapSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) {
+            std::fprintf(m_stream, "\"%s\" \"%s\"\n", attribute.name().c_str(), attribute.value().c_str());
+            ++m_line;
+        }
+        
+        void PrintfMapSerializer::doBeginBrush(const Model::Brush* brush) {
+            m_startLineStack.push_back(m_line);
+            std::fprintf(m_stream, "{\n");
+            ++m_line;
+        }
+        
+        void PrintfMapSerializer::doEndBrush(Model::Brush* brush) {
+            std::fprintf(m_stream, "}\n");
+            ++m_line;
+            setFilePosition(brush);
+        }
+        
+        void PrintfMapSerializer::doBrushFace(Model::BrushFace* face) {
+            const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
+            const Model::BrushFace::Points& points = face->points();
+            
+            std::fprintf(m_stream, "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) %s",
+                         points[0].x(), points[0].y(), points[0].z(),
+                         points[1].x(), points[1].y(), points[1].z(),
+                         points[2].x(), points[2].y(), points[2].z(),
+                         textureName.c_str());
+            
+            if (m_format == Model::MapFormat::Valve) {
+                const Vec3 xAxis = face->textureXAxis();
+                const Vec3 yAxis = face->textureYAxis();
+                std::fprintf(m_stream, " [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g\n",
+                             xAxis.x(), xAxis.y(), xAxis.z(), face->xOffset(),
+                             yAxis.x(), yAxis.y(), yAxis.z(), face->yOffset(),
+                             face->rotation(), face->xScale(), face->yScale());
+            } else if (m_format == Model::MapFormat::Quake2) {
+                std::fprintf(m_stream, " %.6g %.6g %.6g %.6g %.6g %d %d %.6g\n",
+                             face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale(),
+                             face->surfaceContents(), face->surfaceFlags(), face->surfaceValue());
+            } else if (m_format == Model::MapFormat::Hexen2) {
+                std::fprintf(m_stream, " %.6g %.6g %.6g %.6g %.6g 0\n",
+                             face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale());
+            } else {
+                std::fprintf(m_stream, " %.6g %.6g %.6g %.6g %.6g\n",
+                             face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale());
+            }
+            
+            face->setFilePosition(m_line, 1);
+            ++m_line;
+        }
+        
+        void PrintfMapSerializer::setFilePosition(Model::Node* node) {
+            const size_t start = startLine();
+            if (node != NULL)
+                node->setFilePosition(start, m_line - start);
+        }
+        
+        size_t PrintfMapSerializer::startLine() {
+            assert(!m_startLineStack.empty());
+            const size_t result = m_startLineStack.back();
+            m_startLineStack.pop_back();
+            return result;
+        }
+    }
+}
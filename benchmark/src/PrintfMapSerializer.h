@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_PrintfMapSerializer
+#define TrenchBroom_PrintfMapSerializer
+
+#include "IO/NodeSerializer.h"
+#include "Model/MapFormat.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         Writes a map file with one std::fprintf call per line, as MapFileSerializer did before it formatted the file
+         into memory buffers. The output is the same, so it serves as the baseline for the map file tasks.
+         */
+        class PrintfMapSerializer : public IO::NodeSerializer {
+        private:
+            typedef std::vector<size_t> LineStack;
+            
+            Model::MapFormat::Type m_format;
+            FILE* m_stream;
+            LineStack m_startLineStack;
+            size_t m_line;
+        public:
+            PrintfMapSerializer(Model::MapFormat::Type format, FILE* stream);
+        private:
+            void doBeginEntity(const Model::Node* node);
+            void doEndEntity(Model::Node* node);
+            void doEntityAttribute(const Model::EntityAttribute& attribute);
+            void doBeginBrush(const Model::Brush* brush);
+            void doEndBrush(Model::Brush* brush);
+            void doBrushFace(Model::BrushFace* face);
+        private:
+            void setFilePosition(Model::Node* node);
+            size_t startLine();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_PrintfMapSerializer) */
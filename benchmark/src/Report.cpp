@@ -0,0 +1,161 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Report.h"
+
+#include "GeometryLayouts.h"
+#include "Workload.h"
+#include "Model/AssortNodesVisitor.h"
+#include "Model/Brush.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+#include <cstdio>
+#include <memory>
+#include <ostream>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        Report::WorkloadInfo::WorkloadInfo(const Workload& workload) :
+        name(workload.name()),
+        format(Model::formatName(workload.format())),
+        bytes(workload.data().size()),
+        entities(0),
+        brushes(0),
+        faces(0),
+        linkedGeometryBytes(0),
+        compactGeometryBytes(0),
+        allocatedGeometryBlocks(0),
+        allocatedGeometryBytes(0),
+        geometryChunkBytes(0) {
+            const std::auto_ptr<Model::World> world(workload.createWorld());
+            Model::AssortNodesVisitor visitor;
+            world->acceptAndRecurse(visitor);
+            
+            entities = visitor.entities().size();
+            brushes = visitor.brushes().size();
+            
+            const Model::BrushList& brushList = visitor.brushes();
+            Model::BrushList::const_iterator it, end;
+            for (it = brushList.begin(), end = brushList.end(); it != end; ++it) {
+                faces += (*it)->faces().size();
+                
+                const std::auto_ptr<Model::BrushGeometry> geometry(copyGeometry(*it));
+                linkedGeometryBytes += memoryUsage(*geometry);
+                compactGeometryBytes += CompactBrushGeometry(*geometry).memoryUsage();
+            }
+            
+            // all brush geometry has been built by now, and the allocators hold little else
+            const AllocatorUsage usage = geometryAllocatorUsage();
+            allocatedGeometryBlocks = usage.liveBlocks;
+            allocatedGeometryBytes = usage.liveBytes;
+            geometryChunkBytes = usage.chunkBytes;
+        }
+
+        Report::Report(const String& buildId, const size_t iterations) :
+        m_buildId(buildId),
+        m_iterations(iterations) {}
+        
+        void Report::addWorkload(const Workload& workload) {
+            m_workloads.push_back(WorkloadInfo(workload));
+        }
+        
+        void Report::addMeasurement(const Measurement& measurement) {
+            m_measurements.push_back(measurement);
+        }
+        
+        void Report::write(std::ostream& stream) const {
+            stream << "{\n";
+            stream << "  \"build\": " << quoted(m_buildId) << ",\n";
+            stream << "  \"iterations\": " << m_iterations << ",\n";
+            
+            stream << "  \"workloads\": [";
+            for (size_t i = 0; i < m_workloads.size(); ++i) {
+                const WorkloadInfo& info = m_workloads[i];
+                stream << (i == 0 ? "\n" : ",\n");
+                stream << "    { \"name\": " << quoted(info.name)
+                       << ", \"format\": " << quoted(info.format)
+                       << ", \"bytes\": " << info.bytes
+                       << ", \"entities\": " << info.entities
+                       << ", \"brushes\": " << info.brushes
+                       << ", \"faces\": " << info.faces
+                       << ", \"linkedGeometryBytesPerBrush\": " << bytesPerBrush(info.linkedGeometryBytes, info.brushes)
+                       << ", \"compactGeometryBytesPerBrush\": " << bytesPerBrush(info.compactGeometryBytes, info.brushes)
+                       << ", \"allocatedGeometryBlocks\": " << info.allocatedGeometryBlocks
+                       << ", \"allocatedGeometryBytesPerBrush\": " << bytesPerBrush(info.allocatedGeometryBytes, info.brushes)
+                       << ", \"geometryChunkBytesPerBrush\": " << bytesPerBrush(info.geometryChunkBytes, info.brushes) << " }";
+            }
+            stream << "\n  ],\n";
+            
+            stream << "  \"results\": [";
+            for (size_t i = 0; i < m_measurements.size(); ++i) {
+                const Measurement& measurement = m_measurements[i];
+                stream << (i == 0 ? "\n" : ",\n");
+                stream << "    { \"task\": " << quoted(measurement.task())
+                       << ", \"workload\": " << quoted(measurement.workload())
+                       << ", \"iterations\": " << measurement.iterations()
+                       << ", \"minMs\": " << measurement.min()
+                       << ", \"medianMs\": " << measurement.median()
+                       << ", \"meanMs\": " << measurement.mean()
+                       << ", \"maxMs\": " << measurement.max() << " }";
+            }
+            stream << "\n  ]\n";
+            stream << "}\n";
+        }
+
+        double Report::bytesPerBrush(const size_t bytes, const size_t brushes) {
+            if (brushes == 0)
+                return 0.0;
+            return static_cast<double>(bytes) / static_cast<double>(brushes);
+        }
+
+        String Report::quoted(const String& str) {
+            StringStream result;
+            result << '"';
+            for (size_t i = 0; i < str.size(); ++i) {
+                const char c = str[i];
+                switch (c) {
+                    case '"':
+                        result << "\\\"";
+                        break;
+                    case '\\':
+                        result << "\\\\";
+                        break;
+                    case '\n':
+                        result << "\\n";
+                        break;
+                    case '\t':
+                        result << "\\t";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char buffer[8];
+                            std::sprintf(buffer, "\\u%04x", static_cast<unsigned int>(c));
+                            result << buffer;
+                        } else {
+                            result << c;
+                        }
+                        break;
+                }
+            }
+            result << '"';
+            return result.str();
+        }
+    }
+}
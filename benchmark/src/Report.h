@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Report
+#define TrenchBroom_Report
+
+#include "StringUtils.h"
+#include "Task.h"
+
+#include <iosfwd>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        class Workload;
+        
+        // Collects the measurements of a benchmark run and writes them as JSON.
+        class Report {
+        private:
+            struct WorkloadInfo {
+                String name;
+                String format;
+                size_t bytes;
+                size_t entities;
+                size_t brushes;
+                size_t faces;
+                size_t linkedGeometryBytes;
+                size_t compactGeometryBytes;
+                // measured by the geometry allocators while the world is loaded
+                size_t allocatedGeometryBlocks;
+                size_t allocatedGeometryBytes;
+                size_t geometryChunkBytes;
+                
+                WorkloadInfo(const Workload& workload);
+            };
+            
+            String m_buildId;
+            size_t m_iterations;
+            std::vector<WorkloadInfo> m_workloads;
+            Measurement::List m_measurements;
+        public:
+            Report(const String& buildId, size_t iterations);
+            
+            void addWorkload(const Workload& workload);
+            void addMeasurement(const Measurement& measurement);
+            
+            void write(std::ostream& stream) const;
+        private:
+            static double bytesPerBrush(size_t bytes, size_t brushes);
+            static String quoted(const String& str);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_Report) */
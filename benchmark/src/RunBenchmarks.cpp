@@ -0,0 +1,201 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchTasks.h"
+#include "ConvexHullTasks.h"
+#include "MapGenerator.h"
+#include "MapTasks.h"
+#include "OctreeTasks.h"
+#include "Report.h"
+#include "Task.h"
+#include "VecMathTasks.h"
+#include "Workload.h"
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "IO/Path.h"
+#include "Model/MapFormat.h"
+#include "Version.h"
+
+#include <wx/wx.h>
+#include <wx/cmdline.h>
+#include <wx/config.h>
+#include <wx/fileconf.h>
+#include <wx/init.h>
+
+#include <algorithm>
+#include <clocale>
+#include <fstream>
+#include <iostream>
+
+using namespace TrenchBroom;
+
+static const wxCmdLineEntryDesc CmdLineDesc[] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",       "show this help", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "i", "iterations", "number of iterations of every task (default 5)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "g", "grid",       "size of the generated brush grid, 0 to skip (default 16)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "d", "detail",     "number of generated detail brushes, 0 to skip (default 4000)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "e", "entities",   "number of generated linked entities, 0 to skip (default 2000)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "p", "points",     "largest number of points for the convex hull tasks, 0 to skip (default 100000)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "b", "objects",    "number of objects for the octree tasks, 0 to skip (default 100000)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "v", "vectors",    "number of vectors for the vector math tasks, 0 to skip (default 1000000)", wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, "f", "format",     "format of the given map files (default Standard)", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "t", "task",       "only run the task with the given name", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "o", "output",     "write the report to the given file instead of stdout", wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_PARAM,  NULL, NULL,        "map file", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE, NULL, NULL, NULL, wxCMD_LINE_VAL_NONE, 0 }
+};
+
+static size_t sizeOption(const wxCmdLineParser& parser, const wxString& name, const size_t defaultValue) {
+    long value;
+    if (!parser.Found(name, &value))
+        return defaultValue;
+    return value < 0 ? 0 : static_cast<size_t>(value);
+}
+
+static String stringOption(const wxCmdLineParser& parser, const wxString& name, const String& defaultValue) {
+    wxString value;
+    if (!parser.Found(name, &value))
+        return defaultValue;
+    return value.ToStdString();
+}
+
+static Benchmark::Workload::List createWorkloads(const wxCmdLineParser& parser, const BBox3& worldBounds) {
+    Benchmark::Workload::List workloads;
+    
+    const size_t gridSize = sizeOption(parser, "grid", 16);
+    if (gridSize > 0)
+        workloads.push_back(Benchmark::Workload("grid", Model::MapFormat::Standard, worldBounds, Benchmark::MapGenerator::grid(gridSize)));
+    
+    const size_t detailCount = sizeOption(parser, "detail", 4000);
+    if (detailCount > 0)
+        workloads.push_back(Benchmark::Workload("detail", Model::MapFormat::Standard, worldBounds, Benchmark::MapGenerator::detail(detailCount)));
+
+    const size_t entityCount = sizeOption(parser, "entities", 2000);
+    if (entityCount > 0)
+        workloads.push_back(Benchmark::Workload("entities", Model::MapFormat::Standard, worldBounds, Benchmark::MapGenerator::entities(entityCount)));
+    
+    const Model::MapFormat::Type format = Model::mapFormat(stringOption(parser, "format", "Standard"));
+    if (format == Model::MapFormat::Unknown)
+        throw Exception("Unknown map format");
+    
+    for (size_t i = 0; i < parser.GetParamCount(); ++i) {
+        const IO::Path path(parser.GetParam(i).ToStdString());
+        workloads.push_back(Benchmark::Workload::fromFile(path, format, worldBounds));
+    }
+    
+    return workloads;
+}
+
+static void runBenchmarks(const wxCmdLineParser& parser) {
+    // the same world bounds that the editor uses
+    const BBox3 worldBounds(-16384.0, 16384.0);
+    const size_t iterations = std::max(sizeOption(parser, "iterations", 5), static_cast<size_t>(1));
+    const String taskName = stringOption(parser, "task", "");
+    
+    const Benchmark::Workload::List workloads = createWorkloads(parser, worldBounds);
+    Benchmark::Task::List tasks = Benchmark::createMapTasks();
+    
+    Benchmark::Task::List batchTasks = Benchmark::createBatchTasks();
+    tasks.insert(tasks.end(), batchTasks.begin(), batchTasks.end());
+
+    Benchmark::Report report(BUILD_ID, iterations);
+    
+    Benchmark::Workload::List::const_iterator wIt, wEnd;
+    for (wIt = workloads.begin(), wEnd = workloads.end(); wIt != wEnd; ++wIt) {
+        const Benchmark::Workload& workload = *wIt;
+        report.addWorkload(workload);
+        
+        Benchmark::Task::List::const_iterator tIt, tEnd;
+        for (tIt = tasks.begin(), tEnd = tasks.end(); tIt != tEnd; ++tIt) {
+            Benchmark::Task* task = *tIt;
+            if (taskName.empty() || task->name() == taskName) {
+                std::cerr << "Running " << task->name() << " on " << workload.name() << std::endl;
+                report.addMeasurement(task->run(workload, iterations));
+            }
+        }
+    }
+    
+    VectorUtils::clearAndDelete(tasks);
+    
+    // the convex hull, octree and vector math tasks generate their own data, so they are run only once
+    const Benchmark::Workload points("points", Model::MapFormat::Standard, worldBounds, "");
+    Benchmark::Task::List generatedTasks = Benchmark::createConvexHullTasks(sizeOption(parser, "points", 100000));
+    
+    Benchmark::Task::List octreeTasks = Benchmark::createOctreeTasks(sizeOption(parser, "objects", 100000));
+    generatedTasks.insert(generatedTasks.end(), octreeTasks.begin(), octreeTasks.end());
+    
+    Benchmark::Task::List vecMathTasks = Benchmark::createVecMathTasks(sizeOption(parser, "vectors", 1000000));
+    generatedTasks.insert(generatedTasks.end(), vecMathTasks.begin(), vecMathTasks.end());
+    
+    Benchmark::Task::List::const_iterator tIt, tEnd;
+    for (tIt = generatedTasks.begin(), tEnd = generatedTasks.end(); tIt != tEnd; ++tIt) {
+        Benchmark::Task* task = *tIt;
+        if (taskName.empty() || task->name() == taskName) {
+            std::cerr << "Running " << task->name() << std::endl;
+            report.addMeasurement(task->run(points, iterations));
+        }
+    }
+    
+    VectorUtils::clearAndDelete(generatedTasks);
+    
+    const String outputPath = stringOption(parser, "output", "");
+    if (outputPath.empty()) {
+        report.write(std::cout);
+    } else {
+        std::ofstream stream(outputPath.c_str());
+        if (!stream.is_open())
+            throw FileSystemException("Cannot open file: " + outputPath);
+        report.write(stream);
+    }
+}
+
+int main(int argc, char **argv) {
+    wxInitializer initializer(argc, argv);
+    if (!initializer.IsOk()) {
+        std::cerr << "Failed to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+    
+    // use an empty file config so that we always use the default preferences
+    wxConfig::Set(new wxFileConfig("TrenchBroom-Benchmark"));
+    
+    // set the locale to US so that we can parse floats attribute
+    std::setlocale(LC_NUMERIC, "C");
+
+    int result = 0;
+    wxCmdLineParser parser(CmdLineDesc, argc, argv);
+    parser.SetSwitchChars("-");
+    
+    const int parseResult = parser.Parse();
+    if (parseResult != 0) {
+        // -1 means that the help was shown
+        result = parseResult == -1 ? 0 : 1;
+    } else {
+        try {
+            runBenchmarks(parser);
+        } catch (const Exception& e) {
+            std::cerr << "Benchmark failed: " << e.what() << std::endl;
+            result = 1;
+        }
+    }
+    
+    delete wxConfig::Set(NULL);
+    return result;
+}
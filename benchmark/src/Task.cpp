@@ -0,0 +1,106 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Task.h"
+
+#include "Workload.h"
+
+#include <wx/stopwatch.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        Measurement::Measurement(const String& task, const String& workload, const std::vector<double>& times) :
+        m_task(task),
+        m_workload(workload),
+        m_times(times) {
+            assert(!m_times.empty());
+            std::sort(m_times.begin(), m_times.end());
+        }
+        
+        const String& Measurement::task() const {
+            return m_task;
+        }
+        
+        const String& Measurement::workload() const {
+            return m_workload;
+        }
+        
+        size_t Measurement::iterations() const {
+            return m_times.size();
+        }
+        
+        double Measurement::min() const {
+            return m_times.front();
+        }
+        
+        double Measurement::max() const {
+            return m_times.back();
+        }
+        
+        double Measurement::mean() const {
+            return std::accumulate(m_times.begin(), m_times.end(), 0.0) / static_cast<double>(m_times.size());
+        }
+        
+        double Measurement::median() const {
+            const size_t count = m_times.size();
+            if (count % 2 == 1)
+                return m_times[count / 2];
+            return (m_times[count / 2 - 1] + m_times[count / 2]) / 2.0;
+        }
+
+        Task::Task(const String& name) :
+        m_name(name) {}
+        
+        Task::~Task() {}
+        
+        const String& Task::name() const {
+            return m_name;
+        }
+        
+        Measurement Task::run(const Workload& workload, const size_t iterations) {
+            assert(iterations > 0);
+            
+            std::vector<double> times;
+            times.reserve(iterations);
+            
+            for (size_t i = 0; i < iterations; ++i) {
+                doSetUp(workload);
+                try {
+                    wxStopWatch stopWatch;
+                    doRun(workload);
+                    const wxLongLong micros = stopWatch.TimeInMicro();
+                    times.push_back(micros.ToDouble() / 1000.0);
+                } catch (...) {
+                    doTearDown();
+                    throw;
+                }
+                doTearDown();
+            }
+            
+            return Measurement(m_name, workload.name(), times);
+        }
+
+        void Task::doSetUp(const Workload& workload) {}
+        void Task::doTearDown() {}
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Task
+#define TrenchBroom_Task
+
+#include "StringUtils.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        class Workload;
+        
+        // The running times of all iterations of a task on a workload, in milliseconds.
+        class Measurement {
+        public:
+            typedef std::vector<Measurement> List;
+        private:
+            String m_task;
+            String m_workload;
+            std::vector<double> m_times;
+        public:
+            Measurement(const String& task, const String& workload, const std::vector<double>& times);
+            
+            const String& task() const;
+            const String& workload() const;
+            size_t iterations() const;
+            
+            double min() const;
+            double max() const;
+            double mean() const;
+            double median() const;
+        };
+        
+        /*
+         A timed operation on a workload. For every iteration, the task is set up, run and torn down again, and
+         only the time spent running it is measured.
+         */
+        class Task {
+        public:
+            typedef std::vector<Task*> List;
+        private:
+            String m_name;
+        public:
+            Task(const String& name);
+            virtual ~Task();
+            
+            const String& name() const;
+            Measurement run(const Workload& workload, size_t iterations);
+        private:
+            virtual void doSetUp(const Workload& workload);
+            virtual void doRun(const Workload& workload) = 0;
+            virtual void doTearDown();
+        private:
+            Task(const Task&);
+            Task& operator=(const Task&);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_Task) */
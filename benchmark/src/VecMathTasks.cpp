@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VecMathTasks.h"
+
+#include <cstdlib>
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        template <typename T>
+        static void addVecMathTasks(Task::List& tasks, const size_t vectorCount) {
+            tasks.push_back(new VecMathTask<T>(VecMathTask<T>::Kernel_Dot, vectorCount));
+            tasks.push_back(new VecMathTask<T>(VecMathTask<T>::Kernel_Cross, vectorCount));
+            tasks.push_back(new VecMathTask<T>(VecMathTask<T>::Kernel_MatrixMultiply, vectorCount));
+            tasks.push_back(new VecMathTask<T>(VecMathTask<T>::Kernel_TransformPoints, vectorCount));
+        }
+        
+        Task::List createVecMathTasks(const size_t vectorCount) {
+            Task::List tasks;
+            if (vectorCount > 0) {
+                addVecMathTasks<float>(tasks, vectorCount);
+                addVecMathTasks<double>(tasks, vectorCount);
+            }
+            return tasks;
+        }
+        
+        template <typename T>
+        VecMathTask<T>::VecMathTask(const Kernel kernel, const size_t vectorCount) :
+        Task(taskName(kernel, vectorCount)),
+        m_kernel(kernel),
+        m_vectorCount(vectorCount),
+        m_result(static_cast<T>(0.0)) {}
+        
+        template <typename T>
+        String VecMathTask<T>::taskName(const Kernel kernel, const size_t vectorCount) {
+            StringStream name;
+            name << "vecMath";
+            switch (kernel) {
+                case Kernel_Dot:
+                    name << "Dot";
+                    break;
+                case Kernel_Cross:
+                    name << "Cross";
+                    break;
+                case Kernel_MatrixMultiply:
+                    name << "MatrixMultiply";
+                    break;
+                case Kernel_TransformPoints:
+                    name << "TransformPoints";
+                    break;
+            }
+            name << (sizeof(T) == sizeof(float) ? "Float" : "Double");
+            name << vectorCount;
+            return name.str();
+        }
+        
+        template <typename T>
+        static T random(const T min, const T max) {
+            return min + (max - min) * static_cast<T>(std::rand()) / static_cast<T>(RAND_MAX);
+        }
+        
+        template <typename T>
+        void VecMathTask<T>::doSetUp(const Workload& workload) {
+            // the same vectors for every iteration
+            std::srand(static_cast<unsigned int>(m_vectorCount));
+            
+            m_vectors.clear();
+            m_vectors.reserve(m_vectorCount);
+            for (size_t i = 0; i < m_vectorCount; ++i)
+                m_vectors.push_back(Vec<T,3>(random<T>(-512.0, 512.0), random<T>(-512.0, 512.0), random<T>(-512.0, 512.0)));
+            
+            // a rotation about an oblique axis followed by a translation, as when transforming objects
+            const Vec<T,3> axis = Vec<T,3>(1.0, 2.0, 3.0).normalized();
+            m_matrix = translationMatrix(Vec<T,3>(16.0, -32.0, 64.0)) * rotationMatrix(axis, static_cast<T>(0.3));
+            m_result = static_cast<T>(0.0);
+        }
+        
+        template <typename T>
+        void VecMathTask<T>::doRun(const Workload& workload) {
+            // the results are accumulated so that the computations cannot be optimized away
+            T result = static_cast<T>(0.0);
+            switch (m_kernel) {
+                case Kernel_Dot:
+                    for (size_t i = 1; i < m_vectors.size(); ++i)
+                        result += m_vectors[i - 1].dot(m_vectors[i]);
+                    break;
+                case Kernel_Cross:
+                    for (size_t i = 1; i < m_vectors.size(); ++i)
+                        result += crossed(m_vectors[i - 1], m_vectors[i]).x();
+                    break;
+                case Kernel_MatrixMultiply:
+                    for (size_t i = 0; i < m_vectors.size(); ++i)
+                        result += (m_matrix * translationMatrix(m_vectors[i]))[3][0];
+                    break;
+                case Kernel_TransformPoints: {
+                    const typename Vec<T,3>::List transformed = m_matrix * m_vectors;
+                    for (size_t i = 0; i < transformed.size(); ++i)
+                        result += transformed[i].x();
+                    break;
+                }
+            }
+            m_result = result;
+        }
+        
+        template <typename T>
+        void VecMathTask<T>::doTearDown() {
+            m_vectors.clear();
+        }
+        
+        template class VecMathTask<float>;
+        template class VecMathTask<double>;
+    }
+}
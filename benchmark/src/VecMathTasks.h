@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VecMathTasks
+#define TrenchBroom_VecMathTasks
+
+#include "Task.h"
+#include "VecMath.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        /*
+         Creates the vector math tasks on the given number of vectors. These tasks generate their own vectors and do not
+         depend on the workload. The caller takes ownership of the tasks.
+         */
+        Task::List createVecMathTasks(size_t vectorCount);
+        
+        // Runs one vector or matrix kernel over a fixed set of generated vectors of type T.
+        template <typename T>
+        class VecMathTask : public Task {
+        public:
+            typedef enum {
+                // the dot product of each vector with its successor
+                Kernel_Dot,
+                // the cross product of each vector with its successor
+                Kernel_Cross,
+                // the product of a 4x4 matrix with a matrix built from each vector
+                Kernel_MatrixMultiply,
+                // transforms all vectors as points with one 4x4 matrix
+                Kernel_TransformPoints
+            } Kernel;
+        private:
+            Kernel m_kernel;
+            size_t m_vectorCount;
+            typename Vec<T,3>::List m_vectors;
+            Mat<T,4,4> m_matrix;
+            T m_result;
+        public:
+            VecMathTask(Kernel kernel, size_t vectorCount);
+        private:
+            static String taskName(Kernel kernel, size_t vectorCount);
+            
+            void doSetUp(const Workload& workload);
+            void doRun(const Workload& workload);
+            void doTearDown();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_VecMathTasks) */
@@ -0,0 +1,63 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Workload.h"
+
+#include "IO/DiskFileSystem.h"
+#include "IO/Path.h"
+#include "IO/WorldReader.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace Benchmark {
+        Workload::Workload(const String& name, const Model::MapFormat::Type format, const BBox3& worldBounds, const String& data) :
+        m_name(name),
+        m_format(format),
+        m_worldBounds(worldBounds),
+        m_data(data) {}
+        
+        Workload Workload::fromFile(const IO::Path& path, const Model::MapFormat::Type format, const BBox3& worldBounds) {
+            const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
+            const String data(file->begin(), file->end());
+            return Workload(path.lastComponent().asString(), format, worldBounds, data);
+        }
+
+        const String& Workload::name() const {
+            return m_name;
+        }
+        
+        Model::MapFormat::Type Workload::format() const {
+            return m_format;
+        }
+        
+        const BBox3& Workload::worldBounds() const {
+            return m_worldBounds;
+        }
+        
+        const String& Workload::data() const {
+            return m_data;
+        }
+
+        Model::World* Workload::createWorld(const bool deferBrushGeometry) const {
+            IO::WorldReader reader(m_data, NULL);
+            reader.setDeferBrushGeometry(deferBrushGeometry);
+            return reader.read(m_format, m_worldBounds);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Workload
+#define TrenchBroom_Workload
+
+#include "StringUtils.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        class Path;
+    }
+    
+    namespace Benchmark {
+        // A map that the benchmarks are run on, either generated or read from a map file.
+        class Workload {
+        public:
+            typedef std::vector<Workload> List;
+        private:
+            String m_name;
+            Model::MapFormat::Type m_format;
+            BBox3 m_worldBounds;
+            String m_data;
+        public:
+            Workload(const String& name, Model::MapFormat::Type format, const BBox3& worldBounds, const String& data);
+            
+            static Workload fromFile(const IO::Path& path, Model::MapFormat::Type format, const BBox3& worldBounds);
+            
+            const String& name() const;
+            Model::MapFormat::Type format() const;
+            const BBox3& worldBounds() const;
+            const String& data() const;
+            
+            Model::World* createWorld(bool deferBrushGeometry = false) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_Workload) */
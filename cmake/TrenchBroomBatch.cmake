@@ -0,0 +1,23 @@
+SET(BATCH_SOURCE_DIR "${CMAKE_SOURCE_DIR}/batch/src")
+
+FILE(GLOB_RECURSE BATCH_SOURCE
+    "${BATCH_SOURCE_DIR}/*.h"
+    "${BATCH_SOURCE_DIR}/*.cpp"
+)
+
+ADD_EXECUTABLE(TrenchBroom-Batch ${BATCH_SOURCE} $<TARGET_OBJECTS:common>)
+
+# The build id is written to the report and taken from the generated version header
+ADD_TARGET_PROPERTY(TrenchBroom-Batch INCLUDE_DIRECTORIES "${BATCH_SOURCE_DIR}")
+ADD_TARGET_PROPERTY(TrenchBroom-Batch INCLUDE_DIRECTORIES ${CMAKE_CURRENT_BINARY_DIR})
+ADD_DEPENDENCIES(TrenchBroom-Batch GenerateVersion)
+TARGET_LINK_LIBRARIES(TrenchBroom-Batch ${wxWidgets_LIBRARIES} ${FREETYPE_LIBRARIES} ${FREEIMAGE_LIBRARIES})
+
+# Copy some Windows-specific resources
+IF(WIN32)
+	ADD_CUSTOM_COMMAND(TARGET TrenchBroom-Batch POST_BUILD
+		COMMAND ${CMAKE_COMMAND} -E copy_directory "${LIB_BIN_DIR}/win32" "$<TARGET_FILE_DIR:TrenchBroom-Batch>"
+	)
+ENDIF()
+
+SET_XCODE_ATTRIBUTES(TrenchBroom-Batch)
@@ -0,0 +1,33 @@
+SET(BENCHMARK_SOURCE_DIR "${CMAKE_SOURCE_DIR}/benchmark/src")
+
+FILE(GLOB_RECURSE BENCHMARK_SOURCE
+    "${BENCHMARK_SOURCE_DIR}/*.h"
+    "${BENCHMARK_SOURCE_DIR}/*.cpp"
+)
+
+# The batch tasks run the jobs of the batch tool, so its sources are compiled in without its main function
+SET(BENCHMARK_BATCH_SOURCE_DIR "${CMAKE_SOURCE_DIR}/batch/src")
+LIST(APPEND BENCHMARK_SOURCE
+    "${BENCHMARK_BATCH_SOURCE_DIR}/Job.h"
+    "${BENCHMARK_BATCH_SOURCE_DIR}/Job.cpp"
+    "${BENCHMARK_BATCH_SOURCE_DIR}/WorkerPool.h"
+    "${BENCHMARK_BATCH_SOURCE_DIR}/WorkerPool.cpp"
+)
+
+ADD_EXECUTABLE(TrenchBroom-Benchmark ${BENCHMARK_SOURCE} $<TARGET_OBJECTS:common>)
+
+# The build id of the benchmarked commit is taken from the generated version header
+ADD_TARGET_PROPERTY(TrenchBroom-Benchmark INCLUDE_DIRECTORIES "${BENCHMARK_SOURCE_DIR}")
+ADD_TARGET_PROPERTY(TrenchBroom-Benchmark INCLUDE_DIRECTORIES "${BENCHMARK_BATCH_SOURCE_DIR}")
+ADD_TARGET_PROPERTY(TrenchBroom-Benchmark INCLUDE_DIRECTORIES ${CMAKE_CURRENT_BINARY_DIR})
+ADD_DEPENDENCIES(TrenchBroom-Benchmark GenerateVersion)
+TARGET_LINK_LIBRARIES(TrenchBroom-Benchmark ${wxWidgets_LIBRARIES} ${FREETYPE_LIBRARIES} ${FREEIMAGE_LIBRARIES})
+
+# Copy some Windows-specific resources
+IF(WIN32)
+	ADD_CUSTOM_COMMAND(TARGET TrenchBroom-Benchmark POST_BUILD
+		COMMAND ${CMAKE_COMMAND} -E copy_directory "${LIB_BIN_DIR}/win32" "$<TARGET_FILE_DIR:TrenchBroom-Benchmark>"
+	)
+ENDIF()
+
+SET_XCODE_ATTRIBUTES(TrenchBroom-Benchmark)
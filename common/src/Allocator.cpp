@@ -0,0 +1,208 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Allocator.h"
+
+#include <cassert>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#include <stdlib.h>
+#endif
+
+AllocatorThreadCache::~AllocatorThreadCache() {}
+
+namespace AllocatorSupport {
+#ifdef _WIN32
+    static VOID WINAPI deleteThreadCache(PVOID cache) {
+        delete static_cast<AllocatorThreadCache*>(cache);
+    }
+    
+    ThreadKey createThreadKey() {
+        // fiber local storage is used because, unlike thread local storage, it calls back when a thread exits
+        const DWORD index = FlsAlloc(&deleteThreadCache);
+        if (index == FLS_OUT_OF_INDEXES)
+            throw std::bad_alloc();
+        return static_cast<ThreadKey>(index);
+    }
+    
+    AllocatorThreadCache* threadCache(const ThreadKey key) {
+        return static_cast<AllocatorThreadCache*>(FlsGetValue(static_cast<DWORD>(key)));
+    }
+    
+    void setThreadCache(const ThreadKey key, AllocatorThreadCache* cache) {
+        FlsSetValue(static_cast<DWORD>(key), cache);
+    }
+    
+    void* allocateAligned(const size_t size, const size_t alignment) {
+        void* memory = _aligned_malloc(size, alignment);
+        if (memory == NULL)
+            throw std::bad_alloc();
+        return memory;
+    }
+    
+    void freeAligned(void* memory) {
+        _aligned_free(memory);
+    }
+#else
+    extern "C" {
+        static void deleteThreadCache(void* cache) {
+            delete static_cast<AllocatorThreadCache*>(cache);
+        }
+    }
+    
+    ThreadKey createThreadKey() {
+        pthread_key_t key;
+        if (pthread_key_create(&key, &deleteThreadCache) != 0)
+            throw std::bad_alloc();
+        return static_cast<ThreadKey>(key);
+    }
+    
+    AllocatorThreadCache* threadCache(const ThreadKey key) {
+        return static_cast<AllocatorThreadCache*>(pthread_getspecific(static_cast<pthread_key_t>(key)));
+    }
+    
+    void setThreadCache(const ThreadKey key, AllocatorThreadCache* cache) {
+        pthread_setspecific(static_cast<pthread_key_t>(key), cache);
+    }
+    
+    void* allocateAligned(const size_t size, const size_t alignment) {
+        void* memory = NULL;
+        if (posix_memalign(&memory, alignment, size) != 0)
+            throw std::bad_alloc();
+        return memory;
+    }
+    
+    void freeAligned(void* memory) {
+        free(memory);
+    }
+#endif
+    
+    class ScratchArena : public AllocatorThreadCache {
+    private:
+        static const size_t ChunkSize = 64 * 1024;
+        static const size_t Alignment = 16;
+        
+        typedef std::vector<unsigned char*> ChunkList;
+        
+        ChunkList m_chunks;
+        size_t m_currentChunk;
+        size_t m_offset;
+        size_t m_depth;
+    public:
+        ScratchArena() :
+        m_currentChunk(0),
+        m_offset(0),
+        m_depth(0) {}
+        
+        ~ScratchArena() {
+            ChunkList::const_iterator it, end;
+            for (it = m_chunks.begin(), end = m_chunks.end(); it != end; ++it)
+                freeAligned(*it);
+        }
+        
+        bool active() const {
+            return m_depth > 0;
+        }
+        
+        void enter() {
+            ++m_depth;
+        }
+        
+        void leave() {
+            assert(m_depth > 0);
+            if (--m_depth == 0) {
+                m_currentChunk = 0;
+                m_offset = 0;
+            }
+        }
+        
+        void* allocate(size_t size) {
+            assert(active());
+            assert(size <= ChunkSize);
+            
+            size = (size + Alignment - 1) & ~(Alignment - 1);
+            if (m_currentChunk == m_chunks.size() || m_offset + size > ChunkSize) {
+                if (m_currentChunk < m_chunks.size())
+                    ++m_currentChunk;
+                if (m_currentChunk == m_chunks.size())
+                    m_chunks.push_back(static_cast<unsigned char*>(allocateAligned(ChunkSize, Alignment)));
+                m_offset = 0;
+            }
+            
+            void* block = m_chunks[m_currentChunk] + m_offset;
+            m_offset += size;
+            return block;
+        }
+        
+        bool owns(const void* block) const {
+            const unsigned char* address = static_cast<const unsigned char*>(block);
+            for (size_t i = 0; i <= m_currentChunk && i < m_chunks.size(); ++i) {
+                if (address >= m_chunks[i] && address < m_chunks[i] + ChunkSize)
+                    return true;
+            }
+            return false;
+        }
+    };
+    
+    static ThreadKey scratchArenaKey() {
+        static const ThreadKey key = createThreadKey();
+        return key;
+    }
+    
+    // Forces the creation of the key during static initialization, see Allocator::central.
+    static const ThreadKey ForcedScratchArenaKey = scratchArenaKey();
+    
+    static ScratchArena& scratchArena() {
+        ScratchArena* arena = static_cast<ScratchArena*>(threadCache(scratchArenaKey()));
+        if (arena == NULL) {
+            arena = new ScratchArena();
+            setThreadCache(scratchArenaKey(), arena);
+        }
+        return *arena;
+    }
+    
+    ScratchArena* activeScratchArena() {
+        ScratchArena* arena = static_cast<ScratchArena*>(threadCache(scratchArenaKey()));
+        if (arena != NULL && arena->active())
+            return arena;
+        return NULL;
+    }
+    
+    void* allocateScratch(ScratchArena* arena, const size_t size) {
+        return arena->allocate(size);
+    }
+    
+    bool ownsScratchBlock(const ScratchArena* arena, const void* block) {
+        return arena->owns(block);
+    }
+}
+
+AllocatorScratchScope::AllocatorScratchScope() {
+    AllocatorSupport::scratchArena().enter();
+}
+
+AllocatorScratchScope::~AllocatorScratchScope() {
+    AllocatorSupport::scratchArena().leave();
+}
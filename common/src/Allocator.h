@@ -20,68 +20,168 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include <algorithm>
 #include <cassert>
-#include <iostream>
-#include <limits>
-#include <stack>
+#include <cstddef>
+#include <new>
 #include <vector>
 
+#include <wx/thread.h>
+
 // Undefine this to prevent false positives when looking for memory leaks.
 #define TB_ENABLE_ALLOCATOR 1
 
-template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+/*
+ Per thread state of an allocator. The cache of a thread is deleted when that thread exits.
+ */
+class AllocatorThreadCache {
+public:
+    virtual ~AllocatorThreadCache();
+};
+
+namespace AllocatorSupport {
+    typedef unsigned long ThreadKey;
+    
+    ThreadKey createThreadKey();
+    AllocatorThreadCache* threadCache(ThreadKey key);
+    void setThreadCache(ThreadKey key, AllocatorThreadCache* cache);
+    
+    void* allocateAligned(size_t size, size_t alignment);
+    void freeAligned(void* memory);
+    
+    class ScratchArena;
+    
+    // Returns the arena of the calling thread if a scratch scope is active on it, and NULL otherwise.
+    ScratchArena* activeScratchArena();
+    void* allocateScratch(ScratchArena* arena, size_t size);
+    bool ownsScratchBlock(const ScratchArena* arena, const void* block);
+}
+
+/*
+ While a scratch scope is active on a thread, every allocator allocates from an arena that belongs to that thread, and
+ the deletion of arena blocks does nothing. The arena is reset when the outermost scope ends, but it keeps its memory
+ for the next scope. This is meant for temporary objects that are built to answer a query, such as a copy of a
+ polyhedron. Such objects must be destroyed before the scope ends and must not be passed to other threads.
+ */
+class AllocatorScratchScope {
+public:
+    AllocatorScratchScope();
+    ~AllocatorScratchScope();
+private:
+    AllocatorScratchScope(const AllocatorScratchScope& other);
+    AllocatorScratchScope& operator=(const AllocatorScratchScope& other);
+};
+
+/*
+ Allocates objects of type T in chunks of ChunkSize bytes, which must be a power of two. Each chunk is aligned to its
+ size, so the chunk that owns a block is found by masking the block's address.
+ 
+ Every thread keeps a cache of up to PoolSize free blocks and allocates from and deallocates to it without locking.
+ Blocks move between the thread caches and the chunks in batches of half the pool size under a lock. A block may be
+ freed by any thread, it then becomes part of that thread's cache.
+ */
+template <class T, size_t PoolSize = 64, size_t ChunkSize = 16384>
 class Allocator {
+public:
+    struct Statistics {
+        // blocks that are in use by objects
+        size_t liveBlocks;
+        // free blocks that are held by the thread caches
+        size_t cachedBlocks;
+        size_t chunkCount;
+        size_t bytes;
+        
+        Statistics() :
+        liveBlocks(0),
+        cachedBlocks(0),
+        chunkCount(0),
+        bytes(0) {}
+    };
 private:
+    static const size_t BatchSize = PoolSize / 2;
+    // keep this many empty chunks around instead of releasing them immediately
+    static const size_t MaxEmptyChunks = 2;
+    
+    /*
+     A chunk header is placed at the start of each chunk, and the blocks follow at HeaderSize bytes.
+     */
     class Chunk {
     private:
-        unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
-        unsigned char m_firstFreeBlock;
-        unsigned char m_numFreeBlocks;
+        void* m_firstFreeBlock;
+        size_t m_numFreeBlocks;
+        // blocks at or after this index have never been allocated and are not linked into the free list
+        size_t m_firstUntouchedBlock;
     public:
-        Chunk() :
-        m_firstFreeBlock(0),
-        m_numFreeBlocks(BlocksPerChunk - 1) {
-            for (size_t i = 0; i < BlocksPerChunk - 1; i++)
-                m_blocks[i * sizeof(T)] = static_cast<unsigned char>(i + 1);
+        Chunk* previous;
+        Chunk* next;
+    public:
+        static const size_t HeaderSize = 64;
+        
+        static size_t blockSize() {
+            return sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T);
         }
         
-        bool contains(const T* t) const {
-            const unsigned char* block = reinterpret_cast<const unsigned char*>(t);
-            if (block < m_blocks)
-                return false;
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            return offset < (BlocksPerChunk - 1) * sizeof(T);
+        static size_t blockCount() {
+            return (ChunkSize - HeaderSize) / blockSize();
         }
         
-        T* allocate() {
-            if (m_numFreeBlocks == 0)
-                return NULL;
+        static Chunk* create() {
+            assert((ChunkSize & (ChunkSize - 1)) == 0);
+            assert(sizeof(Chunk) <= HeaderSize);
+            assert(blockCount() > 0);
             
-            unsigned char* block = m_blocks + m_firstFreeBlock * sizeof(T);
-            m_firstFreeBlock = *block;
-            m_numFreeBlocks--;
-            return reinterpret_cast<T*>(block);
+            void* memory = AllocatorSupport::allocateAligned(ChunkSize, ChunkSize);
+            return new (memory) Chunk();
         }
         
-        void deallocate(T* t) {
-            assert(m_numFreeBlocks < BlocksPerChunk - 1);
-            assert(contains(t));
-            
-            unsigned char* block = reinterpret_cast<unsigned char*>(t);
-            assert(block >= m_blocks);
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            assert(offset % sizeof(T) == 0);
+        static void destroy(Chunk* chunk) {
+            chunk->~Chunk();
+            AllocatorSupport::freeAligned(chunk);
+        }
+        
+        static Chunk* owner(void* block) {
+            const size_t address = reinterpret_cast<size_t>(block);
+            return reinterpret_cast<Chunk*>(address & ~(ChunkSize - 1));
+        }
+    private:
+        Chunk() :
+        m_firstFreeBlock(NULL),
+        m_numFreeBlocks(blockCount()),
+        m_firstUntouchedBlock(0),
+        previous(NULL),
+        next(NULL) {}
+        
+        unsigned char* blocks() {
+            return reinterpret_cast<unsigned char*>(this) + HeaderSize;
+        }
+    public:
+        void* allocate() {
+            assert(!full());
             
-            size_t index = offset / sizeof(T);
-            assert(index < BlocksPerChunk);
+            void* block = NULL;
+            if (m_firstFreeBlock != NULL) {
+                block = m_firstFreeBlock;
+                m_firstFreeBlock = *reinterpret_cast<void**>(block);
+            } else {
+                block = blocks() + m_firstUntouchedBlock * blockSize();
+                ++m_firstUntouchedBlock;
+            }
+            --m_numFreeBlocks;
+            return block;
+        }
+        
+        void deallocate(void* block) {
+            assert(owner(block) == this);
+            assert(m_numFreeBlocks < blockCount());
+            assert(static_cast<size_t>(reinterpret_cast<unsigned char*>(block) - blocks()) % blockSize() == 0);
             
-            *block = m_firstFreeBlock;
-            m_firstFreeBlock = static_cast<unsigned char>(index);
-            m_numFreeBlocks++;
+            *reinterpret_cast<void**>(block) = m_firstFreeBlock;
+            m_firstFreeBlock = block;
+            ++m_numFreeBlocks;
         }
         
         bool empty() const {
-            return m_numFreeBlocks == BlocksPerChunk - 1;
+            return m_numFreeBlocks == blockCount();
         }
         
         bool full() const {
@@ -89,114 +189,249 @@ private:
         }
     };
     
-    typedef std::vector<Chunk*> ChunkList;
-    typedef std::stack<T*> Pool;
-    
-    static Pool& pool() {
-        static Pool p;
-        return p;
-    }
-    
-    static ChunkList& fullChunks() {
-        static ChunkList chunks;
-        return chunks;
-    }
-    
-    static ChunkList& mixedChunks() {
-        static ChunkList chunks;
-        return chunks;
-    }
+    class Cache;
     
-    static ChunkList emptyChunks() {
-        static ChunkList chunks;
-        return chunks;
-    }
-public:
-#ifdef TB_ENABLE_ALLOCATOR
-    void* operator new(size_t size) {
-        assert(size == sizeof(T));
+    /*
+     Owns all chunks. The chunks that have free blocks are kept in a doubly linked list, with the empty chunks at its
+     end. Full chunks are not linked at all.
+     */
+    class Central {
+    private:
+        typedef std::vector<Cache*> CacheList;
         
-        if (!pool().empty()) {
-            T* t = pool().top();
-            pool().pop();
-            return t;
-        }
+        wxCriticalSection m_lock;
+        AllocatorSupport::ThreadKey m_threadKey;
+        Chunk* m_first;
+        Chunk* m_last;
+        size_t m_chunkCount;
+        size_t m_emptyChunkCount;
+        // blocks that were handed to the thread caches and not returned yet
+        size_t m_acquiredBlocks;
+        CacheList m_caches;
+    public:
+        Central() :
+        m_threadKey(AllocatorSupport::createThreadKey()),
+        m_first(NULL),
+        m_last(NULL),
+        m_chunkCount(0),
+        m_emptyChunkCount(0),
+        m_acquiredBlocks(0) {}
         
-        Chunk* chunk = NULL;
-        if (mixedChunks().empty()) {
-            if (!emptyChunks().empty()) {
-                chunk = emptyChunks().back();
-                emptyChunks().pop_back();
-            } else {
-                chunk = new Chunk();
+        // The chunks are not released on exit because objects with static storage duration may still use them.
+        
+        Cache& cache() {
+            AllocatorThreadCache* cache = AllocatorSupport::threadCache(m_threadKey);
+            if (cache == NULL) {
+                Cache* newCache = new Cache(*this);
+                AllocatorSupport::setThreadCache(m_threadKey, newCache);
+                
+                wxCriticalSectionLocker lock(m_lock);
+                m_caches.push_back(newCache);
+                return *newCache;
             }
-        } else {
-            chunk = mixedChunks().back();
-            mixedChunks().pop_back();
+            return *static_cast<Cache*>(cache);
         }
         
-        assert(!chunk->full());
-        T* block = chunk->allocate();
-        
-        if (chunk->full())
-            fullChunks().push_back(chunk);
-            else
-                mixedChunks().push_back(chunk);
-                return block;
-    }
-    
-    void operator delete(void* block) {
-        T* t = reinterpret_cast<T*>(block);
-        
-        if (PoolSize > 0 && pool().size() < PoolSize) {
-            pool().push(t);
-            return;
+        void removeCache(Cache* cache) {
+            wxCriticalSectionLocker lock(m_lock);
+            typename CacheList::iterator it = std::find(m_caches.begin(), m_caches.end(), cache);
+            assert(it != m_caches.end());
+            m_caches.erase(it);
         }
         
-        typename ChunkList::reverse_iterator fullIt, fullEnd, mixedIt, mixedEnd;
-        fullIt = fullChunks().rbegin();
-        fullEnd = fullChunks().rend();
-        mixedIt = mixedChunks().rbegin();
-        mixedEnd = mixedChunks().rend();
-        
-        Chunk* chunk = NULL;
-        while (fullIt < fullEnd || mixedIt < mixedEnd) {
-            if (fullIt < fullEnd) {
-                Chunk* fullChunk = *fullIt;
-                if (fullChunk->contains(t)) {
-                    chunk = fullChunk;
-                    break;
+        size_t acquire(void** blocks, const size_t count) {
+            wxCriticalSectionLocker lock(m_lock);
+            
+            size_t acquired = 0;
+            while (acquired < count) {
+                if (m_first == NULL) {
+                    append(Chunk::create());
+                    ++m_chunkCount;
+                    ++m_emptyChunkCount;
                 }
-                ++fullIt;
+                
+                Chunk* chunk = m_first;
+                if (chunk->empty()) {
+                    assert(m_emptyChunkCount > 0);
+                    --m_emptyChunkCount;
+                }
+                
+                while (acquired < count && !chunk->full())
+                    blocks[acquired++] = chunk->allocate();
+                if (chunk->full())
+                    unlink(chunk);
             }
-            if (mixedIt < mixedEnd) {
-                Chunk* mixedChunk = *mixedIt;
-                if (mixedChunk->contains(t)) {
-                    chunk = mixedChunk;
-                    break;
+            
+            m_acquiredBlocks += acquired;
+            return acquired;
+        }
+        
+        void release(void** blocks, const size_t count) {
+            wxCriticalSectionLocker lock(m_lock);
+            
+            for (size_t i = 0; i < count; ++i) {
+                Chunk* chunk = Chunk::owner(blocks[i]);
+                if (chunk->full())
+                    prepend(chunk);
+                
+                chunk->deallocate(blocks[i]);
+                if (chunk->empty()) {
+                    unlink(chunk);
+                    if (m_emptyChunkCount < MaxEmptyChunks) {
+                        append(chunk);
+                        ++m_emptyChunkCount;
+                    } else {
+                        Chunk::destroy(chunk);
+                        --m_chunkCount;
+                    }
                 }
-                ++mixedIt;
             }
+            
+            assert(m_acquiredBlocks >= count);
+            m_acquiredBlocks -= count;
         }
         
-        assert(chunk != NULL);
+        Statistics statistics() {
+            wxCriticalSectionLocker lock(m_lock);
+            
+            Statistics result;
+            typename CacheList::const_iterator it, end;
+            for (it = m_caches.begin(), end = m_caches.end(); it != end; ++it) {
+                const Cache* cache = *it;
+                result.cachedBlocks += cache->size();
+            }
+            
+            result.liveBlocks = m_acquiredBlocks - result.cachedBlocks;
+            result.chunkCount = m_chunkCount;
+            result.bytes = m_chunkCount * ChunkSize;
+            return result;
+        }
+    private:
+        void prepend(Chunk* chunk) {
+            chunk->previous = NULL;
+            chunk->next = m_first;
+            if (m_first != NULL)
+                m_first->previous = chunk;
+            else
+                m_last = chunk;
+            m_first = chunk;
+        }
         
-        if (chunk->full()) {
-            fullChunks().erase((fullIt + 1).base());
-            mixedChunks().push_back(chunk);
+        void append(Chunk* chunk) {
+            chunk->previous = m_last;
+            chunk->next = NULL;
+            if (m_last != NULL)
+                m_last->next = chunk;
+            else
+                m_first = chunk;
+            m_last = chunk;
         }
         
-        chunk->deallocate(t);
+        void unlink(Chunk* chunk) {
+            if (chunk->previous != NULL)
+                chunk->previous->next = chunk->next;
+            else
+                m_first = chunk->next;
+            if (chunk->next != NULL)
+                chunk->next->previous = chunk->previous;
+            else
+                m_last = chunk->previous;
+            chunk->previous = chunk->next = NULL;
+        }
+    };
+    
+    /*
+     The free blocks of one thread. Only the owning thread modifies the cache.
+     */
+    class Cache : public AllocatorThreadCache {
+    private:
+        Central& m_central;
+        void* m_blocks[PoolSize];
+        size_t m_size;
+    public:
+        Cache(Central& central) :
+        m_central(central),
+        m_size(0) {}
         
-        if (chunk->empty()) {
-            mixedChunks().erase((mixedIt + 1).base());
-            if (emptyChunks().size() < 2)
-                emptyChunks().push_back(chunk);
-                else
-                    delete chunk;
+        ~Cache() {
+            m_central.release(m_blocks, m_size);
+            m_central.removeCache(this);
         }
+        
+        size_t size() const {
+            return m_size;
+        }
+        
+        void* allocate() {
+            if (m_size == 0)
+                m_size = m_central.acquire(m_blocks, BatchSize);
+            return m_blocks[--m_size];
+        }
+        
+        void deallocate(void* block) {
+            if (m_size == PoolSize) {
+                m_central.release(m_blocks + PoolSize - BatchSize, BatchSize);
+                m_size -= BatchSize;
+            }
+            m_blocks[m_size++] = block;
+        }
+    };
+    
+    /*
+     Created on first use, so that objects can be allocated during static initialization, and never destroyed, since
+     objects with static storage duration and the thread caches may still use it on exit.
+     
+     The initialization of a function local static is not thread safe in C++03 and before Visual C++ 2015, so the
+     first use is forced by s_initializer during static initialization, when only the main thread runs.
+     */
+    static Central& central() {
+        static Central* instance = new Central();
+        return *instance;
+    }
+    
+    class Initializer {
+    public:
+        Initializer() {
+            central();
+        }
+        
+        // Referring to s_initializer ensures that it is instantiated along with the allocator.
+        void touch() const {}
+    };
+    
+    static const Initializer s_initializer;
+public:
+    /*
+     Exact while no other thread allocates or deallocates objects of type T.
+     */
+    static Statistics statistics() {
+        s_initializer.touch();
+        return central().statistics();
+    }
+#ifdef TB_ENABLE_ALLOCATOR
+    void* operator new(size_t size) {
+        assert(size == sizeof(T));
+        assert(BatchSize > 0);
+        
+        s_initializer.touch();
+        AllocatorSupport::ScratchArena* arena = AllocatorSupport::activeScratchArena();
+        if (arena != NULL)
+            return AllocatorSupport::allocateScratch(arena, size);
+        return central().cache().allocate();
+    }
+    
+    void operator delete(void* block) {
+        if (block == NULL)
+            return;
+        
+        const AllocatorSupport::ScratchArena* arena = AllocatorSupport::activeScratchArena();
+        if (arena == NULL || !AllocatorSupport::ownsScratchBlock(arena, block))
+            central().cache().deallocate(block);
     }
 #endif
 };
 
+template <class T, size_t PoolSize, size_t ChunkSize>
+const typename Allocator<T, PoolSize, ChunkSize>::Initializer Allocator<T, PoolSize, ChunkSize>::s_initializer;
+
 #endif
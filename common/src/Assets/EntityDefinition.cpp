@@ -22,11 +22,17 @@
 #include "CollectionUtils.h"
 #include "Assets/AttributeDefinition.h"
 
+#include <wx/thread.h>
+
 #include <algorithm>
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Assets {
+        // The definitions can be shared by worlds whose entities are created or destroyed concurrently, e.g. when maps
+        // are validated in a batch.
+        static wxCriticalSection UsageCountLock;
+        
         class CompareByName {
         private:
             bool m_shortName;
@@ -90,10 +96,12 @@ namespace TrenchBroom {
         }
         
         void EntityDefinition::incUsageCount() {
+            wxCriticalSectionLocker lock(UsageCountLock);
             ++m_usageCount;
         }
         
         void EntityDefinition::decUsageCount() {
+            wxCriticalSectionLocker lock(UsageCountLock);
             assert(m_usageCount > 0);
             --m_usageCount;
         }
@@ -243,6 +243,32 @@ public:
         
     }
     
+    /*
+     Returns the distance at which the given ray enters this box, 0 if the ray starts inside of this box, or NaN if the
+     ray misses it. This is the slab test, which is much cheaper than intersectWithRay because it does not find the side
+     of this box that is hit. The given inverse direction must be the one returned by Ray::inverseDirection.
+     */
+    T entryDistance(const Ray<T,S>& ray, const Vec<T,S>& inverseDirection) const {
+        T enter = static_cast<T>(0.0);
+        T leave = std::numeric_limits<T>::max();
+        for (size_t i = 0; i < S; ++i) {
+            if (ray.direction[i] == static_cast<T>(0.0)) {
+                if (ray.origin[i] < min[i] || ray.origin[i] > max[i])
+                    return std::numeric_limits<T>::quiet_NaN();
+            } else {
+                T t1 = (min[i] - ray.origin[i]) * inverseDirection[i];
+                T t2 = (max[i] - ray.origin[i]) * inverseDirection[i];
+                if (t1 > t2)
+                    std::swap(t1, t2);
+                enter = std::max(enter, t1);
+                leave = std::min(leave, t2);
+                if (enter > leave)
+                    return std::numeric_limits<T>::quiet_NaN();
+            }
+        }
+        return enter;
+    }
+    
     T intersectWithRay(const Ray<T,S>& ray, Vec<T,S>* sideNormal = NULL) const {
         const bool inside = contains(ray.origin);
         
@@ -30,9 +30,8 @@ namespace TrenchBroom {
 
         ConfigTokenizer::Token ConfigTokenizer::emitToken() {
             while (!eof()) {
-                size_t startLine = line();
-                size_t startColumn = column();
-                const char* c = curPos();
+                const char* start = curPos();
+                const char* c = start;
                 switch (*c) {
                     case '/':
                         advance();
@@ -41,21 +40,21 @@ namespace TrenchBroom {
                         break;
                     case '{':
                         advance();
-                        return Token(ConfigToken::OBrace, c, c+1, offset(c), startLine, startColumn);
+                        return token(ConfigToken::OBrace, c, c+1, start);
                     case '}':
                         advance();
-                        return Token(ConfigToken::CBrace, c, c+1, offset(c), startLine, startColumn);
+                        return token(ConfigToken::CBrace, c, c+1, start);
                     case ',':
                         advance();
-                        return Token(ConfigToken::Comma, c, c+1, offset(c), startLine, startColumn);
+                        return token(ConfigToken::Comma, c, c+1, start);
                     case '=':
                         advance();
-                        return Token(ConfigToken::Equals, c, c+1, offset(c), startLine, startColumn);
+                        return token(ConfigToken::Equals, c, c+1, start);
                     case '"': {
                         advance();
                         c = curPos();
                         const char* e = readQuotedString();
-                        return Token(ConfigToken::String, c, e, offset(c), startLine, startColumn);
+                        return token(ConfigToken::String, c, e, start);
                     }
                     case ' ':
                     case '\t':
@@ -66,8 +65,8 @@ namespace TrenchBroom {
                     default: {
                         const char* e = readString(Whitespace + "=");
                         if (e == NULL)
-                            throw ParserException(startLine, startColumn, "Unexpected character: " + String(c, 1));
-                        return Token(ConfigToken::Identifier, c, e, offset(c), startLine, startColumn);
+                            throw ParserException(line(start), column(start), "Unexpected character: " + String(c, 1));
+                        return token(ConfigToken::Identifier, c, e, start);
                     }
                 }
             }
@@ -38,16 +38,15 @@ namespace TrenchBroom {
         
         DefTokenizer::Token DefTokenizer::emitToken() {
             while (!eof()) {
-                size_t startLine = line();
-                size_t startColumn = column();
-                const char* c = curPos();
+                const char* start = curPos();
+                const char* c = start;
                 switch (*c) {
                     case '/': {
                         advance();
                         if (curChar() == '*') {
                             // eat all chars immediately after the '*' because it's often followed by QUAKE
                             do { advance(); } while (!eof() && !isWhitespace(curChar()));
-                            return Token(DefToken::ODefinition, c, curPos(), offset(c), startLine, startColumn);
+                            return token(DefToken::ODefinition, c, curPos(), start);
                         } else if (curChar() == '/') {
                             discardUntil("\n\r");
                             break;
@@ -58,36 +57,36 @@ namespace TrenchBroom {
                     case '*': {
                         advance();
                         if (curChar() == '/')
-                            return Token(DefToken::CDefinition, c, curPos(), offset(c), startLine, startColumn);
+                            return token(DefToken::CDefinition, c, curPos(), start);
                         // fall through and try to read as word
                         retreat();
                     }
                     case '(':
                         advance();
-                        return Token(DefToken::OParenthesis, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::OParenthesis, c, c + 1, start);
                     case ')':
                         advance();
-                        return Token(DefToken::CParenthesis, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::CParenthesis, c, c + 1, start);
                     case '{':
                         advance();
-                        return Token(DefToken::OBrace, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::OBrace, c, c + 1, start);
                     case '}':
                         advance();
-                        return Token(DefToken::CBrace, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::CBrace, c, c + 1, start);
                     case '=':
                         advance();
-                        return Token(DefToken::Equality, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::Equality, c, c + 1, start);
                     case ';':
                         advance();
-                        return Token(DefToken::Semicolon, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::Semicolon, c, c + 1, start);
                     case '\r':
                         advance();
                     case '\n':
                         advance();
-                        return Token(DefToken::Newline, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::Newline, c, c + 1, start);
                     case ',':
                         advance();
-                        return Token(DefToken::Comma, c, c + 1, offset(c), startLine, startColumn);
+                        return token(DefToken::Comma, c, c + 1, start);
                     case ' ':
                     case '\t':
                         discardWhile(" \t");
@@ -96,19 +95,19 @@ namespace TrenchBroom {
                         advance();
                         c = curPos();
                         const char* e = readQuotedString();
-                        return Token(DefToken::QuotedString, c, e, offset(c), startLine, startColumn);
+                        return token(DefToken::QuotedString, c, e, start);
                     }
                     default: { // integer, decimal or word
                         const char* e = readInteger(WordDelims);
                         if (e != NULL)
-                            return Token(DefToken::Integer, c, e, offset(c), startLine, startColumn);
+                            return token(DefToken::Integer, c, e, start);
                         e = readDecimal(WordDelims);
                         if (e != NULL)
-                            return Token(DefToken::Decimal, c, e, offset(c), startLine, startColumn);
+                            return token(DefToken::Decimal, c, e, start);
                         e = readString(WordDelims);
                         if (e == NULL)
-                            throw ParserException(startLine, startColumn, "Unexpected character: " + String(c, 1));
-                        return Token(DefToken::Word, c, e, offset(c), startLine, startColumn);
+                            throw ParserException(line(start), column(start), "Unexpected character: " + String(c, 1));
+                        return token(DefToken::Word, c, e, start);
                     }
                 }
             }
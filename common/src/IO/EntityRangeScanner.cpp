@@ -0,0 +1,136 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityRangeScanner.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        EntityRangeScanner::Range::Range(const char* i_begin, const char* i_end, const size_t i_line) :
+        begin(i_begin),
+        end(i_end),
+        line(i_line) {}
+
+        size_t EntityRangeScanner::Range::length() const {
+            return static_cast<size_t>(end - begin);
+        }
+
+        EntityRangeScanner::Entity::Entity(const char* i_begin, const size_t i_line) :
+        range(i_begin, i_begin, i_line),
+        lastLine(i_line) {}
+
+        EntityRangeScanner::EntityRangeScanner(const char* begin, const char* end) :
+        m_begin(begin),
+        m_end(end) {
+            assert(m_begin <= m_end);
+        }
+
+        bool EntityRangeScanner::scan(EntityList& result) const {
+            size_t depth = 0;
+            size_t line = 1;
+            
+            const char* c = m_begin;
+            while (c < m_end) {
+                switch (*c) {
+                    case '\n':
+                        ++line;
+                        ++c;
+                        break;
+                    case '/':
+                        if (depth == 0 && c + 2 < m_end && *(c + 1) == '/' && *(c + 2) == '/')
+                            return false; // extra attributes must belong to an entity
+                        else if (c + 1 < m_end && *(c + 1) == '/')
+                            c = skipLine(c);
+                        else if (depth == 0)
+                            return false;
+                        else
+                            ++c;
+                        break;
+                    case '"':
+                        if (depth != 1)
+                            return false;
+                        c = skipQuotedString(c, line);
+                        if (c == NULL)
+                            return false;
+                        break;
+                    case '(':
+                        // a brush face; its texture name may contain braces
+                        if (depth == 2)
+                            c = skipLine(c);
+                        else
+                            ++c;
+                        break;
+                    case '{':
+                        if (depth == 0)
+                            result.push_back(Entity(c, line));
+                        else if (depth == 1)
+                            result.back().brushes.push_back(Range(c, c, line));
+                        else
+                            return false;
+                        ++depth;
+                        ++c;
+                        break;
+                    case '}':
+                        if (depth == 0)
+                            return false;
+                        --depth;
+                        ++c;
+                        if (depth == 0) {
+                            result.back().range.end = c;
+                            result.back().lastLine = line;
+                        } else {
+                            result.back().brushes.back().end = c;
+                        }
+                        break;
+                    default:
+                        if (depth == 0 && !isWhitespace(*c))
+                            return false;
+                        ++c;
+                        break;
+                }
+            }
+            
+            return depth == 0;
+        }
+
+        const char* EntityRangeScanner::skipLine(const char* c) const {
+            while (c < m_end && *c != '\n')
+                ++c;
+            return c;
+        }
+
+        const char* EntityRangeScanner::skipQuotedString(const char* c, size_t& line) const {
+            assert(*c == '"');
+            ++c;
+            while (c < m_end && *c != '"') {
+                if (*c == '\n')
+                    ++line;
+                ++c;
+            }
+            if (c == m_end)
+                return NULL;
+            return c + 1;
+        }
+
+        bool EntityRangeScanner::isWhitespace(const char c) const {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EntityRangeScanner
+#define TrenchBroom_EntityRangeScanner
+
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         Splits the text of a map file into the ranges of its top level entities and their brushes without
+         tokenizing it.
+         
+         The scanner only tracks quoted strings, comments and brace nesting. Brush faces are assumed to occupy
+         a single line so that texture names containing braces do not affect the nesting. If the input cannot be
+         split reliably, the scan fails and the caller should parse the file sequentially instead.
+         */
+        class EntityRangeScanner {
+        public:
+            struct Range {
+                const char* begin;
+                const char* end;
+                size_t line;
+                
+                Range(const char* i_begin, const char* i_end, size_t i_line);
+                size_t length() const;
+            };
+            
+            typedef std::vector<Range> RangeList;
+            
+            struct Entity {
+                Range range;
+                size_t lastLine;
+                RangeList brushes;
+                
+                Entity(const char* i_begin, size_t i_line);
+            };
+            
+            typedef std::vector<Entity> EntityList;
+        private:
+            const char* m_begin;
+            const char* m_end;
+        public:
+            EntityRangeScanner(const char* begin, const char* end);
+            
+            bool scan(EntityList& result) const;
+        private:
+            const char* skipLine(const char* c) const;
+            const char* skipQuotedString(const char* c, size_t& line) const;
+            bool isWhitespace(char c) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_EntityRangeScanner) */
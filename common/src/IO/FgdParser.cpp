@@ -38,9 +38,8 @@ namespace TrenchBroom {
         
         FgdTokenizer::Token FgdTokenizer::emitToken() {
             while (!eof()) {
-                size_t startLine = line();
-                size_t startColumn = column();
-                const char* c = curPos();
+                const char* start = curPos();
+                const char* c = start;
                 
                 switch (*c) {
                     case '/':
@@ -50,30 +49,30 @@ namespace TrenchBroom {
                         break;
                     case '(':
                         advance();
-                        return Token(FgdToken::OParenthesis, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::OParenthesis, c, c+1, start);
                     case ')':
                         advance();
-                        return Token(FgdToken::CParenthesis, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::CParenthesis, c, c+1, start);
                     case '[':
                         advance();
-                        return Token(FgdToken::OBracket, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::OBracket, c, c+1, start);
                     case ']':
                         advance();
-                        return Token(FgdToken::CBracket, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::CBracket, c, c+1, start);
                     case '=':
                         advance();
-                        return Token(FgdToken::Equality, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::Equality, c, c+1, start);
                     case ',':
                         advance();
-                        return Token(FgdToken::Comma, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::Comma, c, c+1, start);
                     case ':':
                         advance();
-                        return Token(FgdToken::Colon, c, c+1, offset(c), startLine, startColumn);
+                        return token(FgdToken::Colon, c, c+1, start);
                     case '"': { // quoted string
                         advance();
                         c = curPos();
                         const char* e = readQuotedString();
-                        return Token(FgdToken::String, c, e, offset(c), startLine, startColumn);
+                        return token(FgdToken::String, c, e, start);
                     }
                     case ' ':
                     case '\t':
@@ -84,16 +83,16 @@ namespace TrenchBroom {
                     default: {
                         const char* e = readInteger(WordDelims);
                         if (e != NULL)
-                            return Token(FgdToken::Integer, c, e, offset(c), startLine, startColumn);
+                            return token(FgdToken::Integer, c, e, start);
                         
                         e = readDecimal(WordDelims);
                         if (e != NULL)
-                            return Token(FgdToken::Decimal, c, e, offset(c), startLine, startColumn);
+                            return token(FgdToken::Decimal, c, e, start);
                         
                         e = readString(WordDelims);
                         if (e == NULL)
-                            throw ParserException(startLine, startColumn, "Unexpected character: '" + String(c, 1) + "'");
-                        return Token(FgdToken::Word, c, e, offset(c), startLine, startColumn);
+                            throw ParserException(line(start), column(start), "Unexpected character: '" + String(c, 1) + "'");
+                        return token(FgdToken::Word, c, e, start);
                     }
                 }
             }
@@ -69,9 +69,10 @@ namespace TrenchBroom {
             return StringUtils::trim(String(buf + expectedHeader.size(), buf + i));
         }
 
-        void writeGameComment(FILE* stream, const String& gameName, const String& mapFormat) {
+        size_t writeGameComment(FILE* stream, const String& gameName, const String& mapFormat) {
             std::fprintf(stream, "// Game: %s\n", gameName.c_str());
             std::fprintf(stream, "// Format: %s\n", mapFormat.c_str());
+            return 2;
         }
 
         Vec3f readVec3f(const char*& cursor) {
@@ -56,7 +56,8 @@ namespace TrenchBroom {
         String readFormatComment(FILE* stream);
         String readInfoComment(FILE* stream, const String& name);
         
-        void writeGameComment(FILE* stream, const String& gameName, const String& mapFormat);
+        // Returns the number of lines written.
+        size_t writeGameComment(FILE* stream, const String& gameName, const String& mapFormat);
         
         template <typename T>
         void advance(const char*& cursor, const size_t i = 1) {
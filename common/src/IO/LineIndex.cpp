@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LineIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace TrenchBroom {
+    namespace IO {
+        LineIndex::LineIndex(const char* begin, const char* end, const size_t firstLine) :
+        m_begin(begin),
+        m_end(end),
+        m_firstLine(firstLine),
+        m_lineStarts(1, 0),
+        m_indexedEnd(begin) {
+            assert(m_begin <= m_end);
+        }
+        
+        size_t LineIndex::line(const size_t offset) const {
+            return m_firstLine + findLine(offset);
+        }
+        
+        size_t LineIndex::column(const size_t offset) const {
+            return offset - m_lineStarts[findLine(offset)] + 1;
+        }
+
+        size_t LineIndex::findLine(const size_t offset) const {
+            assert(offset <= static_cast<size_t>(m_end - m_begin));
+            indexUntil(m_begin + offset);
+            
+            // the last line that starts at or before the offset
+            const std::vector<size_t>::const_iterator it = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset);
+            return static_cast<size_t>(it - m_lineStarts.begin()) - 1;
+        }
+        
+        void LineIndex::indexUntil(const char* pos) const {
+            if (pos <= m_indexedEnd)
+                return;
+            
+            // scan ahead in large chunks so that ascending requests don't rescan the buffer in tiny steps
+            const size_t remaining = static_cast<size_t>(m_end - m_indexedEnd);
+            const char* end = std::max(pos, m_indexedEnd + std::min(remaining, ChunkSize));
+            
+            // memchr is vectorized by the standard library, which makes it much faster than a loop over the characters
+            const char* cur = m_indexedEnd;
+            while (cur < end) {
+                const char* lineBreak = static_cast<const char*>(std::memchr(cur, '\n', static_cast<size_t>(end - cur)));
+                if (lineBreak == NULL)
+                    break;
+                cur = lineBreak + 1;
+                m_lineStarts.push_back(static_cast<size_t>(cur - m_begin));
+            }
+            m_indexedEnd = end;
+        }
+    }
+}
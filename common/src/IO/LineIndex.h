@@ -0,0 +1,55 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_LineIndex
+#define TrenchBroom_LineIndex
+
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /*
+         Maps byte offsets in a buffer to line and column numbers. The offsets of the line starts are collected
+         lazily as far as the requested offsets require, so that a buffer that is never asked for a line is never
+         scanned for line breaks.
+         */
+        class LineIndex {
+        private:
+            static const size_t ChunkSize = 64 * 1024;
+            
+            const char* m_begin;
+            const char* m_end;
+            size_t m_firstLine;
+            
+            mutable std::vector<size_t> m_lineStarts;
+            mutable const char* m_indexedEnd;
+        public:
+            LineIndex(const char* begin, const char* end, size_t firstLine);
+            
+            size_t line(size_t offset) const;
+            size_t column(size_t offset) const;
+        private:
+            size_t findLine(size_t offset) const;
+            void indexUntil(const char* pos) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_LineIndex) */
@@ -0,0 +1,491 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MapCache.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/Path.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushFaceAttributes.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/NodeVisitor.h"
+#include "Model/World.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+namespace TrenchBroom {
+    namespace IO {
+        const char MapCache::Magic[4] = { 'T', 'B', 'M', 'C' };
+        const uint32_t MapCache::Version = 1;
+
+        class MapCache::Writer : public Model::ConstNodeVisitor {
+        private:
+            typedef std::map<const Model::BrushVertex*, uint32_t> VertexIndexMap;
+            Buffer& m_buffer;
+        public:
+            Writer(Buffer& buffer) :
+            m_buffer(buffer) {}
+            
+            template <typename T>
+            void write(const T& value) {
+                const char* bytes = reinterpret_cast<const char*>(&value);
+                m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+            }
+            
+            void write(const String& str) {
+                write(static_cast<uint32_t>(str.size()));
+                m_buffer.insert(m_buffer.end(), str.begin(), str.end());
+            }
+            
+            void write(const Vec3& vec) {
+                for (size_t i = 0; i < 3; ++i)
+                    write(vec[i]);
+            }
+            
+            void write(const BBox3& bounds) {
+                write(bounds.min);
+                write(bounds.max);
+            }
+        private:
+            void doVisit(const Model::World* world) {
+                writeFilePosition(world);
+                writeAttributes(world);
+                writeChildren(world);
+            }
+            
+            void doVisit(const Model::Layer* layer) {
+                write(static_cast<uint8_t>(NodeType_Layer));
+                writeFilePosition(layer);
+                write(layer->name());
+                writeChildren(layer);
+            }
+            
+            void doVisit(const Model::Group* group) {
+                write(static_cast<uint8_t>(NodeType_Group));
+                writeFilePosition(group);
+                write(group->name());
+                writeChildren(group);
+            }
+            
+            void doVisit(const Model::Entity* entity) {
+                write(static_cast<uint8_t>(NodeType_Entity));
+                writeFilePosition(entity);
+                writeAttributes(entity);
+                writeChildren(entity);
+            }
+            
+            void doVisit(const Model::Brush* brush) {
+                write(static_cast<uint8_t>(NodeType_Brush));
+                writeFilePosition(brush);
+
+                VertexIndexMap indices;
+                const Model::Brush::VertexList vertices = brush->vertices();
+                write(static_cast<uint32_t>(vertices.size()));
+                
+                Model::Brush::VertexList::const_iterator vIt, vEnd;
+                for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd; ++vIt) {
+                    const Model::BrushVertex* vertex = *vIt;
+                    indices.insert(std::make_pair(vertex, static_cast<uint32_t>(indices.size())));
+                    write(vertex->position());
+                }
+                
+                const Model::BrushFaceList& faces = brush->faces();
+                write(static_cast<uint32_t>(faces.size()));
+                
+                Model::BrushFaceList::const_iterator fIt, fEnd;
+                for (fIt = faces.begin(), fEnd = faces.end(); fIt != fEnd; ++fIt) {
+                    const Model::BrushFace* face = *fIt;
+                    writeFace(face, indices);
+                }
+            }
+            
+            void writeFace(const Model::BrushFace* face, const VertexIndexMap& indices) {
+                const Model::BrushFace::Points& points = face->points();
+                for (size_t i = 0; i < 3; ++i)
+                    write(points[i]);
+                
+                write(face->textureName());
+                write(face->xOffset());
+                write(face->yOffset());
+                write(face->rotation());
+                write(face->xScale());
+                write(face->yScale());
+                write(face->surfaceContents());
+                write(face->surfaceFlags());
+                write(face->surfaceValue());
+                write(face->textureXAxis());
+                write(face->textureYAxis());
+                
+                const Model::BrushFace::VertexList vertices = face->vertices();
+                write(static_cast<uint32_t>(vertices.size()));
+                
+                Model::BrushFace::VertexList::const_iterator it, end;
+                for (it = vertices.begin(), end = vertices.end(); it != end; ++it) {
+                    const Model::BrushVertex* vertex = *it;
+                    write(MapUtils::find(indices, vertex, static_cast<uint32_t>(0)));
+                }
+            }
+            
+            void writeFilePosition(const Model::Node* node) {
+                write(static_cast<uint64_t>(node->lineNumber()));
+                write(static_cast<uint64_t>(node->lineCount()));
+            }
+            
+            void writeAttributes(const Model::AttributableNode* attributable) {
+                const Model::EntityAttribute::List& attributes = attributable->attributes();
+                write(static_cast<uint32_t>(attributes.size()));
+                
+                Model::EntityAttribute::List::const_iterator it, end;
+                for (it = attributes.begin(), end = attributes.end(); it != end; ++it) {
+                    const Model::EntityAttribute& attribute = *it;
+                    write(attribute.name());
+                    write(attribute.value());
+                }
+            }
+            
+            void writeChildren(const Model::Node* node) {
+                const Model::NodeList& children = node->children();
+                write(static_cast<uint32_t>(children.size()));
+                
+                Model::NodeList::const_iterator it, end;
+                for (it = children.begin(), end = children.end(); it != end; ++it) {
+                    const Model::Node* child = *it;
+                    child->accept(*this);
+                }
+            }
+        };
+        
+        class MapCache::Reader {
+        private:
+            const char* m_cur;
+            const char* m_end;
+            const Model::BrushContentTypeBuilder* m_brushContentTypeBuilder;
+            Model::World* m_world;
+        public:
+            Reader(const char* begin, const char* end, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) :
+            m_cur(begin),
+            m_end(end),
+            m_brushContentTypeBuilder(brushContentTypeBuilder),
+            m_world(NULL) {}
+            
+            template <typename T>
+            T read() {
+                check(sizeof(T));
+                T value;
+                std::memcpy(&value, m_cur, sizeof(T));
+                m_cur += sizeof(T);
+                return value;
+            }
+            
+            String readString() {
+                const size_t length = read<uint32_t>();
+                check(length);
+                const String result(m_cur, m_cur + length);
+                m_cur += length;
+                return result;
+            }
+            
+            Vec3 readVec3() {
+                Vec3 result;
+                for (size_t i = 0; i < 3; ++i)
+                    result[i] = read<FloatType>();
+                return result;
+            }
+            
+            BBox3 readBBox3() {
+                const Vec3 min = readVec3();
+                const Vec3 max = readVec3();
+                return BBox3(min, max);
+            }
+            
+            bool readMagic() {
+                check(sizeof(Magic));
+                const bool result = std::memcmp(m_cur, Magic, sizeof(Magic)) == 0;
+                m_cur += sizeof(Magic);
+                return result;
+            }
+            
+            Model::World* readWorld(const Model::MapFormat::Type format, const BBox3& worldBounds) {
+                m_world = new Model::World(format, m_brushContentTypeBuilder, worldBounds);
+                try {
+                    readFilePosition(m_world);
+                    m_world->setAttributes(readAttributes());
+                    
+                    const size_t layerCount = read<uint32_t>();
+                    if (layerCount == 0 || read<uint8_t>() != NodeType_Layer)
+                        throw FileFormatException("Expected default layer");
+                    
+                    Model::Layer* defaultLayer = m_world->defaultLayer();
+                    readFilePosition(defaultLayer);
+                    readString();
+                    readChildren(defaultLayer, worldBounds);
+                    
+                    for (size_t i = 1; i < layerCount; ++i) {
+                        if (read<uint8_t>() != NodeType_Layer)
+                            throw FileFormatException("Expected layer");
+                        readLayer(worldBounds);
+                    }
+                    
+                    if (m_cur != m_end)
+                        throw FileFormatException("Unexpected trailing data");
+                    return m_world;
+                } catch (...) {
+                    delete m_world;
+                    m_world = NULL;
+                    throw;
+                }
+            }
+        private:
+            void check(const size_t size) const {
+                if (static_cast<size_t>(m_end - m_cur) < size)
+                    throw FileFormatException("Unexpected end of map cache");
+            }
+            
+            void readLayer(const BBox3& worldBounds) {
+                const size_t lineNumber = read<uint64_t>();
+                const size_t lineCount = read<uint64_t>();
+                Model::Layer* layer = m_world->createLayer(readString(), worldBounds);
+                layer->setFilePosition(lineNumber, lineCount);
+                m_world->addChild(layer);
+                readChildren(layer, worldBounds);
+            }
+            
+            void readChildren(Model::Node* parent, const BBox3& worldBounds) {
+                const size_t childCount = read<uint32_t>();
+                for (size_t i = 0; i < childCount; ++i) {
+                    switch (read<uint8_t>()) {
+                        case NodeType_Group:
+                            readGroup(parent, worldBounds);
+                            break;
+                        case NodeType_Entity:
+                            readEntity(parent, worldBounds);
+                            break;
+                        case NodeType_Brush:
+                            parent->addChild(readBrush());
+                            break;
+                        default:
+                            throw FileFormatException("Unexpected node type");
+                    }
+                }
+            }
+            
+            void readGroup(Model::Node* parent, const BBox3& worldBounds) {
+                const size_t lineNumber = read<uint64_t>();
+                const size_t lineCount = read<uint64_t>();
+                Model::Group* group = m_world->createGroup(readString());
+                group->setFilePosition(lineNumber, lineCount);
+                parent->addChild(group);
+                readChildren(group, worldBounds);
+            }
+            
+            void readEntity(Model::Node* parent, const BBox3& worldBounds) {
+                const size_t lineNumber = read<uint64_t>();
+                const size_t lineCount = read<uint64_t>();
+                const Model::EntityAttribute::List attributes = readAttributes();
+                
+                Model::Entity* entity = m_world->createEntity();
+                entity->setFilePosition(lineNumber, lineCount);
+                entity->setAttributes(attributes);
+                parent->addChild(entity);
+                readChildren(entity, worldBounds);
+            }
+            
+            Model::Brush* readBrush() {
+                const size_t lineNumber = read<uint64_t>();
+                const size_t lineCount = read<uint64_t>();
+                
+                const size_t vertexCount = read<uint32_t>();
+                check(vertexCount * 3 * sizeof(FloatType));
+                Vec3::List positions;
+                positions.reserve(vertexCount);
+                for (size_t i = 0; i < vertexCount; ++i)
+                    positions.push_back(readVec3());
+                
+                Model::BrushFaceList faces;
+                Model::BrushGeometry::FaceIndexList indices;
+                try {
+                    const size_t faceCount = read<uint32_t>();
+                    for (size_t i = 0; i < faceCount; ++i) {
+                        indices.push_back(Model::BrushGeometry::IndexList());
+                        faces.push_back(readFace(indices.back()));
+                    }
+                } catch (...) {
+                    VectorUtils::clearAndDelete(faces);
+                    throw;
+                }
+                
+                Model::BrushGeometry* geometry = new Model::BrushGeometry();
+                if (!geometry->setTopology(positions, indices)) {
+                    delete geometry;
+                    VectorUtils::clearAndDelete(faces);
+                    throw FileFormatException("Invalid brush geometry");
+                }
+                
+                Model::Brush* brush = new Model::Brush(faces, geometry);
+                brush->setContentTypeBuilder(m_brushContentTypeBuilder);
+                brush->setFilePosition(lineNumber, lineCount);
+                return brush;
+            }
+            
+            Model::BrushFace* readFace(Model::BrushGeometry::IndexList& indices) {
+                const Vec3 p0 = readVec3();
+                const Vec3 p1 = readVec3();
+                const Vec3 p2 = readVec3();
+                
+                Model::BrushFaceAttributes attribs(readString());
+                attribs.setXOffset(read<float>());
+                attribs.setYOffset(read<float>());
+                attribs.setRotation(read<float>());
+                attribs.setXScale(read<float>());
+                attribs.setYScale(read<float>());
+                attribs.setSurfaceContents(read<int>());
+                attribs.setSurfaceFlags(read<int>());
+                attribs.setSurfaceValue(read<float>());
+                
+                const Vec3 texAxisX = readVec3();
+                const Vec3 texAxisY = readVec3();
+                
+                const size_t vertexCount = read<uint32_t>();
+                check(vertexCount * sizeof(uint32_t));
+                indices.reserve(vertexCount);
+                for (size_t i = 0; i < vertexCount; ++i)
+                    indices.push_back(read<uint32_t>());
+                
+                return m_world->createFace(p0, p1, p2, attribs, texAxisX, texAxisY);
+            }
+            
+            void readFilePosition(Model::Node* node) {
+                const size_t lineNumber = read<uint64_t>();
+                const size_t lineCount = read<uint64_t>();
+                node->setFilePosition(lineNumber, lineCount);
+            }
+            
+            Model::EntityAttribute::List readAttributes() {
+                Model::EntityAttribute::List result;
+                const size_t count = read<uint32_t>();
+                for (size_t i = 0; i < count; ++i) {
+                    const String name = readString();
+                    const String value = readString();
+                    result.push_back(Model::EntityAttribute(name, value));
+                }
+                return result;
+            }
+        };
+        
+        MapCache::MapCache(const char* mapBegin, const char* mapEnd) :
+        m_mapHash(hash(mapBegin, mapEnd)),
+        m_mapSize(static_cast<uint64_t>(mapEnd - mapBegin)) {}
+
+        Path MapCache::cachePath(const Path& mapPath) {
+            return mapPath.addExtension("tbcache");
+        }
+        
+        Model::World* MapCache::read(const char* begin, const char* end, const Model::MapFormat::Type format, const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) const {
+            try {
+                Reader reader(begin, end, brushContentTypeBuilder);
+                if (!reader.readMagic() ||
+                    reader.read<uint32_t>() != Version ||
+                    reader.read<uint32_t>() != sizeof(FloatType) ||
+                    reader.read<uint64_t>() != m_mapSize ||
+                    reader.read<uint64_t>() != m_mapHash ||
+                    reader.read<uint32_t>() != static_cast<uint32_t>(format) ||
+                    reader.readBBox3() != worldBounds)
+                    return NULL;
+                return reader.readWorld(format, worldBounds);
+            } catch (const FileFormatException&) {
+                return NULL;
+            } catch (const GeometryException&) {
+                return NULL;
+            }
+        }
+        
+        Model::World* MapCache::read(const Path& path, const Model::MapFormat::Type format, const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) const {
+            if (!Disk::fileExists(path))
+                return NULL;
+            
+            try {
+                const MappedFile::Ptr file = Disk::openFile(path);
+                return read(file->begin(), file->end(), format, worldBounds, brushContentTypeBuilder);
+            } catch (const FileSystemException&) {
+                return NULL;
+            }
+        }
+        
+        void MapCache::write(const Model::World* world, const BBox3& worldBounds, Buffer& buffer) const {
+            assert(world != NULL);
+            
+            Writer writer(buffer);
+            buffer.insert(buffer.end(), Magic, Magic + sizeof(Magic));
+            writer.write(Version);
+            writer.write(static_cast<uint32_t>(sizeof(FloatType)));
+            writer.write(m_mapSize);
+            writer.write(m_mapHash);
+            writer.write(static_cast<uint32_t>(world->format()));
+            writer.write(worldBounds);
+            world->accept(writer);
+        }
+        
+        void MapCache::write(const Model::World* world, const BBox3& worldBounds, const Path& path) const {
+            Buffer buffer;
+            write(world, worldBounds, buffer);
+            writeFile(buffer, path);
+        }
+        
+        void MapCache::writeFile(const Buffer& buffer, const Path& path) {
+            // write to a temporary file first so that a partially written cache is never picked up
+            const Path tempPath = path.addExtension("tmp");
+            const String tempPathStr = tempPath.asString();
+            const String pathStr = path.asString();
+            
+            FILE* stream = std::fopen(tempPathStr.c_str(), "wb");
+            if (stream == NULL)
+                throw FileSystemException("Cannot open file: " + tempPathStr);
+            
+            const size_t written = std::fwrite(&buffer.front(), 1, buffer.size(), stream);
+            const bool closed = std::fclose(stream) == 0;
+            if (written != buffer.size() || !closed) {
+                std::remove(tempPathStr.c_str());
+                throw FileSystemException("Cannot write file: " + tempPathStr);
+            }
+            
+            std::remove(pathStr.c_str());
+            if (std::rename(tempPathStr.c_str(), pathStr.c_str()) != 0) {
+                std::remove(tempPathStr.c_str());
+                throw FileSystemException("Cannot write file: " + pathStr);
+            }
+        }
+
+        uint64_t MapCache::hash(const char* begin, const char* end) {
+            // 64 bit FNV-1a
+            uint64_t result = 14695981039346656037ULL;
+            for (const char* c = begin; c < end; ++c) {
+                result ^= static_cast<unsigned char>(*c);
+                result *= 1099511628211ULL;
+            }
+            return result;
+        }
+    }
+}
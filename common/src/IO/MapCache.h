@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TrenchBroom_MapCache
+#define TrenchBroom_MapCache
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+#ifdef _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushContentTypeBuilder;
+    }
+    
+    namespace IO {
+        class Path;
+        
+        /*
+         A binary snapshot of a world that was read from a map file. The snapshot is keyed by a hash of the map
+         file's contents, the map format and the world bounds, and it contains the node hierarchy, all attributes,
+         all face attributes and the geometry of every brush, so that reading it requires neither parsing nor
+         clipping. Reading a snapshot that does not match the map file or that is damaged yields NULL, in which
+         case the caller must read the map file itself.
+         */
+        class MapCache {
+        public:
+            typedef std::vector<char> Buffer;
+        private:
+            static const char Magic[4];
+            static const uint32_t Version;
+            
+            typedef enum {
+                NodeType_Layer,
+                NodeType_Group,
+                NodeType_Entity,
+                NodeType_Brush
+            } NodeType;
+            
+            class Writer;
+            class Reader;
+            
+            uint64_t m_mapHash;
+            uint64_t m_mapSize;
+        public:
+            MapCache(const char* mapBegin, const char* mapEnd);
+            
+            static Path cachePath(const Path& mapPath);
+            
+            Model::World* read(const char* begin, const char* end, Model::MapFormat::Type format, const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) const;
+            Model::World* read(const Path& path, Model::MapFormat::Type format, const BBox3& worldBounds, const Model::BrushContentTypeBuilder* brushContentTypeBuilder) const;
+            
+            void write(const Model::World* world, const BBox3& worldBounds, Buffer& buffer) const;
+            void write(const Model::World* world, const BBox3& worldBounds, const Path& path) const;
+            
+            // Writes a buffer that was filled by write to the given path, replacing an existing cache atomically.
+            static void writeFile(const Buffer& buffer, const Path& path);
+            
+            static uint64_t hash(const char* begin, const char* end);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapCache) */
@@ -0,0 +1,99 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapCacheWriter.h"
+
+#include "Exceptions.h"
+#include "Logger.h"
+#include "IO/Path.h"
+
+#include <cassert>
+
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapCacheWriter::WriteThread : public wxThread {
+        private:
+            MapCache::Buffer m_buffer;
+            Path m_path;
+            String m_error;
+        public:
+            WriteThread(MapCache::Buffer& buffer, const Path& path) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_path(path) {
+                m_buffer.swap(buffer);
+            }
+            
+            void write() {
+                try {
+                    MapCache::writeFile(m_buffer, m_path);
+                } catch (const FileSystemException& e) {
+                    m_error = e.what();
+                }
+                MapCache::Buffer().swap(m_buffer);
+            }
+            
+            // Must only be called once the cache has been written.
+            void logMessages(Logger* logger) const {
+                if (logger != NULL && !m_error.empty())
+                    logger->warn("Could not write map cache: %s", m_error.c_str());
+            }
+        private:
+            ExitCode Entry() {
+                write();
+                return static_cast<ExitCode>(0);
+            }
+        };
+        
+        MapCacheWriter::MapCacheWriter() :
+        m_thread(NULL) {}
+        
+        MapCacheWriter::~MapCacheWriter() {
+            finish(NULL);
+        }
+        
+        void MapCacheWriter::write(const MapCache& cache, const Model::World* world, const BBox3& worldBounds, const Path& path, Logger* logger) {
+            finish(logger);
+            
+            // the buffer must be filled here because the world may only be accessed on this thread
+            MapCache::Buffer buffer;
+            cache.write(world, worldBounds, buffer);
+            
+            WriteThread* thread = new WriteThread(buffer, path);
+            if (thread->Run() == wxTHREAD_NO_ERROR) {
+                m_thread = thread;
+            } else {
+                thread->write();
+                thread->logMessages(logger);
+                delete thread;
+            }
+        }
+        
+        void MapCacheWriter::finish(Logger* logger) {
+            if (m_thread == NULL)
+                return;
+            
+            m_thread->Wait();
+            m_thread->logMessages(logger);
+            delete m_thread;
+            m_thread = NULL;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapCacheWriter
+#define TrenchBroom_MapCacheWriter
+
+#include "IO/MapCache.h"
+
+namespace TrenchBroom {
+    class Logger;
+    
+    namespace IO {
+        class Path;
+        
+        /*
+         Writes map caches to disk on a worker thread so that opening a map does not wait for its cache. The world is
+         serialized into a buffer on the calling thread, so it can be edited while the buffer is written. Only one
+         cache is written at a time, and a failure is logged when the next cache is written or finish is called.
+         */
+        class MapCacheWriter {
+        private:
+            class WriteThread;
+            WriteThread* m_thread;
+        public:
+            MapCacheWriter();
+            ~MapCacheWriter();
+            
+            // Serializes the given world with the given cache and writes it to the given path in the background.
+            void write(const MapCache& cache, const Model::World* world, const BBox3& worldBounds, const Path& path, Logger* logger);
+            // Waits until the current cache has been written, if any, and logs a failure to the given logger.
+            void finish(Logger* logger);
+        private:
+            MapCacheWriter(const MapCacheWriter& other);
+            MapCacheWriter& operator=(const MapCacheWriter& other);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapCacheWriter) */
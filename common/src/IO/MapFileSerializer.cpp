@@ -19,249 +19,299 @@
 
 #include "MapFileSerializer.h"
 #include "Exceptions.h"
+#include "ParallelTaskRunner.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/MapFileSplicer.h"
 #include "IO/Path.h"
 #include "Model/BrushFace.h"
 
+#include <algorithm>
+#include <cstddef>
+
 namespace TrenchBroom {
     namespace IO {
+        /*
+         The faces are formatted by hand into a string buffer instead of passing every value through std::fprintf.
+         The output is identical to that of the format strings given in the comments below.
+         */
+        static void appendFloat(String& buffer, const FloatType value, const int precision) {
+            StringUtils::appendDouble(buffer, static_cast<double>(value), precision);
+        }
+        
+        // "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) %s"
+        static void appendPointsAndTextureName(String& buffer, const Model::BrushFace* face, const int precision) {
+            const Model::BrushFace::Points& points = face->points();
+            for (size_t i = 0; i < 3; ++i) {
+                buffer.append("( ");
+                appendFloat(buffer, points[i].x(), precision);
+                buffer.push_back(' ');
+                appendFloat(buffer, points[i].y(), precision);
+                buffer.push_back(' ');
+                appendFloat(buffer, points[i].z(), precision);
+                buffer.append(" ) ");
+            }
+            
+            const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
+            buffer.append(textureName);
+        }
+        
+        // " %.6g %.6g %.6g %.6g %.6g"
+        static void appendTextureAttributes(String& buffer, const Model::BrushFace* face) {
+            buffer.push_back(' ');
+            appendFloat(buffer, face->xOffset(), 6);
+            buffer.push_back(' ');
+            appendFloat(buffer, face->yOffset(), 6);
+            buffer.push_back(' ');
+            appendFloat(buffer, face->rotation(), 6);
+            buffer.push_back(' ');
+            appendFloat(buffer, face->xScale(), 6);
+            buffer.push_back(' ');
+            appendFloat(buffer, face->yScale(), 6);
+        }
+        
         class StandardFileSerializer : public MapFileSerializer {
         private:
             bool m_longFormat;
-            String FaceFormat;
         public:
-            StandardFileSerializer(FILE* stream, const bool longFormat) :
-            MapFileSerializer(stream),
-            m_longFormat(longFormat) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s %.6g %.6g %.6g %.6g %.6g";
-                if (m_longFormat)
-                    str << " %d %d %.6g";
-                FaceFormat = str.str();
-            }
+            StandardFileSerializer(FILE* stream, const size_t firstLine, const MapFileSplicer* splicer, const bool longFormat) :
+            MapFileSerializer(stream, firstLine, splicer),
+            m_longFormat(longFormat) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Model::BrushFace::Points& points = face->points();
+            void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const {
+                appendPointsAndTextureName(buffer, face, FloatPrecision);
+                appendTextureAttributes(buffer, face);
                 
+                // " %d %d %.6g"
                 if (m_longFormat) {
-                    std::fprintf(stream, FaceFormat.c_str(),
-                                 points[0].x(),
-                                 points[0].y(),
-                                 points[0].z(),
-                                 points[1].x(),
-                                 points[1].y(),
-                                 points[1].z(),
-                                 points[2].x(),
-                                 points[2].y(),
-                                 points[2].z(),
-                                 textureName.c_str(),
-                                 face->xOffset(),
-                                 face->yOffset(),
-                                 face->rotation(),
-                                 face->xScale(),
-                                 face->yScale(),
-                                 face->surfaceContents(),
-                                 face->surfaceFlags(),
-                                 face->surfaceValue());
-                } else {
-                    std::fprintf(stream, FaceFormat.c_str(),
-                                 points[0].x(),
-                                 points[0].y(),
-                                 points[0].z(),
-                                 points[1].x(),
-                                 points[1].y(),
-                                 points[1].z(),
-                                 points[2].x(),
-                                 points[2].y(),
-                                 points[2].z(),
-                                 textureName.c_str(),
-                                 face->xOffset(),
-                                 face->yOffset(),
-                                 face->rotation(),
-                                 face->xScale(),
-                                 face->yScale());
+                    buffer.push_back(' ');
+                    StringUtils::appendInt(buffer, face->surfaceContents());
+                    buffer.push_back(' ');
+                    StringUtils::appendInt(buffer, face->surfaceFlags());
+                    buffer.push_back(' ');
+                    appendFloat(buffer, face->surfaceValue(), 6);
                 }
-                std::fprintf(stream, "\n");
-                return 1;
+                buffer.push_back('\n');
             }
         };
         
         class Hexen2FileSerializer : public MapFileSerializer {
-        private:
-            String FaceFormat;
         public:
-            Hexen2FileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s %.6g %.6g %.6g %.6g %.6g 0\n"; // the extra value is written here
-                
-                FaceFormat = str.str();
-            }
+            Hexen2FileSerializer(FILE* stream, const size_t firstLine, const MapFileSplicer* splicer) :
+            MapFileSerializer(stream, firstLine, splicer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Model::BrushFace::Points& points = face->points();
-                
-                std::fprintf(stream, FaceFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z(),
-                             textureName.c_str(),
-                             face->xOffset(),
-                             face->yOffset(),
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
-                return 1;
+            void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const {
+                appendPointsAndTextureName(buffer, face, FloatPrecision);
+                appendTextureAttributes(buffer, face);
+                buffer.append(" 0\n"); // the extra value is written here
             }
         };
         
         class ValveFileSerializer : public MapFileSerializer {
-        private:
-            String FaceFormat;
         public:
-            ValveFileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s " <<
-                "[ %.6g %.6g %.6g %.6g ] " <<
-                "[ %.6g %.6g %.6g %.6g ] " <<
-                "%.6g %.6g %.6g\n";
-                
-                FaceFormat = str.str();
-            }
+            ValveFileSerializer(FILE* stream, const size_t firstLine, const MapFileSplicer* splicer) :
+            MapFileSerializer(stream, firstLine, splicer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) {
-                const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Vec3 xAxis = face->textureXAxis();
-                const Vec3 yAxis = face->textureYAxis();
-                const Model::BrushFace::Points& points = face->points();
+            void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const {
+                appendPointsAndTextureName(buffer, face, FloatPrecision);
                 
-                std::fprintf(stream, FaceFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z(),
-                             
-                             textureName.c_str(),
-                             
-                             xAxis.x(),
-                             xAxis.y(),
-                             xAxis.z(),
-                             face->xOffset(),
-                             
-                             yAxis.x(),
-                             yAxis.y(),
-                             yAxis.z(),
-                             face->yOffset(),
-                             
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
-                return 1;
+                // " [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g\n"
+                appendTextureAxis(buffer, face->textureXAxis(), face->xOffset());
+                appendTextureAxis(buffer, face->textureYAxis(), face->yOffset());
+                buffer.push_back(' ');
+                appendFloat(buffer, face->rotation(), 6);
+                buffer.push_back(' ');
+                appendFloat(buffer, face->xScale(), 6);
+                buffer.push_back(' ');
+                appendFloat(buffer, face->yScale(), 6);
+                buffer.push_back('\n');
+            }
+            
+            void appendTextureAxis(String& buffer, const Vec3& axis, const float offset) const {
+                buffer.append(" [ ");
+                appendFloat(buffer, axis.x(), 6);
+                buffer.push_back(' ');
+                appendFloat(buffer, axis.y(), 6);
+                buffer.push_back(' ');
+                appendFloat(buffer, axis.z(), 6);
+                buffer.push_back(' ');
+                appendFloat(buffer, offset, 6);
+                buffer.append(" ]");
             }
         };
 
-        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat::Type format, FILE* stream) {
+        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat::Type format, FILE* stream, const size_t firstLine, const MapFileSplicer* splicer) {
             switch (format) {
                 case Model::MapFormat::Standard:
-                    return NodeSerializer::Ptr(new StandardFileSerializer(stream, false));
+                    return NodeSerializer::Ptr(new StandardFileSerializer(stream, firstLine, splicer, false));
                 case Model::MapFormat::Quake2:
-                    return NodeSerializer::Ptr(new StandardFileSerializer(stream, true));
+                    return NodeSerializer::Ptr(new StandardFileSerializer(stream, firstLine, splicer, true));
                 case Model::MapFormat::Valve:
-                    return NodeSerializer::Ptr(new ValveFileSerializer(stream));
+                    return NodeSerializer::Ptr(new ValveFileSerializer(stream, firstLine, splicer));
                 case Model::MapFormat::Hexen2:
-                    return NodeSerializer::Ptr(new Hexen2FileSerializer(stream));
+                    return NodeSerializer::Ptr(new Hexen2FileSerializer(stream, firstLine, splicer));
                 case Model::MapFormat::Unknown:
                 default:
                     throw new FileFormatException("Unknown map file format");
             }
         }
         
-        MapFileSerializer::MapFileSerializer(FILE* stream) :
-        m_line(1),
-        m_stream(stream) {}
+        class MapFileSerializer::WriteBrushesTask : public ParallelTask {
+        private:
+            const MapFileSerializer& m_serializer;
+            Model::BrushList::const_iterator m_begin;
+            Model::BrushList::const_iterator m_end;
+            size_t m_line;
+            String m_buffer;
+        public:
+            WriteBrushesTask(const MapFileSerializer& serializer, const Model::BrushList::const_iterator begin, const Model::BrushList::const_iterator end, const size_t line) :
+            m_serializer(serializer),
+            m_begin(begin),
+            m_end(end),
+            m_line(line) {}
+            
+            const String& buffer() const {
+                return m_buffer;
+            }
+        private:
+            void doRun() {
+                size_t line = m_line;
+                Model::BrushList::const_iterator it;
+                for (it = m_begin; it != m_end; ++it)
+                    line += m_serializer.writeBrush(m_buffer, line, *it);
+            }
+        };
+        
+        const size_t MapFileSerializer::FlushThreshold = 1024 * 1024;
+        const size_t MapFileSerializer::MinParallelBrushCount = 1024;
+        const size_t MapFileSerializer::BrushesPerTask = 256;
         
+        MapFileSerializer::MapFileSerializer(FILE* stream, const size_t firstLine, const MapFileSplicer* splicer) :
+        m_line(firstLine),
+        m_stream(stream),
+        m_splicer(splicer) {}
+        
+        MapFileSerializer::~MapFileSerializer() {
+            flush();
+        }
+
         void MapFileSerializer::doBeginEntity(const Model::Node* node) {
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            m_buffer.append("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndEntity(Model::Node* node) {
-            std::fprintf(m_stream, "}\n");
+            m_buffer.append("}\n");
             ++m_line;
             setFilePosition(node);
+            
+            if (m_buffer.size() >= FlushThreshold)
+                flush();
         }
         
         void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) { 
-            std::fprintf(m_stream, "\"%s\" \"%s\"\n", attribute.name().c_str(), attribute.value().c_str());
+            // "\"%s\" \"%s\"\n"
+            m_buffer.push_back('"');
+            m_buffer.append(attribute.name());
+            m_buffer.append("\" \"");
+            m_buffer.append(attribute.value());
+            m_buffer.append("\"\n");
             ++m_line;
         }
         
+        void MapFileSerializer::doBrushes(const Model::BrushList& brushes) {
+            if (brushes.size() >= MinParallelBrushCount && ParallelTaskRunner::defaultThreadCount() > 1) {
+                writeBrushesInParallel(brushes);
+            } else {
+                Model::BrushList::const_iterator it, end;
+                for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                    m_line += writeBrush(m_buffer, m_line, *it);
+            }
+        }
+        
         void MapFileSerializer::doBeginBrush(const Model::Brush* brush) {
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            m_buffer.append("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndBrush(Model::Brush* brush) {
-            std::fprintf(m_stream, "}\n");
+            m_buffer.append("}\n");
             ++m_line;
             setFilePosition(brush);
         }
         
         void MapFileSerializer::doBrushFace(Model::BrushFace* face) {
-            const size_t lines = doWriteBrushFace(m_stream, face);
-            face->setFilePosition(m_line, lines);
-            m_line += lines;
+            doWriteBrushFace(m_buffer, face);
+            face->setFilePosition(m_line, 1);
+            ++m_line;
+        }
+        
+        /*
+         Every face occupies exactly one line, so the first line of each brush is known in advance. This allows
+         formatting consecutive runs of brushes concurrently, each into its own buffer, and writing the buffers in
+         order. The brushes are processed in batches to limit the memory held by the buffers.
+         */
+        void MapFileSerializer::writeBrushesInParallel(const Model::BrushList& brushes) {
+            const ParallelTaskRunner runner;
+            const size_t brushesPerBatch = BrushesPerTask * runner.threadCount() * 4;
+            
+            flush();
+            
+            Model::BrushList::const_iterator batchBegin = brushes.begin();
+            while (batchBegin != brushes.end()) {
+                const size_t batchSize = std::min(brushesPerBatch, static_cast<size_t>(brushes.end() - batchBegin));
+                const Model::BrushList::const_iterator batchEnd = batchBegin + static_cast<std::ptrdiff_t>(batchSize);
+                
+                ParallelTask::List tasks;
+                Model::BrushList::const_iterator taskBegin = batchBegin;
+                while (taskBegin != batchEnd) {
+                    const size_t taskSize = std::min(BrushesPerTask, static_cast<size_t>(batchEnd - taskBegin));
+                    const Model::BrushList::const_iterator taskEnd = taskBegin + static_cast<std::ptrdiff_t>(taskSize);
+                    
+                    tasks.push_back(new WriteBrushesTask(*this, taskBegin, taskEnd, m_line));
+                    for (; taskBegin != taskEnd; ++taskBegin)
+                        m_line += (*taskBegin)->faces().size() + 2;
+                }
+                
+                runner.run(tasks);
+                
+                ParallelTask::List::const_iterator it, end;
+                for (it = tasks.begin(), end = tasks.end(); it != end; ++it)
+                    write(static_cast<const WriteBrushesTask*>(*it)->buffer());
+                VectorUtils::clearAndDelete(tasks);
+                
+                batchBegin = batchEnd;
+            }
+        }
+        
+        size_t MapFileSerializer::writeBrush(String& buffer, const size_t line, Model::Brush* brush) const {
+            const Model::BrushFaceList& faces = brush->faces();
+            Model::BrushFaceList::const_iterator it, end;
+            
+            // a spliced brush has the same layout as a formatted one
+            if (m_splicer == NULL || !m_splicer->splice(brush, buffer)) {
+                buffer.append("{\n");
+                for (it = faces.begin(), end = faces.end(); it != end; ++it)
+                    doWriteBrushFace(buffer, *it);
+                buffer.append("}\n");
+            }
+            
+            size_t faceLine = line + 1;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Model::BrushFace* face = *it;
+                face->setFilePosition(faceLine++, 1);
+            }
+            
+            const size_t lineCount = faceLine + 1 - line;
+            brush->setFilePosition(line, lineCount);
+            return lineCount;
         }
         
         void MapFileSerializer::setFilePosition(Model::Node* node) {
             const size_t start = startLine();
-            node->setFilePosition(start, m_line - start);
+            if (node != NULL)
+                node->setFilePosition(start, m_line - start);
         }
 
         size_t MapFileSerializer::startLine() {
@@ -270,5 +320,15 @@ namespace TrenchBroom {
             m_startLineStack.pop_back();
             return result;
         }
+        
+        void MapFileSerializer::write(const String& str) {
+            if (!str.empty())
+                std::fwrite(str.data(), 1, str.size(), m_stream);
+        }
+
+        void MapFileSerializer::flush() {
+            write(m_buffer);
+            m_buffer.clear();
+        }
     }
 }
@@ -29,30 +29,47 @@
 
 namespace TrenchBroom {
     namespace IO {
+        class MapFileSplicer;
         class Path;
         
         class MapFileSerializer : public NodeSerializer {
         private:
             typedef std::vector<size_t> LineStack;
+            class WriteBrushesTask;
+            
+            static const size_t FlushThreshold;
+            static const size_t MinParallelBrushCount;
+            static const size_t BrushesPerTask;
+            
             LineStack m_startLineStack;
             size_t m_line;
             FILE* m_stream;
+            String m_buffer;
+            const MapFileSplicer* m_splicer;
         public:
-            static Ptr create(Model::MapFormat::Type format, FILE* stream);
+            // The given line number is that of the first line written. Unmodified brushes are copied by the given splicer unless it is NULL.
+            static Ptr create(Model::MapFormat::Type format, FILE* stream, size_t firstLine = 1, const MapFileSplicer* splicer = NULL);
+            virtual ~MapFileSerializer();
         protected:
-            MapFileSerializer(FILE* file);
+            MapFileSerializer(FILE* file, size_t firstLine, const MapFileSplicer* splicer);
         private:
             void doBeginEntity(const Model::Node* node);
             void doEndEntity(Model::Node* node);
             void doEntityAttribute(const Model::EntityAttribute& attribute);
+            void doBrushes(const Model::BrushList& brushes);
             void doBeginBrush(const Model::Brush* brush);
             void doEndBrush(Model::Brush* brush);
             void doBrushFace(Model::BrushFace* face);
         private:
+            void writeBrushesInParallel(const Model::BrushList& brushes);
+            size_t writeBrush(String& buffer, size_t line, Model::Brush* brush) const;
             void setFilePosition(Model::Node* node);
             size_t startLine();
+            void write(const String& str);
+            void flush();
         private:
-            virtual size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) = 0;
+            // Appends the given face as a single line including the line break. Called concurrently for different faces.
+            virtual void doWriteBrushFace(String& buffer, const Model::BrushFace* face) const = 0;
         };
     }
 }
@@ -0,0 +1,180 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapFileSplicer.h"
+
+#include "Exceptions.h"
+#include "IO/DiskFileSystem.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/NodeVisitor.h"
+#include "Model/World.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapFileSplicer::RecordBrushes : public Model::ConstNodeVisitor {
+        private:
+            BrushLineMap& m_brushes;
+        public:
+            RecordBrushes(BrushLineMap& brushes) :
+            m_brushes(brushes) {}
+        private:
+            void doVisit(const Model::World* world)   {}
+            void doVisit(const Model::Layer* layer)   {}
+            void doVisit(const Model::Group* group)   {}
+            void doVisit(const Model::Entity* entity) {}
+            void doVisit(const Model::Brush* brush)   {
+                m_brushes.insert(m_brushes.end(), std::make_pair(brush, brush->lineNumber()));
+            }
+        };
+        
+        /*
+         Forgets the brushes among the given nodes and in the groups and entities among them. A changed world or layer
+         only forgets its brushes if it is removed, since its children are notified themselves when they change.
+         */
+        class MapFileSplicer::ForgetBrushes : public Model::ConstNodeVisitor {
+        private:
+            MapFileSplicer& m_splicer;
+            bool m_removed;
+        public:
+            ForgetBrushes(MapFileSplicer& splicer, const bool removed) :
+            m_splicer(splicer),
+            m_removed(removed) {}
+        private:
+            void doVisit(const Model::World* world)   { if (!m_removed) stopRecursion(); }
+            void doVisit(const Model::Layer* layer)   { if (!m_removed) stopRecursion(); }
+            void doVisit(const Model::Group* group)   {}
+            void doVisit(const Model::Entity* entity) {}
+            void doVisit(const Model::Brush* brush)   { m_splicer.forget(brush); }
+        };
+        
+        void MapFileSplicer::record(const Path& path, const Model::World* world) {
+            try {
+                const MappedFile::Ptr file = Disk::openFile(path);
+                record(file->begin(), file->end(), world);
+            } catch (const FileSystemException&) {
+                clear();
+            }
+        }
+        
+        void MapFileSplicer::record(const char* begin, const char* end, const Model::World* world) {
+            assert(world != NULL);
+            clear();
+            
+            // the text must be copied because the file is usually overwritten while the brushes are spliced
+            m_text.assign(begin, end);
+            m_lines.push_back(0);
+            for (size_t i = 0; i < m_text.size(); ++i) {
+                if (m_text[i] == '\n')
+                    m_lines.push_back(i + 1);
+            }
+            
+            RecordBrushes recordBrushes(m_brushes);
+            world->acceptAndRecurse(recordBrushes);
+        }
+        
+        void MapFileSplicer::clear() {
+            m_brushes.clear();
+            m_text.clear();
+            m_lines.clear();
+        }
+        
+        void MapFileSplicer::nodesDidChange(const Model::NodeList& nodes) {
+            if (m_brushes.empty())
+                return;
+            ForgetBrushes forgetBrushes(*this, false);
+            Model::Node::acceptAndRecurse(nodes.begin(), nodes.end(), forgetBrushes);
+        }
+        
+        void MapFileSplicer::nodesWillBeRemoved(const Model::NodeList& nodes) {
+            if (m_brushes.empty())
+                return;
+            ForgetBrushes forgetBrushes(*this, true);
+            Model::Node::acceptAndRecurse(nodes.begin(), nodes.end(), forgetBrushes);
+        }
+        
+        void MapFileSplicer::brushFacesDidChange(const Model::BrushFaceList& faces) {
+            Model::BrushFaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end && !m_brushes.empty(); ++it)
+                forget((*it)->brush());
+        }
+        
+        /*
+         The text of a brush is only copied if the recorded lines consist of an opening brace, one line per face,
+         and a closing brace. Brushes that were added, changed, or read from a file with a different layout are
+         formatted as usual.
+         */
+        bool MapFileSplicer::splice(const Model::Brush* brush, String& buffer) const {
+            const BrushLineMap::const_iterator it = m_brushes.find(brush);
+            if (it == m_brushes.end())
+                return false;
+            
+            const size_t lineNumber = it->second;
+            const size_t faceCount = brush->faces().size();
+            if (!checkLines(lineNumber, faceCount))
+                return false;
+            
+            buffer.append(lineBegin(lineNumber), lineEnd(lineNumber + faceCount + 1));
+            buffer.push_back('\n');
+            return true;
+        }
+        
+        void MapFileSplicer::forget(const Model::Brush* brush) {
+            m_brushes.erase(brush);
+        }
+        
+        static String trimmed(const String::const_iterator begin, const String::const_iterator end) {
+            return StringUtils::trim(String(begin, end), " \t\r");
+        }
+        
+        bool MapFileSplicer::checkLines(const size_t firstLine, const size_t faceCount) const {
+            const size_t lastLine = firstLine + faceCount + 1;
+            if (firstLine == 0 || lastLine > m_lines.size())
+                return false;
+            
+            if (trimmed(lineBegin(firstLine), lineEnd(firstLine)) != "{" ||
+                trimmed(lineBegin(lastLine), lineEnd(lastLine)) != "}")
+                return false;
+            
+            for (size_t line = firstLine + 1; line < lastLine; ++line) {
+                String::const_iterator c = lineBegin(line);
+                const String::const_iterator e = lineEnd(line);
+                while (c != e && (*c == ' ' || *c == '\t'))
+                    ++c;
+                if (c == e || *c != '(')
+                    return false;
+            }
+            return true;
+        }
+        
+        String::const_iterator MapFileSplicer::lineBegin(const size_t line) const {
+            assert(line > 0 && line <= m_lines.size());
+            return m_text.begin() + static_cast<String::difference_type>(m_lines[line - 1]);
+        }
+        
+        String::const_iterator MapFileSplicer::lineEnd(const size_t line) const {
+            assert(line > 0 && line <= m_lines.size());
+            if (line < m_lines.size())
+                return m_text.begin() + static_cast<String::difference_type>(m_lines[line] - 1);
+            return m_text.end();
+        }
+    }
+}
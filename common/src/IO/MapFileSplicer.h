@@ -0,0 +1,72 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapFileSplicer
+#define TrenchBroom_MapFileSplicer
+
+#include "StringUtils.h"
+#include "IO/Path.h"
+#include "Model/ModelTypes.h"
+
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /*
+         Keeps a copy of the map file that a world was last read from or written to, together with the line number of
+         every brush that has not been changed since. When the world is written again, the text of every such brush is
+         copied instead of being formatted again.
+         
+         The splicer does not compare brushes to the file. Instead, it must be told about every change through
+         nodesDidChange, nodesWillBeRemoved and brushFacesDidChange, which forget the affected brushes. Since a removed
+         brush is forgotten before it can be deleted, a brush that is recorded is always the one that was written.
+         */
+        class MapFileSplicer {
+        private:
+            class RecordBrushes;
+            class ForgetBrushes;
+            
+            typedef std::map<const Model::Brush*, size_t> BrushLineMap;
+            typedef std::vector<size_t> LineList;
+            
+            BrushLineMap m_brushes;
+            String m_text;
+            LineList m_lines;
+        public:
+            void record(const Path& path, const Model::World* world);
+            void record(const char* begin, const char* end, const Model::World* world);
+            void clear();
+            
+            void nodesDidChange(const Model::NodeList& nodes);
+            void nodesWillBeRemoved(const Model::NodeList& nodes);
+            void brushFacesDidChange(const Model::BrushFaceList& faces);
+            
+            // Appends the text of the given brush if it is unchanged. Can be called concurrently.
+            bool splice(const Model::Brush* brush, String& buffer) const;
+        private:
+            void forget(const Model::Brush* brush);
+            bool checkLines(size_t firstLine, size_t faceCount) const;
+            String::const_iterator lineBegin(size_t line) const;
+            String::const_iterator lineEnd(size_t line) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapFileSplicer) */
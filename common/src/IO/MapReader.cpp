@@ -21,14 +21,20 @@
 
 #include "CollectionUtils.h"
 #include "Logger.h"
+#include "ParallelTaskRunner.h"
+#include "IO/EntityRangeScanner.h"
+#include "IO/RecordingMapParser.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
+#include "Model/BrushGeometryBatch.h"
 #include "Model/Entity.h"
 #include "Model/EntityAttributes.h"
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/ModelFactory.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace IO {
         MapReader::ParentInfo MapReader::ParentInfo::layer(const Model::IdType layerId) {
@@ -55,31 +61,97 @@ namespace TrenchBroom {
             return m_id;
         }
 
+        class MapReader::ParseTask : public ParallelTask {
+        private:
+            RecordingMapParser m_parser;
+            bool m_closesEntity;
+            size_t m_entityStartLine;
+            size_t m_entityLineCount;
+        public:
+            ParseTask(const char* begin, const char* end, const size_t firstLine, const Model::MapFormat::Type format, const RecordingMapParser::Mode mode) :
+            m_parser(begin, end, firstLine, format, mode),
+            m_closesEntity(false),
+            m_entityStartLine(0),
+            m_entityLineCount(0) {}
+            
+            void setClosesEntity(const size_t startLine, const size_t lineCount) {
+                m_closesEntity = true;
+                m_entityStartLine = startLine;
+                m_entityLineCount = lineCount;
+            }
+            
+            const RecordingMapParser& parser() const {
+                return m_parser;
+            }
+            
+            bool closesEntity() const {
+                return m_closesEntity;
+            }
+            
+            size_t entityStartLine() const {
+                return m_entityStartLine;
+            }
+            
+            size_t entityLineCount() const {
+                return m_entityLineCount;
+            }
+        private:
+            void doRun() {
+                m_parser.parse();
+            }
+        };
+        
+        const size_t MapReader::MinParallelReadLength = 512 * 1024;
+        const size_t MapReader::MinParallelChunkLength = 64 * 1024;
+        
         MapReader::MapReader(const char* begin, const char* end, Logger* logger) :
         StandardMapParser(begin, end, logger),
+        m_begin(begin),
+        m_end(end),
+        m_threadCount(ParallelTaskRunner::defaultThreadCount()),
+        m_deferBrushGeometry(false),
         m_factory(NULL),
         m_brushParent(NULL),
         m_currentNode(NULL) {}
         
         MapReader::MapReader(const String& str, Logger* logger) :
         StandardMapParser(str, logger),
+        m_begin(str.c_str()),
+        m_end(str.c_str() + str.size()),
+        m_threadCount(ParallelTaskRunner::defaultThreadCount()),
+        m_deferBrushGeometry(false),
         m_factory(NULL),
         m_brushParent(NULL),
         m_currentNode(NULL) {}
         
         MapReader::~MapReader() {
             VectorUtils::clearAndDelete(m_faces);
+            
+            ParentBrushList::const_iterator it, end;
+            for (it = m_pendingBrushes.begin(), end = m_pendingBrushes.end(); it != end; ++it)
+                delete it->second;
+        }
+
+        void MapReader::setThreadCount(const size_t threadCount) {
+            m_threadCount = threadCount;
+        }
+
+        void MapReader::setDeferBrushGeometry(const bool deferBrushGeometry) {
+            m_deferBrushGeometry = deferBrushGeometry;
         }
 
         void MapReader::readEntities(Model::MapFormat::Type format, const BBox3& worldBounds) {
             m_worldBounds = worldBounds;
-            parseEntities(format);
+            if (!readEntitiesInParallel(format))
+                parseEntities(format);
+            buildDeferredBrushGeometry();
             resolveNodes();
         }
         
         void MapReader::readBrushes(Model::MapFormat::Type format, const BBox3& worldBounds) {
             m_worldBounds = worldBounds;
             parseBrushes(format);
+            buildDeferredBrushGeometry();
         }
         
         void MapReader::readBrushFaces(Model::MapFormat::Type format, const BBox3& worldBounds) {
@@ -87,6 +159,151 @@ namespace TrenchBroom {
             parseBrushFaces(format);
         }
 
+        /*
+         Splits the input into chunks of entities and brushes and parses them concurrently. The recorded parser
+         callbacks are then replayed in file order, so the resulting nodes, their file positions and the resolution
+         of their parents are the same as if the file had been parsed sequentially. Returns false if the input is too
+         small or cannot be split reliably, or if any chunk fails to parse. In that case, nothing has been created
+         yet and the caller must parse the input sequentially, which also reports any errors properly.
+         */
+        bool MapReader::readEntitiesInParallel(const Model::MapFormat::Type format) {
+            if (m_threadCount < 2 || static_cast<size_t>(m_end - m_begin) < MinParallelReadLength)
+                return false;
+            
+            ParseTaskList tasks;
+            createParseTasks(format, tasks);
+            if (tasks.size() < 2) {
+                VectorUtils::clearAndDelete(tasks);
+                return false;
+            }
+            
+            const ParallelTaskRunner runner(m_threadCount);
+            runner.run(ParallelTask::List(tasks.begin(), tasks.end()));
+            
+            ParseTaskList::iterator it, end;
+            for (it = tasks.begin(), end = tasks.end(); it != end; ++it) {
+                const ParseTask* task = *it;
+                if (!task->parser().success()) {
+                    VectorUtils::clearAndDelete(tasks);
+                    return false;
+                }
+            }
+            
+            it = tasks.begin();
+            try {
+                formatSet(format);
+                while (it != tasks.end()) {
+                    replay(**it);
+                    delete *it;
+                    ++it;
+                }
+                tasks.clear();
+            } catch (...) {
+                // the tasks up to the failing one have already been deleted
+                tasks.erase(tasks.begin(), it);
+                VectorUtils::clearAndDelete(tasks);
+                throw;
+            }
+            
+            return true;
+        }
+        
+        void MapReader::createParseTasks(const Model::MapFormat::Type format, ParseTaskList& tasks) const {
+            EntityRangeScanner::EntityList entities;
+            const EntityRangeScanner scanner(m_begin, m_end);
+            if (!scanner.scan(entities))
+                return;
+            
+            const size_t chunkLength = std::max(MinParallelChunkLength, static_cast<size_t>(m_end - m_begin) / (m_threadCount * 4));
+            
+            const char* batchBegin = NULL;
+            const char* batchEnd = NULL;
+            size_t batchLine = 0;
+            
+            EntityRangeScanner::EntityList::const_iterator eIt, eEnd;
+            for (eIt = entities.begin(), eEnd = entities.end(); eIt != eEnd; ++eIt) {
+                const EntityRangeScanner::Entity& entity = *eIt;
+                if (entity.range.length() <= chunkLength || entity.brushes.empty()) {
+                    if (batchBegin == NULL) {
+                        batchBegin = entity.range.begin;
+                        batchLine = entity.range.line;
+                    }
+                    batchEnd = entity.range.end;
+                    
+                    if (static_cast<size_t>(batchEnd - batchBegin) >= chunkLength) {
+                        tasks.push_back(new ParseTask(batchBegin, batchEnd, batchLine, format, RecordingMapParser::Mode_Entities));
+                        batchBegin = NULL;
+                    }
+                } else {
+                    // large entities such as worldspawn are split into their header and chunks of their brushes
+                    if (batchBegin != NULL) {
+                        tasks.push_back(new ParseTask(batchBegin, batchEnd, batchLine, format, RecordingMapParser::Mode_Entities));
+                        batchBegin = NULL;
+                    }
+                    
+                    const EntityRangeScanner::RangeList& brushes = entity.brushes;
+                    tasks.push_back(new ParseTask(entity.range.begin, brushes.front().begin, entity.range.line, format, RecordingMapParser::Mode_EntityHeader));
+                    
+                    EntityRangeScanner::RangeList::const_iterator bIt, bEnd, bFirst;
+                    bFirst = brushes.begin();
+                    for (bIt = brushes.begin(), bEnd = brushes.end(); bIt != bEnd; ++bIt) {
+                        const EntityRangeScanner::Range& brush = *bIt;
+                        const bool last = (bIt + 1 == bEnd);
+                        if (last || static_cast<size_t>(brush.end - bFirst->begin) >= chunkLength) {
+                            tasks.push_back(new ParseTask(bFirst->begin, brush.end, bFirst->line, format, RecordingMapParser::Mode_Brushes));
+                            bFirst = bIt + 1;
+                        }
+                    }
+                    
+                    tasks.back()->setClosesEntity(entity.range.line, entity.lastLine - entity.range.line);
+                }
+            }
+            
+            if (batchBegin != NULL)
+                tasks.push_back(new ParseTask(batchBegin, batchEnd, batchLine, format, RecordingMapParser::Mode_Entities));
+        }
+        
+        void MapReader::replay(const ParseTask& task) {
+            const RecordingMapParser& parser = task.parser();
+            const RecordingMapParser::EventList& events = parser.events();
+            
+            RecordingMapParser::EventList::const_iterator it, end;
+            for (it = events.begin(), end = events.end(); it != end; ++it) {
+                const RecordingMapParser::Event& event = *it;
+                switch (event.type) {
+                    case RecordingMapParser::Event_BeginEntity: {
+                        const RecordingMapParser::EntityInfo& entity = parser.entity(event);
+                        beginEntity(event.line, entity.attributes, entity.extraAttributes);
+                        break;
+                    }
+                    case RecordingMapParser::Event_EndEntity:
+                        endEntity(event.line, event.lineCount);
+                        break;
+                    case RecordingMapParser::Event_BeginBrush:
+                        beginBrush(event.line);
+                        break;
+                    case RecordingMapParser::Event_EndBrush:
+                        endBrush(event.line, event.lineCount, parser.brushExtraAttributes(event));
+                        break;
+                    case RecordingMapParser::Event_BrushFace: {
+                        const RecordingMapParser::FaceInfo& face = parser.face(event);
+                        brushFace(event.line, face.point1, face.point2, face.point3, face.attribs, face.texAxisX, face.texAxisY);
+                        break;
+                    }
+                    case RecordingMapParser::Event_Log: {
+                        const RecordingMapParser::LogInfo& info = parser.message(event);
+                        if (logger() != NULL)
+                            logger()->log(info.level, info.message);
+                        break;
+                    }
+                    switchDefault();
+                }
+            }
+            
+            if (task.closesEntity())
+                endEntity(task.entityStartLine(), task.entityLineCount());
+        }
+
         void MapReader::onFormatSet(const Model::MapFormat::Type format) {
             m_factory = initialize(format, m_worldBounds);
             assert(m_factory != NULL);
@@ -227,11 +444,15 @@ namespace TrenchBroom {
                 // sort the faces by the weight of their plane normals like QBSP does
                 Model::BrushFace::sortFaces(m_faces);
                 
-                Model::Brush* brush = m_factory->createBrush(m_worldBounds, m_faces);
+                Model::Brush* brush = m_factory->createBrush(m_worldBounds, m_faces, m_deferBrushGeometry);
                 setFilePosition(brush, startLine, lineCount);
                 setExtraAttributes(brush, extraAttributes);
                 
-                onBrush(m_brushParent, brush);
+                // all brushes are held back so that they are passed on in file order
+                if (m_deferBrushGeometry)
+                    m_pendingBrushes.push_back(std::make_pair(m_brushParent, brush));
+                else
+                    onBrush(m_brushParent, brush);
                 m_faces.clear();
             } catch (GeometryException& e) {
                 if (logger() != NULL)
@@ -241,6 +462,49 @@ namespace TrenchBroom {
 
         }
 
+        /*
+         Builds the deferred geometry of the pending brushes concurrently. The brushes are only passed on afterwards,
+         in file order, so that their parents and the world's spatial index see their exact bounds.
+         */
+        void MapReader::buildDeferredBrushGeometry() {
+            if (m_pendingBrushes.empty())
+                return;
+            
+            Model::BrushList brushes;
+            brushes.reserve(m_pendingBrushes.size());
+            
+            ParentBrushList::const_iterator it, end;
+            for (it = m_pendingBrushes.begin(), end = m_pendingBrushes.end(); it != end; ++it) {
+                Model::Brush* brush = it->second;
+                if (brush->geometryDeferred())
+                    brushes.push_back(brush);
+            }
+            
+            Model::BrushList invalidBrushes;
+            StringList errors;
+            const ParallelTaskRunner runner(m_threadCount);
+            const Model::BrushGeometryBatch batch(m_worldBounds, runner);
+            batch.buildDeferredGeometry(brushes, invalidBrushes, errors);
+            
+            ParentBrushList pendingBrushes;
+            std::swap(pendingBrushes, m_pendingBrushes);
+            
+            // the invalid brushes are in the same order as the pending brushes
+            size_t invalidIndex = 0;
+            for (it = pendingBrushes.begin(), end = pendingBrushes.end(); it != end; ++it) {
+                Model::Node* parent = it->first;
+                Model::Brush* brush = it->second;
+                if (invalidIndex < invalidBrushes.size() && invalidBrushes[invalidIndex] == brush) {
+                    if (logger() != NULL)
+                        logger()->error("Error parsing brush at line %u: %s", static_cast<unsigned int>(brush->lineNumber()), errors[invalidIndex].c_str());
+                    delete brush;
+                    ++invalidIndex;
+                } else {
+                    onBrush(parent, brush);
+                }
+            }
+        }
+
         MapReader::ParentInfo::Type MapReader::storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes) {
             const String& layerIdStr = findAttribute(attributes, Model::AttributeNames::Layer);
             if (!StringUtils::isBlank(layerIdStr)) {
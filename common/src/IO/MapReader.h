@@ -31,6 +31,8 @@ namespace TrenchBroom {
     }
     
     namespace IO {
+        class RecordingMapParser;
+        
         class MapReader : public StandardMapParser {
         protected:
             class ParentInfo {
@@ -67,6 +69,20 @@ namespace TrenchBroom {
             typedef std::pair<Model::Node*, ParentInfo> NodeParentPair;
             typedef std::vector<NodeParentPair> NodeParentList;
             
+            typedef std::pair<Model::Node*, Model::Brush*> ParentBrushPair;
+            typedef std::vector<ParentBrushPair> ParentBrushList;
+            
+            class ParseTask;
+            typedef std::vector<ParseTask*> ParseTaskList;
+            
+            static const size_t MinParallelReadLength;
+            static const size_t MinParallelChunkLength;
+            
+            const char* m_begin;
+            const char* m_end;
+            size_t m_threadCount;
+            bool m_deferBrushGeometry;
+            
             BBox3 m_worldBounds;
             Model::ModelFactory* m_factory;
             
@@ -77,6 +93,7 @@ namespace TrenchBroom {
             LayerMap m_layers;
             GroupMap m_groups;
             NodeParentList m_unresolvedNodes;
+            ParentBrushList m_pendingBrushes;
         protected:
             MapReader(const char* begin, const char* end, Logger* logger = NULL);
             MapReader(const String& str, Logger* logger = NULL);
@@ -86,6 +103,14 @@ namespace TrenchBroom {
             void readBrushFaces(Model::MapFormat::Type format, const BBox3& worldBounds);
         public:
             virtual ~MapReader();
+            
+            void setThreadCount(size_t threadCount);
+            // Brushes build their geometry concurrently after all of them have been read, see Model::BrushGeometryBatch.
+            void setDeferBrushGeometry(bool deferBrushGeometry);
+        private:
+            bool readEntitiesInParallel(Model::MapFormat::Type format);
+            void createParseTasks(Model::MapFormat::Type format, ParseTaskList& tasks) const;
+            void replay(const ParseTask& task);
         private: // implement MapParser interface
             void onFormatSet(Model::MapFormat::Type format);
             void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes);
@@ -98,6 +123,7 @@ namespace TrenchBroom {
             void createGroup(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes);
             void createEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes);
             void createBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes);
+            void buildDeferredBrushGeometry();
 
             ParentInfo::Type storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes);
             void stripParentAttributes(Model::AttributableNode* attributable, ParentInfo::Type parentType);
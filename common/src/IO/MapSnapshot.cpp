@@ -0,0 +1,100 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapSnapshot.h"
+
+#include "CollectionUtils.h"
+#include "IO/NodeWriter.h"
+#include "Model/BrushFace.h"
+#include "Model/World.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapSnapshot::RecordNodes : public NodeSerializer {
+        private:
+            EntityList& m_entities;
+        public:
+            RecordNodes(EntityList& entities) :
+            m_entities(entities) {}
+        private:
+            void doBeginEntity(const Model::Node* node) {
+                m_entities.push_back(Entity());
+            }
+            
+            void doEndEntity(Model::Node* node) {}
+            
+            void doEntityAttribute(const Model::EntityAttribute& attribute) {
+                assert(!m_entities.empty());
+                m_entities.back().attributes.push_back(attribute);
+            }
+            
+            void doBeginBrush(const Model::Brush* brush) {
+                assert(!m_entities.empty());
+                m_entities.back().brushes.push_back(Model::BrushFaceList());
+            }
+            
+            void doEndBrush(Model::Brush* brush) {}
+            
+            void doBrushFace(Model::BrushFace* face) {
+                assert(!m_entities.empty() && !m_entities.back().brushes.empty());
+                m_entities.back().brushes.back().push_back(face->cloneWithoutTexture());
+            }
+        };
+
+        MapSnapshot::MapSnapshot(Model::World* world) :
+        m_format(world->format()) {
+            NodeWriter writer(world, NodeSerializer::Ptr(new RecordNodes(m_entities)));
+            writer.writeMap();
+        }
+        
+        MapSnapshot::~MapSnapshot() {
+            EntityList::iterator entityIt, entityEnd;
+            for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
+                NodeSerializer::BrushFaceLists& brushes = entityIt->brushes;
+                NodeSerializer::BrushFaceLists::iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt)
+                    VectorUtils::clearAndDelete(*brushIt);
+            }
+        }
+
+        Model::MapFormat::Type MapSnapshot::format() const {
+            return m_format;
+        }
+
+        size_t MapSnapshot::entityCount() const {
+            return m_entities.size();
+        }
+        
+        size_t MapSnapshot::brushCount() const {
+            size_t result = 0;
+            EntityList::const_iterator it, end;
+            for (it = m_entities.begin(), end = m_entities.end(); it != end; ++it)
+                result += it->brushes.size();
+            return result;
+        }
+
+        void MapSnapshot::write(NodeSerializer& serializer) const {
+            EntityList::const_iterator it, end;
+            for (it = m_entities.begin(), end = m_entities.end(); it != end; ++it)
+                serializer.entity(it->attributes, it->brushes);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapSnapshot
+#define TrenchBroom_MapSnapshot
+
+#include "IO/NodeSerializer.h"
+#include "Model/EntityAttributes.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /*
+         A copy of the serializable contents of a world. The copy does not share any mutable state with the world, so it
+         can be serialized on a worker thread while the world is being edited.
+         */
+        class MapSnapshot {
+        private:
+            class RecordNodes;
+            
+            struct Entity {
+                Model::EntityAttribute::List attributes;
+                NodeSerializer::BrushFaceLists brushes;
+            };
+            
+            typedef std::vector<Entity> EntityList;
+            
+            Model::MapFormat::Type m_format;
+            EntityList m_entities;
+        public:
+            // Must be called on the thread that owns the given world.
+            MapSnapshot(Model::World* world);
+            ~MapSnapshot();
+            
+            Model::MapFormat::Type format() const;
+            size_t entityCount() const;
+            size_t brushCount() const;
+            
+            void write(NodeSerializer& serializer) const;
+        private:
+            MapSnapshot(const MapSnapshot& other);
+            MapSnapshot& operator=(const MapSnapshot& other);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapSnapshot) */
@@ -27,17 +27,17 @@
 
 namespace TrenchBroom {
     namespace IO {
-        class NodeSerializer::BrushSerializer : public Model::NodeVisitor {
+        class NodeSerializer::CollectBrushes : public Model::NodeVisitor {
         private:
-            NodeSerializer& m_serializer;
+            Model::BrushList& m_brushes;
         public:
-            BrushSerializer(NodeSerializer& serializer) : m_serializer(serializer) {}
+            CollectBrushes(Model::BrushList& brushes) : m_brushes(brushes) {}
             
             void doVisit(Model::World* world)   {}
             void doVisit(Model::Layer* layer)   {}
             void doVisit(Model::Group* group)   {}
             void doVisit(Model::Entity* entity) {}
-            void doVisit(Model::Brush* brush)   { m_serializer.brush(brush); }
+            void doVisit(Model::Brush* brush)   { m_brushes.push_back(brush); }
         };
 
         NodeSerializer::~NodeSerializer() {}
@@ -57,8 +57,10 @@ namespace TrenchBroom {
         void NodeSerializer::entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, Model::Node* brushParent) {
             beginEntity(node, attributes, parentAttributes);
             
-            BrushSerializer brushSerializer(*this);
-            brushParent->iterate(brushSerializer);
+            Model::BrushList brushParentBrushes;
+            CollectBrushes collectBrushes(brushParentBrushes);
+            brushParent->iterate(collectBrushes);
+            brushes(brushParentBrushes);
             
             endEntity(node);
         }
@@ -69,6 +71,19 @@ namespace TrenchBroom {
             endEntity(node);
         }
 
+        void NodeSerializer::entity(const Model::EntityAttribute::List& attributes, const BrushFaceLists& brushes) {
+            beginEntity(NULL, attributes, Model::EntityAttribute::EmptyList);
+            
+            BrushFaceLists::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                beginBrush(NULL);
+                brushFaces(*it);
+                endBrush(NULL);
+            }
+            
+            endEntity(NULL);
+        }
+
         void NodeSerializer::beginEntity(const Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& extraAttributes) {
             beginEntity(node);
             entityAttributes(attributes);
@@ -94,9 +109,7 @@ namespace TrenchBroom {
         }
         
         void NodeSerializer::brushes(const Model::BrushList& brushes) {
-            Model::BrushList::const_iterator it, end;
-            for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
-                brush(*it);
+            doBrushes(brushes);
         }
         
         void NodeSerializer::brush(Model::Brush* brush) {
@@ -123,6 +136,12 @@ namespace TrenchBroom {
             doBrushFace(face);
         }
         
+        void NodeSerializer::doBrushes(const Model::BrushList& brushes) {
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                brush(*it);
+        }
+        
         class NodeSerializer::GetParentAttributes : public Model::ConstNodeVisitor {
         private:
             const LayerIds& m_layerIds;
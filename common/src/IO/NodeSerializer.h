@@ -25,6 +25,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
@@ -32,16 +33,21 @@ namespace TrenchBroom {
         
         class NodeSerializer {
         private:
-            class BrushSerializer;
+            class CollectBrushes;
         protected:
             static const int FloatPrecision = 17;
         private:
+            // The ids only have to be unique within one serialized map, so every serializer counts on its own.
             template <typename T>
             class IdManager {
             private:
                 typedef std::map<T, String> IdMap;
                 mutable IdMap m_ids;
+                mutable Model::IdType m_currentId;
             public:
+                IdManager() :
+                m_currentId(1) {}
+                
                 const String& getId(const T& t) const {
                     typename IdMap::iterator it = m_ids.find(t);
                     if (it == m_ids.end())
@@ -50,8 +56,7 @@ namespace TrenchBroom {
                 }
             private:
                 Model::IdType makeId() const {
-                    static Model::IdType currentId = 1;
-                    return currentId++;
+                    return m_currentId++;
                 }
                 
                 String idToString(const Model::IdType nodeId) const {
@@ -68,6 +73,7 @@ namespace TrenchBroom {
             GroupIds m_groupIds;
         public:
             typedef std::auto_ptr<NodeSerializer> Ptr;
+            typedef std::vector<Model::BrushFaceList> BrushFaceLists;
             
             virtual ~NodeSerializer();
 
@@ -77,6 +83,8 @@ namespace TrenchBroom {
             
             void entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, Model::Node* brushParent);
             void entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, const Model::BrushList& entityBrushes);
+            // Serializes an entity that is not backed by any nodes. Each face list is serialized as one brush.
+            void entity(const Model::EntityAttribute::List& attributes, const BrushFaceLists& brushes);
         private:
             void beginEntity(const Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& extraAttributes);
             void beginEntity(const Model::Node* node);
@@ -102,10 +110,13 @@ namespace TrenchBroom {
             Model::EntityAttribute::List layerAttributes(const Model::Layer* layer);
             Model::EntityAttribute::List groupAttributes(const Model::Group* group);
         private:
+            // The node passed to the following functions is NULL if the serialized data is not backed by a node.
             virtual void doBeginEntity(const Model::Node* node) = 0;
             virtual void doEndEntity(Model::Node* node) = 0;
             virtual void doEntityAttribute(const Model::EntityAttribute& attribute) = 0;
             
+            // Serializes the given brushes in order. Subclasses may override this to serialize whole lists at once.
+            virtual void doBrushes(const Model::BrushList& brushes);
             virtual void doBeginBrush(const Model::Brush* brush) = 0;
             virtual void doEndBrush(Model::Brush* brush) = 0;
             virtual void doBrushFace(Model::BrushFace* face) = 0;
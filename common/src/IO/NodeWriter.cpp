@@ -102,10 +102,18 @@ namespace TrenchBroom {
         m_world(world),
         m_serializer(MapFileSerializer::create(m_world->format(), stream)) {}
         
+        NodeWriter::NodeWriter(Model::World* world, FILE* stream, const size_t firstLine, const MapFileSplicer* splicer) :
+        m_world(world),
+        m_serializer(MapFileSerializer::create(m_world->format(), stream, firstLine, splicer)) {}
+        
         NodeWriter::NodeWriter(Model::World* world, std::ostream& stream) :
         m_world(world),
         m_serializer(MapStreamSerializer::create(m_world->format(), stream)) {}
 
+        NodeWriter::NodeWriter(Model::World* world, NodeSerializer::Ptr serializer) :
+        m_world(world),
+        m_serializer(serializer) {}
+
         void NodeWriter::writeMap() {
             writeDefaultLayer();
             writeCustomLayers();
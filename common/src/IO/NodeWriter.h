@@ -28,6 +28,7 @@
 
 namespace TrenchBroom {
     namespace IO {
+        class MapFileSplicer;
         class Path;
         class NodeSerializer;
         
@@ -41,7 +42,9 @@ namespace TrenchBroom {
             NodeSerializer::Ptr m_serializer;
         public:
             NodeWriter(Model::World* world, FILE* stream);
+            NodeWriter(Model::World* world, FILE* stream, size_t firstLine, const MapFileSplicer* splicer);
             NodeWriter(Model::World* world, std::ostream& stream);
+            NodeWriter(Model::World* world, NodeSerializer::Ptr serializer);
             
             void writeMap();
         private:
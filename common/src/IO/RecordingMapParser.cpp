@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecordingMapParser.h"
+
+#include "Exceptions.h"
+#include "Macros.h"
+
+#include <wx/string.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        RecordingMapParser::Event::Event(const EventType i_type, const size_t i_line, const size_t i_lineCount, const size_t i_index) :
+        type(i_type),
+        line(i_line),
+        lineCount(i_lineCount),
+        index(i_index) {}
+
+        RecordingMapParser::EntityInfo::EntityInfo(const Model::EntityAttribute::List& i_attributes, const ExtraAttributes& i_extraAttributes) :
+        attributes(i_attributes),
+        extraAttributes(i_extraAttributes) {}
+        
+        RecordingMapParser::FaceInfo::FaceInfo(const Vec3& i_point1, const Vec3& i_point2, const Vec3& i_point3, const Model::BrushFaceAttributes& i_attribs, const Vec3& i_texAxisX, const Vec3& i_texAxisY) :
+        point1(i_point1),
+        point2(i_point2),
+        point3(i_point3),
+        attribs(i_attribs),
+        texAxisX(i_texAxisX),
+        texAxisY(i_texAxisY) {}
+
+        RecordingMapParser::LogInfo::LogInfo(const LogLevel i_level, const String& i_message) :
+        level(i_level),
+        message(i_message) {}
+
+        RecordingMapParser::RecordingMapParser(const char* begin, const char* end, const size_t firstLine, const Model::MapFormat::Type format, const Mode mode) :
+        StandardMapParser(begin, end, firstLine, this),
+        m_format(format),
+        m_mode(mode),
+        m_success(false) {}
+        
+        void RecordingMapParser::parse() {
+            try {
+                switch (m_mode) {
+                    case Mode_Entities:
+                        parseEntities(m_format);
+                        break;
+                    case Mode_EntityHeader:
+                        parseEntityHeader(m_format);
+                        break;
+                    case Mode_Brushes:
+                        parseBrushes(m_format);
+                        break;
+                    switchDefault();
+                }
+                m_success = true;
+            } catch (const Exception& e) {
+                m_errorMessage = e.what();
+                m_success = false;
+            }
+        }
+
+        bool RecordingMapParser::success() const {
+            return m_success;
+        }
+        
+        const String& RecordingMapParser::errorMessage() const {
+            return m_errorMessage;
+        }
+
+        const RecordingMapParser::EventList& RecordingMapParser::events() const {
+            return m_events;
+        }
+        
+        const RecordingMapParser::EntityInfo& RecordingMapParser::entity(const Event& event) const {
+            assert(event.type == Event_BeginEntity);
+            return m_entities[event.index];
+        }
+        
+        const MapParser::ExtraAttributes& RecordingMapParser::brushExtraAttributes(const Event& event) const {
+            assert(event.type == Event_EndBrush);
+            return m_brushes[event.index];
+        }
+        
+        const RecordingMapParser::FaceInfo& RecordingMapParser::face(const Event& event) const {
+            assert(event.type == Event_BrushFace);
+            return m_faces[event.index];
+        }
+        
+        const RecordingMapParser::LogInfo& RecordingMapParser::message(const Event& event) const {
+            assert(event.type == Event_Log);
+            return m_messages[event.index];
+        }
+
+        void RecordingMapParser::onFormatSet(const Model::MapFormat::Type format) {}
+        
+        void RecordingMapParser::onBeginEntity(const size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes) {
+            m_events.push_back(Event(Event_BeginEntity, line, 0, m_entities.size()));
+            m_entities.push_back(EntityInfo(attributes, extraAttributes));
+        }
+        
+        void RecordingMapParser::onEndEntity(const size_t startLine, const size_t lineCount) {
+            m_events.push_back(Event(Event_EndEntity, startLine, lineCount, 0));
+        }
+        
+        void RecordingMapParser::onBeginBrush(const size_t line) {
+            m_events.push_back(Event(Event_BeginBrush, line, 0, 0));
+        }
+        
+        void RecordingMapParser::onEndBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes) {
+            m_events.push_back(Event(Event_EndBrush, startLine, lineCount, m_brushes.size()));
+            m_brushes.push_back(extraAttributes);
+        }
+        
+        void RecordingMapParser::onBrushFace(const size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY) {
+            m_events.push_back(Event(Event_BrushFace, line, 0, m_faces.size()));
+            m_faces.push_back(FaceInfo(point1, point2, point3, attribs, texAxisX, texAxisY));
+        }
+
+        void RecordingMapParser::doLog(const LogLevel level, const String& message) {
+            m_events.push_back(Event(Event_Log, 0, 0, m_messages.size()));
+            m_messages.push_back(LogInfo(level, message));
+        }
+        
+        void RecordingMapParser::doLog(const LogLevel level, const wxString& message) {
+            doLog(level, message.ToStdString());
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RecordingMapParser
+#define TrenchBroom_RecordingMapParser
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Logger.h"
+#include "IO/StandardMapParser.h"
+#include "Model/BrushFaceAttributes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         Parses a range of entities and records the parser callbacks so that they can be replayed later. This allows
+         several ranges of a map file to be parsed concurrently while the resulting nodes are still created in file
+         order. Messages logged by the parser are recorded in order with the callbacks.
+         */
+        class RecordingMapParser : private Logger, public StandardMapParser {
+        public:
+            typedef enum {
+                Mode_Entities,
+                Mode_EntityHeader,
+                Mode_Brushes
+            } Mode;
+            
+            typedef enum {
+                Event_BeginEntity,
+                Event_EndEntity,
+                Event_BeginBrush,
+                Event_EndBrush,
+                Event_BrushFace,
+                Event_Log
+            } EventType;
+            
+            struct Event {
+                EventType type;
+                size_t line;
+                size_t lineCount;
+                size_t index;
+                
+                Event(EventType i_type, size_t i_line, size_t i_lineCount, size_t i_index);
+            };
+            
+            struct EntityInfo {
+                Model::EntityAttribute::List attributes;
+                ExtraAttributes extraAttributes;
+                
+                EntityInfo(const Model::EntityAttribute::List& i_attributes, const ExtraAttributes& i_extraAttributes);
+            };
+            
+            struct FaceInfo {
+                Vec3 point1;
+                Vec3 point2;
+                Vec3 point3;
+                Model::BrushFaceAttributes attribs;
+                Vec3 texAxisX;
+                Vec3 texAxisY;
+                
+                FaceInfo(const Vec3& i_point1, const Vec3& i_point2, const Vec3& i_point3, const Model::BrushFaceAttributes& i_attribs, const Vec3& i_texAxisX, const Vec3& i_texAxisY);
+            };
+            
+            struct LogInfo {
+                LogLevel level;
+                String message;
+                
+                LogInfo(LogLevel i_level, const String& i_message);
+            };
+            
+            typedef std::vector<Event> EventList;
+            typedef std::vector<EntityInfo> EntityInfoList;
+            typedef std::vector<ExtraAttributes> ExtraAttributesList;
+            typedef std::vector<FaceInfo> FaceInfoList;
+            typedef std::vector<LogInfo> LogInfoList;
+        private:
+            Model::MapFormat::Type m_format;
+            Mode m_mode;
+            
+            EventList m_events;
+            EntityInfoList m_entities;
+            ExtraAttributesList m_brushes;
+            FaceInfoList m_faces;
+            LogInfoList m_messages;
+            
+            bool m_success;
+            String m_errorMessage;
+        public:
+            RecordingMapParser(const char* begin, const char* end, size_t firstLine, Model::MapFormat::Type format, Mode mode);
+            
+            void parse();
+            
+            bool success() const;
+            const String& errorMessage() const;
+            
+            const EventList& events() const;
+            const EntityInfo& entity(const Event& event) const;
+            const ExtraAttributes& brushExtraAttributes(const Event& event) const;
+            const FaceInfo& face(const Event& event) const;
+            const LogInfo& message(const Event& event) const;
+        private: // implement MapParser interface
+            void onFormatSet(Model::MapFormat::Type format);
+            void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes);
+            void onEndEntity(size_t startLine, size_t lineCount);
+            void onBeginBrush(size_t line);
+            void onEndBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes);
+            void onBrushFace(size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY);
+        private: // implement Logger interface
+            void doLog(LogLevel level, const String& message);
+            void doLog(LogLevel level, const wxString& message);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_RecordingMapParser) */
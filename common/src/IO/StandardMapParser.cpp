@@ -27,8 +27,8 @@ namespace TrenchBroom {
     namespace IO {
         const String QuakeMapTokenizer::NumberDelim = Whitespace + ")";
 
-        QuakeMapTokenizer::QuakeMapTokenizer(const char* begin, const char* end) :
-        Tokenizer(begin, end),
+        QuakeMapTokenizer::QuakeMapTokenizer(const char* begin, const char* end, const size_t firstLine) :
+        Tokenizer(begin, end, firstLine),
         m_skipEol(true) {}
         
         QuakeMapTokenizer::QuakeMapTokenizer(const String& str) :
@@ -41,9 +41,8 @@ namespace TrenchBroom {
         
         QuakeMapTokenizer::Token QuakeMapTokenizer::emitToken() {
             while (!eof()) {
-                size_t startLine = line();
-                size_t startColumn = column();
-                const char* c = curPos();
+                const char* start = curPos();
+                const char* c = start;
                 switch (*c) {
                     case '/':
                         advance();
@@ -51,39 +50,39 @@ namespace TrenchBroom {
                             advance();
                             if (curChar() == '/') {
                                 advance();
-                                return Token(QuakeMapToken::Comment, c, c+3, offset(c), startLine, startColumn);
+                                return token(QuakeMapToken::Comment, c, c+3, start);
                             }
                             discardUntil("\n\r");
                         }
                         break;
                     case '{':
                         advance();
-                        return Token(QuakeMapToken::OBrace, c, c+1, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::OBrace, c, c+1, start);
                     case '}':
                         advance();
-                        return Token(QuakeMapToken::CBrace, c, c+1, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::CBrace, c, c+1, start);
                     case '(':
                         advance();
-                        return Token(QuakeMapToken::OParenthesis, c, c+1, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::OParenthesis, c, c+1, start);
                     case ')':
                         advance();
-                        return Token(QuakeMapToken::CParenthesis, c, c+1, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::CParenthesis, c, c+1, start);
                     case '[':
                         advance();
-                        return Token(QuakeMapToken::OBracket, c, c+1, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::OBracket, c, c+1, start);
                     case ']':
                         advance();
-                        return Token(QuakeMapToken::CBracket, c, c+1, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::CBracket, c, c+1, start);
                     case '"': { // quoted string
                         advance();
                         c = curPos();
                         const char* e = readQuotedString();
-                        return Token(QuakeMapToken::String, c, e, offset(c), startLine, startColumn);
+                        return token(QuakeMapToken::String, c, e, start);
                     }
                     case '\n':
                         if (!m_skipEol) {
                             advance();
-                            return Token(QuakeMapToken::Eol, c, c+1, offset(c), startLine, startColumn);
+                            return token(QuakeMapToken::Eol, c, c+1, start);
                         }
                     case '\r':
                     case ' ':
@@ -91,18 +90,15 @@ namespace TrenchBroom {
                         discardWhile(Whitespace);
                         break;
                     default: { // whitespace, integer, decimal or word
-                        const char* e = readInteger(NumberDelim);
+                        bool decimal = false;
+                        const char* e = readNumber(NumberDelim, decimal);
                         if (e != NULL)
-                            return Token(QuakeMapToken::Integer, c, e, offset(c), startLine, startColumn);
-                        
-                        e = readDecimal(NumberDelim);
-                        if (e != NULL)
-                            return Token(QuakeMapToken::Decimal, c, e, offset(c), startLine, startColumn);
+                            return token(decimal ? QuakeMapToken::Decimal : QuakeMapToken::Integer, c, e, start);
                         
                         e = readString(Whitespace);
                         if (e == NULL)
-                            throw ParserException(startLine, startColumn, "Unexpected character: " + String(c, 1));
-                        return Token(QuakeMapToken::String, c, e, offset(c), startLine, startColumn);
+                            throw ParserException(line(start), column(start), "Unexpected character: " + String(c, 1));
+                        return token(QuakeMapToken::String, c, e, start);
                     }
                 }
             }
@@ -119,6 +115,11 @@ namespace TrenchBroom {
         m_logger(logger),
         m_format(Model::MapFormat::Unknown) {}
         
+        StandardMapParser::StandardMapParser(const char* begin, const char* end, const size_t firstLine, Logger* logger) :
+        m_tokenizer(QuakeMapTokenizer(begin, end, firstLine)),
+        m_logger(logger),
+        m_format(Model::MapFormat::Unknown) {}
+        
         StandardMapParser::~StandardMapParser() {}
 
         Logger* StandardMapParser::logger() const {
@@ -185,6 +186,37 @@ namespace TrenchBroom {
             }
         }
         
+        void StandardMapParser::parseEntityHeader(const Model::MapFormat::Type format) {
+            setFormat(format);
+            
+            // parses the opening brace and the attributes of an entity whose brushes and closing brace are parsed separately
+            Token token = m_tokenizer.nextToken();
+            expect(QuakeMapToken::OBrace, token);
+            
+            Model::EntityAttribute::List attributes;
+            ExtraAttributes extraAttributes;
+            const size_t startLine = token.line();
+            
+            token = m_tokenizer.nextToken();
+            while (token.type() != QuakeMapToken::Eof) {
+                switch (token.type()) {
+                    case QuakeMapToken::Comment:
+                        parseExtraAttributes(extraAttributes);
+                        break;
+                    case QuakeMapToken::String:
+                        m_tokenizer.pushToken(token);
+                        parseEntityAttribute(attributes);
+                        break;
+                    default:
+                        expect(QuakeMapToken::Comment | QuakeMapToken::String | QuakeMapToken::Eof, token);
+                }
+                
+                token = m_tokenizer.nextToken();
+            }
+            
+            beginEntity(startLine, attributes, extraAttributes);
+        }
+        
         void StandardMapParser::parseBrushes(const Model::MapFormat::Type format) {
             setFormat(format);
 
@@ -53,7 +53,7 @@ namespace TrenchBroom {
             static const String NumberDelim;
             bool m_skipEol;
         public:
-            QuakeMapTokenizer(const char* begin, const char* end);
+            QuakeMapTokenizer(const char* begin, const char* end, size_t firstLine = 1);
             QuakeMapTokenizer(const String& str);
             
             void setSkipEol(bool skipEol);
@@ -74,12 +74,15 @@ namespace TrenchBroom {
             
             virtual ~StandardMapParser();
         protected:
+            StandardMapParser(const char* begin, const char* end, size_t firstLine, Logger* logger);
+            
             Logger* logger() const;
 
 
             Model::MapFormat::Type detectFormat();
             
             void parseEntities(Model::MapFormat::Type format);
+            void parseEntityHeader(Model::MapFormat::Type format);
             void parseBrushes(Model::MapFormat::Type format);
             void parseBrushFaces(Model::MapFormat::Type format);
             
@@ -21,6 +21,7 @@
 #define TrenchBroom_Token
 
 #include "StringUtils.h"
+#include "IO/LineIndex.h"
 
 #include <cassert>
 #include <cstdlib>
@@ -35,6 +36,9 @@ namespace TrenchBroom {
             const char* m_begin;
             const char* m_end;
             size_t m_position;
+            // if a line index is set, the line and column are looked up lazily for the line offset
+            const LineIndex* m_lineIndex;
+            size_t m_lineOffset;
             size_t m_line;
             size_t m_column;
         public:
@@ -43,6 +47,8 @@ namespace TrenchBroom {
             m_begin(NULL),
             m_end(NULL),
             m_position(0),
+            m_lineIndex(NULL),
+            m_lineOffset(0),
             m_line(0),
             m_column(0) {}
             
@@ -51,11 +57,25 @@ namespace TrenchBroom {
             m_begin(begin),
             m_end(end),
             m_position(position),
+            m_lineIndex(NULL),
+            m_lineOffset(0),
             m_line(line),
             m_column(column) {
                 assert(end >= begin);
             }
             
+            TokenTemplate(const Type type, const char* begin, const char* end, const size_t position, const LineIndex& lineIndex, const size_t lineOffset) :
+            m_type(type),
+            m_begin(begin),
+            m_end(end),
+            m_position(position),
+            m_lineIndex(&lineIndex),
+            m_lineOffset(lineOffset),
+            m_line(0),
+            m_column(0) {
+                assert(end >= begin);
+            }
+            
             Type type() const {
                 return m_type;
             }
@@ -81,34 +101,21 @@ namespace TrenchBroom {
             }
             
             size_t line() const {
-                return m_line;
+                return m_lineIndex != NULL ? m_lineIndex->line(m_lineOffset) : m_line;
             }
             
             size_t column() const {
-                return m_column;
+                return m_lineIndex != NULL ? m_lineIndex->column(m_lineOffset) : m_column;
             }
             
             template <typename T>
             T toFloat() const {
-                static const size_t BufferSize = 256;
-                static char buffer[BufferSize];
-                assert(length() < BufferSize);
-                
-                memcpy(buffer, m_begin, length());
-                buffer[length()] = 0;
-                const T f = static_cast<T>(std::atof(buffer));
-                return f;
+                return static_cast<T>(StringUtils::stringToDouble(m_begin, m_end));
             }
             
             template <typename T>
             T toInteger() const {
-                static char buffer[64];
-                assert(length() < 64);
-                
-                memcpy(buffer, m_begin, length());
-                buffer[length()] = 0;
-                const T i = static_cast<T>(std::atoi(buffer));
-                return i;
+                return static_cast<T>(StringUtils::stringToInt(m_begin, m_end));
             }
         };
     }
@@ -21,10 +21,11 @@
 #define TrenchBroom_Tokenizer_h
 
 #include "Exceptions.h"
-#include "Token.h"
+#include "IO/LineIndex.h"
+#include "IO/Token.h"
 
 #include <cassert>
-#include <stack>
+#include <cstring>
 
 namespace TrenchBroom {
     namespace IO {
@@ -33,43 +34,40 @@ namespace TrenchBroom {
         public:
             typedef TokenTemplate<TokenType> Token;
         private:
-            typedef std::stack<Token> TokenStack;
-            
-            struct State {
-                const char* cur;
-                size_t line;
-                size_t column;
-                size_t lastColumn;
-                
-                State(const char* i_cur) :
-                cur(i_cur),
-                line(1),
-                column(1),
-                lastColumn(0) {}
-            };
+            // the parsers push back at most two tokens at a time
+            static const size_t MaxPushedTokens = 4;
             
             const char* m_begin;
             const char* m_end;
-            State m_state;
+            const char* m_cur;
             
-            TokenStack m_tokenStack;
+            // Only the current position is tracked while reading. Lines and columns are computed from the offsets
+            // when they are requested, which is rare compared to the number of characters read.
+            LineIndex m_lineIndex;
+            
+            Token m_pushedTokens[MaxPushedTokens];
+            size_t m_pushedTokenCount;
         public:
             static const String Whitespace;
         public:
-            Tokenizer(const char* begin, const char* end) :
+            Tokenizer(const char* begin, const char* end, const size_t firstLine = 1) :
             m_begin(begin),
             m_end(end),
-            m_state(State(m_begin)) {}
+            m_cur(m_begin),
+            m_lineIndex(m_begin, m_end, firstLine),
+            m_pushedTokenCount(0) {}
             
             Tokenizer(const String& str) :
             m_begin(str.c_str()),
             m_end(str.c_str() + str.size()),
-            m_state(State(m_begin)) {}
+            m_cur(m_begin),
+            m_lineIndex(m_begin, m_end, 1),
+            m_pushedTokenCount(0) {}
             
             virtual ~Tokenizer() {}
             
             Token nextToken() {
-                return !m_tokenStack.empty() ? popToken() : emitToken();
+                return m_pushedTokenCount > 0 ? popToken() : emitToken();
             }
             
             Token peekToken() {
@@ -79,14 +77,14 @@ namespace TrenchBroom {
             }
             
             void pushToken(const Token& token) {
-                m_tokenStack.push(token);
+                if (m_pushedTokenCount == MaxPushedTokens)
+                    throw ParserException("Cannot push back more tokens");
+                m_pushedTokens[m_pushedTokenCount++] = token;
             }
             
             Token popToken() {
-                assert(!m_tokenStack.empty());
-                Token token = m_tokenStack.top();
-                m_tokenStack.pop();
-                return token;
+                assert(m_pushedTokenCount > 0);
+                return m_pushedTokens[--m_pushedTokenCount];
             }
             
             String readRemainder(const TokenType delimiterType) {
@@ -115,7 +113,8 @@ namespace TrenchBroom {
             }
             
             void reset() {
-                m_state = State(m_begin);
+                m_cur = m_begin;
+                m_pushedTokenCount = 0;
             }
 
             double progress() const {
@@ -127,15 +126,29 @@ namespace TrenchBroom {
             }
         protected:
             size_t line() const {
-                return m_state.line;
+                return line(curPos());
             }
             
             size_t column() const {
-                return m_state.column;
+                return column(curPos());
+            }
+            
+            size_t line(const char* pos) const {
+                return m_lineIndex.line(offset(pos));
+            }
+            
+            size_t column(const char* pos) const {
+                return m_lineIndex.column(offset(pos));
+            }
+            
+            // Creates a token whose line and column are those of the given start position, which precedes the
+            // token's data if it is quoted. They are only computed if they are requested.
+            Token token(const TokenType type, const char* begin, const char* end, const char* start) const {
+                return Token(type, begin, end, offset(begin), m_lineIndex, offset(start));
             }
             
             bool eof() const {
-                return m_state.cur >= m_end;
+                return m_cur >= m_end;
             }
             
             size_t length() const {
@@ -148,7 +161,7 @@ namespace TrenchBroom {
             }
             
             const char* curPos() const {
-                return m_state.cur;
+                return m_cur;
             }
             
             char curChar() const {
@@ -159,45 +172,20 @@ namespace TrenchBroom {
             }
             
             char lookAhead(const size_t offset = 1) {
-                if (m_state.cur + offset >= m_end)
+                if (m_cur + offset >= m_end)
                     return 0;
-                return *(m_state.cur + offset);
+                return *(m_cur + offset);
             }
             
             void advance() {
                 errorIfEof();
-                
-                if (curChar() == '\n') {
-                    ++m_state.line;
-                    m_state.lastColumn = m_state.column;
-                    m_state.column = 1;
-                } else {
-                    ++m_state.column;
-                }
-                
-                ++m_state.cur;
+                ++m_cur;
             }
             
             void retreat() {
                 if (curPos() == m_begin)
                     throw ParserException("Cannot retreat beyond beginning of file");
-                if (curChar() == '\n') {
-                    --m_state.line;
-                    if (m_state.lastColumn > 0) {
-                        m_state.column = m_state.lastColumn;
-                        m_state.lastColumn = 0;
-                    } else {
-                        m_state.column = 1;
-                        const char* c = m_state.cur - 1;
-                        while (c > m_begin && *c != '\n') {
-                            --c;
-                            ++m_state.column;
-                        }
-                    }
-                } else {
-                    --m_state.column;
-                }
-                --m_state.cur;
+                --m_cur;
             }
             
             bool isDigit(const char c) const {
@@ -212,7 +200,7 @@ namespace TrenchBroom {
                 if (curChar() != '+' && curChar() != '-' && !isDigit(curChar()))
                     return NULL;
                 
-                const State previous = m_state;
+                const char* previous = m_cur;
                 if (curChar() == '+' || curChar() == '-')
                     advance();
                 while (!eof() && isDigit(curChar()))
@@ -220,7 +208,7 @@ namespace TrenchBroom {
                 if (eof() || isAnyOf(curChar(), delims))
                     return curPos();
                 
-                m_state = previous;
+                m_cur = previous;
                 return NULL;
             }
             
@@ -228,7 +216,7 @@ namespace TrenchBroom {
                 if (curChar() != '+' && curChar() != '-' && curChar() != '.' && !isDigit(curChar()))
                     return NULL;
                 
-                const State previous = m_state;
+                const char* previous = m_cur;
                 advance();
                 while (!eof() && isDigit(curChar()))
                     advance();
@@ -248,10 +236,42 @@ namespace TrenchBroom {
                 if (eof() || isAnyOf(curChar(), delims))
                     return curPos();
                 
-                m_state = previous;
+                m_cur = previous;
                 return NULL;
             }
             
+            /*
+             Reads an integer or a decimal number in a single pass and classifies it the same way as readInteger and
+             readDecimal would. Returns the end of the number or NULL if the current position does not start a number
+             that is followed by one of the given delimiters. In the latter case, the current position is unchanged.
+             */
+            const char* readNumber(const String& delims, bool& decimal) {
+                const char* c = curPos();
+                if (eof() || (*c != '+' && *c != '-' && *c != '.' && !isDigit(*c)))
+                    return NULL;
+                
+                const char* e = skipDigits(c + 1);
+                if (*c != '.' && isDelimiter(e, delims)) {
+                    decimal = false;
+                    m_cur = e;
+                    return e;
+                }
+                
+                if (e < m_end && *e == '.')
+                    e = skipDigits(e + 1);
+                if (e < m_end && *e == 'e') {
+                    ++e;
+                    if (e < m_end && (*e == '+' || *e == '-' || isDigit(*e)))
+                        e = skipDigits(e + 1);
+                }
+                if (!isDelimiter(e, delims))
+                    return NULL;
+                
+                decimal = true;
+                m_cur = e;
+                return e;
+            }
+            
             const char* readString(const String& delims) {
                 while (!eof() && !isAnyOf(curChar(), delims))
                     advance();
@@ -259,6 +279,15 @@ namespace TrenchBroom {
             }
             
             const char* readQuotedString() {
+                // skip a word at a time as long as it does not contain the closing quote
+                while (m_cur + sizeof(size_t) <= m_end) {
+                    size_t word;
+                    std::memcpy(&word, m_cur, sizeof(size_t));
+                    if (containsByte(word, '"'))
+                        break;
+                    m_cur += sizeof(size_t);
+                }
+                
                 while (!eof() && curChar() != '"')
                     advance();
                 errorIfEof();
@@ -288,6 +317,23 @@ namespace TrenchBroom {
                     throw ParserException("Unexpected end of file");
             }
         private:
+            const char* skipDigits(const char* c) const {
+                while (c < m_end && isDigit(*c))
+                    ++c;
+                return c;
+            }
+            
+            bool isDelimiter(const char* c, const String& delims) const {
+                return c >= m_end || isAnyOf(*c, delims);
+            }
+            
+            static bool containsByte(const size_t word, const unsigned char byte) {
+                static const size_t Ones = ~static_cast<size_t>(0) / 0xFF;
+                static const size_t Highs = Ones * 0x80;
+                const size_t x = word ^ (Ones * byte);
+                return ((x - Ones) & ~x & Highs) != 0;
+            }
+            
             bool isAnyOf(const char c, const String& allow) const {
                 for (size_t i = 0; i < allow.size(); i++)
                     if (c == allow[i])
@@ -25,6 +25,9 @@
 
 #include <cassert>
 
+template <typename T, size_t R, size_t C>
+struct MatKernels;
+
 template <typename T, size_t R, size_t C>
 class Mat {
 public:
@@ -140,12 +143,7 @@ public:
     
     // Matrix multiplication
     const Mat<T,R,C> operator*(const Mat<T,C,R>& right) const {
-        Mat<T,R,C> result(Mat<T,R,C>::Null);
-        for (size_t c = 0; c < C; c++)
-            for (size_t r = 0; r < R; r++)
-                for (size_t i = 0; i < C; ++i)
-                    result[c][r] += v[i][r] * right[c][i];
-        return result;
+        return MatKernels<T,R,C>::multiply(*this, right);
     }
     
     Mat<T,R,C>& operator*= (const Mat<T,C,R>& right) {
@@ -177,11 +175,7 @@ public:
     
     // Vector right multiplication
     const Vec<T,C> operator*(const Vec<T,C>& right) const {
-        Vec<T,C> result;
-        for (size_t r = 0; r < R; r++)
-            for (size_t c = 0; c < C; ++c)
-                result[r] += v[c][r] * right[c];
-        return result;
+        return MatKernels<T,R,C>::multiply(*this, right);
     }
     
     const Vec<T,C-1> operator*(const Vec<T,C-1>& right) const {
@@ -261,6 +255,8 @@ public:
     }
 };
 
+#include "MatKernels.h"
+
 template <typename T, size_t R, size_t C>
 Mat<T,R,C> operator*(const T left, const Mat<T,R,C>& right) {
     return right * left;
@@ -0,0 +1,166 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MatKernels_h
+#define TrenchBroom_MatKernels_h
+
+// This file is included by Mat.h after the definition of Mat and must not be included directly.
+
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+/*
+ The matrix products which are computed in bulk when transforming vertices and composing transformations. Every element
+ of a product is summed up from zero in the order of the columns of the left factor. The specializations for 4x4
+ matrices compute whole columns at once, but they keep this order so that their results are identical.
+ */
+template <typename T, size_t R, size_t C>
+struct MatKernels {
+    static Mat<T,R,C> multiply(const Mat<T,R,C>& left, const Mat<T,C,R>& right) {
+        Mat<T,R,C> result(Mat<T,R,C>::Null);
+        for (size_t c = 0; c < C; c++)
+            for (size_t r = 0; r < R; r++)
+                for (size_t i = 0; i < C; ++i)
+                    result[c][r] += left[i][r] * right[c][i];
+        return result;
+    }
+    
+    static Vec<T,C> multiply(const Mat<T,R,C>& left, const Vec<T,C>& right) {
+        Vec<T,C> result;
+        for (size_t r = 0; r < R; r++)
+            for (size_t c = 0; c < C; ++c)
+                result[r] += left[c][r] * right[c];
+        return result;
+    }
+};
+
+#ifdef __SSE2__
+template <>
+struct MatKernels<float,4,4> {
+    static Mat<float,4,4> multiply(const Mat<float,4,4>& left, const Mat<float,4,4>& right) {
+        const Columns columns(left);
+        Mat<float,4,4> result(Mat<float,4,4>::Null);
+        for (size_t c = 0; c < 4; c++)
+            _mm_storeu_ps(&result[c][0], columns.multiply(&right[c][0]));
+        return result;
+    }
+    
+    static Vec<float,4> multiply(const Mat<float,4,4>& left, const Vec<float,4>& right) {
+        Vec<float,4> result;
+        _mm_storeu_ps(&result[0], Columns(left).multiply(&right[0]));
+        return result;
+    }
+private:
+    // the columns of the left factor, loaded once for all columns of the right factor
+    struct Columns {
+        const __m128 v0, v1, v2, v3;
+        
+        explicit Columns(const Mat<float,4,4>& mat) :
+        v0(_mm_loadu_ps(&mat[0][0])),
+        v1(_mm_loadu_ps(&mat[1][0])),
+        v2(_mm_loadu_ps(&mat[2][0])),
+        v3(_mm_loadu_ps(&mat[3][0])) {}
+        
+        __m128 multiply(const float* column) const {
+            __m128 sum = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(v0, _mm_set1_ps(column[0])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(v1, _mm_set1_ps(column[1])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(v2, _mm_set1_ps(column[2])));
+            return _mm_add_ps(sum, _mm_mul_ps(v3, _mm_set1_ps(column[3])));
+        }
+    };
+};
+
+template <>
+struct MatKernels<double,4,4> {
+    static Mat<double,4,4> multiply(const Mat<double,4,4>& left, const Mat<double,4,4>& right) {
+        const Columns columns(left);
+        Mat<double,4,4> result(Mat<double,4,4>::Null);
+        for (size_t c = 0; c < 4; c++)
+            columns.multiply(&right[c][0], &result[c][0]);
+        return result;
+    }
+    
+    static Vec<double,4> multiply(const Mat<double,4,4>& left, const Vec<double,4>& right) {
+        Vec<double,4> result;
+        Columns(left).multiply(&right[0], &result[0]);
+        return result;
+    }
+private:
+#ifdef __AVX__
+    // the columns of the left factor, loaded once for all columns of the right factor
+    struct Columns {
+        const __m256d v0, v1, v2, v3;
+        
+        explicit Columns(const Mat<double,4,4>& mat) :
+        v0(_mm256_loadu_pd(&mat[0][0])),
+        v1(_mm256_loadu_pd(&mat[1][0])),
+        v2(_mm256_loadu_pd(&mat[2][0])),
+        v3(_mm256_loadu_pd(&mat[3][0])) {}
+        
+        void multiply(const double* column, double* result) const {
+            __m256d sum = _mm256_add_pd(_mm256_setzero_pd(), _mm256_mul_pd(v0, _mm256_set1_pd(column[0])));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(v1, _mm256_set1_pd(column[1])));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(v2, _mm256_set1_pd(column[2])));
+            _mm256_storeu_pd(result, _mm256_add_pd(sum, _mm256_mul_pd(v3, _mm256_set1_pd(column[3]))));
+        }
+    };
+#else
+    // the columns of the left factor, split into upper and lower halves since a register holds two doubles
+    struct Columns {
+        const __m128d u0, u1, u2, u3;
+        const __m128d l0, l1, l2, l3;
+        
+        explicit Columns(const Mat<double,4,4>& mat) :
+        u0(_mm_loadu_pd(&mat[0][0])),
+        u1(_mm_loadu_pd(&mat[1][0])),
+        u2(_mm_loadu_pd(&mat[2][0])),
+        u3(_mm_loadu_pd(&mat[3][0])),
+        l0(_mm_loadu_pd(&mat[0][2])),
+        l1(_mm_loadu_pd(&mat[1][2])),
+        l2(_mm_loadu_pd(&mat[2][2])),
+        l3(_mm_loadu_pd(&mat[3][2])) {}
+        
+        void multiply(const double* column, double* result) const {
+            const __m128d f0 = _mm_set1_pd(column[0]);
+            const __m128d f1 = _mm_set1_pd(column[1]);
+            const __m128d f2 = _mm_set1_pd(column[2]);
+            const __m128d f3 = _mm_set1_pd(column[3]);
+            
+            __m128d upper = _mm_add_pd(_mm_setzero_pd(), _mm_mul_pd(u0, f0));
+            __m128d lower = _mm_add_pd(_mm_setzero_pd(), _mm_mul_pd(l0, f0));
+            upper = _mm_add_pd(upper, _mm_mul_pd(u1, f1));
+            lower = _mm_add_pd(lower, _mm_mul_pd(l1, f1));
+            upper = _mm_add_pd(upper, _mm_mul_pd(u2, f2));
+            lower = _mm_add_pd(lower, _mm_mul_pd(l2, f2));
+            _mm_storeu_pd(result, _mm_add_pd(upper, _mm_mul_pd(u3, f3)));
+            _mm_storeu_pd(result + 2, _mm_add_pd(lower, _mm_mul_pd(l3, f3)));
+        }
+    };
+#endif
+};
+#endif
+
+#endif
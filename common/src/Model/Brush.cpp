@@ -19,7 +19,9 @@
 
 #include "Brush.h"
 
+#include "Allocator.h"
 #include "CollectionUtils.h"
+#include "ParallelTaskRunner.h"
 #include "Model/BrushContentTypeBuilder.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -242,28 +244,296 @@ namespace TrenchBroom {
             }
         };
         
-        Brush::Brush(const BBox3& worldBounds, const BrushFaceList& faces) :
+        /*
+         Finds the vertices of a brush by intersecting every triple of face planes. For brushes with few faces, this
+         is much cheaper than building the brush geometry. The brush is regular if every face contributes at least
+         three vertices and no two vertices are very close to each other, which means that building its geometry will
+         neither drop any faces nor heal any edges nor fail.
+         */
+        class Brush::EstimateGeometry {
+        private:
+            const BrushFaceList& m_faces;
+            Vec3::List m_vertices;
+            bool m_regular;
+        public:
+            EstimateGeometry(const BBox3& worldBounds, const BrushFaceList& faces) :
+            m_faces(faces),
+            m_regular(false) {
+                if (m_faces.size() < 4 || m_faces.size() > MaxDeferredFaceCount || hasDuplicateBoundaries())
+                    return;
+                
+                const BBox3 maxBounds = worldBounds.expanded(1.0);
+                const size_t count = m_faces.size();
+                for (size_t i = 0; i < count; ++i) {
+                    for (size_t j = i + 1; j < count; ++j) {
+                        for (size_t k = j + 1; k < count; ++k) {
+                            Vec3 vertex;
+                            if (intersect(m_faces[i]->boundary(), m_faces[j]->boundary(), m_faces[k]->boundary(), vertex) && contains(vertex)) {
+                                if (!maxBounds.contains(vertex) || !addVertex(vertex))
+                                    return;
+                            }
+                        }
+                    }
+                }
+                
+                m_regular = m_vertices.size() >= 4 && allFacesHaveVertices();
+            }
+            
+            bool regular() const {
+                return m_regular;
+            }
+            
+            BBox3 bounds() const {
+                assert(m_regular);
+                return BBox3(m_vertices);
+            }
+        private:
+            bool hasDuplicateBoundaries() const {
+                for (size_t i = 0; i < m_faces.size(); ++i) {
+                    for (size_t j = i + 1; j < m_faces.size(); ++j) {
+                        if (m_faces[i]->boundary().equals(m_faces[j]->boundary()))
+                            return true;
+                    }
+                }
+                return false;
+            }
+            
+            static bool intersect(const Plane3& p1, const Plane3& p2, const Plane3& p3, Vec3& result) {
+                const Vec3 n23 = crossed(p2.normal, p3.normal);
+                const FloatType denominator = p1.normal.dot(n23);
+                if (Math::zero(denominator))
+                    return false;
+                
+                const Vec3 n31 = crossed(p3.normal, p1.normal);
+                const Vec3 n12 = crossed(p1.normal, p2.normal);
+                result = (p1.distance * n23 + p2.distance * n31 + p3.distance * n12) / denominator;
+                return true;
+            }
+            
+            bool contains(const Vec3& point) const {
+                BrushFaceList::const_iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                    const BrushFace* face = *it;
+                    if (face->boundary().pointStatus(point) == Math::PointStatus::PSAbove)
+                        return false;
+                }
+                return true;
+            }
+            
+            bool addVertex(const Vec3& vertex) {
+                // several triples of planes meet in the same vertex if more than three faces are incident to it
+                const FloatType epsilon = Math::Constants<FloatType>::pointStatusEpsilon();
+                // shorter edges may be healed or lead to the brush being rejected when building its geometry
+                const FloatType minDistance = 1.0;
+                Vec3::List::const_iterator it, end;
+                for (it = m_vertices.begin(), end = m_vertices.end(); it != end; ++it) {
+                    const FloatType distance2 = (*it - vertex).squaredLength();
+                    if (distance2 <= epsilon * epsilon)
+                        return true;
+                    if (distance2 < minDistance * minDistance)
+                        return false;
+                }
+                m_vertices.push_back(vertex);
+                return true;
+            }
+            
+            bool allFacesHaveVertices() const {
+                BrushFaceList::const_iterator fIt, fEnd;
+                for (fIt = m_faces.begin(), fEnd = m_faces.end(); fIt != fEnd; ++fIt) {
+                    const BrushFace* face = *fIt;
+                    size_t vertexCount = 0;
+                    
+                    Vec3::List::const_iterator vIt, vEnd;
+                    for (vIt = m_vertices.begin(), vEnd = m_vertices.end(); vIt != vEnd && vertexCount < 3; ++vIt) {
+                        if (face->boundary().pointStatus(*vIt) == Math::PointStatus::PSInside)
+                            ++vertexCount;
+                    }
+                    
+                    if (vertexCount < 3)
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        Brush::DeferredGeometry::DeferredGeometry(const BBox3& i_worldBounds, const BBox3& i_bounds) :
+        worldBounds(i_worldBounds),
+        bounds(i_bounds) {}
+
+        /*
+         A bounding volume hierarchy over the faces of a brush. Every node is bounded by the faces below it. The faces
+         of an inner node are split at the median of their centers along the axis in which the centers are spread the
+         most.
+         */
+        class Brush::FaceTree {
+        private:
+            static const size_t MaxLeafFaceCount = 4;
+            
+            struct Node {
+                BBox3 bounds;
+                // the children of an inner node are the node following it and the node at index second
+                size_t first;
+                size_t count;
+                size_t second;
+                
+                Node() :
+                first(0),
+                count(0),
+                second(0) {}
+            };
+            
+            struct FaceInfo {
+                BrushFace* face;
+                BBox3 bounds;
+                Vec3 center;
+            };
+            
+            class CompareCenters {
+            private:
+                size_t m_axis;
+            public:
+                CompareCenters(const size_t axis) :
+                m_axis(axis) {}
+                
+                bool operator()(const FaceInfo& lhs, const FaceInfo& rhs) const {
+                    return lhs.center[m_axis] < rhs.center[m_axis];
+                }
+            };
+            
+            std::vector<Node> m_nodes;
+            BrushFaceList m_faces;
+        public:
+            FaceTree(const BrushFaceList& faces) {
+                assert(!faces.empty());
+                
+                std::vector<FaceInfo> infos;
+                infos.reserve(faces.size());
+                
+                BrushFaceList::const_iterator it, end;
+                for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                    BrushFace* face = *it;
+                    const BrushHalfEdgeList& boundary = face->geometry()->boundary();
+                    
+                    FaceInfo info;
+                    info.face = face;
+                    // faces which are perpendicular to an axis must not have flat bounds
+                    info.bounds = BBox3(boundary.begin(), boundary.end(), BrushGeometry::GetVertexPosition()).expand(Math::Constants<FloatType>::almostZero());
+                    info.center = info.bounds.center();
+                    infos.push_back(info);
+                }
+                
+                m_nodes.reserve(2 * faces.size());
+                m_faces.reserve(faces.size());
+                build(infos, 0, infos.size());
+            }
+            
+            // Returns the first face that the given ray hits. A ray hits at most one face of a convex brush from the front.
+            BrushFaceHit findFaceHit(const Ray3& ray) const {
+                const Vec3 inverseDirection = ray.inverseDirection();
+                size_t stack[64];
+                size_t stackSize = 0;
+                stack[stackSize++] = 0;
+                
+                while (stackSize > 0) {
+                    const size_t index = stack[--stackSize];
+                    const Node& node = m_nodes[index];
+                    if (Math::isnan(node.bounds.entryDistance(ray, inverseDirection)))
+                        continue;
+                    
+                    if (node.count > 0) {
+                        for (size_t i = node.first; i < node.first + node.count; ++i) {
+                            BrushFace* face = m_faces[i];
+                            const FloatType distance = face->intersectWithRay(ray);
+                            if (!Math::isnan(distance))
+                                return BrushFaceHit(face, distance);
+                        }
+                    } else {
+                        stack[stackSize++] = node.second;
+                        stack[stackSize++] = index + 1;
+                    }
+                }
+                return BrushFaceHit();
+            }
+        private:
+            size_t build(std::vector<FaceInfo>& infos, const size_t begin, const size_t end) {
+                const size_t index = m_nodes.size();
+                m_nodes.push_back(Node());
+                
+                BBox3 bounds = infos[begin].bounds;
+                BBox3 centers(infos[begin].center, infos[begin].center);
+                for (size_t i = begin + 1; i < end; ++i) {
+                    bounds.mergeWith(infos[i].bounds);
+                    centers.mergeWith(infos[i].center);
+                }
+                m_nodes[index].bounds = bounds;
+                
+                if (end - begin <= MaxLeafFaceCount) {
+                    m_nodes[index].first = m_faces.size();
+                    m_nodes[index].count = end - begin;
+                    for (size_t i = begin; i < end; ++i)
+                        m_faces.push_back(infos[i].face);
+                } else {
+                    const size_t axis = centers.size().firstComponent();
+                    const size_t mid = (begin + end) / 2;
+                    std::nth_element(infos.begin() + static_cast<std::ptrdiff_t>(begin),
+                                     infos.begin() + static_cast<std::ptrdiff_t>(mid),
+                                     infos.begin() + static_cast<std::ptrdiff_t>(end),
+                                     CompareCenters(axis));
+                    build(infos, begin, mid);
+                    m_nodes[index].second = build(infos, mid, end);
+                }
+                return index;
+            }
+        };
+        
+        Brush::Brush(const BBox3& worldBounds, const BrushFaceList& faces, const bool deferGeometry) :
         m_geometry(NULL),
+        m_deferredGeometry(NULL),
         m_contentTypeBuilder(NULL),
         m_contentType(0),
         m_transparent(false),
-        m_contentTypeValid(true) {
+        m_contentTypeValid(true),
+        m_faceTree(NULL) {
             addFaces(faces);
             try {
-                rebuildGeometry(worldBounds);
+                if (!deferGeometry || !this->deferGeometry(worldBounds))
+                    rebuildGeometry(worldBounds);
             } catch (const GeometryException&) {
                 cleanup();
                 throw;
             }
         }
 
+        /*
+         Creates a brush from previously built geometry without clipping. The brush takes ownership of the
+         given geometry, and the given faces must correspond to the geometry's faces in order.
+         */
+        Brush::Brush(const BrushFaceList& faces, BrushGeometry* geometry) :
+        m_geometry(geometry),
+        m_deferredGeometry(NULL),
+        m_contentTypeBuilder(NULL),
+        m_contentType(0),
+        m_transparent(false),
+        m_contentTypeValid(true),
+        m_faceTree(NULL) {
+            assert(m_geometry != NULL);
+            assert(m_geometry->faceCount() == faces.size());
+            
+            addFaces(faces);
+            linkFacesToGeometry();
+            nodeBoundsDidChange();
+        }
+
         Brush::~Brush() {
             cleanup();
         }
 
         void Brush::cleanup() {
+            invalidateFaceTree();
             delete m_geometry;
             m_geometry = NULL;
+            delete m_deferredGeometry;
+            m_deferredGeometry = NULL;
             VectorUtils::clearAndDelete(m_faces);
             m_contentTypeBuilder = NULL;
         }
@@ -333,6 +603,10 @@ namespace TrenchBroom {
         void Brush::faceDidChange() {
             invalidateContentType();
         }
+        
+        void Brush::faceGeometryDidChange() {
+            invalidateFaceTree();
+        }
 
         void Brush::addFaces(const BrushFaceList& faces) {
             addFaces(faces.begin(), faces.end(), faces.size());
@@ -346,6 +620,7 @@ namespace TrenchBroom {
             m_faces.push_back(face);
             face->setBrush(this);
             invalidateContentType();
+            invalidateFaceTree();
             if (face->selected())
                 incChildSelectionCount(1);
         }
@@ -377,6 +652,7 @@ namespace TrenchBroom {
                 decChildSelectionCount(1);
             face->setBrush(NULL);
             invalidateContentType();
+            invalidateFaceTree();
         }
         
         void Brush::cloneFaceAttributesFrom(const BrushList& brushes) {
@@ -453,6 +729,7 @@ namespace TrenchBroom {
                     testFaces.push_back(brushFace);
             }
             
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(worldBounds);
             CanMoveBoundary canMove(testGeometry, testFaces);
             const bool inWorldBounds = worldBounds.contains(testGeometry.bounds()) && testGeometry.closed();
@@ -526,7 +803,10 @@ namespace TrenchBroom {
             assert(!vertexPositions.empty());
             if (delta.null())
                 return false;
+            if (!hasVertexPositions(vertexPositions))
+                return false;
             
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(*m_geometry);
             const SetTempFaceLinks setFaceLinks(this, testGeometry);
             
@@ -554,6 +834,7 @@ namespace TrenchBroom {
             
             const FloatType snapToF = static_cast<FloatType>(snapTo);
 
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(*m_geometry);
             const SetTempFaceLinks setFaceLinks(this, testGeometry);
             
@@ -608,10 +889,14 @@ namespace TrenchBroom {
             if (delta.null())
                 return true;
             
+            const Vec3::List vertexPositions = Edge3::asVertexList(edgePositions);
+            if (!hasVertexPositions(vertexPositions))
+                return false;
+            
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(*m_geometry);
             const SetTempFaceLinks setFaceLinks(this, testGeometry);
 
-            const Vec3::List vertexPositions = Edge3::asVertexList(edgePositions);
             const BrushGeometry::MoveVerticesResult result = testGeometry.moveVertices(vertexPositions, delta, false);
             if (!result.allVerticesMoved() || !worldBounds.contains(testGeometry.bounds()))
                 return false;
@@ -657,7 +942,10 @@ namespace TrenchBroom {
             assert(m_geometry != NULL);
             if (delta.null())
                 return false;
+            if (!m_geometry->hasEdge(edgePosition.start(), edgePosition.end()))
+                return false;
             
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(*m_geometry);
             const SetTempFaceLinks setFaceLinks(this, testGeometry);
             
@@ -687,10 +975,14 @@ namespace TrenchBroom {
             if (delta.null())
                 return false;
             
+            const Vec3::List vertexPositions = Polygon3::asVertexList(facePositions);
+            if (!hasVertexPositions(vertexPositions))
+                return false;
+            
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(*m_geometry);
             const SetTempFaceLinks setFaceLinks(this, testGeometry);
             
-            const Vec3::List vertexPositions = Polygon3::asVertexList(facePositions);
             const BrushGeometry::MoveVerticesResult result = testGeometry.moveVertices(vertexPositions, delta, false);
 
             if (!result.allVerticesMoved() || !worldBounds.contains(testGeometry.bounds()))
@@ -737,7 +1029,10 @@ namespace TrenchBroom {
             assert(m_geometry != NULL);
             if (delta.null())
                 return false;
+            if (!m_geometry->hasFace(facePosition.vertices()))
+                return false;
             
+            const AllocatorScratchScope scratch;
             BrushGeometry testGeometry(*m_geometry);
             const SetTempFaceLinks setFaceLinks(this, testGeometry);
             const BrushGeometry::MoveVerticesResult result = testGeometry.splitFace(facePosition.vertices(), delta);
@@ -759,20 +1054,69 @@ namespace TrenchBroom {
             return result.newVertexPositions.front();
         }
 
+        bool Brush::hasVertexPositions(const Vec3::List& positions) const {
+            Vec3::List::const_iterator it, end;
+            for (it = positions.begin(), end = positions.end(); it != end; ++it) {
+                if (!m_geometry->hasVertex(*it))
+                    return false;
+            }
+            return true;
+        }
+
         BrushList Brush::subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const {
             const BrushGeometry::SubtractResult result = m_geometry->subtract(*subtrahend->m_geometry);
+            return createBrushes(factory, worldBounds, defaultTextureName, result, subtrahend);
+        }
+        
+        class Brush::SubtractTask : public ParallelTask {
+        private:
+            const BrushGeometry& m_minuend;
+            const BrushGeometry& m_subtrahend;
+            BrushGeometry::SubtractResult m_result;
+        public:
+            SubtractTask(const BrushGeometry& minuend, const BrushGeometry& subtrahend) :
+            m_minuend(minuend),
+            m_subtrahend(subtrahend) {}
             
-            BrushList brushes(0);
-            brushes.reserve(result.size());
+            const BrushGeometry::SubtractResult& result() const {
+                return m_result;
+            }
+        private:
+            void doRun() {
+                m_result = m_minuend.subtract(m_subtrahend);
+            }
+        };
+        
+        Brush::BrushLists Brush::subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushList& minuends, const Brush* subtrahend, const ParallelTaskRunner& runner) {
+            ParallelTask::List tasks;
+            tasks.reserve(minuends.size());
+            
+            BrushList::const_iterator it, end;
+            for (it = minuends.begin(), end = minuends.end(); it != end; ++it) {
+                const Brush* minuend = *it;
+                tasks.push_back(new SubtractTask(*minuend->m_geometry, *subtrahend->m_geometry));
+            }
             
-            BrushGeometry::SubtractResult::const_iterator it, end;
-            for (it = result.begin(), end = result.end(); it != end; ++it) {
-                const BrushGeometry& geometry = *it;
-                Brush* brush = createBrush(factory, worldBounds, defaultTextureName, geometry, subtrahend);
-                brushes.push_back(brush);
+            runner.run(tasks);
+            
+            // Creating the brushes touches the textures' usage counts, so it must not run concurrently.
+            BrushLists result;
+            result.reserve(minuends.size());
+            try {
+                for (size_t i = 0; i < minuends.size(); ++i) {
+                    const SubtractTask* task = static_cast<const SubtractTask*>(tasks[i]);
+                    result.push_back(minuends[i]->createBrushes(factory, worldBounds, defaultTextureName, task->result(), subtrahend));
+                }
+            } catch (...) {
+                BrushLists::iterator rIt, rEnd;
+                for (rIt = result.begin(), rEnd = result.end(); rIt != rEnd; ++rIt)
+                    VectorUtils::clearAndDelete(*rIt);
+                VectorUtils::clearAndDelete(tasks);
+                throw;
             }
             
-            return brushes;
+            VectorUtils::clearAndDelete(tasks);
+            return result;
         }
 
         void Brush::intersect(const BBox3& worldBounds, const Brush* brush) {
@@ -787,6 +1131,20 @@ namespace TrenchBroom {
             rebuildGeometry(worldBounds);
         }
 
+        BrushList Brush::createBrushes(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry::SubtractResult& geometries, const Brush* subtrahend) const {
+            BrushList brushes(0);
+            brushes.reserve(geometries.size());
+            
+            BrushGeometry::SubtractResult::const_iterator it, end;
+            for (it = geometries.begin(), end = geometries.end(); it != end; ++it) {
+                const BrushGeometry& geometry = *it;
+                Brush* brush = createBrush(factory, worldBounds, defaultTextureName, geometry, subtrahend);
+                brushes.push_back(brush);
+            }
+            
+            return brushes;
+        }
+
         Brush* Brush::createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const Brush* subtrahend) const {
             BrushFaceList faces(0);
             faces.reserve(geometry.faceCount());
@@ -831,6 +1189,7 @@ namespace TrenchBroom {
             } while (current != first);
             
             invalidateContentType();
+            invalidateFaceTree();
         }
 
         void Brush::updatePointsFromVertices(const BBox3& worldBounds) {
@@ -846,7 +1205,38 @@ namespace TrenchBroom {
         }
 
         void Brush::rebuildGeometry(const BBox3& worldBounds) {
+            buildGeometry(worldBounds);
+            nodeBoundsDidChange();
+        }
+
+        void Brush::findIntegerPlanePoints(const BBox3& worldBounds) {
+            const NotifyNodeChange nodeChange(this);
+            findIntegerPlanePointsAndBuildGeometry(worldBounds);
+            nodeBoundsDidChange();
+        }
+
+        bool Brush::geometryDeferred() const {
+            return m_geometry == NULL && m_deferredGeometry != NULL;
+        }
+        
+        void Brush::buildDeferredGeometry() {
+            assert(geometryDeferred());
+            const BBox3 worldBounds = m_deferredGeometry->worldBounds;
+            buildGeometry(worldBounds);
+        }
+
+        void Brush::buildGeometry(const BBox3& worldBounds) {
+            delete m_deferredGeometry;
+            m_deferredGeometry = NULL;
+            
             delete m_geometry;
+            m_geometry = NULL;
+            
+            if (buildBoxGeometry(worldBounds)) {
+                updateFacesFromGeometry(worldBounds);
+                return;
+            }
+            
             m_geometry = new BrushGeometry(worldBounds.expanded(1.0));
             
             AddFacesToGeometry addFacesToGeometry(*m_geometry, m_faces);
@@ -857,18 +1247,171 @@ namespace TrenchBroom {
                 throw GeometryException("Brush is invalid");
             if (!fullySpecified())
                 throw GeometryException("Brush is not fully specified");
-            nodeBoundsDidChange();
+        }
+        
+        /*
+         Most brushes are axis aligned boxes. Their geometry is created directly instead of clipping the world bounds
+         with every face. The geometry's faces are created in the order of this brush's faces, so the order of the faces
+         is the same as if the geometry had been clipped. Returns false if this brush is not such a box.
+         */
+        bool Brush::buildBoxGeometry(const BBox3& worldBounds) {
+            BBox3 bounds;
+            if (!findBoxBounds(worldBounds, bounds))
+                return false;
+            
+            // The vertex at index i has the maximal x, y and z coordinates if bit 0, 1 and 2 of i is set, respectively.
+            // The boundaries are indexed by axis and direction and are in counter clockwise order when viewed from outside.
+            static const size_t Boundaries[3][2][4] = {
+                { { 0, 4, 6, 2 }, { 1, 3, 7, 5 } },
+                { { 0, 1, 5, 4 }, { 2, 6, 7, 3 } },
+                { { 0, 2, 3, 1 }, { 4, 5, 7, 6 } }
+            };
+            
+            Vec3::List positions(8);
+            for (size_t i = 0; i < 8; ++i) {
+                for (size_t j = 0; j < 3; ++j)
+                    positions[i][j] = (i & (1 << j)) != 0 ? bounds.max[j] : bounds.min[j];
+            }
+            
+            BrushGeometry::FaceIndexList boundaries;
+            boundaries.reserve(m_faces.size());
+            
+            BrushFaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                const Vec3& normal = (*it)->boundary().normal;
+                const size_t axis = normal.firstComponent();
+                const size_t* boundary = Boundaries[axis][normal[axis] > 0.0 ? 1 : 0];
+                boundaries.push_back(BrushGeometry::IndexList(boundary, boundary + 4));
+            }
+            
+            m_geometry = new BrushGeometry();
+            if (!m_geometry->setTopology(positions, boundaries)) {
+                delete m_geometry;
+                m_geometry = NULL;
+                return false;
+            }
+            
+            linkFacesToGeometry();
+            return true;
+        }
+        
+        // Links the faces of the geometry to the faces of this brush in order.
+        void Brush::linkFacesToGeometry() {
+            assert(m_geometry->faceCount() == m_faces.size());
+            
+            BrushFaceList::const_iterator it = m_faces.begin();
+            BrushFaceGeometry* first = m_geometry->faces().front();
+            BrushFaceGeometry* current = first;
+            do {
+                current->setPayload(*it++);
+                current = current->next();
+            } while (current != first);
+            
+            restoreFaceLinks(m_geometry);
+        }
+        
+        /*
+         Determines the bounds of this brush if it consists of exactly one face for every axis aligned direction, and
+         if the bounds are within the given world bounds. Only then does clipping yield the same box.
+         */
+        bool Brush::findBoxBounds(const BBox3& worldBounds, BBox3& bounds) const {
+            if (m_faces.size() != 6)
+                return false;
+            
+            bool found[3][2] = { { false, false }, { false, false }, { false, false } };
+            
+            BrushFaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                const Plane3& plane = (*it)->boundary();
+                const size_t axis = plane.normal.firstComponent();
+                if (Math::abs(plane.normal[axis]) != 1.0)
+                    return false;
+                
+                const size_t direction = plane.normal[axis] > 0.0 ? 1 : 0;
+                if (found[axis][direction])
+                    return false;
+                found[axis][direction] = true;
+                
+                if (direction == 1)
+                    bounds.max[axis] = plane.distance;
+                else
+                    bounds.min[axis] = -plane.distance;
+            }
+            
+            bounds.min.correct();
+            bounds.max.correct();
+            
+            for (size_t i = 0; i < 3; ++i) {
+                if (bounds.max[i] - bounds.min[i] < Math::Constants<FloatType>::pointStatusEpsilon())
+                    return false;
+            }
+            return worldBounds.contains(bounds);
         }
 
-        void Brush::findIntegerPlanePoints(const BBox3& worldBounds) {
-            const NotifyNodeChange nodeChange(this);
+        void Brush::transformAndBuildGeometry(const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds) {
+            BrushFaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                BrushFace* face = *it;
+                face->transform(transformation, lockTextures);
+            }
+            
+            const bool translation = translationMatrix(transformation) == transformation;
+            if (!translation || !translateGeometry(transformation[3].xyz(), worldBounds))
+                buildGeometry(worldBounds);
+        }
+        
+        /*
+         Translating a brush does not change its shape, so its geometry is moved along with the faces instead of being
+         rebuilt. Returns false if the translated brush would not be within the given world bounds, or if a vertex of
+         a face does not lie on the face's plane because the face was changed since the geometry was built. In both
+         cases, the geometry must be rebuilt.
+         */
+        bool Brush::translateGeometry(const Vec3& delta, const BBox3& worldBounds) {
+            const BBox3& bounds = m_geometry->bounds();
+            if (!worldBounds.contains(BBox3(bounds.min + delta, bounds.max + delta)))
+                return false;
+            
+            m_geometry->translate(delta);
             
+            BrushFaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                const BrushFace* face = *it;
+                const Plane3& boundary = face->boundary();
+                const BrushFaceGeometry* geometry = face->geometry();
+                if (boundary.normal.dot(geometry->normal()) <= 0.0)
+                    return false;
+                
+                // every vertex of the face must still lie on the face's plane
+                const BrushHalfEdge* first = geometry->boundary().front();
+                const BrushHalfEdge* current = first;
+                do {
+                    if (boundary.pointStatus(current->origin()->position()) != Math::PointStatus::PSInside)
+                        return false;
+                    current = current->next();
+                } while (current != first);
+            }
+            return true;
+        }
+
+        void Brush::findIntegerPlanePointsAndBuildGeometry(const BBox3& worldBounds) {
             BrushFaceList::const_iterator it, end;
             for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
                 BrushFace* brushFace = *it;
                 brushFace->findIntegerPlanePoints();
             }
-            rebuildGeometry(worldBounds);
+            buildGeometry(worldBounds);
+        }
+
+        bool Brush::deferGeometry(const BBox3& worldBounds) {
+            assert(m_geometry == NULL);
+            
+            const EstimateGeometry estimate(worldBounds, m_faces);
+            if (!estimate.regular())
+                return false;
+            
+            m_deferredGeometry = new DeferredGeometry(worldBounds, estimate.bounds());
+            nodeBoundsDidChange();
+            return true;
         }
 
         bool Brush::checkGeometry() const {
@@ -939,10 +1482,16 @@ namespace TrenchBroom {
         }
 
         const BBox3& Brush::doGetBounds() const {
-            assert(m_geometry != NULL);
+            if (m_geometry == NULL) {
+                assert(m_deferredGeometry != NULL);
+                return m_deferredGeometry->bounds;
+            }
             return m_geometry->bounds();
         }
 
+        /*
+         A clone has the same shape as this brush, so its geometry is copied instead of being rebuilt from the faces.
+         */
         Node* Brush::doClone(const BBox3& worldBounds) const {
             BrushFaceList faceClones;
             faceClones.reserve(m_faces.size());
@@ -953,7 +1502,7 @@ namespace TrenchBroom {
                 faceClones.push_back(face->clone());
             }
             
-            Brush* brush = new Brush(worldBounds, faceClones);
+            Brush* brush = new Brush(faceClones, new BrushGeometry(*m_geometry));
             brush->setContentTypeBuilder(m_contentTypeBuilder);
             cloneAttributes(brush);
             return brush;
@@ -1005,6 +1554,11 @@ namespace TrenchBroom {
                 result.push_back(this);
         }
 
+        void Brush::doFindNodesIntersecting(const BBox3& bounds, NodeList& result) {
+            if (this->bounds().intersects(bounds))
+                result.push_back(this);
+        }
+
         FloatType Brush::doIntersectWithRay(const Ray3& ray) const {
             const BrushFaceHit hit = findFaceHit(ray);
             return hit.distance;
@@ -1018,6 +1572,11 @@ namespace TrenchBroom {
             if (Math::isnan(bounds().intersectWithRay(ray)))
                 return BrushFaceHit();
             
+            if (m_faces.size() >= MinFaceTreeFaceCount) {
+                validateFaceTree();
+                return m_faceTree->findFaceHit(ray);
+            }
+            
             BrushFaceList::const_iterator it, end;
             for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
                 BrushFace* face = *it;
@@ -1028,6 +1587,16 @@ namespace TrenchBroom {
             return BrushFaceHit();
         }
 
+        void Brush::invalidateFaceTree() {
+            delete m_faceTree;
+            m_faceTree = NULL;
+        }
+        
+        void Brush::validateFaceTree() const {
+            if (m_faceTree == NULL)
+                m_faceTree = new FaceTree(m_faces);
+        }
+
         Node* Brush::doGetContainer() const {
             FindContainerVisitor visitor;
             escalate(visitor);
@@ -1048,13 +1617,8 @@ namespace TrenchBroom {
         
         void Brush::doTransform(const Mat4x4& transformation, bool lockTextures, const BBox3& worldBounds) {
             const NotifyNodeChange nodeChange(this);
-
-            BrushFaceList::const_iterator it, end;
-            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
-                BrushFace* face = *it;
-                face->transform(transformation, lockTextures);
-            }
-            rebuildGeometry(worldBounds);
+            transformAndBuildGeometry(transformation, lockTextures, worldBounds);
+            nodeBoundsDidChange();
         }
         
         class Brush::Contains : public ConstNodeVisitor, public NodeQuery<bool> {
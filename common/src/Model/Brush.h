@@ -30,6 +30,8 @@
 #include "Model/Object.h"
 
 namespace TrenchBroom {
+    class ParallelTaskRunner;
+    
     namespace Model {
         struct BrushAlgorithmResult;
         class BrushContentTypeBuilder;
@@ -39,6 +41,7 @@ namespace TrenchBroom {
         class Brush : public Node, public Object {
         private:
             friend class SetTempFaceLinks;
+            friend class BrushGeometryBatch;
         public:
             static const Hit::HitType BrushHit;
         private:
@@ -57,19 +60,41 @@ namespace TrenchBroom {
             class CanMoveBoundary;
             class MoveVerticesCallback;
             class QueryCallback;
+            class EstimateGeometry;
+            
+            struct DeferredGeometry {
+                BBox3 worldBounds;
+                BBox3 bounds;
+                
+                DeferredGeometry(const BBox3& i_worldBounds, const BBox3& i_bounds);
+            };
+            
+            static const size_t MaxDeferredFaceCount = 16;
+            
+            // Brushes with at least this many faces find the face hit by a ray using a bounding volume hierarchy.
+            class FaceTree;
+            static const size_t MinFaceTreeFaceCount = 16;
         public:
             typedef ConstProjectingSequence<BrushVertexList, ProjectToVertex> VertexList;
             typedef ConstProjectingSequence<BrushEdgeList, ProjectToEdge> EdgeList;
         private:
             BrushFaceList m_faces;
             BrushGeometry* m_geometry;
+            DeferredGeometry* m_deferredGeometry;
             
             const BrushContentTypeBuilder* m_contentTypeBuilder;
             mutable BrushContentType::FlagType m_contentType;
             mutable bool m_transparent;
             mutable bool m_contentTypeValid;
+            
+            mutable FaceTree* m_faceTree;
         public:
-            Brush(const BBox3& worldBounds, const BrushFaceList& faces);
+            /*
+             If deferGeometry is true and the faces form a regular brush, only the bounds are estimated here. Such a
+             brush must be built by BrushGeometryBatch::buildDeferredGeometry before anything else is done with it.
+             */
+            Brush(const BBox3& worldBounds, const BrushFaceList& faces, bool deferGeometry = false);
+            Brush(const BrushFaceList& faces, BrushGeometry* geometry);
             ~Brush();
         private:
             void cleanup();
@@ -86,6 +111,7 @@ namespace TrenchBroom {
             bool fullySpecified() const;
             
             void faceDidChange();
+            void faceGeometryDidChange();
         private:
             void addFaces(const BrushFaceList& faces);
             template <typename I>
@@ -155,11 +181,26 @@ namespace TrenchBroom {
             Polygon3::List moveFaces(const BBox3& worldBounds, const Polygon3::List& facePositions, const Vec3& delta);
             bool canSplitFace(const BBox3& worldBounds, const Polygon3& facePosition, const Vec3& delta);
             Vec3 splitFace(const BBox3& worldBounds, const Polygon3& facePosition, const Vec3& delta);
-            
+        private:
+            // Moving an unknown vertex always fails, so the queries can check this without copying the geometry.
+            bool hasVertexPositions(const Vec3::List& positions) const;
+        public:
             // CSG operations
+            typedef std::vector<BrushList> BrushLists;
+            
             BrushList subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const;
+            /*
+             Subtracts the given subtrahend from each of the given minuends and returns one list of fragments per
+             minuend. A list is empty if the subtrahend does not cut its minuend. The geometry is computed by the given
+             runner, but the brushes are created on the calling thread in the order of the minuends, so the result does
+             not depend on the number of threads.
+             */
+            static BrushLists subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushList& minuends, const Brush* subtrahend, const ParallelTaskRunner& runner);
             void intersect(const BBox3& worldBounds, const Brush* brush);
         private:
+            class SubtractTask;
+            
+            BrushList createBrushes(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry::SubtractResult& geometries, const Brush* subtrahend) const;
             Brush* createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const Brush* subtrahend) const;
         private:
             void updateFacesFromGeometry(const BBox3& worldBounds);
@@ -167,7 +208,20 @@ namespace TrenchBroom {
         public: // brush geometry
             void rebuildGeometry(const BBox3& worldBounds);
             void findIntegerPlanePoints(const BBox3& worldBounds);
+            
+            bool geometryDeferred() const;
         private:
+            // These only change this brush and send no notifications, so BrushGeometryBatch can run them concurrently.
+            void buildGeometry(const BBox3& worldBounds);
+            void buildDeferredGeometry();
+            bool buildBoxGeometry(const BBox3& worldBounds);
+            void linkFacesToGeometry();
+            bool findBoxBounds(const BBox3& worldBounds, BBox3& bounds) const;
+            void transformAndBuildGeometry(const Mat4x4& transformation, bool lockTextures, const BBox3& worldBounds);
+            bool translateGeometry(const Vec3& delta, const BBox3& worldBounds);
+            void findIntegerPlanePointsAndBuildGeometry(const BBox3& worldBounds);
+            
+            bool deferGeometry(const BBox3& worldBounds);
             bool checkGeometry() const;
         public: // content type
             bool transparent() const;
@@ -199,6 +253,7 @@ namespace TrenchBroom {
         private: // implement Object interface
             void doPick(const Ray3& ray, PickResult& pickResult) const;
             void doFindNodesContaining(const Vec3& point, NodeList& result);
+            void doFindNodesIntersecting(const BBox3& bounds, NodeList& result);
             FloatType doIntersectWithRay(const Ray3& ray) const;
 
             struct BrushFaceHit {
@@ -209,6 +264,8 @@ namespace TrenchBroom {
             };
 
             BrushFaceHit findFaceHit(const Ray3& ray) const;
+            void invalidateFaceTree();
+            void validateFaceTree() const;
             
             Node* doGetContainer() const;
             Layer* doGetLayer() const;
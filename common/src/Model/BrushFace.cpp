@@ -53,6 +53,8 @@ namespace TrenchBroom {
         m_vertexIndex(0),
         m_cachedVertices(0),
         m_verticesValid(false),
+        m_projectionAxis(0),
+        m_projectedEdgesValid(false),
         m_attribs(attribs) {
             assert(m_texCoordSystem != NULL);
             setPoints(point0, point1, point2);
@@ -122,6 +124,10 @@ namespace TrenchBroom {
             return result;
         }
 
+        BrushFace* BrushFace::cloneWithoutTexture() const {
+            return new BrushFace(points()[0], points()[1], points()[2], m_attribs.takeSnapshot(), m_texCoordSystem->clone());
+        }
+
         BrushFaceSnapshot* BrushFace::takeSnapshot() {
             return new BrushFaceSnapshot(this, m_texCoordSystem);
         }
@@ -581,6 +587,10 @@ namespace TrenchBroom {
         Vec2f BrushFace::textureCoords(const Vec3& point) const {
             return m_texCoordSystem->getTexCoords(point, m_attribs);
         }
+        
+        void BrushFace::textureCoords(const Vec3* points, const size_t count, Vec2f* texCoords) const {
+            m_texCoordSystem->getTexCoords(points, count, m_attribs, texCoords);
+        }
 
         bool BrushFace::containsPoint(const Vec3& point) const {
             const Vec3 toPoint = point - m_boundary.anchor();
@@ -598,7 +608,30 @@ namespace TrenchBroom {
             if (!Math::neg(dot))
                 return Math::nan<FloatType>();
             
-            return intersectPolygonWithRay(ray, m_boundary, m_geometry->boundary().begin(), m_geometry->boundary().end(), BrushGeometry::GetVertexPosition());
+            const FloatType distance = m_boundary.intersectWithRay(ray);
+            if (Math::isnan(distance))
+                return distance;
+            
+            // The face is convex, so the point is inside if it is not outside of any edge.
+            validateProjectedEdges();
+            const Vec3 point = swizzle(ray.pointAtDistance(distance), m_projectionAxis);
+            const size_t count = m_projectedEdges.size() / 3;
+            if (count == 0)
+                return Math::nan<FloatType>();
+            
+            const FloatType* normalsX = &m_projectedEdges[0];
+            const FloatType* normalsY = normalsX + count;
+            const FloatType* distances = normalsY + count;
+            
+            FloatType minDistance = std::numeric_limits<FloatType>::max();
+            for (size_t i = 0; i < count; ++i) {
+                const FloatType edgeDistance = normalsX[i] * point.x() + normalsY[i] * point.y() - distances[i];
+                minDistance = edgeDistance < minDistance ? edgeDistance : minDistance;
+            }
+            
+            if (Math::neg(minDistance))
+                return Math::nan<FloatType>();
+            return distance;
         }
 
         void BrushFace::setPoints(const Vec3& point0, const Vec3& point1, const Vec3& point2) {
@@ -630,6 +663,9 @@ namespace TrenchBroom {
         
         void BrushFace::invalidateVertexCache() {
             m_verticesValid = false;
+            m_projectedEdgesValid = false;
+            if (m_brush != NULL)
+                m_brush->faceGeometryDidChange();
         }
         
         void BrushFace::validateVertexCache() const {
@@ -637,18 +673,77 @@ namespace TrenchBroom {
                 m_cachedVertices.clear();
                 m_cachedVertices.reserve(vertexCount());
                 
+                // the texture coordinates are computed for batches of vertices to avoid a virtual call per vertex
+                static const size_t BatchSize = 16;
+                Vec3 positions[BatchSize];
+                Vec2f texCoords[BatchSize];
+                
                 const BrushHalfEdge* first = m_geometry->boundary().front();
                 const BrushHalfEdge* current = first;
                 do {
-                    const Vec3& position = current->origin()->position();
-                    m_cachedVertices.push_back(Vertex(position, m_boundary.normal, textureCoords(position)));
+                    size_t count = 0;
+                    do {
+                        positions[count++] = current->origin()->position();
+                        
+                        // The boundary is in CCW order, but the renderer expects CW order:
+                        current = current->previous();
+                    } while (current != first && count < BatchSize);
                     
-                    // The boundary is in CCW order, but the renderer expects CW order:
-                    current = current->previous();
+                    textureCoords(positions, count, texCoords);
+                    for (size_t i = 0; i < count; ++i)
+                        m_cachedVertices.push_back(Vertex(positions[i], m_boundary.normal, texCoords[i]));
                 } while (current != first);
                 
                 m_verticesValid = true;
             }
         }
+        
+        void BrushFace::validateProjectedEdges() const {
+            if (!m_projectedEdgesValid) {
+                m_projectionAxis = m_boundary.normal.firstComponent();
+                
+                Vec3::List positions;
+                positions.reserve(vertexCount());
+                const BrushHalfEdge* first = m_geometry->boundary().front();
+                const BrushHalfEdge* current = first;
+                do {
+                    positions.push_back(swizzle(current->origin()->position(), m_projectionAxis));
+                    current = current->next();
+                } while (current != first);
+                
+                // the projection may mirror the face, then its edges turn clockwise
+                FloatType area = 0.0;
+                for (size_t i = 0; i < positions.size(); ++i) {
+                    const Vec3& p0 = positions[i];
+                    const Vec3& p1 = positions[Math::succ(i, positions.size())];
+                    area += p0.x() * p1.y() - p1.x() * p0.y();
+                }
+                const FloatType orientation = area < 0.0 ? -1.0 : 1.0;
+                
+                std::vector<FloatType> normalsX, normalsY, distances;
+                for (size_t i = 0; i < positions.size(); ++i) {
+                    const Vec3& p0 = positions[i];
+                    const Vec3& p1 = positions[Math::succ(i, positions.size())];
+                    const FloatType dx = p1.x() - p0.x();
+                    const FloatType dy = p1.y() - p0.y();
+                    const FloatType length = std::sqrt(dx * dx + dy * dy);
+                    if (Math::zero(length))
+                        continue;
+                    
+                    const FloatType normalX = -dy / length * orientation;
+                    const FloatType normalY =  dx / length * orientation;
+                    normalsX.push_back(normalX);
+                    normalsY.push_back(normalY);
+                    distances.push_back(normalX * p0.x() + normalY * p0.y());
+                }
+                
+                m_projectedEdges.clear();
+                m_projectedEdges.reserve(3 * normalsX.size());
+                m_projectedEdges.insert(m_projectedEdges.end(), normalsX.begin(), normalsX.end());
+                m_projectedEdges.insert(m_projectedEdges.end(), normalsY.begin(), normalsY.end());
+                m_projectedEdges.insert(m_projectedEdges.end(), distances.begin(), distances.end());
+                m_projectedEdgesValid = true;
+            }
+        }
     }
 }
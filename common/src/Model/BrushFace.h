@@ -94,6 +94,15 @@ namespace TrenchBroom {
             mutable size_t m_vertexIndex;
             mutable Vertex::List m_cachedVertices;
             mutable bool m_verticesValid;
+            
+            /*
+             The edges of this face projected onto the coordinate plane of the largest component of its normal. The
+             lines through the edges are stored as three consecutive arrays of the x and y coordinates of their normals
+             and of their distances from the origin. The normals point into the face.
+             */
+            mutable size_t m_projectionAxis;
+            mutable std::vector<FloatType> m_projectedEdges;
+            mutable bool m_projectedEdgesValid;
         protected:
             BrushFaceAttributes m_attribs;
         public:
@@ -107,6 +116,8 @@ namespace TrenchBroom {
             virtual ~BrushFace();
             
             BrushFace* clone() const;
+            // Unlike clone, the copy does not reference the texture and may therefore be destroyed on any thread.
+            BrushFace* cloneWithoutTexture() const;
             
             BrushFaceSnapshot* takeSnapshot();
 
@@ -196,6 +207,7 @@ namespace TrenchBroom {
             void getFaceIndices(Renderer::TexturedIndexArrayBuilder& builder) const;
             
             Vec2f textureCoords(const Vec3& point) const;
+            void textureCoords(const Vec3* points, size_t count, Vec2f* texCoords) const;
 
             bool containsPoint(const Vec3& point) const;
             FloatType intersectWithRay(const Ray3& ray) const;
@@ -206,6 +218,7 @@ namespace TrenchBroom {
             bool vertexCacheValid() const;
             void invalidateVertexCache();
             void validateVertexCache() const;
+            void validateProjectedEdges() const;
 
             BrushFace(const BrushFace& other);
             BrushFace& operator=(const BrushFace& other);
@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrushGeometryBatch.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "ParallelTaskRunner.h"
+#include "Model/Brush.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushGeometryBatch::Operation {
+        public:
+            virtual ~Operation() {}
+            
+            void apply(Brush* brush, const BBox3& worldBounds) const {
+                doApply(brush, worldBounds);
+            }
+        private:
+            virtual void doApply(Brush* brush, const BBox3& worldBounds) const = 0;
+        };
+        
+        class BrushGeometryBatch::RebuildGeometry : public BrushGeometryBatch::Operation {
+        private:
+            void doApply(Brush* brush, const BBox3& worldBounds) const {
+                brush->buildGeometry(worldBounds);
+            }
+        };
+        
+        class BrushGeometryBatch::Transform : public BrushGeometryBatch::Operation {
+        private:
+            const Mat4x4& m_transformation;
+            bool m_lockTextures;
+        public:
+            Transform(const Mat4x4& transformation, const bool lockTextures) :
+            m_transformation(transformation),
+            m_lockTextures(lockTextures) {}
+        private:
+            void doApply(Brush* brush, const BBox3& worldBounds) const {
+                brush->transformAndBuildGeometry(m_transformation, m_lockTextures, worldBounds);
+            }
+        };
+        
+        class BrushGeometryBatch::BuildDeferredGeometry : public BrushGeometryBatch::Operation {
+        private:
+            void doApply(Brush* brush, const BBox3& worldBounds) const {
+                brush->buildDeferredGeometry();
+            }
+        };
+        
+        class BrushGeometryBatch::FindIntegerPlanePoints : public BrushGeometryBatch::Operation {
+        private:
+            void doApply(Brush* brush, const BBox3& worldBounds) const {
+                brush->findIntegerPlanePointsAndBuildGeometry(worldBounds);
+            }
+        };
+        
+        class BrushGeometryBatch::ProcessBrushesTask : public ParallelTask {
+        private:
+            const Operation& m_operation;
+            const BBox3& m_worldBounds;
+            const BrushList& m_brushes;
+            size_t m_begin;
+            size_t m_end;
+            FailureList m_failures;
+        public:
+            ProcessBrushesTask(const Operation& operation, const BBox3& worldBounds, const BrushList& brushes, const size_t begin, const size_t end) :
+            m_operation(operation),
+            m_worldBounds(worldBounds),
+            m_brushes(brushes),
+            m_begin(begin),
+            m_end(end) {}
+            
+            const FailureList& failures() const {
+                return m_failures;
+            }
+        private:
+            void doRun() {
+                for (size_t i = m_begin; i < m_end; ++i) {
+                    try {
+                        m_operation.apply(m_brushes[i], m_worldBounds);
+                    } catch (const GeometryException& e) {
+                        m_failures.push_back(std::make_pair(i, String(e.what())));
+                    }
+                }
+            }
+        };
+        
+        const size_t BrushGeometryBatch::BrushesPerTask = 64;
+        
+        BrushGeometryBatch::BrushGeometryBatch(const BBox3& worldBounds, const ParallelTaskRunner& runner) :
+        m_worldBounds(worldBounds),
+        m_runner(runner) {}
+        
+        void BrushGeometryBatch::rebuildGeometry(const BrushList& brushes) const {
+            process(brushes, RebuildGeometry(), false);
+        }
+        
+        void BrushGeometryBatch::transform(const BrushList& brushes, const Mat4x4& transformation, const bool lockTextures) const {
+            process(brushes, Transform(transformation, lockTextures), true);
+        }
+        
+        void BrushGeometryBatch::findIntegerPlanePoints(const BrushList& brushes) const {
+            process(brushes, FindIntegerPlanePoints(), true);
+        }
+        
+        void BrushGeometryBatch::buildDeferredGeometry(const BrushList& brushes, BrushList& invalidBrushes, StringList& errors) const {
+            const FailureList failures = run(brushes, BuildDeferredGeometry());
+            
+            FailureList::const_iterator it, end;
+            for (it = failures.begin(), end = failures.end(); it != end; ++it) {
+                invalidBrushes.push_back(brushes[it->first]);
+                errors.push_back(it->second);
+            }
+        }
+        
+        void BrushGeometryBatch::process(const BrushList& brushes, const Operation& operation, const bool notifyChange) const {
+            if (notifyChange) {
+                BrushList::const_iterator it, end;
+                for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                    Brush* brush = *it;
+                    brush->nodeWillChange();
+                }
+            }
+            
+            const FailureList failures = run(brushes, operation);
+            
+            FailureList::const_iterator fIt = failures.begin();
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                Brush* brush = brushes[i];
+                if (fIt != failures.end() && fIt->first == i)
+                    ++fIt;
+                else
+                    brush->nodeBoundsDidChange();
+                if (notifyChange)
+                    brush->nodeDidChange();
+            }
+            
+            if (!failures.empty()) {
+                GeometryException e;
+                e << failures.size() << " of " << brushes.size() << " brushes are invalid: " << failures.front().second;
+                throw e;
+            }
+        }
+        
+        BrushGeometryBatch::FailureList BrushGeometryBatch::run(const BrushList& brushes, const Operation& operation) const {
+            ParallelTask::List tasks;
+            for (size_t begin = 0; begin < brushes.size(); begin += BrushesPerTask) {
+                const size_t end = std::min(begin + BrushesPerTask, brushes.size());
+                tasks.push_back(new ProcessBrushesTask(operation, m_worldBounds, brushes, begin, end));
+            }
+            
+            m_runner.run(tasks);
+            
+            // The tasks cover consecutive ranges of brushes, so the failures are collected in the order of the brushes.
+            FailureList failures;
+            ParallelTask::List::const_iterator tIt, tEnd;
+            for (tIt = tasks.begin(), tEnd = tasks.end(); tIt != tEnd; ++tIt) {
+                const ProcessBrushesTask* task = static_cast<const ProcessBrushesTask*>(*tIt);
+                failures.insert(failures.end(), task->failures().begin(), task->failures().end());
+            }
+            VectorUtils::clearAndDelete(tasks);
+            return failures;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushGeometryBatch
+#define TrenchBroom_BrushGeometryBatch
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "StringUtils.h"
+#include "Model/ModelTypes.h"
+
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom {
+    class ParallelTaskRunner;
+    
+    namespace Model {
+        /*
+         Rebuilds or transforms the geometry of many brushes at once. The brushes are processed concurrently by the
+         given runner. Afterwards, the change notifications are sent on the calling thread in the order of the brushes.
+         These notifications update the parents and the world's spatial index.
+         
+         If a brush's geometry becomes invalid, the other brushes are still processed. Its bounds are not published.
+         After all brushes have been processed, the failures are reported together as one GeometryException, so that
+         the calling command can restore its snapshot.
+         
+         Brushes whose geometry was deferred when they were read are built by buildDeferredGeometry. These brushes have
+         no parent yet, so no notifications are sent for them.
+         */
+        class BrushGeometryBatch {
+        private:
+            class Operation;
+            class RebuildGeometry;
+            class Transform;
+            class BuildDeferredGeometry;
+            class FindIntegerPlanePoints;
+            class ProcessBrushesTask;
+            
+            typedef std::pair<size_t, String> Failure;
+            typedef std::vector<Failure> FailureList;
+            
+            static const size_t BrushesPerTask;
+            
+            const BBox3 m_worldBounds;
+            const ParallelTaskRunner& m_runner;
+        public:
+            BrushGeometryBatch(const BBox3& worldBounds, const ParallelTaskRunner& runner);
+            
+            void rebuildGeometry(const BrushList& brushes) const;
+            void transform(const BrushList& brushes, const Mat4x4& transformation, bool lockTextures) const;
+            void findIntegerPlanePoints(const BrushList& brushes) const;
+            
+            // Collects the brushes whose geometry is invalid along with the reasons. The caller must discard them.
+            void buildDeferredGeometry(const BrushList& brushes, BrushList& invalidBrushes, StringList& errors) const;
+        private:
+            void process(const BrushList& brushes, const Operation& operation, bool notifyChange) const;
+            FailureList run(const BrushList& brushes, const Operation& operation) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_BrushGeometryBatch) */
@@ -19,6 +19,7 @@
 
 #include "Entity.h"
 
+#include "ParallelTaskRunner.h"
 #include "Model/BoundsContainsNodeVisitor.h"
 #include "Model/BoundsIntersectsNodeVisitor.h"
 #include "Model/Brush.h"
@@ -31,6 +32,7 @@
 #include "Model/IssueGenerator.h"
 #include "Model/NodeVisitor.h"
 #include "Model/PickResult.h"
+#include "Model/TransformObjectVisitor.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -194,6 +196,22 @@ namespace TrenchBroom {
             }
         }
 
+        void Entity::doFindNodesIntersecting(const BBox3& bounds, NodeList& result) {
+            if (!this->bounds().intersects(bounds))
+                return;
+            
+            if (hasChildren()) {
+                const NodeList& children = Node::children();
+                NodeList::const_iterator it, end;
+                for (it = children.begin(), end = children.end(); it != end; ++it) {
+                    Node* child = *it;
+                    child->findNodesIntersecting(bounds, result);
+                }
+            } else {
+                result.push_back(this);
+            }
+        }
+
         FloatType Entity::doIntersectWithRay(const Ray3& ray) const {
             if (hasChildren()) {
                 const BBox3& myBounds = bounds();
@@ -263,29 +281,12 @@ namespace TrenchBroom {
             return visitor.hasResult() ? visitor.result() : NULL;
         }
 
-        class TransformEntity : public NodeVisitor {
-        private:
-            const Mat4x4d& m_transformation;
-            bool m_lockTextures;
-            const BBox3& m_worldBounds;
-        public:
-            TransformEntity(const Mat4x4d& transformation, const bool lockTextures, const BBox3& worldBounds) :
-            m_transformation(transformation),
-            m_lockTextures(lockTextures),
-            m_worldBounds(worldBounds) {}
-        private:
-            void doVisit(World* world)   {}
-            void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   {}
-            void doVisit(Entity* entity) {}
-            void doVisit(Brush* brush)   { brush->transform(m_transformation, m_lockTextures, m_worldBounds); }
-        };
-
         void Entity::doTransform(const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds) {
             if (hasChildren()) {
                 const NotifyNodeChange nodeChange(this);
-                TransformEntity visitor(transformation, lockTextures, worldBounds);
+                TransformObjectVisitor visitor(transformation, lockTextures, worldBounds);
                 iterate(visitor);
+                visitor.transformBrushes(ParallelTaskRunner());
             } else {
                 // node change is called by setOrigin already
                 const Vec3 bottomCenter = Vec3(bounds().center().xy(), bounds().min.z());
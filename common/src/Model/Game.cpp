@@ -57,13 +57,17 @@ namespace TrenchBroom {
             return doNewMap(format, worldBounds);
         }
         
-        World* Game::loadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const {
-            return doLoadMap(format, worldBounds, path, logger);
+        World* Game::loadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, const bool useCache, const bool deferGeometry, Logger* logger) const {
+            return doLoadMap(format, worldBounds, path, useCache, deferGeometry, logger);
         }
 
-        void Game::writeMap(World* world, const IO::Path& path) const {
+        void Game::writeMap(World* world, const IO::Path& path, const IO::MapFileSplicer* splicer) const {
             assert(world != NULL);
-            doWriteMap(world, path);
+            doWriteMap(world, path, splicer);
+        }
+
+        void Game::writeMapSnapshot(const IO::MapSnapshot& snapshot, const IO::Path& path) const {
+            doWriteMapSnapshot(snapshot, path);
         }
 
         NodeList Game::parseNodes(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const {
@@ -37,6 +37,8 @@ namespace TrenchBroom {
     class Logger;
     
     namespace IO {
+        class MapFileSplicer;
+        class MapSnapshot;
         class MapWriter;
     }
     
@@ -59,8 +61,10 @@ namespace TrenchBroom {
             void setAdditionalSearchPaths(const IO::Path::List& searchPaths);
         public: // loading and writing map files
             World* newMap(MapFormat::Type format, const BBox3& worldBounds) const;
-            World* loadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const;
-            void writeMap(World* world, const IO::Path& path) const;
+            World* loadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, bool useCache, bool deferGeometry, Logger* logger) const;
+            void writeMap(World* world, const IO::Path& path, const IO::MapFileSplicer* splicer) const;
+            // Does not access any documents, so it may be called on a worker thread.
+            void writeMapSnapshot(const IO::MapSnapshot& snapshot, const IO::Path& path) const;
         public: // parsing and serializing objects
             NodeList parseNodes(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const;
             BrushFaceList parseBrushFaces(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const;
@@ -93,8 +97,9 @@ namespace TrenchBroom {
             virtual void doSetAdditionalSearchPaths(const IO::Path::List& searchPaths) = 0;
             
             virtual World* doNewMap(MapFormat::Type format, const BBox3& worldBounds) const = 0;
-            virtual World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const = 0;
-            virtual void doWriteMap(World* world, const IO::Path& path) const = 0;
+            virtual World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, bool useCache, bool deferGeometry, Logger* logger) const = 0;
+            virtual void doWriteMap(World* world, const IO::Path& path, const IO::MapFileSplicer* splicer) const = 0;
+            virtual void doWriteMapSnapshot(const IO::MapSnapshot& snapshot, const IO::Path& path) const = 0;
             
             virtual NodeList doParseNodes(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const = 0;
             virtual BrushFaceList doParseBrushFaces(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const = 0;
@@ -28,7 +28,10 @@
 #include "IO/FgdParser.h"
 #include "IO/FileSystem.h"
 #include "IO/IOUtils.h"
+#include "IO/MapCache.h"
+#include "IO/MapFileSerializer.h"
 #include "IO/MapParser.h"
+#include "IO/MapSnapshot.h"
 #include "IO/MdlParser.h"
 #include "IO/Md2Parser.h"
 #include "IO/NodeReader.h"
@@ -93,23 +96,59 @@ namespace TrenchBroom {
             return new World(format, brushContentTypeBuilder(), worldBounds);
         }
         
-        World* GameImpl::doLoadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const {
-            const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
+        World* GameImpl::doLoadMap(const MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, const bool useCache, const bool deferGeometry, Logger* logger) const {
+            const IO::Path fixedPath = IO::Disk::fixPath(path);
+            const IO::MappedFile::Ptr file = IO::Disk::openFile(fixedPath);
+            if (!useCache) {
+                IO::WorldReader reader(file->begin(), file->end(), brushContentTypeBuilder(), logger);
+                reader.setDeferBrushGeometry(deferGeometry);
+                return reader.read(format, worldBounds);
+            }
+            
+            const IO::MapCache cache(file->begin(), file->end());
+            const IO::Path cachePath = IO::MapCache::cachePath(fixedPath);
+            
+            // a cache that is still being written for this map must be complete before it can be read
+            m_cacheWriter.finish(logger);
+            
+            World* world = cache.read(cachePath, format, worldBounds, brushContentTypeBuilder());
+            if (world != NULL) {
+                if (logger != NULL)
+                    logger->debug("Loaded map from cache " + cachePath.asString());
+                return world;
+            }
+            
             IO::WorldReader reader(file->begin(), file->end(), brushContentTypeBuilder(), logger);
-            return reader.read(format, worldBounds);
+            reader.setDeferBrushGeometry(deferGeometry);
+            world = reader.read(format, worldBounds);
+            
+            // the reader has built any deferred brush geometry by now, which the cache contains
+            m_cacheWriter.write(cache, world, worldBounds, cachePath, logger);
+            return world;
         }
         
-        void GameImpl::doWriteMap(World* world, const IO::Path& path) const {
+        void GameImpl::doWriteMap(World* world, const IO::Path& path, const IO::MapFileSplicer* splicer) const {
             const String mapFormatName = formatName(world->format());
             
             IO::OpenFile openFile(path, true);
             FILE* stream = openFile.file();
-            IO::writeGameComment(stream, gameName(), mapFormatName);
+            const size_t commentLines = IO::writeGameComment(stream, gameName(), mapFormatName);
             
-            IO::NodeWriter writer(world, stream);
+            IO::NodeWriter writer(world, stream, commentLines + 1, splicer);
             writer.writeMap();
         }
 
+        void GameImpl::doWriteMapSnapshot(const IO::MapSnapshot& snapshot, const IO::Path& path) const {
+            const String mapFormatName = formatName(snapshot.format());
+            
+            IO::OpenFile openFile(path, true);
+            FILE* stream = openFile.file();
+            const size_t commentLines = IO::writeGameComment(stream, gameName(), mapFormatName);
+            
+            IO::NodeSerializer::Ptr serializer = IO::MapFileSerializer::create(snapshot.format(), stream, commentLines + 1);
+            snapshot.write(*serializer);
+        }
+
         NodeList GameImpl::doParseNodes(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const {
             IO::NodeReader reader(str, world, logger);
             return reader.read(worldBounds);
@@ -25,6 +25,7 @@
 #include "SharedPointer.h"
 #include "Assets/AssetTypes.h"
 #include "IO/GameFileSystem.h"
+#include "IO/MapCacheWriter.h"
 #include "Model/Game.h"
 #include "Model/GameConfig.h"
 #include "Model/ModelTypes.h"
@@ -44,6 +45,7 @@ namespace TrenchBroom {
             
             IO::GameFileSystem m_fs;
             Assets::Palette* m_palette;
+            mutable IO::MapCacheWriter m_cacheWriter;
         public:
             GameImpl(const GameConfig& config, const IO::Path& gamePath);
             ~GameImpl();
@@ -54,8 +56,9 @@ namespace TrenchBroom {
             void doSetAdditionalSearchPaths(const IO::Path::List& searchPaths);
 
             World* doNewMap(MapFormat::Type format, const BBox3& worldBounds) const;
-            World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, Logger* logger) const;
-            void doWriteMap(World* world, const IO::Path& path) const;
+            World* doLoadMap(MapFormat::Type format, const BBox3& worldBounds, const IO::Path& path, bool useCache, bool deferGeometry, Logger* logger) const;
+            void doWriteMap(World* world, const IO::Path& path, const IO::MapFileSplicer* splicer) const;
+            void doWriteMapSnapshot(const IO::MapSnapshot& snapshot, const IO::Path& path) const;
 
             NodeList doParseNodes(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const;
             BrushFaceList doParseBrushFaces(const String& str, World* world, const BBox3& worldBounds, Logger* logger) const;
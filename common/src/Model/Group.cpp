@@ -20,6 +20,7 @@
 #include "Group.h"
 
 #include "Hit.h"
+#include "ParallelTaskRunner.h"
 #include "Model/BoundsContainsNodeVisitor.h"
 #include "Model/BoundsIntersectsNodeVisitor.h"
 #include "Model/Brush.h"
@@ -191,6 +192,20 @@ namespace TrenchBroom {
             }
         }
 
+        void Group::doFindNodesIntersecting(const BBox3& bounds, NodeList& result) {
+            if (!this->bounds().intersects(bounds))
+                return;
+            
+            result.push_back(this);
+            
+            const NodeList& children = Node::children();
+            NodeList::const_iterator it, end;
+            for (it = children.begin(), end = children.end(); it != end; ++it) {
+                Node* child = *it;
+                child->findNodesIntersecting(bounds, result);
+            }
+        }
+
         FloatType Group::doIntersectWithRay(const Ray3& ray) const {
             const BBox3& myBounds = bounds();
             if (!myBounds.contains(ray.origin) && Math::isnan(myBounds.intersectWithRay(ray)))
@@ -236,6 +251,7 @@ namespace TrenchBroom {
         void Group::doTransform(const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds) {
             TransformObjectVisitor visitor(transformation, lockTextures, worldBounds);
             iterate(visitor);
+            visitor.transformBrushes(ParallelTaskRunner());
         }
         
         bool Group::doContains(const Node* node) const {
@@ -84,6 +84,7 @@ namespace TrenchBroom {
             
             void doPick(const Ray3& ray, PickResult& pickResult) const;
             void doFindNodesContaining(const Vec3& point, NodeList& result);
+            void doFindNodesIntersecting(const BBox3& bounds, NodeList& result);
             FloatType doIntersectWithRay(const Ray3& ray) const;
 
             void doGenerateIssues(const IssueGenerator* generator, IssueList& issues);
@@ -23,10 +23,15 @@
 #include "Model/Entity.h"
 #include "Model/Node.h"
 
+#include <wx/thread.h>
+
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Model {
+        // Issues of different worlds can be created concurrently, e.g. when maps are validated in a batch.
+        static wxCriticalSection SeqIdLock;
+        
         Issue::~Issue() {}
 
         size_t Issue::seqId() const {
@@ -69,6 +74,7 @@ namespace TrenchBroom {
 
         size_t Issue::nextSeqId() {
             static size_t seqId = 0;
+            wxCriticalSectionLocker lock(SeqIdLock);
             return seqId++;
         }
 
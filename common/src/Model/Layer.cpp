@@ -24,23 +24,41 @@
 #include "Model/Entity.h"
 #include "Model/IssueGenerator.h"
 #include "Model/NodeVisitor.h"
+#include "Model/PickResult.h"
+#include "Model/World.h"
 
 namespace TrenchBroom {
     namespace Model {
         Layer::Layer(const String& name, const BBox3& worldBounds) :
         m_name(name),
-        m_octree(worldBounds, static_cast<FloatType>(64.0f)) {}
+        m_bounds(worldBounds) {}
         
         void Layer::setName(const String& name) {
             m_name = name;
         }
 
+        void Layer::findChildrenIntersecting(const BBox3& bounds, NodeList& result) const {
+            const World* world = this->world();
+            if (world != NULL) {
+                world->findLayerChildrenIntersecting(bounds, this, World::Filter_None, result);
+                return;
+            }
+            
+            const NodeList& children = Node::children();
+            NodeList::const_iterator it, end;
+            for (it = children.begin(), end = children.end(); it != end; ++it) {
+                Node* node = *it;
+                if (node->bounds().intersects(bounds))
+                    result.push_back(node);
+            }
+        }
+
         const String& Layer::doGetName() const {
             return m_name;
         }
 
         const BBox3& Layer::doGetBounds() const {
-            return m_octree.bounds();
+            return m_bounds;
         }
 
         Node* Layer::doClone(const BBox3& worldBounds) const {
@@ -73,61 +91,28 @@ namespace TrenchBroom {
             return false;
         }
 
-        class Layer::AddNodeToOctree : public NodeVisitor {
-        private:
-            NodeTree& m_octree;
-        public:
-            AddNodeToOctree(NodeTree& octree) :
-            m_octree(octree) {}
-        private:
-            void doVisit(World* world)   {}
-            void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   { m_octree.addObject(group->bounds(), group); }
-            void doVisit(Entity* entity) { m_octree.addObject(entity->bounds(), entity); }
-            void doVisit(Brush* brush)   { m_octree.addObject(brush->bounds(), brush); }
-        };
-        
-        class Layer::RemoveNodeFromOctree : public NodeVisitor {
-        private:
-            NodeTree& m_octree;
-        public:
-            RemoveNodeFromOctree(NodeTree& octree) :
-            m_octree(octree) {}
-        private:
-            void doVisit(World* world)   {}
-            void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   { m_octree.removeObject(group); }
-            void doVisit(Entity* entity) { m_octree.removeObject(entity); }
-            void doVisit(Brush* brush)   { m_octree.removeObject(brush); }
-        };
-        
-        class Layer::UpdateNodeInOctree : public NodeVisitor {
-        private:
-            NodeTree& m_octree;
-        public:
-            UpdateNodeInOctree(NodeTree& octree) :
-            m_octree(octree) {}
-        private:
-            void doVisit(World* world)   {}
-            void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   { m_octree.updateObject(group->bounds(), group); }
-            void doVisit(Entity* entity) { m_octree.updateObject(entity->bounds(), entity); }
-            void doVisit(Brush* brush)   { m_octree.updateObject(brush->bounds(), brush); }
-        };
-
+        // The children of a layer that belongs to a world are kept in the world's spatial index. A layer that was
+        // removed from its world, e.g. by an undoable command, answers queries by visiting its children.
         void Layer::doChildWasAdded(Node* node) {
-            AddNodeToOctree visitor(m_octree);
-            node->accept(visitor);
+            World* world = this->world();
+            if (world != NULL)
+                world->layerChildWasAdded(node);
         }
         
         void Layer::doChildWillBeRemoved(Node* node) {
-            RemoveNodeFromOctree visitor(m_octree);
-            node->accept(visitor);
+            World* world = this->world();
+            if (world != NULL)
+                world->layerChildWillBeRemoved(node);
         }
         
         void Layer::doChildBoundsDidChange(Node* node) {
-            UpdateNodeInOctree visitor(m_octree);
-            node->accept(visitor);
+            World* world = this->world();
+            if (world != NULL)
+                world->layerChildBoundsDidChange(node);
+        }
+
+        World* Layer::world() const {
+            return static_cast<World*>(parent());
         }
 
         bool Layer::doSelectable() const {
@@ -147,16 +132,28 @@ namespace TrenchBroom {
         }
 
         void Layer::doPick(const Ray3& ray, PickResult& pickResult) const {
-            const Model::NodeList candidates = m_octree.findObjects(ray);
+            const World* world = this->world();
+            if (world != NULL) {
+                world->pickLayerChildren(ray, this, World::Filter_Hidden, pickResult);
+                return;
+            }
+            
+            const NodeList& children = Node::children();
             NodeList::const_iterator it, end;
-            for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+            for (it = children.begin(), end = children.end(); it != end; ++it) {
                 const Node* node = *it;
                 node->pick(ray, pickResult);
             }
         }
         
         void Layer::doFindNodesContaining(const Vec3& point, NodeList& result) {
-            const Model::NodeList candidates = m_octree.findObjects(point);
+            NodeList candidates;
+            const World* world = this->world();
+            if (world != NULL)
+                world->findLayerChildrenContaining(point, this, World::Filter_None, candidates);
+            else
+                candidates = Node::children();
+            
             NodeList::const_iterator it, end;
             for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
                 Node* node = *it;
@@ -164,6 +161,17 @@ namespace TrenchBroom {
             }
         }
 
+        void Layer::doFindNodesIntersecting(const BBox3& bounds, NodeList& result) {
+            NodeList candidates;
+            findChildrenIntersecting(bounds, candidates);
+            
+            NodeList::const_iterator it, end;
+            for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+                Node* node = *it;
+                node->findNodesIntersecting(bounds, result);
+            }
+        }
+
         FloatType Layer::doIntersectWithRay(const Ray3& ray) const {
             return Math::nan<FloatType>();
         }
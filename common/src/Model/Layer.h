@@ -23,20 +23,20 @@
 #include "StringUtils.h"
 #include "Model/ModelTypes.h"
 #include "Model/Node.h"
-#include "Model/Octree.h"
 
 namespace TrenchBroom {
     namespace Model {
         class Layer : public Node {
         private:
             String m_name;
-            
-            typedef Octree<FloatType, Node*> NodeTree;
-            NodeTree m_octree;
+            BBox3 m_bounds;
         public:
             Layer(const String& name, const BBox3& worldBounds);
             
             void setName(const String& name);
+            
+            // Adds the children of this layer whose bounds intersect the given bounds, without descending into them.
+            void findChildrenIntersecting(const BBox3& bounds, NodeList& result) const;
         private: // implement Node interface
             const String& doGetName() const;
             const BBox3& doGetBounds() const;
@@ -46,13 +46,10 @@ namespace TrenchBroom {
             bool doCanRemoveChild(const Node* child) const;
             bool doRemoveIfEmpty() const;
             
-            class AddNodeToOctree;
-            class RemoveNodeFromOctree;
-            class UpdateNodeInOctree;
-            
             void doChildWasAdded(Node* node);
             void doChildWillBeRemoved(Node* node);
             void doChildBoundsDidChange(Node* node);
+            World* world() const;
             
             bool doSelectable() const;
             
@@ -62,6 +59,7 @@ namespace TrenchBroom {
 
             void doPick(const Ray3& ray, PickResult& pickResult) const;
             void doFindNodesContaining(const Vec3& point, NodeList& result);
+            void doFindNodesIntersecting(const BBox3& bounds, NodeList& result);
             FloatType doIntersectWithRay(const Ray3& ray) const;
         private:
             Layer(const Layer&);
@@ -43,8 +43,8 @@ namespace TrenchBroom {
             return doCreateEntity();
         }
         
-        Brush* ModelFactory::createBrush(const BBox3& worldBounds, const BrushFaceList& faces) const {
-            return doCreateBrush(worldBounds, faces);
+        Brush* ModelFactory::createBrush(const BBox3& worldBounds, const BrushFaceList& faces, const bool deferGeometry) const {
+            return doCreateBrush(worldBounds, faces, deferGeometry);
         }
         
         BrushFace* ModelFactory::createFace(const Vec3& point1, const Vec3& point2, const Vec3& point3, const BrushFaceAttributes& attribs) const {
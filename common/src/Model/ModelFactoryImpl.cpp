@@ -67,9 +67,9 @@ namespace TrenchBroom {
             return new Entity();
         }
         
-        Brush* ModelFactoryImpl::doCreateBrush(const BBox3& worldBounds, const BrushFaceList& faces) const {
+        Brush* ModelFactoryImpl::doCreateBrush(const BBox3& worldBounds, const BrushFaceList& faces, const bool deferGeometry) const {
             assert(m_format != MapFormat::Unknown);
-            Brush* brush = new Brush(worldBounds, faces);
+            Brush* brush = new Brush(worldBounds, faces, deferGeometry);
             brush->setContentTypeBuilder(m_brushContentTypeBuilder);
             return brush;
         }
@@ -524,6 +524,10 @@ namespace TrenchBroom {
             doFindNodesContaining(point, result);
         }
 
+        void Node::findNodesIntersecting(const BBox3& bounds, NodeList& result) {
+            doFindNodesIntersecting(bounds, result);
+        }
+
         FloatType Node::intersectWithRay(const Ray3& ray) const {
             return doIntersectWithRay(ray);
         }
@@ -532,6 +536,10 @@ namespace TrenchBroom {
             return m_lineNumber;
         }
 
+        size_t Node::lineCount() const {
+            return m_lineCount;
+        }
+
         void Node::setFilePosition(const size_t lineNumber, const size_t lineCount) {
             m_lineNumber = lineNumber;
             m_lineCount = lineCount;
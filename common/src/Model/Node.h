@@ -213,9 +213,12 @@ namespace TrenchBroom {
         public: // picking
             void pick(const Ray3& ray, PickResult& result) const;
             void findNodesContaining(const Vec3& point, NodeList& result);
+            // Finds the nodes whose bounds intersect the given bounds. The result may still need an exact test.
+            void findNodesIntersecting(const BBox3& bounds, NodeList& result);
             FloatType intersectWithRay(const Ray3& ray) const;
         public: // file position
             size_t lineNumber() const;
+            size_t lineCount() const;
             void setFilePosition(size_t lineNumber, size_t lineCount);
             bool containsLine(size_t lineNumber) const;
         public: // issue management
@@ -406,6 +409,7 @@ namespace TrenchBroom {
             
             virtual void doPick(const Ray3& ray, PickResult& pickResult) const = 0;
             virtual void doFindNodesContaining(const Vec3& point, NodeList& result) = 0;
+            virtual void doFindNodesIntersecting(const BBox3& bounds, NodeList& result) = 0;
             virtual FloatType doIntersectWithRay(const Ray3& ray) const = 0;
             
             virtual void doGenerateIssues(const IssueGenerator* generator, IssueList& issues) = 0;
@@ -0,0 +1,209 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NodeQueryBatch.h"
+
+#include "CollectionUtils.h"
+#include "ParallelTaskRunner.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/NodeVisitor.h"
+#include "Model/World.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Model {
+        class NodeQueryBatch::Test {
+        public:
+            virtual ~Test() {}
+            
+            bool matches(const Brush* brush, const Node* node) const {
+                return doMatches(brush, node);
+            }
+        private:
+            virtual bool doMatches(const Brush* brush, const Node* node) const = 0;
+        };
+        
+        class NodeQueryBatch::Touches : public NodeQueryBatch::Test {
+        private:
+            bool doMatches(const Brush* brush, const Node* node) const {
+                return brush->intersects(node);
+            }
+        };
+        
+        class NodeQueryBatch::IsContained : public NodeQueryBatch::Test {
+        private:
+            bool doMatches(const Brush* brush, const Node* node) const {
+                return brush->contains(node);
+            }
+        };
+        
+        /*
+         Collects the given node and those of its descendants whose bounds intersect the bounds of the given brush.
+         The children of a node are skipped if its bounds do not intersect. The geometry of the candidate brushes is
+         built here so that the exact tests do not have to modify any brush.
+         */
+        class NodeQueryBatch::CollectCandidates : public NodeVisitor {
+        private:
+            const Brush* m_brush;
+            CandidateList& m_candidates;
+        public:
+            CollectCandidates(const Brush* brush, CandidateList& candidates) :
+            m_brush(brush),
+            m_candidates(candidates) {}
+        private:
+            void doVisit(World* world)   {}
+            void doVisit(Layer* layer)   {}
+            void doVisit(Group* group)   { addCandidate(group); }
+            void doVisit(Entity* entity) { addCandidate(entity); }
+            void doVisit(Brush* brush)   { addCandidate(brush); }
+            
+            void addCandidate(Node* node) {
+                if (node == m_brush || !node->bounds().intersects(m_brush->bounds()))
+                    stopRecursion();
+                else
+                    m_candidates.push_back(std::make_pair(m_brush, node));
+            }
+        };
+        
+        /*
+         Collects the matching nodes in the order of the map. Only the candidates and their ancestors are visited,
+         since a node can only be a candidate if its parent is one, too. Matching nodes that are hidden or locked are
+         skipped, but their children are still visited because they can override the state of their parent.
+         */
+        class NodeQueryBatch::CollectMatches : public NodeVisitor {
+        private:
+            const NodeSet& m_candidates;
+            const NodeSet& m_matches;
+            NodeList m_result;
+        public:
+            CollectMatches(const NodeSet& candidates, const NodeSet& matches) :
+            m_candidates(candidates),
+            m_matches(matches) {}
+            
+            const NodeList& result() const {
+                return m_result;
+            }
+        private:
+            void doVisit(World* world)   {}
+            void doVisit(Layer* layer)   {}
+            void doVisit(Group* group)   { collect(group); }
+            void doVisit(Entity* entity) { collect(entity); }
+            void doVisit(Brush* brush)   { collect(brush); }
+            
+            void collect(Node* node) {
+                if (m_candidates.count(node) == 0)
+                    stopRecursion();
+                else if (m_matches.count(node) > 0 && (node->visible() || node->selected()) && node->editable())
+                    m_result.push_back(node);
+            }
+        };
+        
+        class NodeQueryBatch::TestCandidatesTask : public ParallelTask {
+        private:
+            const Test& m_test;
+            const CandidateList& m_candidates;
+            size_t m_begin;
+            size_t m_end;
+            NodeList m_matches;
+        public:
+            TestCandidatesTask(const Test& test, const CandidateList& candidates, const size_t begin, const size_t end) :
+            m_test(test),
+            m_candidates(candidates),
+            m_begin(begin),
+            m_end(end) {}
+            
+            const NodeList& matches() const {
+                return m_matches;
+            }
+        private:
+            void doRun() {
+                for (size_t i = m_begin; i < m_end; ++i) {
+                    const Candidate& candidate = m_candidates[i];
+                    if (m_test.matches(candidate.first, candidate.second))
+                        m_matches.push_back(candidate.second);
+                }
+            }
+        };
+        
+        const size_t NodeQueryBatch::CandidatesPerTask = 64;
+        
+        NodeQueryBatch::NodeQueryBatch(World* world, const ParallelTaskRunner& runner) :
+        m_world(world),
+        m_runner(runner) {
+            assert(m_world != NULL);
+        }
+        
+        NodeList NodeQueryBatch::findTouchingNodes(const BrushList& brushes) const {
+            return findMatchingNodes(brushes, Touches());
+        }
+        
+        NodeList NodeQueryBatch::findContainedNodes(const BrushList& brushes) const {
+            return findMatchingNodes(brushes, IsContained());
+        }
+        
+        NodeList NodeQueryBatch::findMatchingNodes(const BrushList& brushes, const Test& test) const {
+            CandidateList candidates;
+            BrushList::const_iterator bIt, bEnd;
+            for (bIt = brushes.begin(), bEnd = brushes.end(); bIt != bEnd; ++bIt) {
+                const Brush* brush = *bIt;
+                
+                NodeList layerChildren;
+                m_world->findLayerChildrenIntersecting(brush->bounds(), NULL, World::Filter_Hidden | World::Filter_Locked, layerChildren);
+                
+                CollectCandidates visitor(brush, candidates);
+                Node::acceptAndRecurse(layerChildren.begin(), layerChildren.end(), visitor);
+            }
+            
+            if (candidates.empty())
+                return EmptyNodeList;
+            
+            ParallelTask::List tasks;
+            for (size_t begin = 0; begin < candidates.size(); begin += CandidatesPerTask) {
+                const size_t end = std::min(begin + CandidatesPerTask, candidates.size());
+                tasks.push_back(new TestCandidatesTask(test, candidates, begin, end));
+            }
+            
+            m_runner.run(tasks);
+            
+            NodeSet matches;
+            ParallelTask::List::const_iterator tIt, tEnd;
+            for (tIt = tasks.begin(), tEnd = tasks.end(); tIt != tEnd; ++tIt) {
+                const TestCandidatesTask* task = static_cast<const TestCandidatesTask*>(*tIt);
+                matches.insert(task->matches().begin(), task->matches().end());
+            }
+            VectorUtils::clearAndDelete(tasks);
+            
+            if (matches.empty())
+                return EmptyNodeList;
+            
+            NodeSet candidateNodes;
+            CandidateList::const_iterator cIt, cEnd;
+            for (cIt = candidates.begin(), cEnd = candidates.end(); cIt != cEnd; ++cIt)
+                candidateNodes.insert(cIt->second);
+            
+            CollectMatches visitor(candidateNodes, matches);
+            m_world->acceptAndRecurse(visitor);
+            return visitor.result();
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_NodeQueryBatch
+#define TrenchBroom_NodeQueryBatch
+
+#include "TrenchBroom.h"
+#include "Model/ModelTypes.h"
+
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom {
+    class ParallelTaskRunner;
+    
+    namespace Model {
+        /*
+         Finds the nodes that touch or are contained in any of the given brushes. For each brush, the candidates are
+         the nodes whose bounds intersect the brush's bounds. They are gathered from the world's spatial index, and the
+         children of groups and entities are only considered if their parent is a candidate. The exact tests of the
+         candidates run concurrently on the given runner.
+         
+         The result contains every matching node once, in the order in which the nodes appear in the map. Nodes that
+         are hidden or locked are left out, since they cannot be selected.
+         */
+        class NodeQueryBatch {
+        private:
+            class Test;
+            class Touches;
+            class IsContained;
+            class CollectCandidates;
+            class CollectMatches;
+            class TestCandidatesTask;
+            
+            typedef std::pair<const Brush*, Node*> Candidate;
+            typedef std::vector<Candidate> CandidateList;
+            
+            static const size_t CandidatesPerTask;
+            
+            World* m_world;
+            const ParallelTaskRunner& m_runner;
+        public:
+            NodeQueryBatch(World* world, const ParallelTaskRunner& runner);
+            
+            NodeList findTouchingNodes(const BrushList& brushes) const;
+            NodeList findContainedNodes(const BrushList& brushes) const;
+        private:
+            NodeList findMatchingNodes(const BrushList& brushes, const Test& test) const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_NodeQueryBatch) */
@@ -1,18 +1,18 @@
 /*
  Copyright (C) 2010-2014 Kristian Duske
- 
+
  This file is part of TrenchBroom.
- 
+
  TrenchBroom is free software: you can redistribute it and/or modify
  it under the terms of the GNU General Public License as published by
  the Free Software Foundation, either version 3 of the License, or
  (at your option) any later version.
- 
+
  TrenchBroom is distributed in the hope that it will be useful,
  but WITHOUT ANY WARRANTY; without even the implied warranty of
  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  GNU General Public License for more details.
- 
+
  You should have received a copy of the GNU General Public License
  along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
  */
@@ -20,179 +20,204 @@
 #ifndef TrenchBroom_Octree
 #define TrenchBroom_Octree
 
-#include "CollectionUtils.h"
-#include "Macros.h"
 #include "VecMath.h"
 #include "Exceptions.h"
-#include "SharedPointer.h"
 
-#include <map>
+#include <cassert>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Model {
+        // The hash of an object stored in an octree. Objects are either integral values or pointers.
+        template <typename T>
+        struct OctreeObjectHash {
+            size_t operator()(const T object) const {
+                return static_cast<size_t>(object);
+            }
+        };
+        
+        template <typename T>
+        struct OctreeObjectHash<T*> {
+            size_t operator()(const T* object) const {
+                return reinterpret_cast<size_t>(object);
+            }
+        };
+        
+        /*
+         A loose octree. Every node has a cell, and the cells of the children of a node divide its cell into octants.
+         The loose bounds of a node extend its cell by half of the cell size on every side. An object is stored in the
+         deepest node whose cell contains the center of the object and whose loose bounds contain the object, so it
+         never sticks to a node only because it straddles the boundary of a cell.
+         
+         The nodes are kept in a pool and refer to each other by their index. Each node keeps a list of its objects,
+         and an object is removed from that list by swapping it with the last one. The node and the list position of
+         every object are found in a hash table.
+         */
         template <typename F, typename T>
-        class OctreeNode {
-        private:
+        class Octree {
+        public:
             typedef std::vector<T> List;
             
-            BBox<F,3> m_bounds;
-            F m_minSize;
-            OctreeNode* m_parent;
-            OctreeNode* m_children[8];
-            List m_objects;
-        public:
-            OctreeNode(const BBox<F,3>& bounds, const F minSize, OctreeNode* parent) :
-            m_bounds(bounds),
-            m_minSize(minSize),
-            m_parent(parent) {
-                for (size_t i = 0; i < 8; ++i)
-                    m_children[i] = NULL;
+            // Receives the objects of the nodes that a ray hits, see findObjects below.
+            class RayVisitor {
+            public:
+                virtual ~RayVisitor() {}
+                
+                void visit(T object) { doVisit(object); }
+                bool done(const F distance) const { return doDone(distance); }
+            private:
+                virtual void doVisit(T object) = 0;
+                // Returns whether none of the objects that the ray hits at the given distance or further matter anymore.
+                virtual bool doDone(F distance) const = 0;
+            };
+        private:
+            static const size_t NoNode = static_cast<size_t>(-1);
+            
+            static BBox<F,3> loose(const BBox<F,3>& cell) {
+                const Vec<F,3> margin = cell.size() / static_cast<F>(2.0);
+                return BBox<F,3>(cell.min - margin, cell.max + margin);
             }
             
-            ~OctreeNode() {
-                for (size_t i = 0; i < 8; ++i) {
-                    if (m_children[i] != NULL) {
-                        delete m_children[i];
-                        m_children[i] = NULL;
-                    }
+            struct Node {
+                BBox<F,3> cell;
+                BBox<F,3> looseBounds;
+                size_t parent;
+                size_t children[8];
+                // the number of objects in this node and all its descendants, so that empty subtrees can be skipped
+                size_t objectCount;
+                List objects;
+                
+                Node(const BBox<F,3>& i_cell, const size_t i_parent) :
+                cell(i_cell),
+                looseBounds(loose(i_cell)),
+                parent(i_parent),
+                objectCount(0) {
+                    for (size_t i = 0; i < 8; ++i)
+                        children[i] = NoNode;
                 }
-            }
+            };
             
-            bool contains(const BBox<F,3>& bounds) const {
-                return m_bounds.contains(bounds);
-            }
+            typedef std::vector<Node> NodePool;
             
-            bool containsObject(const BBox<F,3>& bounds, T object) const {
-                assert(contains(bounds));
-                for (size_t i = 0; i < 8; ++i) {
-                    if (m_children[i] != NULL && m_children[i]->contains(bounds)) {
-                        return m_children[i]->containsObject(bounds, object);
+            // The location of an object in the octree.
+            struct Entry {
+                T object;
+                size_t node;
+                size_t index;
+                bool used;
+                
+                Entry() :
+                object(),
+                node(NoNode),
+                index(0),
+                used(false) {}
+            };
+            
+            // An open addressing hash table with linear probing that maps objects to their location.
+            class ObjectMap {
+            private:
+                typedef std::vector<Entry> EntryList;
+                EntryList m_entries;
+                size_t m_size;
+            public:
+                ObjectMap() :
+                m_entries(16),
+                m_size(0) {}
+                
+                Entry* find(const T object) {
+                    size_t slot = home(object);
+                    while (m_entries[slot].used) {
+                        if (m_entries[slot].object == object)
+                            return &m_entries[slot];
+                        slot = next(slot);
                     }
+                    return NULL;
                 }
                 
-                typename List::const_iterator it = std::find(m_objects.begin(), m_objects.end(), object);
-                return it != m_objects.end();
-            }
-            
-            OctreeNode* addObject(const BBox<F,3>& bounds, T object) {
-                assert(contains(bounds));
+                const Entry* find(const T object) const {
+                    return const_cast<ObjectMap*>(this)->find(object);
+                }
                 
-                const Vec3f size = m_bounds.size();
-                if (size.x() > m_minSize || size.y() > m_minSize || size.z() > m_minSize) {
-                    for (size_t i = 0; i < 8; ++i) {
-                        if (m_children[i] != NULL && m_children[i]->contains(bounds)) {
-                            return m_children[i]->addObject(bounds, object);
-                        } else {
-                            const BBox<F,3> childBounds = octant(i);
-                            if (childBounds.contains(bounds)) {
-                                OctreeNode<F,T>* child = new OctreeNode<F,T>(childBounds, m_minSize, this);
-                                try {
-                                    OctreeNode* result = child->addObject(bounds, object);
-                                    m_children[i] = child;
-                                    return result;
-                                } catch (...) {
-                                    delete child;
-                                    throw;
-                                }
-                            }
+                bool insert(const T object, const size_t node, const size_t index) {
+                    if (2 * (m_size + 1) > m_entries.size())
+                        grow();
+                    
+                    size_t slot = home(object);
+                    while (m_entries[slot].used) {
+                        if (m_entries[slot].object == object)
+                            return false;
+                        slot = next(slot);
+                    }
+                    
+                    Entry& entry = m_entries[slot];
+                    entry.object = object;
+                    entry.node = node;
+                    entry.index = index;
+                    entry.used = true;
+                    ++m_size;
+                    return true;
+                }
+                
+                void erase(Entry* entry) {
+                    assert(entry != NULL && entry->used);
+                    
+                    // shift the following entries of the probe sequence back so that no tombstones are needed
+                    size_t hole = static_cast<size_t>(entry - &m_entries.front());
+                    size_t slot = next(hole);
+                    while (m_entries[slot].used) {
+                        const size_t slotHome = home(m_entries[slot].object);
+                        if (distance(slotHome, slot) >= distance(hole, slot)) {
+                            m_entries[hole] = m_entries[slot];
+                            hole = slot;
                         }
+                        slot = next(slot);
                     }
+                    m_entries[hole] = Entry();
+                    --m_size;
+                }
+            private:
+                size_t home(const T object) const {
+                    size_t hash = OctreeObjectHash<T>()(object);
+                    hash ^= hash >> 16;
+                    hash *= 0x45d9f3bu;
+                    hash ^= hash >> 16;
+                    return hash & (m_entries.size() - 1);
                 }
                 
-                assert(!VectorUtils::contains(m_objects, object));
-                m_objects.push_back(object);
-                return this;
-            }
-            
-            bool removeObject(T object) {
-                typename List::iterator it = std::find(m_objects.begin(), m_objects.end(), object);
-                if (it == m_objects.end())
-                    return false;
-                m_objects.erase(it);
-                return true;
-            }
-
-            OctreeNode* findContaining(const BBox<F,3>& bounds) {
-                if (contains(bounds))
-                    return this;
-                if (m_parent == NULL)
-                    return NULL;
-                return m_parent->findContaining(bounds);
-            }
-            
-            void findObjects(const Ray<F,3>& ray, List& result) const {
-                const F distance = m_bounds.intersectWithRay(ray);
-                if (Math::isnan(distance))
-                    return;
+                size_t next(const size_t slot) const {
+                    return (slot + 1) & (m_entries.size() - 1);
+                }
                 
-                for (size_t i = 0; i < 8; ++i)
-                    if (m_children[i] != NULL)
-                        m_children[i]->findObjects(ray, result);
-                result.insert(result.end(), m_objects.begin(), m_objects.end());
-            }
-            
-            void findObjects(const Vec<F,3>& point, List& result) const {
-                if (!m_bounds.contains(point))
-                    return;
+                size_t distance(const size_t from, const size_t to) const {
+                    return (to - from) & (m_entries.size() - 1);
+                }
                 
-                for (size_t i = 0; i < 8; ++i)
-                    if (m_children[i] != NULL)
-                        m_children[i]->findObjects(point, result);
-                result.insert(result.end(), m_objects.begin(), m_objects.end());
-            }
-        private:
-            BBox<F,3> octant(const size_t index) const {
-                const Vec3f& min = m_bounds.min;
-                const Vec3f& max = m_bounds.max;
-                const Vec3f mid = (min + max) / 2.0f;
-                switch (index) {
-                    case 0: // xyz +++
-                        return BBox<F,3>(mid, max);
-                    case 1: // xyz -++
-                        return BBox<F,3>(Vec3f(min.x(), mid.y(), mid.z()),
-                                      Vec3f(mid.x(), max.y(), max.z()));
-                    case 2: // xyz +-+
-                        return BBox<F,3>(Vec3f(mid.x(), min.y(), mid.z()),
-                                      Vec3f(max.x(), mid.y(), max.z()));
-                    case 3: // xyz --+
-                        return BBox<F,3>(Vec3f(min.x(), min.y(), mid.z()),
-                                      Vec3f(mid.x(), mid.y(), max.z()));
-                    case 4: // xyz ++-
-                        return BBox<F,3>(Vec3f(mid.x(), mid.y(), min.z()),
-                                      Vec3f(max.x(), max.y(), mid.z()));
-                    case 5: // xyz -+-
-                        return BBox<F,3>(Vec3f(min.x(), mid.y(), min.z()),
-                                      Vec3f(mid.x(), max.y(), mid.z()));
-                    case 6: // xyz +--
-                        return BBox<F,3>(Vec3f(mid.x(), min.y(), min.z()),
-                                      Vec3f(max.x(), mid.y(), mid.z()));
-                    case 7: // xyz ---
-                        return BBox<F,3>(Vec3f(min.x(), min.y(), min.z()),
-                                      Vec3f(mid.x(), mid.y(), mid.z()));
-                    default:
-                        assert(false);
-                        return BBox<F,3>();
+                void grow() {
+                    EntryList entries(2 * m_entries.size());
+                    using std::swap;
+                    swap(m_entries, entries);
+                    m_size = 0;
+                    
+                    typename EntryList::const_iterator it, end;
+                    for (it = entries.begin(), end = entries.end(); it != end; ++it) {
+                        if (it->used)
+                            insert(it->object, it->node, it->index);
+                    }
                 }
-            }
-        };
-        
-        template <typename F, typename T>
-        class Octree {
-        public:
-            typedef std::vector<T> List;
-        private:
-            typedef std::map<T, OctreeNode<F,T>*> ObjectMap;
+            };
+            
             BBox<F,3> m_bounds;
-            OctreeNode<F,T>* m_root;
+            F m_minSize;
+            NodePool m_nodes;
             ObjectMap m_objectMap;
+            // incremented by every change so that a traversal can detect changes made while it visits objects
+            size_t m_revision;
         public:
             Octree(const BBox<F,3>& bounds, const F minSize) :
             m_bounds(bounds),
-            m_root(new OctreeNode<F,T>(bounds, minSize, NULL)) {}
-            
-            ~Octree() {
-                delete m_root;
+            m_minSize(minSize),
+            m_revision(0) {
+                m_nodes.push_back(Node(bounds, NoNode));
             }
             
             const BBox<F,3>& bounds() const {
@@ -200,61 +225,272 @@ namespace TrenchBroom {
             }
             
             void addObject(const BBox<F,3>& bounds, T object) {
-                if (!m_root->contains(bounds))
+                if (!m_bounds.contains(bounds))
                     throw OctreeException("Object is too large for this octree");
+                if (m_objectMap.find(object) != NULL)
+                    throw OctreeException("Object is already in octree");
+                ++m_revision;
                 
-                OctreeNode<F,T>* node = m_root->addObject(bounds, object);
-                if (node == NULL)
-                    throw OctreeException("Unknown error when inserting into octree");
-                assertResult(MapUtils::insertOrFail(m_objectMap, object, node));
+                const size_t node = findOrCreateNode(0, bounds, bounds.center());
+                m_objectMap.insert(object, node, m_nodes[node].objects.size());
+                insertIntoNode(node, object);
             }
             
             void removeObject(T object) {
-                typename ObjectMap::iterator it = m_objectMap.find(object);
-                if (it == m_objectMap.end())
+                Entry* entry = m_objectMap.find(object);
+                if (entry == NULL)
                     throw OctreeException("Cannot find object in octree");
+                ++m_revision;
                 
-                OctreeNode<F,T>* node = it->second;
-                if (!node->removeObject(object))
-                    throw OctreeException("Cannot find object in octree");
-                m_objectMap.erase(it);
+                removeFromNode(entry->node, entry->index);
+                m_objectMap.erase(entry);
             }
             
             void updateObject(const BBox<F,3>& bounds, T object) {
-                typename ObjectMap::iterator it = m_objectMap.find(object);
-                if (it == m_objectMap.end())
+                Entry* entry = m_objectMap.find(object);
+                if (entry == NULL)
                     throw OctreeException("Cannot find object in octree");
-
-                OctreeNode<F,T>* oldNode = it->second;
-                if (!oldNode->removeObject(object))
-                    throw OctreeException("Cannot find object in octree");
-                
-                OctreeNode<F,T>* newAncestor = oldNode->findContaining(bounds);
-                if (newAncestor == NULL)
+                if (!m_bounds.contains(bounds))
                     throw OctreeException("Cannot find new ancestor node in octree");
-                OctreeNode<F,T>* newParent = newAncestor->addObject(bounds, object);
-                if (newParent == NULL)
-                    throw OctreeException("Unknown error when inserting into octree");
-                MapUtils::insertOrReplace(m_objectMap, object, newParent);
+                ++m_revision;
+                
+                // Small changes of the bounds usually keep the object in its node or move it to a neighbour, so the
+                // search starts at the current node and only goes up as far as necessary.
+                const Vec<F,3> center = bounds.center();
+                size_t start = entry->node;
+                while (!canHold(m_nodes[start], bounds, center))
+                    start = m_nodes[start].parent;
+                
+                const size_t newNode = findOrCreateNode(start, bounds, center);
+                if (newNode == entry->node)
+                    return;
+                
+                const size_t oldNode = entry->node;
+                const size_t oldIndex = entry->index;
+                entry->node = newNode;
+                entry->index = m_nodes[newNode].objects.size();
+                insertIntoNode(newNode, object);
+                removeFromNode(oldNode, oldIndex);
             }
             
             bool containsObject(const BBox<F,3>& bounds, T object) const {
-                if (!m_root->contains(bounds))
+                if (!m_bounds.contains(bounds))
                     return false;
-                return m_root->containsObject(bounds, object);
+                const Entry* entry = m_objectMap.find(object);
+                return entry != NULL && entry->node == findNode(bounds);
             }
             
             List findObjects(const Ray<F,3>& ray) const {
                 List result;
-                m_root->findObjects(ray, result);
+                findObjects(0, ray, ray.inverseDirection(), result);
                 return result;
             }
             
+            /*
+             Passes the objects of all nodes that the given ray hits to the given visitor. The children of every node
+             are visited in the order in which the ray enters them. An object is always hit no nearer than where the ray
+             enters its node, so the traversal skips every node that the ray enters at a distance where the visitor is
+             done. The visitor must not add, remove or update any objects.
+             */
+            void findObjects(const Ray<F,3>& ray, RayVisitor& visitor) const {
+                const Vec<F,3> inverseDirection = ray.inverseDirection();
+                const F distance = m_nodes[0].looseBounds.entryDistance(ray, inverseDirection);
+                if (!Math::isnan(distance))
+                    findObjects(0, distance, ray, inverseDirection, visitor);
+            }
+            
             List findObjects(const Vec<F,3>& point) const {
                 List result;
-                m_root->findObjects(point, result);
+                findObjects(0, point, result);
+                return result;
+            }
+            
+            // Returns the objects of all nodes that intersect the given bounds. The objects' own bounds may not intersect.
+            List findObjects(const BBox<F,3>& bounds) const {
+                List result;
+                findObjects(0, bounds, result);
+                return result;
+            }
+        private:
+            /*
+             Returns the index of the octant of the given cell that contains the given point. Points on the boundary
+             between two octants belong to the upper one.
+             */
+            static size_t octantIndex(const BBox<F,3>& cell, const Vec<F,3>& point) {
+                const Vec<F,3> mid = cell.center();
+                size_t index = 0;
+                for (size_t i = 0; i < 3; ++i) {
+                    if (point[i] < mid[i])
+                        index |= (static_cast<size_t>(1) << i);
+                }
+                return index;
+            }
+            
+            static BBox<F,3> octant(const BBox<F,3>& cell, const size_t index) {
+                const Vec<F,3> mid = cell.center();
+                BBox<F,3> result;
+                for (size_t i = 0; i < 3; ++i) {
+                    if ((index & (static_cast<size_t>(1) << i)) != 0) {
+                        result.min[i] = cell.min[i];
+                        result.max[i] = mid[i];
+                    } else {
+                        result.min[i] = mid[i];
+                        result.max[i] = cell.max[i];
+                    }
+                }
                 return result;
             }
+            
+            bool canSplit(const Node& node) const {
+                const Vec<F,3> size = node.cell.size();
+                return size.x() > m_minSize || size.y() > m_minSize || size.z() > m_minSize;
+            }
+            
+            // Returns the node where an object with the given bounds is stored, or NoNode if that node does not exist.
+            size_t findNode(const BBox<F,3>& bounds) const {
+                const Vec<F,3> center = bounds.center();
+                size_t current = 0;
+                while (canSplit(m_nodes[current])) {
+                    const size_t index = octantIndex(m_nodes[current].cell, center);
+                    const size_t child = m_nodes[current].children[index];
+                    if (child == NoNode)
+                        return loose(octant(m_nodes[current].cell, index)).contains(bounds) ? NoNode : current;
+                    if (!m_nodes[child].looseBounds.contains(bounds))
+                        return current;
+                    current = child;
+                }
+                return current;
+            }
+            
+            /*
+             Returns whether an object with the given bounds and center is stored in the given node or one of its
+             descendants. The root node can hold every object within the bounds of the octree.
+             */
+            bool canHold(const Node& node, const BBox<F,3>& bounds, const Vec<F,3>& center) const {
+                if (!node.looseBounds.contains(bounds))
+                    return false;
+                for (size_t i = 0; i < 3; ++i) {
+                    if (center[i] < node.cell.min[i])
+                        return false;
+                    if (center[i] >= node.cell.max[i] && node.cell.max[i] < m_bounds.max[i])
+                        return false;
+                }
+                return true;
+            }
+            
+            size_t findOrCreateNode(const size_t start, const BBox<F,3>& bounds, const Vec<F,3>& center) {
+                size_t current = start;
+                while (canSplit(m_nodes[current])) {
+                    const size_t index = octantIndex(m_nodes[current].cell, center);
+                    const BBox<F,3> childCell = octant(m_nodes[current].cell, index);
+                    if (!loose(childCell).contains(bounds))
+                        return current;
+                    
+                    size_t child = m_nodes[current].children[index];
+                    if (child == NoNode) {
+                        child = m_nodes.size();
+                        m_nodes.push_back(Node(childCell, current));
+                        m_nodes[current].children[index] = child;
+                    }
+                    current = child;
+                }
+                return current;
+            }
+            
+            void insertIntoNode(const size_t node, T object) {
+                m_nodes[node].objects.push_back(object);
+                for (size_t current = node; current != NoNode; current = m_nodes[current].parent)
+                    ++m_nodes[current].objectCount;
+            }
+            
+            void removeFromNode(const size_t node, const size_t index) {
+                List& objects = m_nodes[node].objects;
+                assert(index < objects.size());
+                
+                if (index + 1 < objects.size()) {
+                    objects[index] = objects.back();
+                    Entry* moved = m_objectMap.find(objects[index]);
+                    assert(moved != NULL);
+                    moved->index = index;
+                }
+                objects.pop_back();
+                
+                for (size_t current = node; current != NoNode; current = m_nodes[current].parent)
+                    --m_nodes[current].objectCount;
+            }
+            
+            void findObjects(const size_t index, const Ray<F,3>& ray, const Vec<F,3>& inverseDirection, List& result) const {
+                const Node& node = m_nodes[index];
+                if (node.objectCount == 0 || Math::isnan(node.looseBounds.entryDistance(ray, inverseDirection)))
+                    return;
+                
+                result.insert(result.end(), node.objects.begin(), node.objects.end());
+                for (size_t i = 0; i < 8; ++i)
+                    if (node.children[i] != NoNode)
+                        findObjects(node.children[i], ray, inverseDirection, result);
+            }
+            
+            void findObjects(const size_t index, const F distance, const Ray<F,3>& ray, const Vec<F,3>& inverseDirection, RayVisitor& visitor) const {
+                if (visitor.done(distance))
+                    return;
+                
+                // The objects are visited in place, so the visitor must not change the octree.
+                const Node& node = m_nodes[index];
+#ifndef NDEBUG
+                const size_t revision = m_revision;
+#endif
+                typename List::const_iterator it, end;
+                for (it = node.objects.begin(), end = node.objects.end(); it != end; ++it) {
+                    visitor.visit(*it);
+                    assert(m_revision == revision);
+                }
+                
+                // sort the children that the ray hits by their entry distance
+                size_t children[8];
+                F distances[8];
+                size_t count = 0;
+                for (size_t i = 0; i < 8; ++i) {
+                    const size_t child = node.children[i];
+                    if (child != NoNode && m_nodes[child].objectCount > 0) {
+                        const F childDistance = m_nodes[child].looseBounds.entryDistance(ray, inverseDirection);
+                        if (!Math::isnan(childDistance)) {
+                            size_t j = count++;
+                            while (j > 0 && distances[j - 1] > childDistance) {
+                                children[j] = children[j - 1];
+                                distances[j] = distances[j - 1];
+                                --j;
+                            }
+                            children[j] = child;
+                            distances[j] = childDistance;
+                        }
+                    }
+                }
+                
+                for (size_t i = 0; i < count; ++i)
+                    findObjects(children[i], distances[i], ray, inverseDirection, visitor);
+            }
+            
+            void findObjects(const size_t index, const Vec<F,3>& point, List& result) const {
+                const Node& node = m_nodes[index];
+                if (node.objectCount == 0 || !node.looseBounds.contains(point))
+                    return;
+                
+                result.insert(result.end(), node.objects.begin(), node.objects.end());
+                for (size_t i = 0; i < 8; ++i)
+                    if (node.children[i] != NoNode)
+                        findObjects(node.children[i], point, result);
+            }
+            
+            void findObjects(const size_t index, const BBox<F,3>& bounds, List& result) const {
+                const Node& node = m_nodes[index];
+                if (node.objectCount == 0 || !node.looseBounds.intersects(bounds))
+                    return;
+                
+                result.insert(result.end(), node.objects.begin(), node.objects.end());
+                for (size_t i = 0; i < 8; ++i)
+                    if (node.children[i] != NoNode)
+                        findObjects(node.children[i], bounds, result);
+            }
         };
     }
 }
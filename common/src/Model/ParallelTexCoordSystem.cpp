@@ -87,6 +87,10 @@ namespace TrenchBroom {
             return (computeTexCoords(point, attribs.scale()) + attribs.offset()) / attribs.textureSize();
         }
         
+        void ParallelTexCoordSystem::doGetTexCoords(const Vec3* points, const size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const {
+            computeTexCoords(points, count, attribs.scale(), attribs.offset(), attribs.textureSize(), texCoords);
+        }
+        
         void ParallelTexCoordSystem::doSetRotation(const Vec3& normal, const float oldAngle, const float newAngle) {
             const float angleDelta = newAngle - oldAngle;
             if (angleDelta == 0.0f)
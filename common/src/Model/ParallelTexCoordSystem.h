@@ -63,6 +63,7 @@ namespace TrenchBroom {
 
             bool isRotationInverted(const Vec3& normal) const;
             Vec2f doGetTexCoords(const Vec3& point, const BrushFaceAttributes& attribs) const;
+            void doGetTexCoords(const Vec3* points, size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const;
             
             void doSetRotation(const Vec3& normal, float oldAngle, float newAngle);
             void applyRotation(const Vec3& normal, FloatType angle);
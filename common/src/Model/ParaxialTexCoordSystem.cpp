@@ -101,6 +101,10 @@ namespace TrenchBroom {
             return (computeTexCoords(point, attribs.scale()) + attribs.offset()) / attribs.textureSize();
         }
         
+        void ParaxialTexCoordSystem::doGetTexCoords(const Vec3* points, const size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const {
+            computeTexCoords(points, count, attribs.scale(), attribs.offset(), attribs.textureSize(), texCoords);
+        }
+        
         void ParaxialTexCoordSystem::doSetRotation(const Vec3& normal, const float oldAngle, const float newAngle) {
             m_index = planeNormalIndex(normal);
             axes(m_index, m_xAxis, m_yAxis);
@@ -56,6 +56,7 @@ namespace TrenchBroom {
 
             bool isRotationInverted(const Vec3& normal) const;
             Vec2f doGetTexCoords(const Vec3& point, const BrushFaceAttributes& attribs) const;
+            void doGetTexCoords(const Vec3* points, size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const;
             
             void doSetRotation(const Vec3& normal, float oldAngle, float newAngle);
             void doTransform(const Plane3& oldBoundary, const Mat4x4& transformation, BrushFaceAttributes& attribs, bool lockTexture, const Vec3& invariant);
@@ -20,6 +20,9 @@
 #include "PickResult.h"
 
 #include "Model/CompareHits.h"
+#include "Model/EditorContext.h"
+#include "Model/HitAdapter.h"
+#include "Model/HitFilter.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -33,7 +36,9 @@ namespace TrenchBroom {
         
         PickResult::PickResult() :
         m_editorContext(NULL),
-        m_compare(new CompareHitsByDistance()) {}
+        m_compare(new CompareHitsByDistance()),
+        m_maxHits(std::numeric_limits<size_t>::max()),
+        m_maxHitsTypeMask(Hit::AnyType) {}
 
         PickResult PickResult::byDistance(const EditorContext& editorContext) {
             CompareHits* compare = new CombineCompareHits(new CompareHitsByDistance(),
@@ -45,6 +50,14 @@ namespace TrenchBroom {
             return PickResult(editorContext, new CompareHitsBySize(axis));
         }
 
+        PickResult PickResult::firstByDistance(const EditorContext& editorContext, const Hit::HitType typeMask, const size_t maxHits) {
+            assert(maxHits > 0);
+            PickResult result = byDistance(editorContext);
+            result.m_maxHits = maxHits;
+            result.m_maxHitsTypeMask = typeMask;
+            return result;
+        }
+
         bool PickResult::empty() const {
             return m_hits.empty();
         }
@@ -55,8 +68,33 @@ namespace TrenchBroom {
         
         void PickResult::addHit(const Hit& hit) {
             assert(m_compare != NULL);
+            if (m_maxHits < std::numeric_limits<size_t>::max()) {
+                // only the hits that the caller will query for may count towards the maximum
+                if (complete(hit.distance()) || !hit.hasType(m_maxHitsTypeMask))
+                    return;
+                if (m_editorContext != NULL) {
+                    const Node* node = hitToNode(hit);
+                    if (node != NULL && !m_editorContext->visible(node))
+                        return;
+                    if (!ContextHitFilter(*m_editorContext).matches(hit))
+                        return;
+                }
+            }
+            
             Hit::List::iterator pos = std::upper_bound(m_hits.begin(), m_hits.end(), hit, CompareWrapper(m_compare.get()));
             m_hits.insert(pos, hit);
+            
+            if (m_hits.size() > m_maxHits) {
+                const FloatType lastDistance = lastKeptHit().distance();
+                while (m_hits.size() > m_maxHits && !Math::eq(m_hits.back().distance(), lastDistance))
+                    m_hits.pop_back();
+            }
+        }
+        
+        bool PickResult::complete(const FloatType distance) const {
+            if (m_hits.size() < m_maxHits)
+                return false;
+            return Math::lt(lastKeptHit().distance(), distance);
         }
         
         const Hit::List& PickResult::all() const {
@@ -68,5 +106,12 @@ namespace TrenchBroom {
                 return HitQuery(m_hits, *m_editorContext);
             return HitQuery(m_hits);
         }
+        
+        const Hit& PickResult::lastKeptHit() const {
+            assert(m_hits.size() >= m_maxHits);
+            Hit::List::const_iterator it = m_hits.begin();
+            std::advance(it, m_maxHits - 1);
+            return *it;
+        }
     }
 }
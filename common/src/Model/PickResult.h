@@ -25,6 +25,8 @@
 #include "Model/Hit.h"
 #include "Model/HitQuery.h"
 
+#include <limits>
+
 namespace TrenchBroom {
     namespace Model {
         class CompareHits;
@@ -38,24 +40,38 @@ namespace TrenchBroom {
             const EditorContext* m_editorContext;
             Hit::List m_hits;
             ComparePtr m_compare;
+            size_t m_maxHits;
+            Hit::HitType m_maxHitsTypeMask;
             class CompareWrapper;
         public:
             PickResult(const EditorContext& editorContext, CompareHits* compare) :
             m_editorContext(&editorContext),
-            m_compare(compare) {}
+            m_compare(compare),
+            m_maxHits(std::numeric_limits<size_t>::max()),
+            m_maxHitsTypeMask(Hit::AnyType) {}
 
             PickResult();
 
             static PickResult byDistance(const EditorContext& editorContext);
             static PickResult bySize(const EditorContext& editorContext, Math::Axis::Type axis);
+            /*
+             Keeps only the given number of nearest pickable hits of the given types, and any further such hits at the
+             same distance as the last of them. All other hits are dropped, so this yields the same first hit as a
+             query for pickable hits of these types on a full pick result.
+             */
+            static PickResult firstByDistance(const EditorContext& editorContext, Hit::HitType typeMask, size_t maxHits);
 
             bool empty() const;
             size_t size() const;
 
             void addHit(const Hit& hit);
+            // Returns whether a hit at the given distance or further would not be kept.
+            bool complete(FloatType distance) const;
 
             const Hit::List& all() const;
             HitQuery query() const;
+        private:
+            const Hit& lastKeptHit() const;
         };
     }
 }
@@ -22,6 +22,10 @@
 #include "Assets/Texture.h"
 #include "Model/BrushFace.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace TrenchBroom {
     namespace Model {
         TexCoordSystemSnapshot::~TexCoordSystemSnapshot() {}
@@ -64,6 +68,10 @@ namespace TrenchBroom {
             return doGetTexCoords(point, attribs);
         }
         
+        void TexCoordSystem::getTexCoords(const Vec3* points, const size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const {
+            doGetTexCoords(points, count, attribs, texCoords);
+        }
+        
         void TexCoordSystem::setRotation(const Vec3& normal, const float oldAngle, const float newAngle) {
             doSetRotation(normal, oldAngle, newAngle);
         }
@@ -232,5 +240,39 @@ namespace TrenchBroom {
                          point.dot(safeScaleAxis(getYAxis(), scale.y())));
         }
         
+        /*
+         Computes the same texture coordinates as (computeTexCoords(point, scale) + offset) / textureSize for every
+         point, but the scaled axes are computed only once. The dot products are summed up in the same order as in
+         Vec::dot, so that the results are identical.
+         */
+        void TexCoordSystem::computeTexCoords(const Vec3* points, const size_t count, const Vec2f& scale, const Vec2f& offset, const Vec2f& textureSize, Vec2f* texCoords) const {
+            const Vec3 xAxis = safeScaleAxis(getXAxis(), scale.x());
+            const Vec3 yAxis = safeScaleAxis(getYAxis(), scale.y());
+            
+#ifdef __SSE2__
+            // every point is projected onto both axes at once, so each register holds one component of both axes
+            const __m128d axesX = _mm_setr_pd(xAxis.x(), yAxis.x());
+            const __m128d axesY = _mm_setr_pd(xAxis.y(), yAxis.y());
+            const __m128d axesZ = _mm_setr_pd(xAxis.z(), yAxis.z());
+            const __m128 offsets = _mm_setr_ps(offset.x(), offset.y(), 0.0f, 0.0f);
+            const __m128 sizes = _mm_setr_ps(textureSize.x(), textureSize.y(), 1.0f, 1.0f);
+            
+            for (size_t i = 0; i < count; ++i) {
+                const Vec3& point = points[i];
+                __m128d projection = _mm_add_pd(_mm_setzero_pd(), _mm_mul_pd(_mm_set1_pd(point.x()), axesX));
+                projection = _mm_add_pd(projection, _mm_mul_pd(_mm_set1_pd(point.y()), axesY));
+                projection = _mm_add_pd(projection, _mm_mul_pd(_mm_set1_pd(point.z()), axesZ));
+                
+                const __m128 texCoord = _mm_div_ps(_mm_add_ps(_mm_cvtpd_ps(projection), offsets), sizes);
+                _mm_storel_pi(reinterpret_cast<__m64*>(&texCoords[i][0]), texCoord);
+            }
+#else
+            for (size_t i = 0; i < count; ++i) {
+                const Vec2f projection(points[i].dot(xAxis), points[i].dot(yAxis));
+                texCoords[i] = (projection + offset) / textureSize;
+            }
+#endif
+        }
+        
     }
 }
@@ -54,6 +54,8 @@ namespace TrenchBroom {
             void resetTextureAxesToParallel(const Vec3& normal, float angle);
             
             Vec2f getTexCoords(const Vec3& point, const BrushFaceAttributes& attribs) const;
+            // computes the texture coordinates of count points at once and writes them to texCoords
+            void getTexCoords(const Vec3* points, size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const;
             
             void setRotation(const Vec3& normal, float oldAngle, float newAngle);
             void transform(const Plane3& oldBoundary, const Mat4x4& transformation, BrushFaceAttributes& attribs, bool lockTexture, const Vec3& invariant);
@@ -80,6 +82,7 @@ namespace TrenchBroom {
 
             virtual bool isRotationInverted(const Vec3& normal) const = 0;
             virtual Vec2f doGetTexCoords(const Vec3& point, const BrushFaceAttributes& attribs) const = 0;
+            virtual void doGetTexCoords(const Vec3* points, size_t count, const BrushFaceAttributes& attribs, Vec2f* texCoords) const = 0;
             
             virtual void doSetRotation(const Vec3& normal, float oldAngle, float newAngle) = 0;
             virtual void doTransform(const Plane3& oldBoundary, const Mat4x4& transformation, BrushFaceAttributes& attribs, bool lockTexture, const Vec3& invariant) = 0;
@@ -90,6 +93,7 @@ namespace TrenchBroom {
             virtual float doMeasureAngle(float currentAngle, const Vec2f& center, const Vec2f& point) const = 0;
         protected:
             Vec2f computeTexCoords(const Vec3& point, const Vec2f& scale) const;
+            void computeTexCoords(const Vec3* points, size_t count, const Vec2f& scale, const Vec2f& offset, const Vec2f& textureSize, Vec2f* texCoords) const;
 
             template <typename T>
             T safeScale(const T value) const {
@@ -20,6 +20,7 @@
 #include "TransformObjectVisitor.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushGeometryBatch.h"
 #include "Model/Entity.h"
 #include "Model/Group.h"
 
@@ -30,10 +31,15 @@ namespace TrenchBroom {
         m_lockTextures(lockTextures),
         m_worldBounds(worldBounds) {}
 
+        void TransformObjectVisitor::transformBrushes(const ParallelTaskRunner& runner) {
+            const BrushGeometryBatch batch(m_worldBounds, runner);
+            batch.transform(m_brushes, m_transformation, m_lockTextures);
+        }
+
         void TransformObjectVisitor::doVisit(World* world)   {}
         void TransformObjectVisitor::doVisit(Layer* layer)   {}
-        void TransformObjectVisitor::doVisit(Group* group)   {  group->transform(m_transformation, m_lockTextures, m_worldBounds); }
+        void TransformObjectVisitor::doVisit(Group* group)   { group->iterate(*this); }
         void TransformObjectVisitor::doVisit(Entity* entity) { entity->transform(m_transformation, m_lockTextures, m_worldBounds); }
-        void TransformObjectVisitor::doVisit(Brush* brush)   {  brush->transform(m_transformation, m_lockTextures, m_worldBounds); }
+        void TransformObjectVisitor::doVisit(Brush* brush)   { m_brushes.push_back(brush); }
     }
 }
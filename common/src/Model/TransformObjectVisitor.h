@@ -22,17 +22,25 @@
 
 #include "TrenchBroom.h"
 #include "VecMath.h"
+#include "Model/ModelTypes.h"
 #include "Model/NodeVisitor.h"
 
 namespace TrenchBroom {
+    class ParallelTaskRunner;
+    
     namespace Model {
         class TransformObjectVisitor : public NodeVisitor {
         private:
             const Mat4x4d& m_transformation;
             bool m_lockTextures;
             const BBox3& m_worldBounds;
+            BrushList m_brushes;
         public:
             TransformObjectVisitor(const Mat4x4d& transformation, bool lockTextures, const BBox3& worldBounds);
+            
+            // The visited brushes, including those in groups, are only collected. Call this after visiting to transform
+            // them all in one batch. Brush entities transform their brushes themselves.
+            void transformBrushes(const ParallelTaskRunner& runner);
         private:
             void doVisit(World* world);
             void doVisit(Layer* layer);
@@ -28,6 +28,7 @@
 #include "Model/IssueGenerator.h"
 #include "Model/Layer.h"
 #include "Model/NodeVisitor.h"
+#include "Model/PickResult.h"
 
 #include <cassert>
 
@@ -35,7 +36,8 @@ namespace TrenchBroom {
     namespace Model {
         World::World(MapFormat::Type mapFormat, const BrushContentTypeBuilder* brushContentTypeBuilder, const BBox3& worldBounds) :
         m_factory(mapFormat, brushContentTypeBuilder),
-        m_defaultLayer(NULL) {
+        m_defaultLayer(NULL),
+        m_nodeTree(worldBounds, static_cast<FloatType>(64.0f)) {
             addOrUpdateAttribute(AttributeNames::Classname, AttributeValues::WorldspawnClassname);
             createDefaultLayer(worldBounds);
         }
@@ -63,6 +65,104 @@ namespace TrenchBroom {
             addChild(m_defaultLayer);
         }
 
+        class World::PickNodes : public NodeTree::RayVisitor {
+        private:
+            const Ray3& m_ray;
+            const Layer* m_layer;
+            LayerChildFilter m_filter;
+            PickResult& m_pickResult;
+        public:
+            PickNodes(const Ray3& ray, const Layer* layer, const LayerChildFilter filter, PickResult& pickResult) :
+            m_ray(ray),
+            m_layer(layer),
+            m_filter(filter),
+            m_pickResult(pickResult) {}
+        private:
+            void doVisit(Node* node) {
+                if (accepts(node, m_layer, m_filter))
+                    node->pick(m_ray, m_pickResult);
+            }
+            
+            bool doDone(const FloatType distance) const { return m_pickResult.complete(distance); }
+        };
+
+        void World::pickLayerChildren(const Ray3& ray, const Layer* layer, const LayerChildFilter filter, PickResult& pickResult) const {
+            PickNodes visitor(ray, layer, filter, pickResult);
+            m_nodeTree.findObjects(ray, visitor);
+        }
+        
+        void World::findLayerChildrenContaining(const Vec3& point, const Layer* layer, const LayerChildFilter filter, NodeList& result) const {
+            const NodeList candidates = m_nodeTree.findObjects(point);
+            NodeList::const_iterator it, end;
+            for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+                Node* node = *it;
+                if (node->bounds().contains(point) && accepts(node, layer, filter))
+                    result.push_back(node);
+            }
+        }
+
+        void World::findLayerChildrenIntersecting(const BBox3& bounds, const Layer* layer, const LayerChildFilter filter, NodeList& result) const {
+            const NodeList candidates = m_nodeTree.findObjects(bounds);
+            NodeList::const_iterator it, end;
+            for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+                Node* node = *it;
+                if (node->bounds().intersects(bounds) && accepts(node, layer, filter))
+                    result.push_back(node);
+            }
+        }
+        
+        void World::layerChildWasAdded(Node* node) {
+            m_nodeTree.addObject(node->bounds(), node);
+        }
+        
+        void World::layerChildWillBeRemoved(Node* node) {
+            m_nodeTree.removeObject(node);
+        }
+        
+        void World::layerChildBoundsDidChange(Node* node) {
+            m_nodeTree.updateObject(node->bounds(), node);
+        }
+
+        bool World::accepts(const Node* node, const Layer* layer, const LayerChildFilter filter) {
+            if (layer != NULL && node->parent() != layer)
+                return false;
+            return filter == Filter_None || containsMatchingNode(node, filter);
+        }
+        
+        bool World::containsMatchingNode(const Node* node, const LayerChildFilter filter) {
+            const bool shown = (filter & Filter_Hidden) == 0 || node->visible() || node->selected();
+            const bool editable = (filter & Filter_Locked) == 0 || node->editable();
+            if (shown && editable)
+                return true;
+            
+            const NodeList& children = node->children();
+            NodeList::const_iterator it, end;
+            for (it = children.begin(), end = children.end(); it != end; ++it) {
+                const Node* child = *it;
+                if (containsMatchingNode(child, filter))
+                    return true;
+            }
+            return false;
+        }
+
+        void World::addLayerToNodeTree(const Layer* layer) {
+            const NodeList& children = layer->children();
+            NodeList::const_iterator it, end;
+            for (it = children.begin(), end = children.end(); it != end; ++it) {
+                Node* node = *it;
+                m_nodeTree.addObject(node->bounds(), node);
+            }
+        }
+        
+        void World::removeLayerFromNodeTree(const Layer* layer) {
+            const NodeList& children = layer->children();
+            NodeList::const_iterator it, end;
+            for (it = children.begin(), end = children.end(); it != end; ++it) {
+                Node* node = *it;
+                m_nodeTree.removeObject(node);
+            }
+        }
+
         const IssueGeneratorList& World::registeredIssueGenerators() const {
             return m_issueGeneratorRegistry.registeredGenerators();
         }
@@ -171,21 +271,39 @@ namespace TrenchBroom {
             return false;
         }
 
+        void World::doChildWasAdded(Node* node) {
+            addLayerToNodeTree(static_cast<const Layer*>(node));
+        }
+        
+        void World::doChildWillBeRemoved(Node* node) {
+            removeLayerFromNodeTree(static_cast<const Layer*>(node));
+        }
+
+        // Hidden nodes are skipped because picking never considers them. Locked nodes can still be picked, e.g. to
+        // draw new brushes onto them.
         void World::doPick(const Ray3& ray, PickResult& pickResult) const {
-            const NodeList& children = Node::children();
-            NodeList::const_iterator it, end;
-            for (it = children.begin(), end = children.end(); it != end; ++it) {
-                const Node* child = *it;
-                child->pick(ray, pickResult);
-            }
+            pickLayerChildren(ray, NULL, Filter_Hidden, pickResult);
         }
         
         void World::doFindNodesContaining(const Vec3& point, NodeList& result) {
-            const NodeList& children = Node::children();
+            NodeList layerChildren;
+            findLayerChildrenContaining(point, NULL, Filter_None, layerChildren);
+            
             NodeList::const_iterator it, end;
-            for (it = children.begin(), end = children.end(); it != end; ++it) {
-                Node* child = *it;
-                child->findNodesContaining(point, result);
+            for (it = layerChildren.begin(), end = layerChildren.end(); it != end; ++it) {
+                Node* node = *it;
+                node->findNodesContaining(point, result);
+            }
+        }
+
+        void World::doFindNodesIntersecting(const BBox3& bounds, NodeList& result) {
+            NodeList layerChildren;
+            findLayerChildrenIntersecting(bounds, NULL, Filter_None, layerChildren);
+            
+            NodeList::const_iterator it, end;
+            for (it = layerChildren.begin(), end = layerChildren.end(); it != end; ++it) {
+                Node* node = *it;
+                node->findNodesIntersecting(bounds, result);
             }
         }
 
@@ -277,8 +395,8 @@ namespace TrenchBroom {
             return m_factory.createEntity();
         }
         
-        Brush* World::doCreateBrush(const BBox3& worldBounds, const BrushFaceList& faces) const {
-            return m_factory.createBrush(worldBounds, faces);
+        Brush* World::doCreateBrush(const BBox3& worldBounds, const BrushFaceList& faces, const bool deferGeometry) const {
+            return m_factory.createBrush(worldBounds, faces, deferGeometry);
         }
         
         BrushFace* World::doCreateFace(const Vec3& point1, const Vec3& point2, const Vec3& point3, const BrushFaceAttributes& attribs) const {
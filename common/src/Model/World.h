@@ -29,6 +29,7 @@
 #include "Model/ModelFactory.h"
 #include "Model/ModelFactoryImpl.h"
 #include "Model/Node.h"
+#include "Model/Octree.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -42,6 +43,18 @@ namespace TrenchBroom {
             AttributableNodeIndex m_attributableIndex;
             IssueGeneratorRegistry m_issueGeneratorRegistry;
             bool m_issuesMustBeValidated;
+            
+            // The children of all layers are kept in a single octree so that spatial queries do not have to visit
+            // every layer. The layer of a node in the tree is its parent.
+            typedef Octree<FloatType, Node*> NodeTree;
+            NodeTree m_nodeTree;
+        public:
+            // Filters the layer children visited by the spatial queries below. A node can override the visibility
+            // and lock state of its parent, so a layer child is only skipped if none of its descendants passes.
+            typedef int LayerChildFilter;
+            static const LayerChildFilter Filter_None   = 0;
+            static const LayerChildFilter Filter_Hidden = 1; // skip nodes that are neither visible nor selected
+            static const LayerChildFilter Filter_Locked = 2; // skip nodes that are not editable
         public:
             World(MapFormat::Type mapFormat, const BrushContentTypeBuilder* brushContentTypeBuilder, const BBox3& worldBounds);
         public: // layer management
@@ -50,6 +63,25 @@ namespace TrenchBroom {
             LayerList customLayers() const;
         private:
             void createDefaultLayer(const BBox3& worldBounds);
+        public: // spatial index, the given layer restricts a query to its children unless it is NULL
+            void pickLayerChildren(const Ray3& ray, const Layer* layer, LayerChildFilter filter, PickResult& pickResult) const;
+            // Adds the layer children whose bounds contain the given point, without descending into them.
+            void findLayerChildrenContaining(const Vec3& point, const Layer* layer, LayerChildFilter filter, NodeList& result) const;
+            // Adds the layer children whose bounds intersect the given bounds, without descending into them.
+            void findLayerChildrenIntersecting(const BBox3& bounds, const Layer* layer, LayerChildFilter filter, NodeList& result) const;
+            
+            // called by the layers when their children change
+            void layerChildWasAdded(Node* node);
+            void layerChildWillBeRemoved(Node* node);
+            void layerChildBoundsDidChange(Node* node);
+        private:
+            class PickNodes;
+            
+            static bool accepts(const Node* node, const Layer* layer, LayerChildFilter filter);
+            static bool containsMatchingNode(const Node* node, LayerChildFilter filter);
+            
+            void addLayerToNodeTree(const Layer* layer);
+            void removeLayerFromNodeTree(const Layer* layer);
         public: // selection
             // issue generator registration
             const IssueGeneratorList& registeredIssueGenerators() const;
@@ -67,8 +99,11 @@ namespace TrenchBroom {
             bool doCanRemoveChild(const Node* child) const;
             bool doRemoveIfEmpty() const;
             bool doSelectable() const;
+            void doChildWasAdded(Node* node);
+            void doChildWillBeRemoved(Node* node);
             void doPick(const Ray3& ray, PickResult& pickResult) const;
             void doFindNodesContaining(const Vec3& point, NodeList& result);
+            void doFindNodesIntersecting(const BBox3& bounds, NodeList& result);
             FloatType doIntersectWithRay(const Ray3& ray) const;
             void doGenerateIssues(const IssueGenerator* generator, IssueList& issues);
             void doAccept(NodeVisitor& visitor);
@@ -89,7 +124,7 @@ namespace TrenchBroom {
             Layer* doCreateLayer(const String& name, const BBox3& worldBounds) const;
             Group* doCreateGroup(const String& name) const;
             Entity* doCreateEntity() const;
-            Brush* doCreateBrush(const BBox3& worldBounds, const BrushFaceList& faces) const;
+            Brush* doCreateBrush(const BBox3& worldBounds, const BrushFaceList& faces, bool deferGeometry) const;
             BrushFace* doCreateFace(const Vec3& point1, const Vec3& point2, const Vec3& point3, const BrushFaceAttributes& attribs) const;
             BrushFace* doCreateFace(const Vec3& point1, const Vec3& point2, const Vec3& point3, const BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY) const;
         private:
@@ -0,0 +1,112 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelTaskRunner.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    ParallelTask::~ParallelTask() {}
+
+    void ParallelTask::run() {
+        doRun();
+    }
+
+    class ParallelTaskRunner::Queue {
+    private:
+        const ParallelTask::List& m_tasks;
+        size_t m_next;
+        wxCriticalSection m_critical;
+    public:
+        Queue(const ParallelTask::List& tasks) :
+        m_tasks(tasks),
+        m_next(0) {}
+        
+        void runAll() {
+            ParallelTask* task = next();
+            while (task != NULL) {
+                task->run();
+                task = next();
+            }
+        }
+    private:
+        ParallelTask* next() {
+            wxCriticalSectionLocker lock(m_critical);
+            if (m_next >= m_tasks.size())
+                return NULL;
+            return m_tasks[m_next++];
+        }
+    };
+    
+    class ParallelTaskRunner::Worker : public wxThread {
+    private:
+        Queue& m_queue;
+    public:
+        Worker(Queue& queue) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_queue(queue) {}
+    private:
+        ExitCode Entry() {
+            m_queue.runAll();
+            return static_cast<ExitCode>(0);
+        }
+    };
+    
+    size_t ParallelTaskRunner::defaultThreadCount() {
+        const int cpuCount = wxThread::GetCPUCount();
+        return cpuCount > 0 ? static_cast<size_t>(cpuCount) : 1;
+    }
+
+    ParallelTaskRunner::ParallelTaskRunner(const size_t threadCount) :
+    m_threadCount(std::max(threadCount, static_cast<size_t>(1))) {}
+    
+    size_t ParallelTaskRunner::threadCount() const {
+        return m_threadCount;
+    }
+
+    void ParallelTaskRunner::run(const ParallelTask::List& tasks) const {
+        Queue queue(tasks);
+        
+        typedef std::vector<Worker*> WorkerList;
+        WorkerList workers;
+        
+        const size_t workerCount = std::min(m_threadCount, tasks.size()) - (tasks.empty() ? 0 : 1);
+        for (size_t i = 0; i < workerCount; ++i) {
+            Worker* worker = new Worker(queue);
+            if (worker->Run() != wxTHREAD_NO_ERROR) {
+                // the calling thread will pick up the remaining work
+                delete worker;
+                break;
+            }
+            workers.push_back(worker);
+        }
+        
+        queue.runAll();
+        
+        WorkerList::const_iterator it, end;
+        for (it = workers.begin(), end = workers.end(); it != end; ++it) {
+            Worker* worker = *it;
+            worker->Wait();
+            delete worker;
+        }
+    }
+}
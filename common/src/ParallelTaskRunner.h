@@ -0,0 +1,57 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ParallelTaskRunner
+#define TrenchBroom_ParallelTaskRunner
+
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    class ParallelTask {
+    public:
+        typedef std::vector<ParallelTask*> List;
+    public:
+        virtual ~ParallelTask();
+        
+        void run();
+    private:
+        // Implementations must not throw. Errors must be recorded by the task and evaluated by the caller.
+        virtual void doRun() = 0;
+    };
+    
+    class ParallelTaskRunner {
+    private:
+        class Queue;
+        class Worker;
+        
+        size_t m_threadCount;
+    public:
+        static size_t defaultThreadCount();
+        
+        ParallelTaskRunner(size_t threadCount = defaultThreadCount());
+        
+        size_t threadCount() const;
+        
+        // Runs the given tasks on up to threadCount threads including the calling thread and returns when all tasks have finished.
+        void run(const ParallelTask::List& tasks) const;
+    };
+}
+
+#endif /* defined(TrenchBroom_ParallelTaskRunner) */
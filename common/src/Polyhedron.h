@@ -25,6 +25,8 @@
 #include "DoublyLinkedList.h"
 
 #include <cassert>
+#include <cstring>
+#include <iostream>
 #include <queue>
 #include <vector>
 
@@ -277,6 +279,11 @@ private: // Constructor helpers
     void setBounds(const BBox<T,3>& bounds, Callback& callback);
 private: // Copy constructor
     class Copy;
+public: // Restoring a previously built polyhedron
+    typedef std::vector<size_t> IndexList;
+    typedef std::vector<IndexList> FaceIndexList;
+
+    bool setTopology(const typename V::List& positions, const FaceIndexList& faces);
 public: // Destructor
     virtual ~Polyhedron();
 public: // operators
@@ -349,6 +356,8 @@ private: // General purpose methods
     bool checkEdgeLengths(const T minLength = Math::Constants<T>::pointStatusEpsilon()) const;
     
     void updateBounds();
+public: // Translation
+    void translate(const V& delta);
 public: // Vertex correction and edge healing
     void correctVertexPositions(const size_t decimals = 0, const T epsilon = Math::Constants<T>::correctEpsilon());
     bool healEdges(const T minLength = Math::Constants<T>::pointStatusEpsilon());
@@ -451,11 +460,32 @@ private:
     void addFurtherPointToPolyhedron(const V& position, Callback& callback);
     bool addPointToPolyhedron(const V& position, const Seam& seam, Callback& callback);
     
+    class SpatialHash;
+    class ConflictTracker;
+    
+    static const size_t MinBatchPointCount = 16;
+    
+    template <typename I> typename V::List uniquePoints(I cur, I end) const;
+    IndexList extremePointsFirst(const typename V::List& points) const;
+    void addFurtherPointsToPolyhedron(const typename V::List& points, Callback& callback);
+    
+    typedef std::vector<HalfEdge*> HalfEdgeVector;
+    
+    FaceSet findVisibleRegion(const V& position, Face* initialFace) const;
+    bool addPinchedFaces(const V& position, FaceSet& region) const;
+    bool addEnclosedFaces(const V& position, FaceSet& region) const;
+    HalfEdgeVector findRegionBoundary(const FaceSet& region) const;
+    HalfEdge* nextRegionBoundaryEdge(HalfEdge* edge, const FaceSet& region) const;
+    static T distanceAbove(const Face* face, const V& position);
+    
     class SplittingCriterion;
     class SplitByVisibilityCriterion;
+    class SplitByRegionCriterion;
     class SplitByNormalCriterion;
     
     Seam createSeam(const SplittingCriterion& criterion);
+    Seam createSeam(const SplittingCriterion& criterion, Face* initialFace);
+    Seam traceSeam(const SplittingCriterion& criterion, Edge* first);
     
     void split(const Seam& seam, Callback& callback);
     void deleteFaces(HalfEdge* current, FaceSet& visitedFaces, VertexList& verticesToDelete, Callback& callback);
@@ -20,6 +20,10 @@
 #ifndef TrenchBroom_Polyhedron_ConvexHull_h
 #define TrenchBroom_Polyhedron_ConvexHull_h
 
+#include <cmath>
+#include <limits>
+#include <map>
+
 template <typename T, typename FP, typename VP>
 class Polyhedron<T,FP,VP>::Seam {
 private:
@@ -96,14 +100,39 @@ void Polyhedron<T,FP,VP>::addPoints(const typename V::List& points, Callback& ca
 template <typename T, typename FP, typename VP> template <typename I>
 void Polyhedron<T,FP,VP>::addPoints(I cur, I end) {
     Callback c;
-    while (cur != end)
-        addPoint(*cur++, c);
+    addPoints(cur, end, c);
 }
 
+// Adds the given points in a batch. Near-coincident points are dropped first. Then the points are added one by one
+// until this polyhedron has volume, starting with the extreme points along each axis. The remaining points are added
+// quickhull style: every point is assigned to a face that it is above of, and the farthest point of a face is added
+// next, so that the points which the new faces enclose never have to be looked at again.
+//
+// Fewer points, such as the vertices of a brush, are added one by one in their given order. The result of operations
+// such as subtract depends on the order of the faces, which then stays the same as with addPoint.
 template <typename T, typename FP, typename VP> template <typename I>
 void Polyhedron<T,FP,VP>::addPoints(I cur, I end, Callback& callback) {
-    while (cur != end)
-        addPoint(*cur++, callback);
+    const typename V::List points = uniquePoints(cur, end);
+    if (points.size() < MinBatchPointCount) {
+        typename V::List::const_iterator it, itEnd;
+        for (it = points.begin(), itEnd = points.end(); it != itEnd; ++it)
+            addPoint(*it, callback);
+        return;
+    }
+    
+    const IndexList order = extremePointsFirst(points);
+    
+    size_t i = 0;
+    while (i < order.size() && !polyhedron())
+        addPoint(points[order[i++]], callback);
+    
+    if (i < order.size()) {
+        typename V::List remaining;
+        remaining.reserve(order.size() - i);
+        while (i < order.size())
+            remaining.push_back(points[order[i++]]);
+        addFurtherPointsToPolyhedron(remaining, callback);
+    }
 }
 
 template <typename T, typename FP, typename VP>
@@ -145,12 +174,10 @@ void Polyhedron<T,FP,VP>::merge(const Polyhedron& other) {
 template <typename T, typename FP, typename VP>
 void Polyhedron<T,FP,VP>::merge(const Polyhedron& other, Callback& callback) {
     if (!other.empty()) {
-        const Vertex* firstVertex = other.vertices().front();
-        const Vertex* currentVertex = firstVertex;
-        do {
-            addPoint(currentVertex->position(), callback);
-            currentVertex = currentVertex->next();
-        } while (currentVertex != firstVertex);
+        typename V::List positions;
+        positions.reserve(other.vertexCount());
+        V::toList(other.vertices().begin(), other.vertices().end(), GetVertexPosition(), positions);
+        addPoints(positions.begin(), positions.end(), callback);
     }
 }
 
@@ -331,11 +358,503 @@ bool Polyhedron<T,FP,VP>::addPointToPolyhedron(const V& position, const Seam& se
     return true;
 }
 
+template <typename T, typename FP, typename VP>
+class Polyhedron<T,FP,VP>::SpatialHash {
+private:
+    typedef std::vector<typename V::List> BucketList;
+    
+    T m_cellSize;
+    BucketList m_buckets;
+public:
+    SpatialHash(const size_t pointCount, const T cellSize) :
+    m_cellSize(cellSize) {
+        assert(m_cellSize > static_cast<T>(0.0));
+        size_t bucketCount = 1;
+        while (bucketCount < 2 * pointCount)
+            bucketCount <<= 1;
+        m_buckets.resize(bucketCount);
+    }
+    
+    // Inserts the given point unless a previously inserted point is within the cell size of it in every coordinate.
+    // Such a point can only lie in the cell containing the given point or in one of the adjacent cells.
+    bool insert(const V& point) {
+        const V cell = cellOf(point);
+        for (int x = -1; x <= 1; ++x) {
+            for (int y = -1; y <= 1; ++y) {
+                for (int z = -1; z <= 1; ++z) {
+                    const V neighbour = cell + V(static_cast<T>(x), static_cast<T>(y), static_cast<T>(z));
+                    const typename V::List& bucket = m_buckets[bucketIndex(neighbour)];
+                    typename V::List::const_iterator it, end;
+                    for (it = bucket.begin(), end = bucket.end(); it != end; ++it) {
+                        if (point.equals(*it, m_cellSize))
+                            return false;
+                    }
+                }
+            }
+        }
+        
+        m_buckets[bucketIndex(cell)].push_back(point);
+        return true;
+    }
+private:
+    V cellOf(const V& point) const {
+        return V(std::floor(point.x() / m_cellSize),
+                 std::floor(point.y() / m_cellSize),
+                 std::floor(point.z() / m_cellSize));
+    }
+    
+    size_t bucketIndex(const V& cell) const {
+        size_t hash = 0;
+        for (size_t i = 0; i < 3; ++i) {
+            // adding zero turns -0.0 into +0.0, which compares equal to it
+            const T value = cell[i] + static_cast<T>(0.0);
+            
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            
+            size_t valueHash = 2166136261u;
+            for (size_t j = 0; j < sizeof(T); ++j)
+                valueHash = (valueHash ^ bytes[j]) * 16777619u;
+            hash ^= valueHash + 0x9e3779b9u + (hash << 6) + (hash >> 2);
+        }
+        return hash & (m_buckets.size() - 1);
+    }
+};
+
+// Returns the given points in their order, but without any point that is within the point status epsilon of a point
+// before it. Such points cannot be told apart by the visibility tests which build the hull.
+template <typename T, typename FP, typename VP> template <typename I>
+typename Polyhedron<T,FP,VP>::V::List Polyhedron<T,FP,VP>::uniquePoints(I cur, I end) const {
+    const typename V::List points(cur, end);
+    
+    typename V::List result;
+    result.reserve(points.size());
+    
+    SpatialHash hash(points.size(), Math::Constants<T>::pointStatusEpsilon());
+    typename V::List::const_iterator it, itEnd;
+    for (it = points.begin(), itEnd = points.end(); it != itEnd; ++it) {
+        if (hash.insert(*it))
+            result.push_back(*it);
+    }
+    return result;
+}
+
+// Returns the indices of the given points such that the points with the minimal and maximal coordinate along each axis
+// come first. These span the hull early on, so that fewer of the remaining points end up outside of it.
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::IndexList Polyhedron<T,FP,VP>::extremePointsFirst(const typename V::List& points) const {
+    IndexList result;
+    result.reserve(points.size());
+    if (points.empty())
+        return result;
+    
+    size_t extremes[6] = { 0, 0, 0, 0, 0, 0 };
+    for (size_t i = 1; i < points.size(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            if (points[i][j] < points[extremes[2 * j]][j])
+                extremes[2 * j] = i;
+            if (points[i][j] > points[extremes[2 * j + 1]][j])
+                extremes[2 * j + 1] = i;
+        }
+    }
+    
+    std::vector<bool> added(points.size(), false);
+    for (size_t i = 0; i < 6; ++i) {
+        if (!added[extremes[i]]) {
+            result.push_back(extremes[i]);
+            added[extremes[i]] = true;
+        }
+    }
+    
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (!added[i])
+            result.push_back(i);
+    }
+    return result;
+}
+
+// Keeps track of the points which have not been added to the hull yet. Every such point is assigned to one face which
+// it is above of. When faces are deleted or merged away while a point is added, their points are reassigned to the
+// faces which took their place, or dropped if they are not above any of them. Forwards all events to the given callback.
+template <typename T, typename FP, typename VP>
+class Polyhedron<T,FP,VP>::ConflictTracker : public Callback {
+private:
+    struct Conflict {
+        size_t index;
+        T distance;
+        
+        Conflict(const size_t i_index, const T i_distance) :
+        index(i_index),
+        distance(i_distance) {}
+    };
+    
+    typedef std::vector<Conflict> ConflictList;
+    typedef std::map<Face*, ConflictList> ConflictMap;
+    typedef std::vector<Face*> FaceStack;
+    
+    const typename V::List& m_points;
+    Callback& m_callback;
+    
+    ConflictMap m_conflicts;
+    FaceStack m_pendingFaces;
+    
+    IndexList m_orphans;
+    std::vector<Face*> m_newFaces;
+    FaceSet m_liveNewFaces;
+public:
+    ConflictTracker(const typename V::List& points, Callback& callback) :
+    m_points(points),
+    m_callback(callback) {}
+    
+    void assignPoints(const FaceList& faces) {
+        std::vector<Face*> candidates;
+        candidates.reserve(faces.size());
+        
+        typename FaceList::const_iterator it, end;
+        for (it = faces.begin(), end = faces.end(); it != end; ++it)
+            candidates.push_back(*it);
+        
+        for (size_t i = 0; i < m_points.size(); ++i)
+            m_orphans.push_back(i);
+        assignOrphans(candidates);
+    }
+    
+    // Returns a face which has points assigned to it, or NULL if no points are left.
+    Face* nextFace() {
+        while (!m_pendingFaces.empty()) {
+            Face* face = m_pendingFaces.back();
+            if (m_conflicts.count(face) > 0)
+                return face;
+            m_pendingFaces.pop_back();
+        }
+        return NULL;
+    }
+    
+    size_t takeFarthestPoint(Face* face) {
+        typename ConflictMap::iterator it = m_conflicts.find(face);
+        assert(it != m_conflicts.end());
+        
+        ConflictList& conflicts = it->second;
+        size_t farthest = 0;
+        for (size_t i = 1; i < conflicts.size(); ++i) {
+            if (conflicts[i].distance > conflicts[farthest].distance)
+                farthest = i;
+        }
+        
+        const size_t index = conflicts[farthest].index;
+        conflicts[farthest] = conflicts.back();
+        conflicts.pop_back();
+        if (conflicts.empty())
+            m_conflicts.erase(it);
+        return index;
+    }
+    
+    // Reassigns the points of the faces which were deleted or merged since the last call to the faces which were
+    // created or enlarged in the meantime.
+    void reassignOrphans() {
+        std::vector<Face*> candidates;
+        candidates.reserve(m_newFaces.size());
+        
+        typename std::vector<Face*>::const_iterator it, end;
+        for (it = m_newFaces.begin(), end = m_newFaces.end(); it != end; ++it) {
+            Face* face = *it;
+            if (m_liveNewFaces.erase(face) > 0)
+                candidates.push_back(face);
+        }
+        m_newFaces.clear();
+        
+        assignOrphans(candidates);
+    }
+private:
+    void assignOrphans(const std::vector<Face*>& candidates) {
+        typename V::List origins, normals;
+        origins.reserve(candidates.size());
+        normals.reserve(candidates.size());
+        
+        typename std::vector<Face*>::const_iterator it, end;
+        for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+            const Face* face = *it;
+            origins.push_back(face->origin());
+            normals.push_back(face->normal());
+        }
+        
+        // The same test as Face::visibleFrom, so that a point is only assigned to a face which the seam search considers visible.
+        const T epsilon = Math::Constants<T>::pointStatusEpsilon();
+        for (size_t i = 0; i < m_orphans.size(); ++i) {
+            const size_t index = m_orphans[i];
+            const V& point = m_points[index];
+            for (size_t j = 0; j < candidates.size(); ++j) {
+                const T distance = (point - origins[j]).dot(normals[j]);
+                if (distance > epsilon) {
+                    addConflict(candidates[j], Conflict(index, distance));
+                    break;
+                }
+            }
+        }
+        m_orphans.clear();
+    }
+    
+    void addConflict(Face* face, const Conflict& conflict) {
+        ConflictList& conflicts = m_conflicts[face];
+        if (conflicts.empty())
+            m_pendingFaces.push_back(face);
+        conflicts.push_back(conflict);
+    }
+    
+    void orphanPoints(Face* face) {
+        typename ConflictMap::iterator it = m_conflicts.find(face);
+        if (it != m_conflicts.end()) {
+            const ConflictList& conflicts = it->second;
+            typename ConflictList::const_iterator cIt, cEnd;
+            for (cIt = conflicts.begin(), cEnd = conflicts.end(); cIt != cEnd; ++cIt)
+                m_orphans.push_back(cIt->index);
+            m_conflicts.erase(it);
+        }
+        m_liveNewFaces.erase(face);
+    }
+public:
+    Plane<T,3> plane(const Face* face) const {
+        return m_callback.plane(face);
+    }
+    
+    void faceWasCreated(Face* face) {
+        m_callback.faceWasCreated(face);
+        m_newFaces.push_back(face);
+        m_liveNewFaces.insert(face);
+    }
+    
+    void faceWillBeDeleted(Face* face) {
+        m_callback.faceWillBeDeleted(face);
+        orphanPoints(face);
+    }
+    
+    void faceDidChange(Face* face) {
+        m_callback.faceDidChange(face);
+    }
+    
+    void faceWasSplit(Face* original, Face* clone) {
+        m_callback.faceWasSplit(original, clone);
+    }
+    
+    void facesWillBeMerged(Face* remaining, Face* toDelete) {
+        m_callback.facesWillBeMerged(remaining, toDelete);
+        orphanPoints(toDelete);
+        m_newFaces.push_back(remaining);
+        m_liveNewFaces.insert(remaining);
+    }
+};
+
+// Adds the given points to this polyhedron, which must already have volume.
+template <typename T, typename FP, typename VP>
+void Polyhedron<T,FP,VP>::addFurtherPointsToPolyhedron(const typename V::List& points, Callback& callback) {
+    assert(polyhedron());
+    
+    ConflictTracker tracker(points, callback);
+    tracker.assignPoints(m_faces);
+    
+    Face* face = tracker.nextFace();
+    while (face != NULL) {
+        const V& position = points[tracker.takeFarthestPoint(face)];
+        
+        const FaceSet region = findVisibleRegion(position, face);
+        const Seam seam = createSeam(SplitByRegionCriterion(region), face);
+        if (!seam.empty()) {
+            split(seam, tracker);
+            Vertex* newVertex = weaveCap(seam, position, tracker);
+            cleanupAfterVertexMove(newVertex, tracker);
+        } else {
+            // No seam could be traced around the region, so the point is added like a single point instead.
+            addFurtherPointToPolyhedron(position, tracker);
+        }
+        m_bounds.mergeWith(position);
+        
+        tracker.reassignOrphans();
+        face = tracker.nextFace();
+    }
+    assert(checkInvariant());
+}
+
+/*
+ Returns the faces which are visible from the given point and connected to the given face, which must be visible from
+ it. Faces which are almost coplanar to the point can be misclassified, and then the boundary of this region may touch
+ itself at a vertex or enclose faces which are not visible. A cap cannot be woven onto such a boundary, so the region
+ is grown until its boundary is a single simple loop.
+ */
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::FaceSet Polyhedron<T,FP,VP>::findVisibleRegion(const V& position, Face* initialFace) const {
+    assert(initialFace->visibleFrom(position));
+    
+    FaceSet region;
+    region.insert(initialFace);
+    
+    std::vector<Face*> queue(1, initialFace);
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const HalfEdge* firstEdge = queue[i]->boundary().front();
+        const HalfEdge* currentEdge = firstEdge;
+        do {
+            Face* neighbour = currentEdge->twin()->face();
+            if (neighbour->visibleFrom(position) && region.insert(neighbour).second)
+                queue.push_back(neighbour);
+            currentEdge = currentEdge->next();
+        } while (currentEdge != firstEdge);
+    }
+    
+    bool grown = true;
+    while (grown)
+        grown = addPinchedFaces(position, region) || addEnclosedFaces(position, region);
+    return region;
+}
+
+// Adds faces around every vertex at which the boundary of the given region touches itself. Of the fans of faces
+// around such a vertex which are not part of the region, only the one containing the face that is least visible
+// from the given point is kept out. Returns whether any faces were added.
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::addPinchedFaces(const V& position, FaceSet& region) const {
+    const HalfEdgeVector boundary = findRegionBoundary(region);
+    
+    VertexSet origins;
+    std::vector<Vertex*> pinchedVertices;
+    typename HalfEdgeVector::const_iterator it, end;
+    for (it = boundary.begin(), end = boundary.end(); it != end; ++it) {
+        Vertex* origin = (*it)->origin();
+        if (!origins.insert(origin).second)
+            pinchedVertices.push_back(origin);
+    }
+    
+    typename std::vector<Vertex*>::const_iterator vIt, vEnd;
+    for (vIt = pinchedVertices.begin(), vEnd = pinchedVertices.end(); vIt != vEnd; ++vIt) {
+        const Vertex* vertex = *vIt;
+        
+        std::vector<Face*> fan;
+        size_t leastVisible = 0;
+        T leastDistance = std::numeric_limits<T>::max();
+        
+        HalfEdge* firstEdge = vertex->leaving();
+        HalfEdge* currentEdge = firstEdge;
+        do {
+            Face* face = currentEdge->face();
+            if (region.count(face) == 0) {
+                const T distance = distanceAbove(face, position);
+                if (distance < leastDistance) {
+                    leastVisible = fan.size();
+                    leastDistance = distance;
+                }
+            }
+            fan.push_back(face);
+            currentEdge = currentEdge->nextIncident();
+        } while (currentEdge != firstEdge);
+        
+        std::vector<bool> keepOut(fan.size(), false);
+        for (size_t i = leastVisible; region.count(fan[i]) == 0 && !keepOut[i]; i = (i + 1) % fan.size())
+            keepOut[i] = true;
+        for (size_t i = (leastVisible + fan.size() - 1) % fan.size(); region.count(fan[i]) == 0 && !keepOut[i]; i = (i + fan.size() - 1) % fan.size())
+            keepOut[i] = true;
+        
+        for (size_t i = 0; i < fan.size(); ++i) {
+            if (!keepOut[i])
+                region.insert(fan[i]);
+        }
+    }
+    
+    return !pinchedVertices.empty();
+}
+
+// If the boundary of the given region consists of several loops, adds the faces enclosed by every loop except for
+// the one which borders on the face that is least visible from the given point. Returns whether any faces were added.
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::addEnclosedFaces(const V& position, FaceSet& region) const {
+    const HalfEdgeVector boundary = findRegionBoundary(region);
+    assert(!boundary.empty());
+    
+    HalfEdge* outerFirst = boundary.front();
+    typename HalfEdgeVector::const_iterator it, end;
+    for (it = boundary.begin(), end = boundary.end(); it != end; ++it) {
+        HalfEdge* edge = *it;
+        if (distanceAbove(edge->twin()->face(), position) < distanceAbove(outerFirst->twin()->face(), position))
+            outerFirst = edge;
+    }
+    
+    std::set<HalfEdge*> outerLoop;
+    HalfEdge* current = outerFirst;
+    do {
+        outerLoop.insert(current);
+        current = nextRegionBoundaryEdge(current, region);
+    } while (current != outerFirst);
+    
+    if (outerLoop.size() == boundary.size())
+        return false;
+    
+    std::vector<Face*> queue;
+    for (it = boundary.begin(), end = boundary.end(); it != end; ++it) {
+        HalfEdge* edge = *it;
+        Face* enclosed = edge->twin()->face();
+        if (outerLoop.count(edge) == 0 && region.insert(enclosed).second)
+            queue.push_back(enclosed);
+    }
+    
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const HalfEdge* firstEdge = queue[i]->boundary().front();
+        const HalfEdge* currentEdge = firstEdge;
+        do {
+            Face* neighbour = currentEdge->twin()->face();
+            if (region.insert(neighbour).second)
+                queue.push_back(neighbour);
+            currentEdge = currentEdge->next();
+        } while (currentEdge != firstEdge);
+    }
+    
+    return true;
+}
+
+// Returns the half edges of the faces in the given region whose twins belong to faces outside of it.
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::HalfEdgeVector Polyhedron<T,FP,VP>::findRegionBoundary(const FaceSet& region) const {
+    HalfEdgeVector result;
+    
+    typename FaceSet::const_iterator it, end;
+    for (it = region.begin(), end = region.end(); it != end; ++it) {
+        HalfEdge* firstEdge = (*it)->boundary().front();
+        HalfEdge* currentEdge = firstEdge;
+        do {
+            if (region.count(currentEdge->twin()->face()) == 0)
+                result.push_back(currentEdge);
+            currentEdge = currentEdge->next();
+        } while (currentEdge != firstEdge);
+    }
+    
+    return result;
+}
+
+// Returns the boundary half edge of the given region which follows the given one, assuming that the boundary
+// does not touch itself at the destination of the given half edge.
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::HalfEdge* Polyhedron<T,FP,VP>::nextRegionBoundaryEdge(HalfEdge* edge, const FaceSet& region) const {
+    HalfEdge* next = edge->next();
+    while (region.count(next->twin()->face()) > 0)
+        next = next->twin()->next();
+    return next;
+}
+
+template <typename T, typename FP, typename VP>
+T Polyhedron<T,FP,VP>::distanceAbove(const Face* face, const V& position) {
+    return (position - face->origin()).dot(face->normal());
+}
+
 template <typename T, typename FP, typename VP>
 typename Polyhedron<T,FP,VP>::Seam Polyhedron<T,FP,VP>::createSeam(const SplittingCriterion& criterion) {
+    return traceSeam(criterion, criterion.findFirstSplittingEdge(m_edges));
+}
+
+// Creates a seam around the region of faces which do not match the given criterion and which contains the given face.
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::Seam Polyhedron<T,FP,VP>::createSeam(const SplittingCriterion& criterion, Face* initialFace) {
+    return traceSeam(criterion, criterion.findFirstSplittingEdge(initialFace));
+}
+
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::Seam Polyhedron<T,FP,VP>::traceSeam(const SplittingCriterion& criterion, Edge* first) {
     Seam seam;
     
-    Edge* first = criterion.findFirstSplittingEdge(m_edges);
     if (first != NULL) {
         Edge* current = first;
         do {
@@ -516,6 +1035,42 @@ public:
         return NULL;
     }
     
+    // Searches the faces which do not match this criterion, starting at the given face, for an edge to a matching face.
+    Edge* findFirstSplittingEdge(Face* initialFace) const {
+        assert(initialFace != NULL);
+        if (matches(initialFace))
+            return NULL;
+        
+        std::vector<Face*> queue(1, initialFace);
+        FaceSet visitedFaces;
+        visitedFaces.insert(initialFace);
+        
+        for (size_t i = 0; i < queue.size(); ++i) {
+            Face* face = queue[i];
+            HalfEdge* firstEdge = face->boundary().front();
+            HalfEdge* currentEdge = firstEdge;
+            do {
+                Edge* edge = currentEdge->edge();
+                switch (matches(edge)) {
+                    case MatchResult_Second:
+                        edge->flip();
+                    case MatchResult_First:
+                        return edge;
+                    case MatchResult_Both:
+                    case MatchResult_Neither: {
+                        Face* neighbour = currentEdge->twin()->face();
+                        if (visitedFaces.insert(neighbour).second)
+                            queue.push_back(neighbour);
+                        break;
+                    }
+                    switchDefault()
+                }
+                currentEdge = currentEdge->next();
+            } while (currentEdge != firstEdge);
+        }
+        return NULL;
+    }
+    
     // finds the next seam edge in counter clockwise orientation
     Edge* findNextSplittingEdge(Edge* last) const {
         assert(last != NULL);
@@ -571,4 +1126,17 @@ private:
     }
 };
 
+template <typename T, typename FP, typename VP>
+class Polyhedron<T,FP,VP>::SplitByRegionCriterion : public Polyhedron<T,FP,VP>::SplittingCriterion {
+private:
+    const FaceSet& m_region;
+public:
+    SplitByRegionCriterion(const FaceSet& region) :
+    m_region(region) {}
+private:
+    bool doMatches(const Face* face) const {
+        return m_region.count(const_cast<Face*>(face)) == 0;
+    }
+};
+
 #endif
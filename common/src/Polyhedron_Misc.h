@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_Polyhedron_Misc_h
 #define TrenchBroom_Polyhedron_Misc_h
 
+#include <algorithm>
 #include <map>
 
 template <typename T, typename FP, typename VP>
@@ -372,6 +373,86 @@ Polyhedron<T,FP,VP>::Polyhedron(const Polyhedron<T,FP,VP>& other) {
     Copy copy(other.faces(), other.edges(), *this);
 }
 
+/*
+ Replaces this polyhedron with the closed polyhedron given by the vertex positions and the counter clockwise
+ face boundaries, which index into the positions. No geometric computation is performed, but the topology is
+ validated first: every position must be used, every boundary must have at least three vertices, and every
+ boundary edge must be matched by exactly one opposite edge. Returns false and leaves this polyhedron
+ unchanged if the topology is invalid.
+ */
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::setTopology(const typename V::List& positions, const FaceIndexList& faces) {
+    typedef std::pair<size_t, size_t> IndexPair;
+    typedef std::map<IndexPair, HalfEdge*> HalfEdgeMap;
+
+    if (positions.size() < 4 || faces.size() < 4)
+        return false;
+
+    HalfEdgeMap halfEdges;
+    std::vector<bool> used(positions.size(), false);
+
+    typename FaceIndexList::const_iterator fIt, fEnd;
+    for (fIt = faces.begin(), fEnd = faces.end(); fIt != fEnd; ++fIt) {
+        const IndexList& boundary = *fIt;
+        if (boundary.size() < 3)
+            return false;
+        for (size_t i = 0; i < boundary.size(); ++i) {
+            const size_t origin = boundary[i];
+            const size_t destination = boundary[(i + 1) % boundary.size()];
+            if (origin >= positions.size() || origin == destination)
+                return false;
+            if (!halfEdges.insert(std::make_pair(IndexPair(origin, destination), static_cast<HalfEdge*>(NULL))).second)
+                return false;
+            used[origin] = true;
+        }
+    }
+
+    if (std::find(used.begin(), used.end(), false) != used.end())
+        return false;
+
+    typename HalfEdgeMap::const_iterator hIt, hEnd;
+    for (hIt = halfEdges.begin(), hEnd = halfEdges.end(); hIt != hEnd; ++hIt) {
+        const IndexPair& key = hIt->first;
+        if (halfEdges.count(IndexPair(key.second, key.first)) == 0)
+            return false;
+    }
+
+    clear();
+
+    std::vector<Vertex*> vertices;
+    vertices.reserve(positions.size());
+
+    typename V::List::const_iterator pIt, pEnd;
+    for (pIt = positions.begin(), pEnd = positions.end(); pIt != pEnd; ++pIt) {
+        Vertex* vertex = new Vertex(*pIt);
+        m_vertices.append(vertex, 1);
+        vertices.push_back(vertex);
+    }
+
+    for (fIt = faces.begin(), fEnd = faces.end(); fIt != fEnd; ++fIt) {
+        const IndexList& indices = *fIt;
+        HalfEdgeList boundary;
+        for (size_t i = 0; i < indices.size(); ++i) {
+            HalfEdge* halfEdge = new HalfEdge(vertices[indices[i]]);
+            boundary.append(halfEdge, 1);
+            halfEdges[IndexPair(indices[i], indices[(i + 1) % indices.size()])] = halfEdge;
+        }
+        m_faces.append(new Face(boundary), 1);
+    }
+
+    for (hIt = halfEdges.begin(), hEnd = halfEdges.end(); hIt != hEnd; ++hIt) {
+        const IndexPair& key = hIt->first;
+        if (key.first < key.second) {
+            HalfEdge* first = hIt->second;
+            HalfEdge* second = halfEdges[IndexPair(key.second, key.first)];
+            m_edges.append(new Edge(first, second), 1);
+        }
+    }
+
+    updateBounds();
+    return true;
+}
+
 template <typename T, typename FP, typename VP>
 Polyhedron<T,FP,VP>::~Polyhedron() {
     clear();
@@ -803,6 +884,22 @@ bool Polyhedron<T,FP,VP>::checkEdgeLengths(const T minLength) const {
     return true;
 }
 
+template <typename T, typename FP, typename VP>
+void Polyhedron<T,FP,VP>::translate(const V& delta) {
+    if (m_vertices.empty())
+        return;
+    
+    Vertex* firstVertex = m_vertices.front();
+    Vertex* currentVertex = firstVertex;
+    do {
+        currentVertex->setPosition(currentVertex->position() + delta);
+        currentVertex = currentVertex->next();
+    } while (currentVertex != firstVertex);
+    
+    m_bounds.min += delta;
+    m_bounds.max += delta;
+}
+
 template <typename T, typename FP, typename VP>
 void Polyhedron<T,FP,VP>::correctVertexPositions(const size_t decimals, const T epsilon) {
     Vertex* firstVertex = m_vertices.front();
@@ -419,81 +419,117 @@ private:
         applyMergeGroups();
     }
     
+    /*
+     Identifies a face by its vertex positions. Two fragments are neighbours if they have faces with identical keys, so
+     the keys are hashed to find these faces without comparing every pair of vertex sets.
+     */
     class FaceKey {
     private:
         typename V::Set m_vertices;
+        size_t m_hash;
     public:
-        FaceKey(const Face* face) {
+        FaceKey(const Face* face) :
+        m_hash(0) {
             const HalfEdge* first = face->boundary().front();
             const HalfEdge* current = first;
             do {
                 m_vertices.insert(current->origin()->position());
                 current = current->next();
             } while (current != first);
+            
+            typename V::Set::const_iterator it, end;
+            for (it = m_vertices.begin(), end = m_vertices.end(); it != end; ++it) {
+                const V& position = *it;
+                for (size_t i = 0; i < 3; ++i)
+                    m_hash = combineHash(m_hash, hashValue(position[i]));
+            }
         }
         
-        bool operator<(const FaceKey& other) const {
-            return compare(other) < 0;
+        size_t hash() const {
+            return m_hash;
         }
-    private:
-        int compare(const FaceKey& other) const {
-            typename V::Set::const_iterator myIt = m_vertices.begin();
-            typename V::Set::const_iterator otIt = other.m_vertices.begin();
+        
+        bool operator==(const FaceKey& other) const {
+            if (m_hash != other.m_hash || m_vertices.size() != other.m_vertices.size())
+                return false;
             
-            for (size_t i = 0; i < m_vertices.size(); ++i) {
-                const V& myVertex = *myIt++;
-                const V& otVertex = *otIt++;
-                const int vertexCmp = myVertex.compare(otVertex);
-                if (vertexCmp != 0)
-                    return vertexCmp;
+            typename V::Set::const_iterator myIt, myEnd, otIt;
+            for (myIt = m_vertices.begin(), myEnd = m_vertices.end(), otIt = other.m_vertices.begin(); myIt != myEnd; ++myIt, ++otIt) {
+                if (myIt->compare(*otIt) != 0)
+                    return false;
             }
+            return true;
+        }
+    private:
+        static size_t hashValue(const T value) {
+            // adding zero turns -0.0 into +0.0, which compares equal to it
+            const T normalized = value + static_cast<T>(0.0);
             
-            return 0;
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &normalized, sizeof(T));
+            
+            size_t result = 2166136261u;
+            for (size_t i = 0; i < sizeof(T); ++i)
+                result = (result ^ bytes[i]) * 16777619u;
+            return result;
+        }
+        
+        static size_t combineHash(const size_t seed, const size_t value) {
+            return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
         }
     };
     
+    struct NeighbourFace {
+        size_t index;
+        Face* face;
+        FaceKey key;
+        
+        NeighbourFace(const size_t i_index, Face* i_face) :
+        index(i_index),
+        face(i_face),
+        key(i_face) {}
+    };
     
-    typedef std::pair<size_t, Face*> NeighbourFace;
+    // The faces are bucketed by the hashes of their keys. Every bucket keeps the faces in the order of the fragments.
     typedef std::vector<NeighbourFace> NeighbourFaceList;
-    typedef std::map<FaceKey, NeighbourFaceList> NeighbourMap;
+    typedef std::vector<NeighbourFaceList> NeighbourMap;
     
     void findMergeableNeighbours() {
         const NeighbourMap neighbourMap = findNeighbours();
         typename NeighbourMap::const_iterator nIt, nEnd;
         for (nIt = neighbourMap.begin(), nEnd = neighbourMap.end(); nIt != nEnd; ++nIt) {
-            const NeighbourFaceList& neighbourFaces = nIt->second;
-            assert(neighbourFaces.size() <= 2);
-            
-            if (neighbourFaces.size() == 2) {
-                const NeighbourFace& first  = neighbourFaces[0];
-                const NeighbourFace& second = neighbourFaces[1];
-                
-                const size_t firstIndex = first.first;
-                const size_t secondIndex = second.first;
-                Face* firstFace = first.second;
-                Face* secondFace = second.second;
-                
-                if (mergeableNeighbours(secondFace, *m_indices[firstIndex])) {
-                    m_neighbours[ firstIndex].insert(NeighbourEntry(secondIndex,  firstFace, secondFace));
-                    m_neighbours[secondIndex].insert(NeighbourEntry( firstIndex, secondFace,  firstFace));
+            const NeighbourFaceList& bucket = *nIt;
+            for (size_t i = 0; i < bucket.size(); ++i) {
+                for (size_t j = i + 1; j < bucket.size(); ++j) {
+                    const NeighbourFace& first  = bucket[i];
+                    const NeighbourFace& second = bucket[j];
+                    
+                    if (first.key == second.key && mergeableNeighbours(second.face, *m_indices[first.index])) {
+                        m_neighbours[ first.index].insert(NeighbourEntry(second.index,  first.face, second.face));
+                        m_neighbours[second.index].insert(NeighbourEntry( first.index, second.face,  first.face));
+                    }
                 }
             }
         }
     }
     
-    NeighbourMap findNeighbours() {
-        NeighbourMap result;
+    NeighbourMap findNeighbours() const {
+        size_t faceCount = 0;
+        for (size_t index = 0; index < m_indices.size(); ++index)
+            faceCount += m_indices[index]->faceCount();
+        
+        size_t bucketCount = 1;
+        while (bucketCount < faceCount)
+            bucketCount <<= 1;
         
+        NeighbourMap result(bucketCount);
         for (size_t index = 0; index < m_indices.size(); ++index) {
-            const typename Polyhedron::List::iterator fIt = m_indices[index];
-            const Polyhedron& fragment = *fIt;
+            const Polyhedron& fragment = *m_indices[index];
             Face* firstFace = fragment.faces().front();
             Face* currentFace = firstFace;
             do {
-                const FaceKey key(currentFace);
-                NeighbourFaceList& neighbours = result[key];
-                assert(neighbours.size() < 2);
-                neighbours.push_back(std::make_pair(index, currentFace));
+                const NeighbourFace neighbour(index, currentFace);
+                result[neighbour.key.hash() & (bucketCount - 1)].push_back(neighbour);
                 currentFace = currentFace->next();
             } while (currentFace != firstFace);
         }
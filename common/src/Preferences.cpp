@@ -151,5 +151,9 @@ namespace TrenchBroom {
         Preference<View::KeyboardShortcut> CameraFlyBackward(IO::Path("Controls/Camera/Move backward"), 'S');
         Preference<View::KeyboardShortcut> CameraFlyLeft(IO::Path("Controls/Camera/Move left"), 'A');
         Preference<View::KeyboardShortcut> CameraFlyRight(IO::Path("Controls/Camera/Move right"), 'D');
+        
+        Preference<bool> UseMapCache(IO::Path("Map/Use map cache"), false);
+        Preference<bool> IncrementalSave(IO::Path("Map/Incremental save"), false);
+        Preference<bool> DeferBrushGeometry(IO::Path("Map/Defer brush geometry"), true);
     }
 }
@@ -138,6 +138,10 @@ namespace TrenchBroom {
         extern Preference<View::KeyboardShortcut> CameraFlyBackward;
         extern Preference<View::KeyboardShortcut> CameraFlyLeft;
         extern Preference<View::KeyboardShortcut> CameraFlyRight;
+        
+        extern Preference<bool> UseMapCache;
+        extern Preference<bool> IncrementalSave;
+        extern Preference<bool> DeferBrushGeometry;
     }
 }
 
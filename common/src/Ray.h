@@ -55,6 +55,14 @@ public:
     const Vec<T,S> pointAtDistance(const T distance) const {
         return origin + direction * distance;
     }
+    
+    // The reciprocals of the components of the direction, see BBox::entryDistance. Zero components remain zero.
+    const Vec<T,S> inverseDirection() const {
+        Vec<T,S> result;
+        for (size_t i = 0; i < S; ++i)
+            result[i] = direction[i] == static_cast<T>(0.0) ? static_cast<T>(0.0) : static_cast<T>(1.0) / direction[i];
+        return result;
+    }
 
     Math::PointStatus::Type pointStatus(const Vec<T,S>& point) const {
         const T dot = direction.dot(point - origin);
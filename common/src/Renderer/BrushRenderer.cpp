@@ -148,10 +148,14 @@ namespace TrenchBroom {
             invalidate();
         }
 
+        void BrushRenderer::prepare() {
+            if (!m_valid)
+                validate();
+        }
+        
         void BrushRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             if (!m_brushes.empty()) {
-                if (!m_valid)
-                    validate();
+                prepare();
                 if (renderContext.showFaces())
                     renderFaces(renderBatch);
                 if (renderContext.showEdges() && m_showEdges)
@@ -140,6 +140,8 @@ namespace TrenchBroom {
             void setTransparencyAlpha(float transparencyAlpha);
             void setShowHiddenBrushes(bool showHiddenBrushes);
         public: // rendering
+            // Builds the vertex and index arrays unless they are up to date. Rendering does this automatically.
+            void prepare();
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
             void renderFaces(RenderBatch& renderBatch);
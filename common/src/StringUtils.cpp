@@ -20,8 +20,13 @@
 #include "StringUtils.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
 
 namespace StringUtils {
     String formatString(const char* format, ...) {
@@ -254,4 +259,219 @@ namespace StringUtils {
         assert(longValue >= 0);
         return static_cast<size_t>(longValue);
     }
+    
+    template <typename R>
+    static R convertCopy(const char* begin, const char* end, R (*convert)(const char*)) {
+        static const size_t BufferSize = 64;
+        const size_t length = static_cast<size_t>(end - begin);
+        if (length < BufferSize) {
+            char buffer[BufferSize];
+            std::memcpy(buffer, begin, length);
+            buffer[length] = 0;
+            return convert(buffer);
+        }
+        const String copy(begin, end);
+        return convert(copy.c_str());
+    }
+    
+    // Returns the decimal point of the current locale, or NULL if it is a '.' as in the "C" locale.
+    static const char* localeDecimalPoint() {
+        const char* decimalPoint = std::localeconv()->decimal_point;
+        return decimalPoint[0] == '.' && decimalPoint[1] == 0 ? NULL : decimalPoint;
+    }
+    
+    /*
+     The C library uses the decimal point of the current locale. A decimal point of the locale which is not a '.' ends
+     the number just like in the "C" locale, and a '.' is then replaced by the decimal point of the locale.
+     */
+    static double convertDoubleCopy(const char* begin, const char* end) {
+        const char* decimalPoint = localeDecimalPoint();
+        if (decimalPoint == NULL)
+            return convertCopy(begin, end, &std::atof);
+        
+        String copy(begin, end);
+        const size_t localePos = copy.find(decimalPoint);
+        if (localePos != String::npos)
+            copy.erase(localePos);
+        const size_t pointPos = copy.find('.');
+        if (pointPos != String::npos)
+            copy.replace(pointPos, 1, decimalPoint);
+        return std::atof(copy.c_str());
+    }
+    
+    static bool isDigit(const char c) {
+        return c >= '0' && c <= '9';
+    }
+    
+    int stringToInt(const char* begin, const char* end) {
+        const char* c = begin;
+        if (c == end || (!isDigit(*c) && *c != '-' && *c != '+'))
+            return convertCopy(begin, end, &std::atoi);
+        
+        const bool negative = *c == '-';
+        if (*c == '-' || *c == '+')
+            ++c;
+        
+        // up to 9 digits cannot overflow an int
+        long value = 0;
+        size_t digits = 0;
+        while (c < end && digits < 9 && isDigit(*c)) {
+            value = value * 10 + (*c++ - '0');
+            ++digits;
+        }
+        if (c < end && isDigit(*c))
+            return convertCopy(begin, end, &std::atoi);
+        
+        return static_cast<int>(negative ? -value : value);
+    }
+    
+    // The fast path relies on double arithmetic being evaluated in double precision.
+#if (defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ == 0) || defined(_M_X64)
+    static const bool ExactDoubleArithmetic = true;
+#else
+    static const bool ExactDoubleArithmetic = false;
+#endif
+    
+    double stringToDouble(const char* begin, const char* end) {
+        /*
+         A decimal number whose significant digits fit into the 53 bit mantissa of a double and whose decimal
+         exponent has an absolute value of at most 22 can be converted exactly with a single multiplication or
+         division, because both operands are exactly representable and the operation is correctly rounded.
+         All other inputs are converted by the C library.
+         */
+        static const double PowersOfTen[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        static const int MaxExponent = 22;
+        static const size_t MaxSignificantDigits = 15;
+        
+        if (!ExactDoubleArithmetic)
+            return convertDoubleCopy(begin, end);
+        
+        const char* c = begin;
+        bool negative = false;
+        if (c < end && (*c == '-' || *c == '+'))
+            negative = (*c++ == '-');
+        
+        unsigned long mantissa = 0;
+        size_t significantDigits = 0;
+        int exponent = 0;
+        bool hasDigits = false;
+        
+        while (c < end && isDigit(*c)) {
+            hasDigits = true;
+            if (mantissa != 0 || *c != '0') {
+                if (++significantDigits > MaxSignificantDigits)
+                    return convertDoubleCopy(begin, end);
+                mantissa = mantissa * 10 + static_cast<unsigned long>(*c - '0');
+            }
+            ++c;
+        }
+        
+        if (c < end && *c == '.') {
+            ++c;
+            while (c < end && isDigit(*c)) {
+                hasDigits = true;
+                if (mantissa != 0 || *c != '0') {
+                    if (++significantDigits > MaxSignificantDigits)
+                        return convertDoubleCopy(begin, end);
+                    mantissa = mantissa * 10 + static_cast<unsigned long>(*c - '0');
+                }
+                --exponent;
+                ++c;
+            }
+        }
+        
+        if (!hasDigits)
+            return convertDoubleCopy(begin, end);
+        
+        if (c < end && (*c == 'e' || *c == 'E')) {
+            ++c;
+            bool negativeExponent = false;
+            if (c < end && (*c == '-' || *c == '+'))
+                negativeExponent = (*c++ == '-');
+            if (c == end || !isDigit(*c))
+                return convertDoubleCopy(begin, end);
+            
+            int explicitExponent = 0;
+            while (c < end && isDigit(*c)) {
+                if (explicitExponent > 1000)
+                    return convertDoubleCopy(begin, end);
+                explicitExponent = explicitExponent * 10 + (*c++ - '0');
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        }
+        
+        if (c != end)
+            return convertDoubleCopy(begin, end);
+        
+        double value = static_cast<double>(mantissa);
+        if (mantissa != 0) {
+            if (exponent < -MaxExponent || exponent > MaxExponent)
+                return convertDoubleCopy(begin, end);
+            if (exponent < 0)
+                value /= PowersOfTen[-exponent];
+            else
+                value *= PowersOfTen[exponent];
+        }
+        return negative ? -value : value;
+    }
+    
+    static void appendDigits(String& str, unsigned long value) {
+        char buffer[20];
+        char* c = buffer + sizeof(buffer);
+        do {
+            *--c = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        str.append(c, static_cast<size_t>(buffer + sizeof(buffer) - c));
+    }
+    
+    void appendInt(String& str, const int value) {
+        if (value < 0) {
+            str.push_back('-');
+            // negate in unsigned arithmetic so that the smallest int does not overflow
+            appendDigits(str, 0ul - static_cast<unsigned long>(value));
+        } else {
+            appendDigits(str, static_cast<unsigned long>(value));
+        }
+    }
+    
+    // Appends a number formatted by the C library, replacing the decimal point of the current locale by a '.'.
+    static void appendWithDecimalPoint(String& str, const char* buffer, const size_t length) {
+        const char* decimalPoint = localeDecimalPoint();
+        const char* localePos = decimalPoint == NULL ? NULL : std::strstr(buffer, decimalPoint);
+        if (localePos == NULL) {
+            str.append(buffer, length);
+        } else {
+            str.append(buffer, static_cast<size_t>(localePos - buffer));
+            str.push_back('.');
+            str.append(localePos + std::strlen(decimalPoint));
+        }
+    }
+    
+    void appendDouble(String& str, const double value, const int precision) {
+        /*
+         An integral value with fewer significant digits than the precision is printed by %g without a decimal
+         point or an exponent, so its digits can be appended directly. Most coordinates and many texture attributes
+         in a map are integral. All other values are formatted by the C library.
+         */
+        static const double PowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+        static const int MaxIntegralDigits = 9;
+        
+        const double limit = PowersOfTen[std::max(0, std::min(precision, MaxIntegralDigits))];
+        const double magnitude = value < 0.0 ? -value : value;
+        if (magnitude < limit && magnitude == std::floor(magnitude)) {
+            // negative zero is printed as "-0"
+            if (value < 0.0 || (value == 0.0 && 1.0 / value < 0.0))
+                str.push_back('-');
+            appendDigits(str, static_cast<unsigned long>(magnitude));
+        } else {
+            char buffer[64];
+            const int length = std::sprintf(buffer, "%.*g", precision, value);
+            assert(length > 0 && static_cast<size_t>(length) < sizeof(buffer));
+            appendWithDecimalPoint(str, buffer, static_cast<size_t>(length));
+        }
+    }
 }
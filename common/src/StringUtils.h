@@ -257,6 +257,20 @@ namespace StringUtils {
     long stringToLong(const String& str);
     size_t stringToSize(const String& str);
     
+    /*
+     Convert the characters in the given range without copying them. The results are identical to those of std::atoi
+     and std::atof in the "C" locale, regardless of the current locale.
+     */
+    int stringToInt(const char* begin, const char* end);
+    double stringToDouble(const char* begin, const char* end);
+    
+    /*
+     Append the given value to the given string. The results are identical to those of std::sprintf with the
+     format "%d" and "%.<precision>g", respectively, in the "C" locale, regardless of the current locale.
+     */
+    void appendInt(String& str, int value);
+    void appendDouble(String& str, double value, int precision);
+    
     template <typename D>
     StringList split(const String& str, D d) {
         if (str.empty())
@@ -31,6 +31,9 @@ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
 #include <set>
 #include <vector>
 
+template <typename T, size_t S>
+struct VecKernels;
+
 template <typename T, size_t S>
 class Vec {
 private:
@@ -423,42 +426,27 @@ public:
     }
 
     const Vec<T,S> operator+(const Vec<T,S>& right) const {
-        Vec<T,S> result;
-        for (size_t i = 0; i < S; ++i)
-            result[i] = v[i] + right[i];
-        return result;
+        return VecKernels<T,S>::add(*this, right);
     }
     
     Vec<T,S>& operator+= (const Vec<T,S>& right) {
-        for (size_t i = 0; i < S; ++i)
-            v[i] += right[i];
-        return *this;
+        return *this = VecKernels<T,S>::add(*this, right);
     }
 
     const Vec<T,S> operator-(const Vec<T,S>& right) const {
-        Vec<T,S> result;
-        for (size_t i = 0; i < S; ++i)
-            result[i] = v[i] - right[i];
-        return result;
+        return VecKernels<T,S>::subtract(*this, right);
     }
     
     Vec<T,S>& operator-= (const Vec<T,S>& right) {
-        for (size_t i = 0; i < S; ++i)
-            v[i] -= right[i];
-        return *this;
+        return *this = VecKernels<T,S>::subtract(*this, right);
     }
     
     const Vec<T,S> operator*(const T right) const {
-        Vec<T,S> result;
-        for (size_t i = 0; i < S; ++i)
-            result[i] = v[i] * right;
-        return result;
+        return VecKernels<T,S>::multiply(*this, right);
     }
     
     Vec<T,S>& operator*= (const T right) {
-        for (size_t i = 0; i < S; ++i)
-            v[i] *= right;
-        return *this;
+        return *this = VecKernels<T,S>::multiply(*this, right);
     }
     
     const Vec<T,S> operator*(const Vec<T,S>& right) const {
@@ -579,10 +567,7 @@ public:
     }
 
     T dot(const Vec<T,S>& right) const {
-        T result = static_cast<T>(0.0);
-        for (size_t i = 0; i < S; ++i)
-            result += (v[i] * right[i]);
-        return result;
+        return VecKernels<T,S>::dot(*this, right);
     }
 
     // projects the given distance along this (normalized) vector onto the given vector along the orthogonal of this vector
@@ -957,6 +942,8 @@ public:
     }
 };
 
+#include "VecKernels.h"
+
 template <typename T, size_t S>
 const Vec<T,S> Vec<T,S>::PosX = Vec<T,S>::unit(0);
 template <typename T, size_t S>
@@ -1061,9 +1048,7 @@ Vec<T,3>& cross(Vec<T,3>& left, const Vec<T,3>& right) {
 
 template <typename T>
 const Vec<T,3> crossed(const Vec<T,3>& left, const Vec<T,3>& right) {
-    return Vec<T,3>(left[1] * right[2] - left[2] * right[1],
-                    left[2] * right[0] - left[0] * right[2],
-                    left[0] * right[1] - left[1] * right[0]);
+    return VecKernels<T,3>::cross(left, right);
 }
 
 template <typename T>
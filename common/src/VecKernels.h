@@ -0,0 +1,206 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VecKernels_h
+#define TrenchBroom_VecKernels_h
+
+// This file is included by Vec.h after the definition of Vec and must not be included directly.
+
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+/*
+ The arithmetic on vectors that the geometry code spends most of its time in. The specializations compute all
+ components at once. Dot products are still summed up from zero in the order of the components, so all kernels return
+ exactly the same results as the generic loops.
+ 
+ There is no specialization for vectors of three floats. They cannot be loaded into a register with a single
+ instruction, and assembling them costs more than the arithmetic saves.
+ */
+template <typename T, size_t S>
+struct VecKernels {
+    static Vec<T,S> add(const Vec<T,S>& left, const Vec<T,S>& right) {
+        Vec<T,S> result;
+        for (size_t i = 0; i < S; ++i)
+            result[i] = left[i] + right[i];
+        return result;
+    }
+    
+    static Vec<T,S> subtract(const Vec<T,S>& left, const Vec<T,S>& right) {
+        Vec<T,S> result;
+        for (size_t i = 0; i < S; ++i)
+            result[i] = left[i] - right[i];
+        return result;
+    }
+    
+    static Vec<T,S> multiply(const Vec<T,S>& left, const T right) {
+        Vec<T,S> result;
+        for (size_t i = 0; i < S; ++i)
+            result[i] = left[i] * right;
+        return result;
+    }
+    
+    static T dot(const Vec<T,S>& left, const Vec<T,S>& right) {
+        T result = static_cast<T>(0.0);
+        for (size_t i = 0; i < S; ++i)
+            result += (left[i] * right[i]);
+        return result;
+    }
+    
+    // only used for vectors with three components
+    static Vec<T,S> cross(const Vec<T,S>& left, const Vec<T,S>& right) {
+        return Vec<T,S>(left[1] * right[2] - left[2] * right[1],
+                        left[2] * right[0] - left[0] * right[2],
+                        left[0] * right[1] - left[1] * right[0]);
+    }
+};
+
+#ifdef __SSE2__
+template <>
+struct VecKernels<float,4> {
+    static Vec<float,4> add(const Vec<float,4>& left, const Vec<float,4>& right) {
+        return store(_mm_add_ps(load(left), load(right)));
+    }
+    
+    static Vec<float,4> subtract(const Vec<float,4>& left, const Vec<float,4>& right) {
+        return store(_mm_sub_ps(load(left), load(right)));
+    }
+    
+    static Vec<float,4> multiply(const Vec<float,4>& left, const float right) {
+        return store(_mm_mul_ps(load(left), _mm_set1_ps(right)));
+    }
+    
+    static float dot(const Vec<float,4>& left, const Vec<float,4>& right) {
+        float products[4];
+        _mm_storeu_ps(products, _mm_mul_ps(load(left), load(right)));
+        return (((0.0f + products[0]) + products[1]) + products[2]) + products[3];
+    }
+private:
+    static __m128 load(const Vec<float,4>& vec) {
+        return _mm_loadu_ps(&vec[0]);
+    }
+    
+    static Vec<float,4> store(const __m128 values) {
+        Vec<float,4> result;
+        _mm_storeu_ps(&result[0], values);
+        return result;
+    }
+};
+
+// A vector of three doubles is split into a register holding x and y and a register holding only z.
+template <>
+struct VecKernels<double,3> {
+    static Vec<double,3> add(const Vec<double,3>& left, const Vec<double,3>& right) {
+        return store(_mm_add_pd(_mm_loadu_pd(&left[0]), _mm_loadu_pd(&right[0])),
+                     _mm_add_sd(_mm_load_sd(&left[2]), _mm_load_sd(&right[2])));
+    }
+    
+    static Vec<double,3> subtract(const Vec<double,3>& left, const Vec<double,3>& right) {
+        return store(_mm_sub_pd(_mm_loadu_pd(&left[0]), _mm_loadu_pd(&right[0])),
+                     _mm_sub_sd(_mm_load_sd(&left[2]), _mm_load_sd(&right[2])));
+    }
+    
+    static Vec<double,3> multiply(const Vec<double,3>& left, const double right) {
+        const __m128d factor = _mm_set1_pd(right);
+        return store(_mm_mul_pd(_mm_loadu_pd(&left[0]), factor),
+                     _mm_mul_sd(_mm_load_sd(&left[2]), factor));
+    }
+    
+    static double dot(const Vec<double,3>& left, const Vec<double,3>& right) {
+        double products[2];
+        _mm_storeu_pd(products, _mm_mul_pd(_mm_loadu_pd(&left[0]), _mm_loadu_pd(&right[0])));
+        return ((0.0 + products[0]) + products[1]) + left[2] * right[2];
+    }
+    
+    static Vec<double,3> cross(const Vec<double,3>& left, const Vec<double,3>& right) {
+        // x and y of the result in one register, z in the other
+        const __m128d lyz = _mm_loadu_pd(&left[1]);
+        const __m128d ryz = _mm_loadu_pd(&right[1]);
+        const __m128d lzx = _mm_setr_pd(left[2], left[0]);
+        const __m128d rzx = _mm_setr_pd(right[2], right[0]);
+        const __m128d xy = _mm_sub_pd(_mm_mul_pd(lyz, rzx), _mm_mul_pd(lzx, ryz));
+        const __m128d z = _mm_set_sd(left[0] * right[1] - left[1] * right[0]);
+        return store(xy, z);
+    }
+private:
+    static Vec<double,3> store(const __m128d xy, const __m128d z) {
+        Vec<double,3> result;
+        _mm_storeu_pd(&result[0], xy);
+        _mm_store_sd(&result[2], z);
+        return result;
+    }
+};
+
+template <>
+struct VecKernels<double,4> {
+    static Vec<double,4> add(const Vec<double,4>& left, const Vec<double,4>& right) {
+        Vec<double,4> result;
+#ifdef __AVX__
+        _mm256_storeu_pd(&result[0], _mm256_add_pd(_mm256_loadu_pd(&left[0]), _mm256_loadu_pd(&right[0])));
+#else
+        _mm_storeu_pd(&result[0], _mm_add_pd(_mm_loadu_pd(&left[0]), _mm_loadu_pd(&right[0])));
+        _mm_storeu_pd(&result[2], _mm_add_pd(_mm_loadu_pd(&left[2]), _mm_loadu_pd(&right[2])));
+#endif
+        return result;
+    }
+    
+    static Vec<double,4> subtract(const Vec<double,4>& left, const Vec<double,4>& right) {
+        Vec<double,4> result;
+#ifdef __AVX__
+        _mm256_storeu_pd(&result[0], _mm256_sub_pd(_mm256_loadu_pd(&left[0]), _mm256_loadu_pd(&right[0])));
+#else
+        _mm_storeu_pd(&result[0], _mm_sub_pd(_mm_loadu_pd(&left[0]), _mm_loadu_pd(&right[0])));
+        _mm_storeu_pd(&result[2], _mm_sub_pd(_mm_loadu_pd(&left[2]), _mm_loadu_pd(&right[2])));
+#endif
+        return result;
+    }
+    
+    static Vec<double,4> multiply(const Vec<double,4>& left, const double right) {
+        Vec<double,4> result;
+#ifdef __AVX__
+        _mm256_storeu_pd(&result[0], _mm256_mul_pd(_mm256_loadu_pd(&left[0]), _mm256_set1_pd(right)));
+#else
+        const __m128d factor = _mm_set1_pd(right);
+        _mm_storeu_pd(&result[0], _mm_mul_pd(_mm_loadu_pd(&left[0]), factor));
+        _mm_storeu_pd(&result[2], _mm_mul_pd(_mm_loadu_pd(&left[2]), factor));
+#endif
+        return result;
+    }
+    
+    static double dot(const Vec<double,4>& left, const Vec<double,4>& right) {
+        double products[4];
+#ifdef __AVX__
+        _mm256_storeu_pd(products, _mm256_mul_pd(_mm256_loadu_pd(&left[0]), _mm256_loadu_pd(&right[0])));
+#else
+        _mm_storeu_pd(&products[0], _mm_mul_pd(_mm_loadu_pd(&left[0]), _mm_loadu_pd(&right[0])));
+        _mm_storeu_pd(&products[2], _mm_mul_pd(_mm_loadu_pd(&left[2]), _mm_loadu_pd(&right[2])));
+#endif
+        return (((0.0 + products[0]) + products[1]) + products[2]) + products[3];
+    }
+};
+#endif
+
+#endif
@@ -22,12 +22,131 @@
 #include "StringUtils.h"
 #include "SetAny.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/MapSnapshot.h"
+#include "Model/Game.h"
+#include "View/CachingLogger.h"
 #include "View/MapDocument.h"
 
 #include <cassert>
 
+#include <wx/thread.h>
+
 namespace TrenchBroom {
     namespace View {
+        class Autosaver::BackupThread : public wxThread {
+        private:
+            Model::GamePtr m_game;
+            IO::MapSnapshot* m_snapshot;
+            IO::Path m_mapPath;
+            size_t m_maxBackups;
+            CachingLogger m_logger;
+            
+            wxCriticalSection m_critical;
+            bool m_finished;
+        public:
+            BackupThread(Model::GamePtr game, IO::MapSnapshot* snapshot, const IO::Path& mapPath, const size_t maxBackups) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_game(game),
+            m_snapshot(snapshot),
+            m_mapPath(mapPath),
+            m_maxBackups(maxBackups),
+            m_finished(false) {
+                assert(m_snapshot != NULL);
+            }
+            
+            ~BackupThread() {
+                delete m_snapshot;
+                m_snapshot = NULL;
+            }
+            
+            bool finished() {
+                wxCriticalSectionLocker lock(m_critical);
+                return m_finished;
+            }
+            
+            // Must only be called once the backup has finished.
+            void logMessages(Logger* logger) {
+                if (logger != NULL)
+                    m_logger.setParentLogger(logger);
+            }
+
+            void backup() {
+                const IO::Path mapFilename = m_mapPath.lastComponent();
+                const IO::Path mapBasename = mapFilename.deleteExtension();
+                
+                try {
+                    IO::WritableDiskFileSystem fs = createBackupFileSystem();
+                    IO::Path::List backups = collectBackups(fs, mapBasename);
+                    
+                    thinBackups(fs, backups);
+                    cleanBackups(fs, backups, mapBasename);
+                    
+                    assert(backups.size() < m_maxBackups);
+                    const size_t backupNo = backups.size() + 1;
+                    
+                    const IO::Path backupFilePath = fs.getPath() + makeBackupName(mapBasename, backupNo);
+                    m_game->writeMapSnapshot(*m_snapshot, backupFilePath);
+                    
+                    m_logger.info("Created autosave backup at %s", backupFilePath.asString().c_str());
+                } catch (FileSystemException e) {
+                    m_logger.error("Aborting autosave");
+                }
+            }
+        private:
+            ExitCode Entry() {
+                backup();
+                
+                wxCriticalSectionLocker lock(m_critical);
+                m_finished = true;
+                return static_cast<ExitCode>(0);
+            }
+            
+            IO::WritableDiskFileSystem createBackupFileSystem() {
+                const IO::Path basePath = m_mapPath.deleteLastComponent();
+                const IO::Path autosavePath = basePath + IO::Path("autosave");
+                
+                try {
+                    // ensures that the directory exists or is created if it doesn't
+                    return IO::WritableDiskFileSystem(autosavePath, true);
+                } catch (FileSystemException e) {
+                    m_logger.error("Cannot create autosave directory at %s", autosavePath.asString().c_str());
+                    throw e;
+                }
+            }
+            
+            IO::Path::List collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const;
+            
+            void thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups) {
+                while (backups.size() > m_maxBackups - 1) {
+                    const IO::Path filename = backups.front();
+                    try {
+                        fs.deleteFile(filename);
+                        m_logger.debug("Deleted autosave backup %s", filename.asString().c_str());
+                        backups.erase(backups.begin());
+                    } catch (FileSystemException e) {
+                        m_logger.error("Cannot delete autosave backup %s", filename.asString().c_str());
+                        throw e;
+                    }
+                }
+            }
+            
+            void cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) const {
+                for (size_t i = 0; i < backups.size(); ++i) {
+                    const IO::Path& oldName = backups[i].lastComponent();
+                    const IO::Path newName = makeBackupName(mapBasename, i + 1);
+                    
+                    if (oldName != newName)
+                        fs.moveFile(oldName, newName, false);
+                }
+            }
+            
+            String makeBackupName(const IO::Path& mapBasename, const size_t index) const {
+                StringStream str;
+                str << mapBasename.asString() << "." << index << ".map";
+                return str.str();
+            }
+        };
+        
         Autosaver::Autosaver(View::MapDocumentWPtr document, const time_t saveInterval, const time_t idleInterval, const size_t maxBackups) :
         m_document(document),
         m_logger(NULL),
@@ -36,16 +155,23 @@ namespace TrenchBroom {
         m_maxBackups(maxBackups),
         m_lastSaveTime(time(NULL)),
         m_lastModificationTime(0),
-        m_lastModificationCount(lock(m_document)->modificationCount()) {
+        m_lastModificationCount(lock(m_document)->modificationCount()),
+        m_backupThread(NULL) {
             bindObservers();
         }
         
         Autosaver::~Autosaver() {
             unbindObservers();
+            finishBackup(true);
             triggerAutosave(NULL);
+            finishBackup(true);
         }
         
         void Autosaver::triggerAutosave(Logger* logger) {
+            SetAny<Logger*> setLogger(m_logger, logger);
+            if (!finishBackup(false))
+                return;
+            
             const time_t currentTime = time(NULL);
             
             MapDocumentSPtr document = lock(m_document);
@@ -64,54 +190,41 @@ namespace TrenchBroom {
             if (!IO::Disk::fileExists(IO::Disk::fixPath(document->path())))
                 return;
             
-            SetAny<Logger*> setLogger(m_logger, logger);
             autosave(document);
         }
         
         void Autosaver::autosave(MapDocumentSPtr document) {
+            assert(m_backupThread == NULL);
+            
             const IO::Path& mapPath = document->path();
             assert(IO::Disk::fileExists(IO::Disk::fixPath(mapPath)));
             
-            const IO::Path mapFilename = mapPath.lastComponent();
-            const IO::Path mapBasename = mapFilename.deleteExtension();
+            // the snapshot must be taken here because the document may only be accessed on this thread
+            IO::MapSnapshot* snapshot = new IO::MapSnapshot(document->world());
+            m_lastSaveTime = time(NULL);
+            m_lastModificationCount = document->modificationCount();
             
-            try {
-                IO::WritableDiskFileSystem fs = createBackupFileSystem(mapPath);
-                IO::Path::List backups = collectBackups(fs, mapBasename);
-                
-                thinBackups(fs, backups);
-                cleanBackups(fs, backups, mapBasename);
-
-                assert(backups.size() < m_maxBackups);
-                const size_t backupNo = backups.size() + 1;
-                
-                const IO::Path backupFilePath = fs.getPath() + makeBackupName(mapBasename, backupNo);
-
-                m_lastSaveTime = time(NULL);
-                m_lastModificationCount = document->modificationCount();
-                document->saveDocumentTo(backupFilePath);
-                
-                if (m_logger != NULL)
-                    m_logger->info("Created autosave backup at %s", backupFilePath.asString().c_str());
-                
-            } catch (FileSystemException e) {
-                if (m_logger != NULL)
-                    m_logger->error("Aborting autosave");
+            BackupThread* thread = new BackupThread(document->game(), snapshot, mapPath, m_maxBackups);
+            if (thread->Run() == wxTHREAD_NO_ERROR) {
+                m_backupThread = thread;
+            } else {
+                thread->backup();
+                thread->logMessages(m_logger);
+                delete thread;
             }
         }
         
-        IO::WritableDiskFileSystem Autosaver::createBackupFileSystem(const IO::Path& mapPath) const {
-            const IO::Path basePath = mapPath.deleteLastComponent();
-            const IO::Path autosavePath = basePath + IO::Path("autosave");
-
-            try {
-                // ensures that the directory exists or is created if it doesn't
-                return IO::WritableDiskFileSystem(autosavePath, true);
-            } catch (FileSystemException e) {
-                if (m_logger != NULL)
-                    m_logger->error("Cannot create autosave directory at %s", autosavePath.asString().c_str());
-                throw e;
-            }
+        bool Autosaver::finishBackup(const bool wait) {
+            if (m_backupThread == NULL)
+                return true;
+            if (!wait && !m_backupThread->finished())
+                return false;
+            
+            m_backupThread->Wait();
+            m_backupThread->logMessages(m_logger);
+            delete m_backupThread;
+            m_backupThread = NULL;
+            return true;
         }
 
         struct BackupFileMatcher {
@@ -142,44 +255,12 @@ namespace TrenchBroom {
             return extractBackupNo(lhs) < extractBackupNo(rhs);
         }
         
-        IO::Path::List Autosaver::collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const {
+        IO::Path::List Autosaver::BackupThread::collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const {
             IO::Path::List backups = fs.findItems(IO::Path(""), BackupFileMatcher(mapBasename));
             std::sort(backups.begin(), backups.end(), compareBackupsByNo);
             return backups;
         }
         
-        void Autosaver::thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups) const {
-            while (backups.size() > m_maxBackups - 1) {
-                const IO::Path filename = backups.front();
-                try {
-                    fs.deleteFile(filename);
-                    if (m_logger != NULL)
-                        m_logger->debug("Deleted autosave backup %s", filename.asString().c_str());
-                    backups.erase(backups.begin());
-                } catch (FileSystemException e) {
-                    if (m_logger != NULL)
-                        m_logger->error("Cannot delete autosave backup %s", filename.asString().c_str());
-                    throw e;
-                }
-            }
-        }
-        
-        void Autosaver::cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) const {
-            for (size_t i = 0; i < backups.size(); ++i) {
-                const IO::Path& oldName = backups[i].lastComponent();
-                const IO::Path newName = makeBackupName(mapBasename, i + 1);
-                
-                if (oldName != newName)
-                    fs.moveFile(oldName, newName, false);
-            }
-        }
-        
-        String Autosaver::makeBackupName(const IO::Path& mapBasename, const size_t index) const {
-            StringStream str;
-            str << mapBasename.asString() << "." << index << ".map";
-            return str.str();
-        }
-        
         size_t extractBackupNo(const IO::Path& path) {
             const size_t no = StringUtils::stringToSize(path.deleteExtension().extension());
             assert(no > 0);
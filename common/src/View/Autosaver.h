@@ -28,15 +28,17 @@
 namespace TrenchBroom {
     class Logger;
     
-    namespace IO {
-        class WritableDiskFileSystem;
-    }
-    
     namespace View {
         class Command;
         
+        /*
+         Backups are written by a worker thread from a snapshot of the map so that the user can continue editing in the
+         meantime. The outcome of a backup is logged when the next autosave is triggered.
+         */
         class Autosaver {
         private:
+            class BackupThread;
+            
             View::MapDocumentWPtr m_document;
             Logger* m_logger;
             
@@ -47,6 +49,8 @@ namespace TrenchBroom {
             time_t m_lastSaveTime;
             time_t m_lastModificationTime;
             size_t m_lastModificationCount;
+            
+            BackupThread* m_backupThread;
         public:
             Autosaver(View::MapDocumentWPtr document, time_t saveInterval = 10 * 60, time_t idleInterval = 3, size_t maxBackups = 50);
             ~Autosaver();
@@ -54,12 +58,7 @@ namespace TrenchBroom {
             void triggerAutosave(Logger* logger);
         private:
             void autosave(View::MapDocumentSPtr document);
-            IO::WritableDiskFileSystem createBackupFileSystem(const IO::Path& mapPath) const;
-            IO::Path::List collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const;
-            bool isBackup(const IO::Path& backupPath, const IO::Path& mapBasename) const;
-            void thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups) const;
-            void cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) const;
-            String makeBackupName(const IO::Path& mapBasename, const size_t index) const;
+            bool finishBackup(bool wait);
         private:
             void bindObservers();
             void unbindObservers();
@@ -236,9 +236,12 @@ namespace TrenchBroom {
             const Model::BrushFace* face = Model::hitToFace(hit);
             
             const Model::BrushFace::VertexList vertices = face->vertices();
+            Vec3::List positions;
+            positions.reserve(vertices.size());
             Model::BrushFace::VertexList::const_iterator it, end;
             for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
-                polyhedron.addPoint((*it)->position());
+                positions.push_back((*it)->position());
+            polyhedron.addPoints(positions);
             m_tool->update(polyhedron);
             
             return true;
@@ -19,6 +19,7 @@
 
 #include "View/MapDocument.h"
 
+#include "ParallelTaskRunner.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
 #include "Polyhedron.h"
@@ -28,6 +29,7 @@
 #include "Assets/Texture.h"
 #include "Assets/TextureManager.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/MapFileSplicer.h"
 #include "IO/SystemPaths.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
@@ -35,14 +37,12 @@
 #include "Model/BrushGeometry.h"
 #include "Model/ChangeBrushFaceAttributesRequest.h"
 #include "Model/CollectAttributableNodesVisitor.h"
-#include "Model/CollectContainedNodesVisitor.h"
 #include "Model/CollectMatchingBrushFacesVisitor.h"
 #include "Model/CollectNodesVisitor.h"
 #include "Model/CollectNodesByVisibilityVisitor.h"
 #include "Model/CollectSelectableNodesVisitor.h"
 #include "Model/CollectSelectableNodesWithFilePositionVisitor.h"
 #include "Model/CollectSelectedNodesVisitor.h"
-#include "Model/CollectTouchingNodesVisitor.h"
 #include "Model/CollectUniqueNodesVisitor.h"
 #include "Model/ComputeNodeBoundsVisitor.h"
 #include "Model/EditorContext.h"
@@ -59,6 +59,7 @@
 #include "Model/MissingEntityDefinitionIssueGenerator.h"
 #include "Model/MixedBrushContentsIssueGenerator.h"
 #include "Model/Node.h"
+#include "Model/NodeQueryBatch.h"
 #include "Model/NodeVisitor.h"
 #include "Model/NonIntegerPlanePointsIssueGenerator.h"
 #include "Model/NonIntegerVerticesIssueGenerator.h"
@@ -117,6 +118,7 @@ namespace TrenchBroom {
         m_mapViewConfig(new MapViewConfig(*m_editorContext)),
         m_grid(new Grid(4)),
         m_path(DefaultDocumentName),
+        m_mapFileSplicer(new IO::MapFileSplicer()),
         m_lastSaveModificationCount(0),
         m_modificationCount(0),
         m_currentTextureName(Model::BrushFace::NoTextureName),
@@ -133,6 +135,7 @@ namespace TrenchBroom {
                 unloadPointFile();
             clearWorld();
             
+            delete m_mapFileSplicer;
             delete m_grid;
             delete m_mapViewConfig;
             delete m_textureManager;
@@ -259,7 +262,10 @@ namespace TrenchBroom {
         void MapDocument::saveDocumentTo(const IO::Path& path) {
             assert(m_game != NULL);
             assert(m_world != NULL);
-            m_game->writeMap(m_world, path);
+            
+            const bool incremental = pref(Preferences::IncrementalSave);
+            m_game->writeMap(m_world, path, incremental ? m_mapFileSplicer : NULL);
+            recordMapFile(path);
         }
         
         void MapDocument::doSaveDocument(const IO::Path& path) {
@@ -445,7 +451,9 @@ namespace TrenchBroom {
         
         void MapDocument::selectTouching(const bool del) {
             const Model::BrushList& brushes = m_selectedNodes.brushes();
-            const Model::NodeList nodes = Model::collectMatchingNodes<Model::CollectTouchingNodesVisitor>(brushes.begin(), brushes.end(), m_world);
+            const ParallelTaskRunner runner;
+            const Model::NodeQueryBatch batch(m_world, runner);
+            const Model::NodeList nodes = batch.findTouchingNodes(brushes);
             
             Transaction transaction(this, "Select Touching");
             if (del)
@@ -457,7 +465,9 @@ namespace TrenchBroom {
         
         void MapDocument::selectInside(const bool del) {
             const Model::BrushList& brushes = m_selectedNodes.brushes();
-            const Model::NodeList nodes = Model::collectMatchingNodes<Model::CollectContainedNodesVisitor>(brushes.begin(), brushes.end(), m_world);
+            const ParallelTaskRunner runner;
+            const Model::NodeQueryBatch batch(m_world, runner);
+            const Model::NodeList nodes = batch.findContainedNodes(brushes);
             
             Transaction transaction(this, "Select Inside");
             if (del)
@@ -759,7 +769,7 @@ namespace TrenchBroom {
             if (!hasSelectedBrushFaces() && !selectedNodes().hasOnlyBrushes())
                 return false;
             
-            Polyhedron3 polyhedron;
+            Vec3::List points;
             
             if (hasSelectedBrushFaces()) {
                 const Model::BrushFaceList& faces = selectedBrushFaces();
@@ -770,7 +780,7 @@ namespace TrenchBroom {
                     Model::BrushFace::VertexList::const_iterator vIt, vEnd;
                     for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd; ++vIt) {
                         const Model::BrushVertex* vertex = *vIt;
-                        polyhedron.addPoint(vertex->position());
+                        points.push_back(vertex->position());
                     }
                 }
             } else if (selectedNodes().hasOnlyBrushes()) {
@@ -782,11 +792,13 @@ namespace TrenchBroom {
                     Model::Brush::VertexList::const_iterator vIt, vEnd;
                     for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd; ++vIt) {
                         const Model::BrushVertex* vertex = *vIt;
-                        polyhedron.addPoint(vertex->position());
+                        points.push_back(vertex->position());
                     }
                 }
             }
             
+            const Polyhedron3 polyhedron(points);
+            
             if (!polyhedron.polyhedron() || !polyhedron.closed())
                 return false;
             
@@ -810,17 +822,19 @@ namespace TrenchBroom {
             if (brushes.size() < 2)
                 return false;
             
-            const Model::BrushList minuends(brushes.begin(), brushes.end() - 1);
             Model::Brush* subtrahend = brushes.back();
+            const Model::BrushList minuends = findSubtractMinuends(Model::BrushList(brushes.begin(), brushes.end() - 1), subtrahend);
+            
+            const ParallelTaskRunner runner;
+            const Model::Brush::BrushLists results = Model::Brush::subtract(*m_world, m_worldBounds, currentTextureName(), minuends, subtrahend, runner);
             
             Model::ParentChildrenMap toAdd;
             Model::NodeList toRemove;
             toRemove.push_back(subtrahend);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = minuends.begin(), end = minuends.end(); it != end; ++it) {
-                Model::Brush* minuend = *it;
-                const Model::BrushList result = minuend->subtract(*m_world, m_worldBounds, currentTextureName(), subtrahend);
+            for (size_t i = 0; i < minuends.size(); ++i) {
+                Model::Brush* minuend = minuends[i];
+                const Model::BrushList& result = results[i];
                 if (!result.empty()) {
                     VectorUtils::append(toAdd[minuend->parent()], result);
                     toRemove.push_back(minuend);
@@ -835,6 +849,27 @@ namespace TrenchBroom {
             return true;
         }
 
+        /*
+         Only the brushes that intersect the subtrahend can be cut by it. The world's spatial index yields the brushes
+         whose bounds intersect the subtrahend's bounds, and the selected ones among them are then tested exactly. The
+         minuends keep the order of the given brushes.
+         */
+        Model::BrushList MapDocument::findSubtractMinuends(const Model::BrushList& brushes, const Model::Brush* subtrahend) {
+            Model::NodeList candidateList;
+            m_world->findNodesIntersecting(subtrahend->bounds(), candidateList);
+            
+            const Model::NodeSet candidates(candidateList.begin(), candidateList.end());
+            
+            Model::BrushList result;
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                Model::Brush* brush = *it;
+                if (candidates.count(brush) > 0 && brush->intersects(subtrahend))
+                    result.push_back(brush);
+            }
+            return result;
+        }
+
         bool MapDocument::csgIntersect() {
             const Model::BrushList brushes = selectedNodes().brushes();
             if (brushes.size() < 2)
@@ -1086,19 +1121,29 @@ namespace TrenchBroom {
         void MapDocument::loadWorld(const Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GamePtr game, const IO::Path& path) {
             m_worldBounds = worldBounds;
             m_game = game;
-            m_world = m_game->loadMap(mapFormat, m_worldBounds, path, this);
+            m_world = m_game->loadMap(mapFormat, m_worldBounds, path, pref(Preferences::UseMapCache), pref(Preferences::DeferBrushGeometry), this);
             setCurrentLayer(m_world->defaultLayer());
+            recordMapFile(path);
             
             updateGameSearchPaths();
             setPath(path);
         }
         
         void MapDocument::clearWorld() {
+            m_mapFileSplicer->clear();
             delete m_world;
             m_world = NULL;
             m_currentLayer = NULL;
         }
         
+        // The file positions of the brushes now refer to the given file.
+        void MapDocument::recordMapFile(const IO::Path& path) {
+            if (pref(Preferences::IncrementalSave))
+                m_mapFileSplicer->record(path, m_world);
+            else
+                m_mapFileSplicer->clear();
+        }
+        
         void MapDocument::initializeWorld(const BBox3& worldBounds) {
             const Model::BrushBuilder builder(m_world, worldBounds);
             Model::Brush* brush = builder.createCuboid(Vec3(128.0, 128.0, 32.0), Model::BrushFace::NoTextureName);
@@ -1500,6 +1545,9 @@ namespace TrenchBroom {
             m_mapViewConfig->mapViewConfigDidChangeNotifier.addObserver(mapViewConfigDidChangeNotifier);
             commandDoneNotifier.addObserver(this, &MapDocument::commandDone);
             commandUndoneNotifier.addObserver(this, &MapDocument::commandUndone);
+            nodesDidChangeNotifier.addObserver(m_mapFileSplicer, &IO::MapFileSplicer::nodesDidChange);
+            nodesWillBeRemovedNotifier.addObserver(m_mapFileSplicer, &IO::MapFileSplicer::nodesWillBeRemoved);
+            brushFacesDidChangeNotifier.addObserver(m_mapFileSplicer, &IO::MapFileSplicer::brushFacesDidChange);
         }
         
         void MapDocument::unbindObservers() {
@@ -1509,6 +1557,9 @@ namespace TrenchBroom {
             m_mapViewConfig->mapViewConfigDidChangeNotifier.removeObserver(mapViewConfigDidChangeNotifier);
             commandDoneNotifier.removeObserver(this, &MapDocument::commandDone);
             commandUndoneNotifier.removeObserver(this, &MapDocument::commandUndone);
+            nodesDidChangeNotifier.removeObserver(m_mapFileSplicer, &IO::MapFileSplicer::nodesDidChange);
+            nodesWillBeRemovedNotifier.removeObserver(m_mapFileSplicer, &IO::MapFileSplicer::nodesWillBeRemoved);
+            brushFacesDidChangeNotifier.removeObserver(m_mapFileSplicer, &IO::MapFileSplicer::brushFacesDidChange);
         }
         
         void MapDocument::preferenceDidChange(const IO::Path& path) {
@@ -43,6 +43,10 @@ namespace TrenchBroom {
         class TextureManager;
     }
     
+    namespace IO {
+        class MapFileSplicer;
+    }
+    
     namespace Model {
         class BrushFaceAttributes;
         class ChangeBrushFaceAttributesRequest;
@@ -81,6 +85,7 @@ namespace TrenchBroom {
             Grid* m_grid;
             
             IO::Path m_path;
+            IO::MapFileSplicer* m_mapFileSplicer;
             size_t m_lastSaveModificationCount;
             size_t m_modificationCount;
 
@@ -265,6 +270,8 @@ namespace TrenchBroom {
             bool csgConvexMerge();
             bool csgSubtract();
             bool csgIntersect();
+        private:
+            Model::BrushList findSubtractMinuends(const Model::BrushList& brushes, const Model::Brush* subtrahend);
         public: // modifying entity attributes, declared in MapFacade interface
             bool setAttribute(const Model::AttributeName& name, const Model::AttributeValue& value);
             bool renameAttribute(const Model::AttributeName& oldName, const Model::AttributeName& newName);
@@ -336,6 +343,7 @@ namespace TrenchBroom {
             void createWorld(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GamePtr game);
             void loadWorld(Model::MapFormat::Type mapFormat, const BBox3& worldBounds, Model::GamePtr game, const IO::Path& path);
             void clearWorld();
+            void recordMapFile(const IO::Path& path);
             void initializeWorld(const BBox3& worldBounds);
         public: // asset management
             Assets::EntityDefinitionFileSpec entityDefinitionFile() const;
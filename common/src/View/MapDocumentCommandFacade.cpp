@@ -20,10 +20,13 @@
 #include "MapDocumentCommandFacade.h"
 
 #include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "ParallelTaskRunner.h"
 #include "Assets/EntityDefinitionFileSpec.h"
 #include "Assets/TextureManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
+#include "Model/BrushGeometryBatch.h"
 #include "Model/ChangeBrushFaceAttributesRequest.h"
 #include "Model/CollectNodesWithDescendantSelectionCountVisitor.h"
 #include "Model/CollectRecursivelySelectedNodesVisitor.h"
@@ -585,6 +588,7 @@ namespace TrenchBroom {
             Model::Node::accept(nodes.begin(), nodes.end(), visitor);
             
             invalidateSelectionBounds();
+            visitor.transformBrushes(ParallelTaskRunner());
         }
 
         Model::EntityAttributeSnapshot::Map MapDocumentCommandFacade::performSetAttribute(const Model::AttributeName& name, const Model::AttributeValue& value) {
@@ -768,10 +772,14 @@ namespace TrenchBroom {
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
-                Model::Brush* brush = *it;
-                brush->findIntegerPlanePoints(m_worldBounds);
+            try {
+                const ParallelTaskRunner runner;
+                const Model::BrushGeometryBatch batch(m_worldBounds, runner);
+                batch.findIntegerPlanePoints(brushes);
+            } catch (const GeometryException&) {
+                snapshot->restoreNodes(m_worldBounds);
+                delete snapshot;
+                throw;
             }
             
             return snapshot;
@@ -935,13 +943,18 @@ namespace TrenchBroom {
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
-                Model::Brush* brush = *it;
-                brush->rebuildGeometry(m_worldBounds);
-            }
-
             invalidateSelectionBounds();
+            
+            Model::Snapshot snapshot(brushes.begin(), brushes.end());
+            try {
+                const ParallelTaskRunner runner;
+                const Model::BrushGeometryBatch batch(m_worldBounds, runner);
+                batch.rebuildGeometry(brushes);
+            } catch (const GeometryException&) {
+                // the valid brushes were rebuilt nonetheless
+                snapshot.restoreNodes(m_worldBounds);
+                throw;
+            }
         }
 
         void MapDocumentCommandFacade::restoreSnapshot(Model::Snapshot* snapshot) {
@@ -309,7 +309,7 @@ namespace TrenchBroom {
                 const Ray3f pickRay = m_camera.pickRay(clientCoords.x, clientCoords.y);
                 
                 const Model::EditorContext& editorContext = document->editorContext();
-                Model::PickResult pickResult = Model::PickResult::byDistance(editorContext);
+                Model::PickResult pickResult = Model::PickResult::firstByDistance(editorContext, Model::Brush::BrushHit, 1);
 
                 document->pick(Ray3(pickRay), pickResult);
                 const Model::Hit& hit = pickResult.query().pickable().type(Model::Brush::BrushHit).first();
@@ -50,6 +50,8 @@ namespace TrenchBroom {
             assert(m_toolBox != NULL);
 
             m_inputState.setPickRequest(doGetPickRequest(m_inputState.mouseX(),  m_inputState.mouseY()));
+            // The tools query this result for selected objects behind others and drill through all hits, so it
+            // cannot stop at the first hit.
             Model::PickResult pickResult = doPick(m_inputState.pickRay());
             m_toolBox->pick(m_toolChain, m_inputState, pickResult);
             m_inputState.setPickResult(pickResult);
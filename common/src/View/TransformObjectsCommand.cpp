@@ -19,6 +19,7 @@
 
 #include "TransformObjectsCommand.h"
 
+#include "Exceptions.h"
 #include "Macros.h"
 #include "Model/Snapshot.h"
 #include "View/MapDocument.h"
@@ -56,7 +57,14 @@ namespace TrenchBroom {
         
         bool TransformObjectsCommand::doPerformDo(MapDocumentCommandFacade* document) {
             takeSnapshot(document->selectedNodes().nodes());
-            document->performTransform(m_transform, m_lockTextures);
+            try {
+                document->performTransform(m_transform, m_lockTextures);
+            } catch (const GeometryException&) {
+                // the valid brushes were transformed nonetheless
+                document->restoreSnapshot(m_snapshot);
+                deleteSnapshot();
+                throw;
+            }
             return true;
         }
         
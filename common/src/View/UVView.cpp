@@ -215,10 +215,12 @@ namespace TrenchBroom {
                 const Vec3f pos3 = +w2 * r -h2 * u + p;
                 const Vec3f pos4 = -w2 * r -h2 * u + p;
                 
-                vertices.push_back(Vertex(pos1, normal, face->textureCoords(pos1)));
-                vertices.push_back(Vertex(pos2, normal, face->textureCoords(pos2)));
-                vertices.push_back(Vertex(pos3, normal, face->textureCoords(pos3)));
-                vertices.push_back(Vertex(pos4, normal, face->textureCoords(pos4)));
+                const Vec3 positions[4] = { pos1, pos2, pos3, pos4 };
+                Vec2f texCoords[4];
+                face->textureCoords(positions, 4, texCoords);
+                
+                for (size_t i = 0; i < 4; ++i)
+                    vertices.push_back(Vertex(positions[i], normal, texCoords[i]));
                 
                 return vertices;
             }
@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Allocator.h"
+#include "ParallelTaskRunner.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace TrenchBroom {
+    class AllocatedObject : public Allocator<AllocatedObject> {
+    public:
+        typedef std::vector<AllocatedObject*> List;
+        
+        size_t value;
+        double padding[3];
+        
+        AllocatedObject(const size_t i_value) :
+        value(i_value) {}
+    };
+    
+    static void deleteAll(const AllocatedObject::List& objects) {
+        AllocatedObject::List::const_iterator it, end;
+        for (it = objects.begin(), end = objects.end(); it != end; ++it)
+            delete *it;
+    }
+    
+    TEST(AllocatorTest, allocateAndDelete) {
+        const size_t liveBefore = AllocatedObject::statistics().liveBlocks;
+        
+        AllocatedObject::List objects;
+        for (size_t i = 0; i < 10000; ++i)
+            objects.push_back(new AllocatedObject(i));
+        
+        const AllocatedObject::Statistics allocated = AllocatedObject::statistics();
+        ASSERT_EQ(liveBefore + 10000, allocated.liveBlocks);
+        ASSERT_GE(allocated.bytes, 10000 * sizeof(AllocatedObject));
+        ASSERT_EQ(allocated.chunkCount * 16384, allocated.bytes);
+        
+        // all blocks are distinct and no object overwrote another one
+        AllocatedObject::List sorted = objects;
+        std::sort(sorted.begin(), sorted.end());
+        ASSERT_TRUE(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+        for (size_t i = 0; i < objects.size(); ++i)
+            ASSERT_EQ(i, objects[i]->value);
+        
+        deleteAll(objects);
+        
+        const AllocatedObject::Statistics deleted = AllocatedObject::statistics();
+        ASSERT_EQ(liveBefore, deleted.liveBlocks);
+        ASSERT_LT(deleted.chunkCount, allocated.chunkCount);
+    }
+    
+    TEST(AllocatorTest, reuseDeletedBlocks) {
+        AllocatedObject* first = new AllocatedObject(1);
+        delete first;
+        
+        AllocatedObject* second = new AllocatedObject(2);
+        ASSERT_EQ(first, second);
+        delete second;
+    }
+    
+    TEST(AllocatorTest, scratchScope) {
+        AllocatedObject* outside = new AllocatedObject(1);
+        const AllocatedObject::Statistics before = AllocatedObject::statistics();
+        
+        AllocatedObject* first = NULL;
+        {
+            const AllocatorScratchScope scratch;
+            first = new AllocatedObject(2);
+            AllocatedObject* second = new AllocatedObject(3);
+            ASSERT_NE(first, second);
+            ASSERT_NE(outside, first);
+            
+            delete second;
+            delete first;
+            
+            // an object from outside the scope is returned to the allocator as usual
+            delete outside;
+            ASSERT_EQ(before.liveBlocks - 1, AllocatedObject::statistics().liveBlocks);
+            
+            // deleted arena blocks are not reused within the scope
+            AllocatedObject* third = new AllocatedObject(4);
+            ASSERT_NE(first, third);
+            ASSERT_NE(second, third);
+            delete third;
+        }
+        
+        ASSERT_EQ(before.liveBlocks - 1, AllocatedObject::statistics().liveBlocks);
+        ASSERT_EQ(before.chunkCount, AllocatedObject::statistics().chunkCount);
+        
+        // the arena is reset at the end of the scope and reused by the next one
+        {
+            const AllocatorScratchScope scratch;
+            AllocatedObject* fourth = new AllocatedObject(5);
+            ASSERT_EQ(first, fourth);
+            delete fourth;
+        }
+    }
+    
+    class AllocateTask : public ParallelTask {
+    private:
+        size_t m_count;
+        AllocatedObject::List m_kept;
+        bool m_success;
+    public:
+        AllocateTask(const size_t count) :
+        m_count(count),
+        m_success(true) {}
+        
+        const AllocatedObject::List& kept() const {
+            return m_kept;
+        }
+        
+        bool success() const {
+            return m_success;
+        }
+    private:
+        void doRun() {
+            AllocatedObject::List objects;
+            for (size_t round = 0; round < 4; ++round) {
+                for (size_t i = 0; i < m_count; ++i)
+                    objects.push_back(new AllocatedObject(i));
+                for (size_t i = 0; i < m_count; ++i)
+                    m_success &= objects[i]->value == i;
+                
+                // delete every other object here, and keep the rest for another thread to delete
+                for (size_t i = 0; i < m_count; ++i) {
+                    if (i % 2 == 0)
+                        delete objects[i];
+                    else
+                        m_kept.push_back(objects[i]);
+                }
+                objects.clear();
+            }
+        }
+    };
+    
+    TEST(AllocatorTest, allocateAndDeleteOnSeveralThreads) {
+        const size_t liveBefore = AllocatedObject::statistics().liveBlocks;
+        
+        std::vector<AllocateTask*> tasks;
+        ParallelTask::List taskList;
+        for (size_t i = 0; i < 8; ++i) {
+            tasks.push_back(new AllocateTask(5000));
+            taskList.push_back(tasks.back());
+        }
+        
+        ParallelTaskRunner(4).run(taskList);
+        
+        size_t kept = 0;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            ASSERT_TRUE(tasks[i]->success());
+            kept += tasks[i]->kept().size();
+        }
+        
+        // the caches of the worker threads were returned when the threads exited
+        ASSERT_EQ(liveBefore + kept, AllocatedObject::statistics().liveBlocks);
+        
+        // now the objects of the workers are deleted by this thread
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            deleteAll(tasks[i]->kept());
+            delete tasks[i];
+        }
+        
+        ASSERT_EQ(liveBefore, AllocatedObject::statistics().liveBlocks);
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "IO/LineIndex.h"
+#include "StringUtils.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(LineIndexTest, emptyBuffer) {
+            const String str("");
+            const LineIndex index(str.c_str(), str.c_str() + str.size(), 1);
+            ASSERT_EQ(1u, index.line(0));
+            ASSERT_EQ(1u, index.column(0));
+        }
+        
+        TEST(LineIndexTest, singleLine) {
+            const String str("abc");
+            const LineIndex index(str.c_str(), str.c_str() + str.size(), 1);
+            ASSERT_EQ(1u, index.line(0));
+            ASSERT_EQ(1u, index.column(0));
+            ASSERT_EQ(1u, index.line(2));
+            ASSERT_EQ(3u, index.column(2));
+            ASSERT_EQ(1u, index.line(3));
+            ASSERT_EQ(4u, index.column(3));
+        }
+        
+        TEST(LineIndexTest, multipleLines) {
+            const String str("ab\n\ncde\r\nf\n");
+            const LineIndex index(str.c_str(), str.c_str() + str.size(), 1);
+            
+            // a line break belongs to the line it ends
+            ASSERT_EQ(1u, index.line(2));
+            ASSERT_EQ(3u, index.column(2));
+            ASSERT_EQ(2u, index.line(3));
+            ASSERT_EQ(1u, index.column(3));
+            ASSERT_EQ(3u, index.line(4));
+            ASSERT_EQ(1u, index.column(4));
+            ASSERT_EQ(3u, index.line(7));
+            ASSERT_EQ(4u, index.column(7));
+            ASSERT_EQ(4u, index.line(9));
+            ASSERT_EQ(1u, index.column(9));
+            ASSERT_EQ(5u, index.line(11));
+            ASSERT_EQ(1u, index.column(11));
+        }
+        
+        TEST(LineIndexTest, descendingOffsets) {
+            const String str("a\nb\nc\nd");
+            const LineIndex index(str.c_str(), str.c_str() + str.size(), 1);
+            ASSERT_EQ(4u, index.line(6));
+            ASSERT_EQ(3u, index.line(4));
+            ASSERT_EQ(2u, index.line(2));
+            ASSERT_EQ(1u, index.line(0));
+        }
+        
+        TEST(LineIndexTest, firstLine) {
+            const String str("a\nb");
+            const LineIndex index(str.c_str(), str.c_str() + str.size(), 10);
+            ASSERT_EQ(10u, index.line(0));
+            ASSERT_EQ(11u, index.line(2));
+            ASSERT_EQ(1u, index.column(2));
+        }
+        
+        TEST(LineIndexTest, largeBuffer) {
+            // spans several chunks that are indexed separately
+            StringStream str;
+            for (size_t i = 0; i < 100000; ++i)
+                str << "line\n";
+            const String data = str.str();
+            
+            const LineIndex index(data.c_str(), data.c_str() + data.size(), 1);
+            ASSERT_EQ(1u, index.line(0));
+            ASSERT_EQ(20001u, index.line(100002));
+            ASSERT_EQ(3u, index.column(100002));
+            ASSERT_EQ(100001u, index.line(data.size()));
+            ASSERT_EQ(50001u, index.line(250000));
+        }
+    }
+}
@@ -0,0 +1,242 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include "IO/MapCache.h"
+#include "IO/MapCacheWriter.h"
+#include "IO/Path.h"
+#include "IO/WorldReader.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/Layer.h"
+#include "Model/World.h"
+
+#include <cstdio>
+
+namespace TrenchBroom {
+    namespace IO {
+        static const String CachedMap("{\n"
+                                      "\"classname\" \"worldspawn\"\n"
+                                      "\"message\" \"cached\"\n"
+                                      "{\n"
+                                      "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) tex1 1 2 3 4 5\n"
+                                      "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex2 0 0 0 1 1\n"
+                                      "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) tex3 0 0 0 1 1\n"
+                                      "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) tex4 0 0 0 1 1\n"
+                                      "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) tex5 0 0 0 1 1\n"
+                                      "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) tex6 0 0 0 1 1\n"
+                                      "}\n"
+                                      "}\n"
+                                      "{\n"
+                                      "\"classname\" \"func_group\"\n"
+                                      "\"_tb_type\" \"_tb_layer\"\n"
+                                      "\"_tb_name\" \"Layer\"\n"
+                                      "\"_tb_id\" \"1\"\n"
+                                      "}\n"
+                                      "{\n"
+                                      "\"classname\" \"func_group\"\n"
+                                      "\"_tb_type\" \"_tb_group\"\n"
+                                      "\"_tb_name\" \"Group\"\n"
+                                      "\"_tb_id\" \"2\"\n"
+                                      "\"_tb_layer\" \"1\"\n"
+                                      "}\n"
+                                      "{\n"
+                                      "\"classname\" \"func_door\"\n"
+                                      "\"_tb_group\" \"2\"\n"
+                                      "{\n"
+                                      "( 0 0 0 ) ( 0 1 0 ) ( 0 0 1 ) door 0 0 0 1 1\n"
+                                      "( 0 0 0 ) ( 0 0 1 ) ( 1 0 0 ) door 0 0 0 1 1\n"
+                                      "( 0 0 0 ) ( 1 0 0 ) ( 0 1 0 ) door 0 0 0 1 1\n"
+                                      "( 16 16 16 ) ( 16 17 16 ) ( 17 16 16 ) door 0 0 0 1 1\n"
+                                      "( 16 16 16 ) ( 17 16 16 ) ( 16 16 17 ) door 0 0 0 1 1\n"
+                                      "( 16 16 16 ) ( 16 16 17 ) ( 16 17 16 ) door 0 0 0 1 1\n"
+                                      "}\n"
+                                      "}\n"
+                                      "{\n"
+                                      "\"classname\" \"light\"\n"
+                                      "\"origin\" \"1 2 3\"\n"
+                                      "}\n");
+        
+        inline void assertNodesEqual(const Model::Node* expected, const Model::Node* actual) {
+            ASSERT_EQ(typeid(*expected), typeid(*actual));
+            ASSERT_EQ(expected->name(), actual->name());
+            ASSERT_EQ(expected->lineNumber(), actual->lineNumber());
+            ASSERT_EQ(expected->lineCount(), actual->lineCount());
+            ASSERT_EQ(expected->bounds(), actual->bounds());
+            
+            const Model::AttributableNode* expectedAttributable = dynamic_cast<const Model::AttributableNode*>(expected);
+            if (expectedAttributable != NULL) {
+                const Model::AttributableNode* actualAttributable = static_cast<const Model::AttributableNode*>(actual);
+                const Model::EntityAttribute::List& expectedAttributes = expectedAttributable->attributes();
+                const Model::EntityAttribute::List& actualAttributes = actualAttributable->attributes();
+                ASSERT_EQ(expectedAttributes.size(), actualAttributes.size());
+                
+                Model::EntityAttribute::List::const_iterator eIt, aIt;
+                for (eIt = expectedAttributes.begin(), aIt = actualAttributes.begin(); eIt != expectedAttributes.end(); ++eIt, ++aIt) {
+                    ASSERT_EQ(eIt->name(), aIt->name());
+                    ASSERT_EQ(eIt->value(), aIt->value());
+                }
+            }
+            
+            const Model::Brush* expectedBrush = dynamic_cast<const Model::Brush*>(expected);
+            if (expectedBrush != NULL) {
+                const Model::Brush* actualBrush = static_cast<const Model::Brush*>(actual);
+                ASSERT_EQ(expectedBrush->vertexCount(), actualBrush->vertexCount());
+                ASSERT_EQ(expectedBrush->edgeCount(), actualBrush->edgeCount());
+                ASSERT_TRUE(actualBrush->fullySpecified());
+                
+                const Model::BrushFaceList& expectedFaces = expectedBrush->faces();
+                const Model::BrushFaceList& actualFaces = actualBrush->faces();
+                ASSERT_EQ(expectedFaces.size(), actualFaces.size());
+                for (size_t i = 0; i < expectedFaces.size(); ++i) {
+                    const Model::BrushFace* expectedFace = expectedFaces[i];
+                    const Model::BrushFace* actualFace = actualFaces[i];
+                    ASSERT_EQ(actualBrush, actualFace->brush());
+                    ASSERT_EQ(expectedFace->boundary(), actualFace->boundary());
+                    ASSERT_EQ(expectedFace->textureName(), actualFace->textureName());
+                    ASSERT_EQ(expectedFace->offset(), actualFace->offset());
+                    ASSERT_EQ(expectedFace->scale(), actualFace->scale());
+                    ASSERT_EQ(expectedFace->rotation(), actualFace->rotation());
+                    ASSERT_EQ(expectedFace->textureXAxis(), actualFace->textureXAxis());
+                    ASSERT_EQ(expectedFace->textureYAxis(), actualFace->textureYAxis());
+                    
+                    const Model::BrushFace::VertexList expectedVertices = expectedFace->vertices();
+                    const Model::BrushFace::VertexList actualVertices = actualFace->vertices();
+                    ASSERT_EQ(expectedVertices.size(), actualVertices.size());
+                    
+                    Model::BrushFace::VertexList::const_iterator eIt, aIt;
+                    for (eIt = expectedVertices.begin(), aIt = actualVertices.begin(); eIt != expectedVertices.end(); ++eIt, ++aIt)
+                        ASSERT_EQ((*eIt)->position(), (*aIt)->position());
+                }
+            }
+            
+            ASSERT_EQ(expected->childCount(), actual->childCount());
+            const Model::NodeList& expectedChildren = expected->children();
+            const Model::NodeList& actualChildren = actual->children();
+            for (size_t i = 0; i < expectedChildren.size(); ++i)
+                assertNodesEqual(expectedChildren[i], actualChildren[i]);
+        }
+        
+        TEST(MapCacheTest, readWrittenCache) {
+            const BBox3 worldBounds(8192);
+            
+            WorldReader reader(CachedMap, NULL);
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds);
+            
+            const MapCache cache(CachedMap.data(), CachedMap.data() + CachedMap.size());
+            MapCache::Buffer buffer;
+            cache.write(world, worldBounds, buffer);
+            
+            Model::World* cachedWorld = cache.read(&buffer.front(), &buffer.front() + buffer.size(), Model::MapFormat::Standard, worldBounds, NULL);
+            ASSERT_TRUE(cachedWorld != NULL);
+            assertNodesEqual(world, cachedWorld);
+            
+            const Model::Brush* brush = static_cast<const Model::Brush*>(cachedWorld->defaultLayer()->children().front());
+            ASSERT_EQ(6u, brush->faces().size());
+            ASSERT_EQ(8u, brush->vertexCount());
+            
+            delete cachedWorld;
+            delete world;
+        }
+        
+        TEST(MapCacheTest, rejectStaleCache) {
+            const BBox3 worldBounds(8192);
+            
+            WorldReader reader(CachedMap, NULL);
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds);
+            
+            const MapCache cache(CachedMap.data(), CachedMap.data() + CachedMap.size());
+            MapCache::Buffer buffer;
+            cache.write(world, worldBounds, buffer);
+            delete world;
+            
+            const char* begin = &buffer.front();
+            const char* end = begin + buffer.size();
+            
+            String changedMap = CachedMap;
+            changedMap[changedMap.find("cached")] = 'C';
+            const MapCache changedCache(changedMap.data(), changedMap.data() + changedMap.size());
+            ASSERT_TRUE(changedCache.read(begin, end, Model::MapFormat::Standard, worldBounds, NULL) == NULL);
+            
+            ASSERT_TRUE(cache.read(begin, end, Model::MapFormat::Valve, worldBounds, NULL) == NULL);
+            ASSERT_TRUE(cache.read(begin, end, Model::MapFormat::Standard, BBox3(4096), NULL) == NULL);
+        }
+        
+        TEST(MapCacheTest, rejectCorruptCache) {
+            const BBox3 worldBounds(8192);
+            
+            WorldReader reader(CachedMap, NULL);
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds);
+            
+            const MapCache cache(CachedMap.data(), CachedMap.data() + CachedMap.size());
+            MapCache::Buffer buffer;
+            cache.write(world, worldBounds, buffer);
+            delete world;
+            
+            const char* begin = &buffer.front();
+            for (size_t length = 0; length < buffer.size(); ++length)
+                ASSERT_TRUE(cache.read(begin, begin + length, Model::MapFormat::Standard, worldBounds, NULL) == NULL);
+            
+            MapCache::Buffer trailing = buffer;
+            trailing.push_back('\0');
+            ASSERT_TRUE(cache.read(&trailing.front(), &trailing.front() + trailing.size(), Model::MapFormat::Standard, worldBounds, NULL) == NULL);
+        }
+        
+        static MapCache::Buffer readFile(const Path& path) {
+            MapCache::Buffer buffer;
+            FILE* file = std::fopen(path.asString().c_str(), "rb");
+            if (file != NULL) {
+                char chunk[4096];
+                size_t count;
+                while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+                    buffer.insert(buffer.end(), chunk, chunk + count);
+                std::fclose(file);
+            }
+            return buffer;
+        }
+        
+        TEST(MapCacheTest, writeCacheInBackground) {
+            const BBox3 worldBounds(8192);
+            const Path path("MapCacheTest.tbcache");
+            
+            WorldReader reader(CachedMap, NULL);
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds);
+            
+            const MapCache cache(CachedMap.data(), CachedMap.data() + CachedMap.size());
+            MapCacheWriter writer;
+            writer.write(cache, world, worldBounds, path, NULL);
+            
+            // the cache is written from a snapshot, so the world may change in the meantime
+            world->addOrUpdateAttribute("message", "changed");
+            writer.finish(NULL);
+            
+            const MapCache::Buffer buffer = readFile(path);
+            std::remove(path.asString().c_str());
+            ASSERT_FALSE(buffer.empty());
+            
+            Model::World* cachedWorld = cache.read(&buffer.front(), &buffer.front() + buffer.size(), Model::MapFormat::Standard, worldBounds, NULL);
+            ASSERT_TRUE(cachedWorld != NULL);
+            ASSERT_EQ(String("cached"), cachedWorld->attribute("message"));
+            ASSERT_EQ(world->defaultLayer()->childCount(), cachedWorld->defaultLayer()->childCount());
+            
+            delete cachedWorld;
+            delete world;
+        }
+    }
+}
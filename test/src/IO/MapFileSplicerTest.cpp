@@ -0,0 +1,146 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/MapFileSplicer.h"
+#include "IO/NodeWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+#include <cstdio>
+
+namespace TrenchBroom {
+    namespace IO {
+        static String writeMap(Model::World* world, const MapFileSplicer* splicer) {
+            FILE* file = std::tmpfile();
+            {
+                NodeWriter writer(world, file, 1, splicer);
+                writer.writeMap();
+            }
+            
+            String result;
+            std::rewind(file);
+            char buffer[4096];
+            size_t count;
+            while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, count);
+            std::fclose(file);
+            return result;
+        }
+        
+        // Appends a space to every face line of the given brushes so that spliced text can be told apart.
+        static String markFaceLines(const String& text, const Model::BrushList& brushes) {
+            StringList lines = StringUtils::split(text, '\n');
+            Model::BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                const Model::Brush* brush = *it;
+                for (size_t i = 0; i < brush->faces().size(); ++i)
+                    lines[brush->lineNumber() + i] += " ";
+            }
+            return StringUtils::join(lines, "\n") + "\n";
+        }
+        
+        TEST(MapFileSplicerTest, spliceUnmodifiedBrushes) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World world(Model::MapFormat::Standard, NULL, worldBounds);
+            world.addOrUpdateAttribute("classname", "worldspawn");
+            
+            Model::BrushBuilder builder(&world, worldBounds);
+            Model::BrushList brushes;
+            for (size_t i = 0; i < 3; ++i) {
+                const Vec3 min(static_cast<FloatType>(i) * 64.0, 0.0, 0.0);
+                Model::Brush* brush = builder.createCuboid(BBox3(min, min + Vec3(32.0, 32.0, 32.0)), "rock");
+                world.defaultLayer()->addChild(brush);
+                brushes.push_back(brush);
+            }
+            
+            const String original = markFaceLines(writeMap(&world, NULL), brushes);
+            
+            MapFileSplicer splicer;
+            splicer.record(original.data(), original.data() + original.size(), &world);
+            
+            brushes[1]->faces().front()->setXOffset(5.0f);
+            splicer.brushFacesDidChange(Model::BrushFaceList(1, brushes[1]->faces().front()));
+            
+            Model::Brush* added = builder.createCube(16.0, "sky");
+            world.defaultLayer()->addChild(added);
+            
+            const String spliced = writeMap(&world, &splicer);
+            
+            Model::BrushList unmodified;
+            unmodified.push_back(brushes[0]);
+            unmodified.push_back(brushes[2]);
+            ASSERT_EQ(markFaceLines(writeMap(&world, NULL), unmodified), spliced);
+        }
+        
+        TEST(MapFileSplicerTest, forgetChangedAndRemovedBrushes) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World world(Model::MapFormat::Standard, NULL, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+            
+            Model::Brush* worldBrush = builder.createCube(32.0, "rock");
+            world.defaultLayer()->addChild(worldBrush);
+            
+            Model::Entity* entity = new Model::Entity();
+            entity->addOrUpdateAttribute("classname", "func_door");
+            Model::Brush* entityBrush = builder.createCube(32.0, "door");
+            entity->addChild(entityBrush);
+            world.defaultLayer()->addChild(entity);
+            
+            Model::Layer* layer = new Model::Layer("Layer", worldBounds);
+            Model::Brush* layerBrush = builder.createCube(32.0, "sky");
+            layer->addChild(layerBrush);
+            world.addChild(layer);
+            
+            const String original = writeMap(&world, NULL);
+            
+            MapFileSplicer splicer;
+            splicer.record(original.data(), original.data() + original.size(), &world);
+            
+            String buffer;
+            ASSERT_TRUE(splicer.splice(worldBrush, buffer));
+            ASSERT_TRUE(splicer.splice(entityBrush, buffer));
+            ASSERT_TRUE(splicer.splice(layerBrush, buffer));
+            
+            // the children of a changed layer are notified themselves
+            splicer.nodesDidChange(Model::NodeList(1, world.defaultLayer()));
+            ASSERT_TRUE(splicer.splice(worldBrush, buffer));
+            
+            splicer.nodesDidChange(Model::NodeList(1, entity));
+            ASSERT_TRUE(splicer.splice(worldBrush, buffer));
+            ASSERT_FALSE(splicer.splice(entityBrush, buffer));
+            
+            splicer.nodesWillBeRemoved(Model::NodeList(1, layer));
+            ASSERT_TRUE(splicer.splice(worldBrush, buffer));
+            ASSERT_FALSE(splicer.splice(layerBrush, buffer));
+            
+            splicer.clear();
+            ASSERT_FALSE(splicer.splice(worldBrush, buffer));
+        }
+    }
+}
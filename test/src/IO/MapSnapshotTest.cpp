@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/MapSnapshot.h"
+#include "IO/MapStreamSerializer.h"
+#include "IO/NodeWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        String writeSnapshot(const MapSnapshot& snapshot);
+        String writeSnapshot(const MapSnapshot& snapshot) {
+            StringStream str;
+            NodeSerializer::Ptr serializer = MapStreamSerializer::create(snapshot.format(), str);
+            snapshot.write(*serializer);
+            return str.str();
+        }
+        
+        TEST(MapSnapshotTest, writeSnapshot) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World map(Model::MapFormat::Valve, NULL, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            map.addOrUpdateAttribute("message", "snapshot");
+            
+            Model::BrushBuilder builder(&map, worldBounds);
+            map.defaultLayer()->addChild(builder.createCube(64.0, "first"));
+            
+            Model::Entity* entity = new Model::Entity();
+            entity->addOrUpdateAttribute("classname", "func_door");
+            entity->addChild(builder.createCube(32.0, "second"));
+            entity->addChild(builder.createCube(16.0, "third"));
+            map.defaultLayer()->addChild(entity);
+            
+            StringStream expected;
+            NodeWriter writer(&map, expected);
+            writer.writeMap();
+            
+            const MapSnapshot snapshot(&map);
+            ASSERT_EQ(Model::MapFormat::Valve, snapshot.format());
+            ASSERT_EQ(2u, snapshot.entityCount());
+            ASSERT_EQ(3u, snapshot.brushCount());
+            ASSERT_EQ(expected.str(), writeSnapshot(snapshot));
+        }
+        
+        TEST(MapSnapshotTest, snapshotIsIndependentOfWorld) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World map(Model::MapFormat::Standard, NULL, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::Brush* brush1 = builder.createCube(64.0, "first");
+            Model::Brush* brush2 = builder.createCube(32.0, "second");
+            map.defaultLayer()->addChild(brush1);
+            map.defaultLayer()->addChild(brush2);
+            
+            StringStream expected;
+            NodeWriter writer(&map, expected);
+            writer.writeMap();
+            
+            const MapSnapshot snapshot(&map);
+            
+            map.addOrUpdateAttribute("message", "changed");
+            brush1->faces().front()->setXOffset(5.0f);
+            map.defaultLayer()->removeChild(brush2);
+            delete brush2;
+            
+            ASSERT_EQ(expected.str(), writeSnapshot(snapshot));
+        }
+    }
+}
@@ -23,11 +23,14 @@
 #include "IO/NodeWriter.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/MapFormat.h"
 #include "Model/World.h"
 
+#include <cstdio>
+
 namespace TrenchBroom {
     namespace IO {
         TEST(NodeWriterTest, writeEmptyMap) {
@@ -129,6 +132,34 @@ namespace TrenchBroom {
                                                     ));
         }
         
+        TEST(NodeWriterTest, writeSameIdsForEveryWriter) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World map(Model::MapFormat::Standard, NULL, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            
+            Model::Layer* layer = map.createLayer("Custom Layer", worldBounds);
+            map.addChild(layer);
+            
+            Model::Group* group = map.createGroup("Group");
+            layer->addChild(group);
+            
+            Model::BrushBuilder builder(&map, worldBounds);
+            group->addChild(builder.createCube(64.0, "none"));
+            
+            // the ids are counted by each writer, so that maps can be written concurrently
+            StringStream first;
+            NodeWriter firstWriter(&map, first);
+            firstWriter.writeMap();
+            
+            StringStream second;
+            NodeWriter secondWriter(&map, second);
+            secondWriter.writeMap();
+            
+            ASSERT_EQ(first.str(), second.str());
+            ASSERT_TRUE(StringUtils::matchesPattern(first.str(), "*\"_tb_id\" \"1\"*\"_tb_id\" \"1\"*\"_tb_layer\" \"1\"*"));
+        }
+        
         TEST(NodeWriterTest, writeMapWithGroupInDefaultLayer) {
             const BBox3 worldBounds(8192.0);
             
@@ -350,5 +381,131 @@ namespace TrenchBroom {
 
             delete brush;
         }
+            
+        static String formatFaceWithPrintf(const Model::MapFormat::Type format, const Model::BrushFace* face) {
+            const Model::BrushFace::Points& points = face->points();
+            const Vec3 xAxis = face->textureXAxis();
+            const Vec3 yAxis = face->textureYAxis();
+            
+            char buffer[1024];
+            const int count = std::sprintf(buffer, "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) %s",
+                                           points[0].x(), points[0].y(), points[0].z(),
+                                           points[1].x(), points[1].y(), points[1].z(),
+                                           points[2].x(), points[2].y(), points[2].z(),
+                                           face->textureName().c_str());
+            char* rest = buffer + count;
+            switch (format) {
+                case Model::MapFormat::Standard:
+                    std::sprintf(rest, " %.6g %.6g %.6g %.6g %.6g\n",
+                                 face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale());
+                    break;
+                case Model::MapFormat::Quake2:
+                    std::sprintf(rest, " %.6g %.6g %.6g %.6g %.6g %d %d %.6g\n",
+                                 face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale(),
+                                 face->surfaceContents(), face->surfaceFlags(), face->surfaceValue());
+                    break;
+                case Model::MapFormat::Hexen2:
+                    std::sprintf(rest, " %.6g %.6g %.6g %.6g %.6g 0\n",
+                                 face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale());
+                    break;
+                case Model::MapFormat::Valve:
+                    std::sprintf(rest, " [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g\n",
+                                 xAxis.x(), xAxis.y(), xAxis.z(), face->xOffset(),
+                                 yAxis.x(), yAxis.y(), yAxis.z(), face->yOffset(),
+                                 face->rotation(), face->xScale(), face->yScale());
+                    break;
+                case Model::MapFormat::Unknown:
+                    break;
+            }
+            return buffer;
+        }
+        
+        static String readFile(FILE* file) {
+            String result;
+            std::rewind(file);
+            char buffer[4096];
+            size_t count;
+            while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, count);
+            return result;
+        }
+        
+        // Writes enough brushes to exercise the concurrent serialization and compares the output to that of fprintf.
+        static void assertWritesMapToFile(const Model::MapFormat::Type format) {
+            const BBox3 worldBounds(8192.0);
+            const size_t brushCount = 3000;
+            
+            Model::World map(format, NULL, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            
+            Model::BrushBuilder builder(&map, worldBounds);
+            for (size_t i = 0; i < brushCount; ++i) {
+                const FloatType x = static_cast<FloatType>(i % 100) * 33.0 - 1600.0;
+                const FloatType y = static_cast<FloatType>(i / 100) * 17.3;
+                const FloatType z = static_cast<FloatType>(i) / 7.0;
+                
+                Model::Brush* brush = builder.createCuboid(BBox3(Vec3(x, y, z), Vec3(x + 32.0, y + 16.25, z + 1.0 / 3.0)), "rock");
+                const Model::BrushFaceList& faces = brush->faces();
+                for (size_t j = 0; j < faces.size(); ++j) {
+                    Model::BrushFace* face = faces[j];
+                    face->setXOffset(static_cast<float>(i % 64));
+                    face->setYOffset(static_cast<float>(j) * 0.3f);
+                    face->setRotation(static_cast<float>(i % 360) / 7.0f);
+                    face->setXScale(i % 2 == 0 ? 1.0f : 0.5f);
+                    face->setYScale(-1.0f / 3.0f);
+                    face->setSurfaceContents(static_cast<int>(i));
+                    face->setSurfaceFlags(-static_cast<int>(j));
+                    face->setSurfaceValue(static_cast<float>(i) * 0.1f);
+                }
+                map.defaultLayer()->addChild(brush);
+            }
+            
+            FILE* file = std::tmpfile();
+            ASSERT_TRUE(file != NULL);
+            {
+                NodeWriter writer(&map, file);
+                writer.writeMap();
+            }
+            const String result = readFile(file);
+            std::fclose(file);
+            
+            String expected = "{\n\"classname\" \"worldspawn\"\n";
+            size_t line = 3;
+            const Model::NodeList& brushes = map.defaultLayer()->children();
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                const Model::Brush* brush = static_cast<const Model::Brush*>(brushes[i]);
+                ASSERT_EQ(line, brush->lineNumber());
+                ASSERT_EQ(brush->faces().size() + 2, brush->lineCount());
+                
+                expected += "{\n";
+                const Model::BrushFaceList& faces = brush->faces();
+                for (size_t j = 0; j < faces.size(); ++j) {
+                    expected += formatFaceWithPrintf(format, faces[j]);
+                }
+                expected += "}\n";
+                line += brush->lineCount();
+            }
+            expected += "}\n";
+            
+            ASSERT_EQ(1u, map.lineNumber());
+            ASSERT_EQ(line, map.lineCount());
+            ASSERT_TRUE(expected == result);
+        }
+        
+        TEST(NodeWriterTest, writeStandardMapToFile) {
+            assertWritesMapToFile(Model::MapFormat::Standard);
+        }
+        
+        TEST(NodeWriterTest, writeQuake2MapToFile) {
+            assertWritesMapToFile(Model::MapFormat::Quake2);
+        }
+        
+        TEST(NodeWriterTest, writeValveMapToFile) {
+            assertWritesMapToFile(Model::MapFormat::Valve);
+        }
+        
+        TEST(NodeWriterTest, writeHexen2MapToFile) {
+            assertWritesMapToFile(Model::MapFormat::Hexen2);
+        }
     }
 }
@@ -39,6 +39,14 @@ namespace TrenchBroom {
             return NULL;
         }
         
+        inline void collectNodes(const Model::Node* node, std::vector<const Model::Node*>& result) {
+            result.push_back(node);
+            const Model::NodeList& children = node->children();
+            Model::NodeList::const_iterator it, end;
+            for (it = children.begin(), end = children.end(); it != end; ++it)
+                collectNodes(*it, result);
+        }
+        
         TEST(WorldReaderTest, parseEmptyMap) {
             const String data("");
             BBox3 worldBounds(8192);
@@ -545,6 +553,55 @@ namespace TrenchBroom {
             ASSERT_EQ(1u, mySubGroup->childCount());
         }
 
+        TEST(WorldReaderTest, parseLargeMapInParallel) {
+            StringStream str;
+            str << "// Game: Quake\n";
+            str << "{\n\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0; i < 3000; ++i) {
+                const int x = static_cast<int>(i % 64) * 64;
+                const int y = static_cast<int>(i / 64) * 64;
+                str << "{\n";
+                str << "( " << x << " " << y << " 0 ) ( " << x << " " << y + 1 << " 0 ) ( " << x << " " << y << " 1 ) {fence 0 0 0 1 1\n";
+                str << "( " << x << " " << y << " 0 ) ( " << x << " " << y << " 1 ) ( " << x + 1 << " " << y << " 0 ) none 0 0 0 1 1\n";
+                str << "( " << x << " " << y << " 0 ) ( " << x + 1 << " " << y << " 0 ) ( " << x << " " << y + 1 << " 0 ) none 0 0 0 1 1\n";
+                str << "( " << x + 32 << " " << y + 32 << " 32 ) ( " << x + 32 << " " << y + 33 << " 32 ) ( " << x + 33 << " " << y + 32 << " 32 ) none 0 0 0 1 1\n";
+                str << "( " << x + 32 << " " << y + 32 << " 32 ) ( " << x + 33 << " " << y + 32 << " 32 ) ( " << x + 32 << " " << y + 32 << " 33 ) none 0 0 0 1 1\n";
+                str << "( " << x + 32 << " " << y + 32 << " 32 ) ( " << x + 32 << " " << y + 32 << " 33 ) ( " << x + 32 << " " << y + 33 << " 32 ) none 0 0 0 1 1\n";
+                str << "}\n";
+            }
+            str << "}\n";
+            for (size_t i = 0; i < 500; ++i) {
+                // references a group that is defined later on
+                str << "{\n\"classname\" \"light\"\n\"origin\" \"" << i << " 0 0\"\n\"_tb_group\" \"1\"\n}\n";
+            }
+            str << "{\n\"classname\" \"func_group\"\n\"_tb_type\" \"_tb_group\"\n\"_tb_name\" \"Group\"\n\"_tb_id\" \"1\"\n}\n";
+            const String data = str.str();
+            BBox3 worldBounds(8192);
+            
+            WorldReader serialReader(data, NULL);
+            serialReader.setThreadCount(1);
+            Model::World* serialWorld = serialReader.read(Model::MapFormat::Standard, worldBounds);
+            
+            WorldReader parallelReader(data, NULL);
+            parallelReader.setThreadCount(4);
+            Model::World* parallelWorld = parallelReader.read(Model::MapFormat::Standard, worldBounds);
+            
+            std::vector<const Model::Node*> serialNodes, parallelNodes;
+            collectNodes(serialWorld, serialNodes);
+            collectNodes(parallelWorld, parallelNodes);
+            
+            ASSERT_EQ(3000u + 500u + 3u, serialNodes.size());
+            ASSERT_EQ(serialNodes.size(), parallelNodes.size());
+            for (size_t i = 0; i < serialNodes.size(); ++i) {
+                ASSERT_EQ(serialNodes[i]->lineNumber(), parallelNodes[i]->lineNumber());
+                ASSERT_EQ(serialNodes[i]->childCount(), parallelNodes[i]->childCount());
+                ASSERT_EQ(serialNodes[i]->bounds(), parallelNodes[i]->bounds());
+            }
+            
+            delete serialWorld;
+            delete parallelWorld;
+        }
+        
         /*
         TEST(WorldReaderTest, parseIssueIgnoreFlags) {
             const String data("{"
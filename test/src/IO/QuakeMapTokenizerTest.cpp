@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "IO/StandardMapParser.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        typedef QuakeMapTokenizer::Token Token;
+        
+        TEST(QuakeMapTokenizerTest, classifyNumbers) {
+            const String data("0 -0 +7 - . .5 -12.5 1e5 1e 1.5e-3 12a 1.2.3 ( 64 -32 16 ) 8)");
+            QuakeMapTokenizer tokenizer(data);
+            
+            const QuakeMapToken::Type expected[] = {
+                QuakeMapToken::Integer, QuakeMapToken::Integer, QuakeMapToken::Integer, QuakeMapToken::Integer,
+                QuakeMapToken::Decimal, QuakeMapToken::Decimal, QuakeMapToken::Decimal, QuakeMapToken::Decimal,
+                QuakeMapToken::Decimal, QuakeMapToken::Decimal, QuakeMapToken::String, QuakeMapToken::String,
+                QuakeMapToken::OParenthesis, QuakeMapToken::Integer, QuakeMapToken::Integer, QuakeMapToken::Integer,
+                QuakeMapToken::CParenthesis, QuakeMapToken::Integer, QuakeMapToken::CParenthesis, QuakeMapToken::Eof
+            };
+            
+            for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i)
+                ASSERT_EQ(expected[i], tokenizer.nextToken().type()) << "for token " << i;
+        }
+        
+        TEST(QuakeMapTokenizerTest, tokenPositions) {
+            const String data("{\n\"classname\" \"a long value that spans several words\" 7\n( 1 2.5 3 )\n}");
+            QuakeMapTokenizer tokenizer(data);
+            
+            Token token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::OBrace, token.type());
+            ASSERT_EQ(1u, token.line());
+            
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::String, token.type());
+            ASSERT_EQ(String("classname"), token.data());
+            ASSERT_EQ(2u, token.line());
+            ASSERT_EQ(1u, token.column());
+            
+            token = tokenizer.nextToken();
+            ASSERT_EQ(String("a long value that spans several words"), token.data());
+            ASSERT_EQ(13u, token.column());
+            
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Integer, token.type());
+            ASSERT_EQ(2u, token.line());
+            ASSERT_EQ(53u, token.column());
+            
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::OParenthesis, token.type());
+            ASSERT_EQ(3u, token.line());
+            ASSERT_EQ(1u, token.column());
+            
+            token = tokenizer.nextToken();
+            ASSERT_EQ(3u, token.column());
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Decimal, token.type());
+            ASSERT_EQ(5u, token.column());
+            token = tokenizer.nextToken();
+            ASSERT_EQ(9u, token.column());
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::CParenthesis, token.type());
+            ASSERT_EQ(11u, token.column());
+            
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::CBrace, token.type());
+            ASSERT_EQ(4u, token.line());
+            ASSERT_EQ(1u, token.column());
+        }
+    }
+}
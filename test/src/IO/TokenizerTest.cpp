@@ -124,6 +124,30 @@ namespace TrenchBroom {
             ASSERT_EQ(SimpleToken::Eof, tokenizer.nextToken().type());
         }
 
+        TEST(TokenizerTest, simpleLanguagePushTwoTokens) {
+            const String testString("{\n"
+                                    "  }\n"
+                                    "=");
+            
+            SimpleTokenizer tokenizer(testString);
+            const SimpleTokenizer::Token first = tokenizer.nextToken();
+            const SimpleTokenizer::Token second = tokenizer.nextToken();
+            tokenizer.pushToken(second);
+            tokenizer.pushToken(first);
+            
+            SimpleTokenizer::Token token;
+            ASSERT_EQ(SimpleToken::OBrace, (token = tokenizer.nextToken()).type());
+            ASSERT_EQ(1u, token.line());
+            ASSERT_EQ(1u, token.column());
+            ASSERT_EQ(SimpleToken::CBrace, (token = tokenizer.nextToken()).type());
+            ASSERT_EQ(2u, token.line());
+            ASSERT_EQ(3u, token.column());
+            ASSERT_EQ(SimpleToken::Equals, (token = tokenizer.nextToken()).type());
+            ASSERT_EQ(3u, token.line());
+            ASSERT_EQ(1u, token.column());
+            ASSERT_EQ(SimpleToken::Eof, tokenizer.nextToken().type());
+        }
+
         TEST(TokenizerTest, simpleLanguageEmptyBlockWithLeadingAndTrailingWhitespace) {
             const String testString(" \t{"
                                     " }  ");
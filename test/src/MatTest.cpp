@@ -322,6 +322,47 @@ TEST(MatTest, multiplyWithMatrixAndAssign) {
     ASSERT_MAT_EQ(r, o);
 }
 
+template <typename T>
+Mat<T,4,4> randomMatrix() {
+    Mat<T,4,4> result;
+    for (size_t c = 0; c < 4; ++c)
+        for (size_t r = 0; r < 4; ++r)
+            result[c][r] = static_cast<T>(std::rand()) / static_cast<T>(RAND_MAX) * static_cast<T>(2000.0) - static_cast<T>(1000.0);
+    return result;
+}
+
+template <typename T>
+void assertMultiplicationMatchesReference() {
+    for (size_t i = 0; i < 100; ++i) {
+        const Mat<T,4,4> m = randomMatrix<T>();
+        const Mat<T,4,4> n = randomMatrix<T>();
+        
+        // the products must be summed up in the same order as in the generic implementation
+        Mat<T,4,4> expected(Mat<T,4,4>::Null);
+        for (size_t col = 0; col < 4; col++)
+            for (size_t row = 0; row < 4; row++)
+                for (size_t k = 0; k < 4; ++k)
+                    expected[col][row] += m[k][row] * n[col][k];
+        ASSERT_EQ(expected, m * n);
+        
+        Vec<T,4> column;
+        for (size_t row = 0; row < 4; row++)
+            for (size_t k = 0; k < 4; ++k)
+                column[row] += m[k][row] * n[0][k];
+        ASSERT_EQ(column, m * n[0]);
+    }
+}
+
+TEST(MatTest, multiplicationOfFloatMatricesIsExact) {
+    std::srand(1);
+    assertMultiplicationMatchesReference<float>();
+}
+
+TEST(MatTest, multiplicationOfDoubleMatricesIsExact) {
+    std::srand(1);
+    assertMultiplicationMatchesReference<double>();
+}
+
 TEST(MatTest, rightMultiplyWithScalar) {
     const Mat4x4d m( 1.0,  2.0,  3.0,  4.0,
                      5.0,  6.0,  7.0,  8.0,
@@ -25,6 +25,7 @@
 #include "TestUtils.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushFaceAttributes.h"
+#include "Model/ParallelTexCoordSystem.h"
 #include "Model/ParaxialTexCoordSystem.h"
 #include "Assets/Texture.h"
 
@@ -106,5 +107,41 @@ namespace TrenchBroom {
             EXPECT_EQ(1, texture.usageCount());
             EXPECT_EQ(0, texture2.usageCount());
         }
+        
+        static void assertBatchTexCoordsMatch(const TexCoordSystem& texCoordSystem, const BrushFaceAttributes& attribs) {
+            const Vec3 points[5] = {
+                Vec3(0.0, 0.0, 0.0),
+                Vec3(17.0, -33.5, 12.25),
+                Vec3(-1024.0, 512.0, 96.0),
+                Vec3(3.1, 4.1, 5.9),
+                Vec3(16384.0, -16384.0, 16384.0)
+            };
+            
+            Vec2f texCoords[5];
+            texCoordSystem.getTexCoords(points, 5, attribs, texCoords);
+            for (size_t i = 0; i < 5; ++i)
+                ASSERT_EQ(texCoordSystem.getTexCoords(points[i], attribs), texCoords[i]);
+        }
+        
+        TEST(BrushFaceTest, batchTexCoordsMatchSingleTexCoords) {
+            const Vec3 p0(0.0,  0.0, 4.0);
+            const Vec3 p1(1.0,  0.3, 4.5);
+            const Vec3 p2(0.0, -1.0, 4.0);
+            Assets::Texture texture("testTexture", 64, 32);
+            
+            BrushFaceAttributes attribs("");
+            attribs.setTexture(&texture);
+            attribs.setOffset(Vec2f(13.0f, -7.5f));
+            attribs.setScale(Vec2f(0.5f, -3.0f));
+            attribs.setRotation(33.0f);
+            
+            assertBatchTexCoordsMatch(ParaxialTexCoordSystem(p0, p1, p2, attribs), attribs);
+            assertBatchTexCoordsMatch(ParallelTexCoordSystem(p0, p1, p2, attribs), attribs);
+            
+            // a zero scale is treated as a scale of one
+            attribs.setXScale(0.0f);
+            assertBatchTexCoordsMatch(ParaxialTexCoordSystem(p0, p1, p2, attribs), attribs);
+            assertBatchTexCoordsMatch(ParallelTexCoordSystem(p0, p1, p2, attribs), attribs);
+        }
     }
 }
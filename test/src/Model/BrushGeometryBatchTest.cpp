@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "ParallelTaskRunner.h"
+#include "TestUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushGeometryBatch.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        TEST(BrushGeometryBatchTest, transformBrushes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            BrushBuilder builder(&world, worldBounds);
+            BrushList brushes;
+            for (size_t i = 0; i < 200; ++i) {
+                const Vec3 min(static_cast<FloatType>(i) * 16.0, 0.0, 0.0);
+                brushes.push_back(builder.createCuboid(BBox3(min, min + Vec3(8.0, 8.0, 8.0)), "texture"));
+            }
+            
+            const ParallelTaskRunner runner(4);
+            const BrushGeometryBatch batch(worldBounds, runner);
+            batch.transform(brushes, translationMatrix(Vec3(0.0, 0.0, 32.0)), false);
+            
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                const Vec3 min(static_cast<FloatType>(i) * 16.0, 0.0, 32.0);
+                ASSERT_EQ(BBox3(min, min + Vec3(8.0, 8.0, 8.0)), brushes[i]->bounds());
+            }
+            
+            VectorUtils::clearAndDelete(brushes);
+        }
+        
+        TEST(BrushGeometryBatchTest, collectInvalidBrushes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            BrushBuilder builder(&world, worldBounds);
+            BrushList brushes;
+            brushes.push_back(builder.createCuboid(BBox3(Vec3( 0.0, 0.0, 0.0), Vec3( 8.0, 8.0, 8.0)), "texture"));
+            brushes.push_back(builder.createCuboid(BBox3(Vec3(16.0, 0.0, 0.0), Vec3(24.0, 8.0, 8.0)), "texture"));
+            brushes.push_back(builder.createCuboid(BBox3(Vec3(32.0, 0.0, 0.0), Vec3(40.0, 8.0, 8.0)), "texture"));
+            brushes[1]->findFaceByNormal(Vec3::PosZ)->invert();
+            
+            const ParallelTaskRunner runner(2);
+            const BrushGeometryBatch batch(worldBounds, runner);
+            ASSERT_THROW(batch.transform(brushes, translationMatrix(Vec3(0.0, 0.0, 32.0)), false), GeometryException);
+            
+            // the valid brushes are transformed nonetheless
+            ASSERT_EQ(BBox3(Vec3( 0.0, 0.0, 32.0), Vec3( 8.0, 8.0, 40.0)), brushes[0]->bounds());
+            ASSERT_EQ(BBox3(Vec3(32.0, 0.0, 32.0), Vec3(40.0, 8.0, 40.0)), brushes[2]->bounds());
+            
+            VectorUtils::clearAndDelete(brushes);
+        }
+        
+        static BrushFaceList createCubeFaces(const Vec3& min) {
+            // a cube with length 8
+            const Vec3 max = min + Vec3(8.0, 8.0, 8.0);
+            BrushFaceList faces;
+            faces.push_back(BrushFace::createParaxial(min, min + Vec3::PosY, min + Vec3::PosZ));
+            faces.push_back(BrushFace::createParaxial(max, max + Vec3::PosZ, max + Vec3::PosY));
+            faces.push_back(BrushFace::createParaxial(min, min + Vec3::PosZ, min + Vec3::PosX));
+            faces.push_back(BrushFace::createParaxial(max, max + Vec3::PosX, max + Vec3::PosZ));
+            faces.push_back(BrushFace::createParaxial(max, max + Vec3::PosY, max + Vec3::PosX));
+            faces.push_back(BrushFace::createParaxial(min, min + Vec3::PosX, min + Vec3::PosY));
+            return faces;
+        }
+        
+        TEST(BrushGeometryBatchTest, buildDeferredGeometry) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            BrushList brushes;
+            for (size_t i = 0; i < 200; ++i) {
+                const Vec3 min(static_cast<FloatType>(i) * 16.0, 0.0, 0.0);
+                Brush* brush = new Brush(worldBounds, createCubeFaces(min), true);
+                ASSERT_TRUE(brush->geometryDeferred());
+                brushes.push_back(brush);
+            }
+            
+            const ParallelTaskRunner runner(4);
+            const BrushGeometryBatch batch(worldBounds, runner);
+            BrushList invalidBrushes;
+            StringList errors;
+            batch.buildDeferredGeometry(brushes, invalidBrushes, errors);
+            ASSERT_TRUE(invalidBrushes.empty());
+            ASSERT_TRUE(errors.empty());
+            
+            world.defaultLayer()->addChildren(brushes.begin(), brushes.end(), brushes.size());
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                Brush* brush = brushes[i];
+                ASSERT_FALSE(brush->geometryDeferred());
+                ASSERT_EQ(8u, brush->vertexCount());
+                
+                const Vec3 min(static_cast<FloatType>(i) * 16.0, 0.0, 0.0);
+                ASSERT_EQ(BBox3(min, min + Vec3(8.0, 8.0, 8.0)), brush->bounds());
+                
+                NodeList nodes;
+                world.findNodesContaining(min + Vec3(4.0, 4.0, 4.0), nodes);
+                ASSERT_EQ(1u, nodes.size());
+                ASSERT_EQ(brush, nodes.front());
+            }
+        }
+    }
+}
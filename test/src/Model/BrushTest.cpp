@@ -19,6 +19,7 @@
 
 #include <gtest/gtest.h>
 
+#include "ParallelTaskRunner.h"
 #include "TestUtils.h"
 
 #include "IO/NodeReader.h"
@@ -26,6 +27,7 @@
 #include "Model/BrushBuilder.h"
 #include "Model/BrushContentTypeBuilder.h"
 #include "Model/BrushFace.h"
+#include "Model/BrushGeometryBatch.h"
 #include "Model/Hit.h"
 #include "Model/MapFormat.h"
 #include "Model/ModelFactoryImpl.h"
@@ -99,6 +101,38 @@ namespace TrenchBroom {
          Replace: faces.push_back(BrushFace::createParaxial(Vec3($1, $2, $3), Vec3($4, $5, $6), Vec3($7, $8, $9)));
          */
         
+        TEST(BrushTest, constructAxisAlignedBox) {
+            const BBox3 worldBounds(4096.0);
+            
+            BrushFaceList faces;
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 32.0), Vec3(0.0, 1.0, 32.0), Vec3(1.0, 0.0, 32.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(-8.0, 0.0, 0.0), Vec3(-8.0, 1.0, 0.0), Vec3(-8.0, 0.0, 1.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 16.0, 0.0), Vec3(1.0, 16.0, 0.0), Vec3(0.0, 16.0, 1.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, -4.0), Vec3(1.0, 0.0, -4.0), Vec3(0.0, 1.0, -4.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(24.0, 0.0, 0.0), Vec3(24.0, 0.0, 1.0), Vec3(24.0, 1.0, 0.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, -2.0, 0.0), Vec3(0.0, -2.0, 1.0), Vec3(1.0, -2.0, 0.0)));
+            
+            Brush brush(worldBounds, faces);
+            ASSERT_TRUE(brush.fullySpecified());
+            ASSERT_EQ(BBox3(Vec3(-8.0, -2.0, -4.0), Vec3(24.0, 16.0, 32.0)), brush.bounds());
+            ASSERT_EQ(8u, brush.vertexCount());
+            ASSERT_EQ(12u, brush.edgeCount());
+            
+            const BrushFaceList& brushFaces = brush.faces();
+            ASSERT_EQ(faces, brushFaces);
+            
+            for (size_t i = 0; i < brushFaces.size(); ++i) {
+                const BrushFace* face = brushFaces[i];
+                const BrushFace::VertexList vertices = face->vertices();
+                ASSERT_EQ(4u, vertices.size());
+                
+                BrushFace::VertexList::const_iterator it, end;
+                for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
+                    ASSERT_EQ(Math::PointStatus::PSInside, face->boundary().pointStatus((*it)->position()));
+                ASSERT_VEC_EQ(face->boundary().normal, face->geometry()->normal());
+            }
+        }
+        
         TEST(BrushTest, constructWithFailingFaces) {
             /* from rtz_q1
              {
@@ -459,6 +493,59 @@ namespace TrenchBroom {
             ASSERT_TRUE(hits2.empty());
         }
         
+        TEST(BrushTest, pickBrushWithManyFaces) {
+            const BBox3 worldBounds(4096.0);
+            
+            // build a prism with 32 sides around the Z axis
+            const size_t sideCount = 32;
+            BrushFaceList faces;
+            for (size_t i = 0; i < sideCount; ++i) {
+                const FloatType angle = 2.0 * Math::Constants<FloatType>::pi() * static_cast<FloatType>(i) / static_cast<FloatType>(sideCount);
+                const Vec3 normal(std::cos(angle), std::sin(angle), 0.0);
+                const Vec3 point = 512.0 * normal;
+                const Vec3 tangent = crossed(Vec3::PosZ, normal);
+                faces.push_back(BrushFace::createParaxial(point, point + Vec3::PosZ, point + tangent));
+            }
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 64.0), Vec3(0.0, 1.0, 64.0), Vec3(1.0, 0.0, 64.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0,  0.0), Vec3(1.0, 0.0,  0.0), Vec3(0.0, 1.0,  0.0)));
+            
+            Brush brush(worldBounds, faces);
+            ASSERT_EQ(sideCount + 2, brush.faces().size());
+            
+            for (size_t i = 0; i < 64; ++i) {
+                const FloatType angle = 0.1 * static_cast<FloatType>(i);
+                const Vec3 origin(1024.0 * std::cos(angle), 1024.0 * std::sin(angle), static_cast<FloatType>(i % 96));
+                const Ray3 ray(origin, (Vec3(0.0, 0.0, 32.0) - origin).normalized());
+                
+                // every face on its own must agree with the faces found by the brush
+                BrushFace* expectedFace = NULL;
+                FloatType expectedDistance = Math::nan<FloatType>();
+                const BrushFaceList& brushFaces = brush.faces();
+                for (size_t j = 0; j < brushFaces.size() && expectedFace == NULL; ++j) {
+                    expectedDistance = brushFaces[j]->intersectWithRay(ray);
+                    if (!Math::isnan(expectedDistance))
+                        expectedFace = brushFaces[j];
+                }
+                
+                PickResult hits;
+                brush.pick(ray, hits);
+                if (expectedFace == NULL) {
+                    ASSERT_TRUE(hits.empty());
+                } else {
+                    ASSERT_EQ(1u, hits.size());
+                    ASSERT_EQ(expectedFace, hits.all().front().target<BrushFace*>());
+                    ASSERT_DOUBLE_EQ(expectedDistance, hits.all().front().distance());
+                }
+            }
+            
+            // the cached face bounds must follow the brush
+            brush.transform(translationMatrix(Vec3(0.0, 0.0, 256.0)), false, worldBounds);
+            PickResult hits;
+            brush.pick(Ray3(Vec3(1024.0, 0.0, 288.0), Vec3::NegX), hits);
+            ASSERT_EQ(1u, hits.size());
+            ASSERT_DOUBLE_EQ(512.0, hits.all().front().distance());
+        }
+        
         TEST(BrushTest, partialSelectionAfterAdd) {
             const BBox3 worldBounds(4096.0);
             
@@ -630,6 +717,81 @@ namespace TrenchBroom {
             delete clone;
         }
         
+        static BrushFaceList createCubeWithBevel() {
+            // a cube with length 16 at the origin, with the edge at the top right beveled
+            BrushFaceList faces;
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0), Vec3(0.0, 0.0, 1.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(16.0, 0.0, 0.0), Vec3(16.0, 0.0, 1.0), Vec3(16.0, 1.0, 0.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 1.0), Vec3(1.0, 0.0, 0.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 16.0, 0.0), Vec3(1.0, 16.0, 0.0), Vec3(0.0, 16.0, 1.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 16.0), Vec3(0.0, 1.0, 16.0), Vec3(1.0, 0.0, 16.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(8.0, 0.0, 16.0), Vec3(8.0, 1.0, 16.0), Vec3(16.0, 0.0, 8.0)));
+            return faces;
+        }
+        
+        static void assertFacesLinkedToGeometry(const Brush& brush) {
+            const BrushFaceList& faces = brush.faces();
+            BrushFaceList::const_iterator fIt, fEnd;
+            for (fIt = faces.begin(), fEnd = faces.end(); fIt != fEnd; ++fIt) {
+                const BrushFace* face = *fIt;
+                ASSERT_TRUE(face->geometry() != NULL);
+                ASSERT_EQ(face, face->geometry()->payload());
+                
+                const BrushFace::VertexList vertices = face->vertices();
+                BrushFace::VertexList::const_iterator vIt, vEnd;
+                for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd; ++vIt)
+                    ASSERT_EQ(Math::PointStatus::PSInside, face->boundary().pointStatus((*vIt)->position()));
+            }
+        }
+        
+        TEST(BrushTest, cloneCopiesGeometry) {
+            const BBox3 worldBounds(4096.0);
+            
+            Brush original(worldBounds, createCubeWithBevel());
+            Brush* clone = original.clone(worldBounds);
+            
+            ASSERT_EQ(original.faces().size(), clone->faces().size());
+            ASSERT_EQ(original.vertexCount(), clone->vertexCount());
+            ASSERT_EQ(original.edgeCount(), clone->edgeCount());
+            ASSERT_EQ(original.bounds(), clone->bounds());
+            assertFacesLinkedToGeometry(*clone);
+            
+            for (size_t i = 0; i < original.faces().size(); ++i) {
+                const BrushFace* originalFace = original.faces()[i];
+                const BrushFace* cloneFace = clone->faces()[i];
+                ASSERT_EQ(originalFace->boundary(), cloneFace->boundary());
+                ASSERT_NE(originalFace->geometry(), cloneFace->geometry());
+                ASSERT_EQ(originalFace->vertexCount(), cloneFace->vertexCount());
+            }
+            
+            delete clone;
+        }
+        
+        TEST(BrushTest, translateMovesGeometry) {
+            const BBox3 worldBounds(4096.0);
+            const Vec3 delta(32.0, -16.0, 8.5);
+            
+            Brush brush(worldBounds, createCubeWithBevel());
+            const BBox3 bounds = brush.bounds();
+            
+            Vec3::List positions;
+            const Brush::VertexList vertices = brush.vertices();
+            Brush::VertexList::const_iterator it, end;
+            for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
+                positions.push_back((*it)->position() + delta);
+            
+            brush.transform(translationMatrix(delta), false, worldBounds);
+            
+            ASSERT_EQ(BBox3(bounds.min + delta, bounds.max + delta), brush.bounds());
+            ASSERT_EQ(positions.size(), brush.vertexCount());
+            
+            const Brush::VertexList translatedVertices = brush.vertices();
+            for (it = translatedVertices.begin(), end = translatedVertices.end(); it != end; ++it)
+                ASSERT_TRUE(VectorUtils::contains(positions, (*it)->position()));
+            assertFacesLinkedToGeometry(brush);
+        }
+        
         TEST(BrushTest, clip) {
             const BBox3 worldBounds(4096.0);
             
@@ -826,6 +988,58 @@ namespace TrenchBroom {
             delete brush;
         }
         
+        TEST(BrushTest, rejectUnknownVertexPositions) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            BrushBuilder builder(&world, worldBounds);
+            Brush* brush = builder.createCube(64.0, Model::BrushFace::NoTextureName);
+            
+            const Vec3 known(-32.0, -32.0, -32.0);
+            const Vec3 unknown(-32.0, -32.0, 0.0);
+            const Vec3 delta(-16.0, 0.0, 0.0);
+            
+            ASSERT_TRUE(brush->canMoveVertices(worldBounds, Vec3::List(1, known), delta));
+            ASSERT_FALSE(brush->canMoveVertices(worldBounds, Vec3::List(1, unknown), delta));
+            
+            Vec3::List positions;
+            positions.push_back(known);
+            positions.push_back(unknown);
+            ASSERT_FALSE(brush->canMoveVertices(worldBounds, positions, delta));
+            
+            const Edge3 knownEdge(known, Vec3(-32.0, -32.0, +32.0));
+            const Edge3 unknownEdge(known, unknown);
+            ASSERT_TRUE(brush->canMoveEdges(worldBounds, Edge3::List(1, knownEdge), delta));
+            ASSERT_FALSE(brush->canMoveEdges(worldBounds, Edge3::List(1, unknownEdge), delta));
+            ASSERT_TRUE(brush->canSplitEdge(worldBounds, knownEdge, delta));
+            ASSERT_FALSE(brush->canSplitEdge(worldBounds, unknownEdge, delta));
+            
+            const Vec3 up(0.0, 0.0, 16.0);
+            Vec3::List knownFacePositions(4);
+            knownFacePositions[0] = Vec3(-32.0, -32.0, +32.0);
+            knownFacePositions[1] = Vec3(+32.0, -32.0, +32.0);
+            knownFacePositions[2] = Vec3(+32.0, +32.0, +32.0);
+            knownFacePositions[3] = Vec3(-32.0, +32.0, +32.0);
+            
+            Vec3::List unknownFacePositions = knownFacePositions;
+            unknownFacePositions[3] = Vec3(-32.0, 0.0, +32.0);
+            
+            const Polygon3 knownFace(knownFacePositions);
+            const Polygon3 unknownFace(unknownFacePositions);
+            
+            ASSERT_TRUE(brush->canMoveFaces(worldBounds, Polygon3::List(1, knownFace), up));
+            ASSERT_FALSE(brush->canMoveFaces(worldBounds, Polygon3::List(1, unknownFace), up));
+            ASSERT_TRUE(brush->canSplitFace(worldBounds, knownFace, up));
+            ASSERT_FALSE(brush->canSplitFace(worldBounds, unknownFace, up));
+            
+            // the queries leave the brush unchanged
+            ASSERT_EQ(8u, brush->vertexCount());
+            ASSERT_EQ(6u, brush->faces().size());
+            ASSERT_EQ(BBox3(32.0), brush->bounds());
+            
+            delete brush;
+        }
+        
         TEST(BrushTest, splitFace) {
             const BBox3 worldBounds(4096.0);
             World world(MapFormat::Standard, NULL, worldBounds);
@@ -938,6 +1152,46 @@ namespace TrenchBroom {
             ASSERT_EQ(minuendTexture,    right->findFaceByNormal(Vec3::NegZ)->textureName());
         }
         
+        TEST(BrushTest, subtractCuboidFromSeveralCuboids) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            BrushBuilder builder(&world, worldBounds);
+            BrushList minuends;
+            minuends.push_back(builder.createCuboid(BBox3(Vec3(-32.0, -16.0, -32.0), Vec3( 32.0, 16.0, 32.0)), "minuend"));
+            minuends.push_back(builder.createCuboid(BBox3(Vec3(128.0, -16.0, -32.0), Vec3(192.0, 16.0, 32.0)), "minuend"));
+            minuends.push_back(builder.createCuboid(BBox3(Vec3(-32.0,  64.0, -32.0), Vec3( 32.0, 96.0, 32.0)), "minuend"));
+            Brush* subtrahend = builder.createCuboid(BBox3(Vec3(-16.0, -32.0, -64.0), Vec3(16.0, 128.0, 0.0)), "subtrahend");
+            
+            const ParallelTaskRunner serialRunner(1);
+            const ParallelTaskRunner parallelRunner(4);
+            Brush::BrushLists serialResult = Brush::subtract(world, worldBounds, "default", minuends, subtrahend, serialRunner);
+            Brush::BrushLists parallelResult = Brush::subtract(world, worldBounds, "default", minuends, subtrahend, parallelRunner);
+            
+            ASSERT_EQ(3u, serialResult.size());
+            ASSERT_EQ(3u, serialResult[0].size());
+            ASSERT_TRUE(serialResult[1].empty());
+            ASSERT_EQ(3u, serialResult[2].size());
+            
+            ASSERT_EQ(serialResult.size(), parallelResult.size());
+            for (size_t i = 0; i < serialResult.size(); ++i) {
+                ASSERT_EQ(serialResult[i].size(), parallelResult[i].size());
+                for (size_t j = 0; j < serialResult[i].size(); ++j) {
+                    const Brush* serialBrush = serialResult[i][j];
+                    const Brush* parallelBrush = parallelResult[i][j];
+                    ASSERT_EQ(serialBrush->bounds(), parallelBrush->bounds());
+                    ASSERT_EQ(serialBrush->vertexCount(), parallelBrush->vertexCount());
+                }
+            }
+            
+            for (size_t i = 0; i < serialResult.size(); ++i) {
+                VectorUtils::clearAndDelete(serialResult[i]);
+                VectorUtils::clearAndDelete(parallelResult[i]);
+            }
+            VectorUtils::clearAndDelete(minuends);
+            delete subtrahend;
+        }
+        
         TEST(BrushTest, testAlmostDegenerateBrush) {
             // https://github.com/kduske/TrenchBroom/issues/1194
             const String data("{\n"
@@ -967,6 +1221,129 @@ namespace TrenchBroom {
             return initialPositions;
         }
         
+        static BrushFaceList createCubeFaces() {
+            // a cube with length 16 at the origin
+            BrushFaceList faces;
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0), Vec3(0.0, 0.0, 1.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(16.0, 0.0, 0.0), Vec3(16.0, 0.0, 1.0), Vec3(16.0, 1.0, 0.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 1.0), Vec3(1.0, 0.0, 0.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 16.0, 0.0), Vec3(1.0, 16.0, 0.0), Vec3(0.0, 16.0, 1.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 16.0), Vec3(0.0, 1.0, 16.0), Vec3(1.0, 0.0, 16.0)));
+            faces.push_back(BrushFace::createParaxial(Vec3(0.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0)));
+            return faces;
+        }
+        
+        TEST(BrushTest, deferGeometry) {
+            const BBox3 worldBounds(4096.0);
+            
+            const BrushFaceList faces = createCubeFaces();
+            Brush brush(worldBounds, faces, true);
+            ASSERT_TRUE(brush.geometryDeferred());
+            // the estimated bounds enclose the geometry
+            ASSERT_TRUE(brush.bounds().contains(BBox3(Vec3(0.0, 0.0, 0.0), Vec3(16.0, 16.0, 16.0))));
+            ASSERT_TRUE(brush.bounds().min.equals(Vec3(0.0, 0.0, 0.0), 0.001));
+            ASSERT_TRUE(brush.bounds().max.equals(Vec3(16.0, 16.0, 16.0), 0.001));
+            ASSERT_EQ(faces, brush.faces());
+            
+            const ParallelTaskRunner runner(1);
+            const BrushGeometryBatch batch(worldBounds, runner);
+            BrushList invalidBrushes;
+            StringList errors;
+            batch.buildDeferredGeometry(BrushList(1, &brush), invalidBrushes, errors);
+            ASSERT_TRUE(invalidBrushes.empty());
+            ASSERT_FALSE(brush.geometryDeferred());
+            
+            PickResult hits;
+            brush.pick(Ray3(Vec3(8.0, -8.0, 8.0), Vec3::PosY), hits);
+            ASSERT_EQ(1u, hits.size());
+            ASSERT_EQ(faces[2], hits.all().front().target<BrushFace*>());
+            
+            ASSERT_EQ(faces, brush.faces());
+            ASSERT_EQ(8u, brush.vertexCount());
+            ASSERT_EQ(BBox3(Vec3(0.0, 0.0, 0.0), Vec3(16.0, 16.0, 16.0)), brush.bounds());
+        }
+        
+        TEST(BrushTest, doNotDeferGeometryOfIrregularBrush) {
+            const BBox3 worldBounds(4096.0);
+            
+            BrushFaceList faces = createCubeFaces();
+            // this face does not touch the cube
+            faces.push_back(BrushFace::createParaxial(Vec3(32.0, 0.0, 0.0), Vec3(32.0, 0.0, 1.0), Vec3(32.0, 1.0, 0.0)));
+            
+            Brush brush(worldBounds, faces, true);
+            ASSERT_FALSE(brush.geometryDeferred());
+            ASSERT_EQ(6u, brush.faces().size());
+        }
+        
+        static void assertDeferredGeometryMatches(const String& data) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            IO::NodeReader eagerReader(data, &world);
+            NodeList eagerNodes = eagerReader.read(worldBounds);
+            
+            IO::NodeReader deferredReader(data, &world);
+            deferredReader.setDeferBrushGeometry(true);
+            NodeList deferredNodes = deferredReader.read(worldBounds);
+            
+            ASSERT_EQ(eagerNodes.size(), deferredNodes.size());
+            for (size_t i = 0; i < eagerNodes.size(); ++i) {
+                Brush* eager = static_cast<Brush*>(eagerNodes[i]);
+                Brush* deferred = static_cast<Brush*>(deferredNodes[i]);
+                
+                // the reader builds the deferred geometry before it returns the brushes
+                ASSERT_FALSE(eager->geometryDeferred());
+                ASSERT_FALSE(deferred->geometryDeferred());
+                ASSERT_EQ(eager->faces().size(), deferred->faces().size());
+                
+                const Vec3::List eagerVertices = vertexPositions(eager);
+                const Vec3::List deferredVertices = vertexPositions(deferred);
+                ASSERT_EQ(eagerVertices, deferredVertices);
+                ASSERT_EQ(eager->bounds(), deferred->bounds());
+                
+                for (size_t j = 0; j < eager->faces().size(); ++j)
+                    ASSERT_TRUE(eager->faces()[j]->boundary().equals(deferred->faces()[j]->boundary()));
+            }
+            
+            VectorUtils::clearAndDelete(eagerNodes);
+            VectorUtils::clearAndDelete(deferredNodes);
+        }
+        
+        TEST(BrushTest, deferredGeometryMatchesGeometry) {
+            assertDeferredGeometryMatches("{\n"
+                                          "( -192 704 128 ) ( -156 650 128 ) ( -156 650 160 ) mt_sr_v16 32 0 -180 1 -1\n"
+                                          "( -202 604 160 ) ( -164 664 128 ) ( -216 613 128 ) mt_sr_v16 0 0 -180 1 -1\n"
+                                          "( -156 650 128 ) ( -202 604 128 ) ( -202 604 160 ) mt_sr_v16 32 0 -180 1 -1\n"
+                                          "( -192 704 160 ) ( -256 640 160 ) ( -256 640 128 ) mt_sr_v16 32 0 -180 1 -1\n"
+                                          "( -256 640 160 ) ( -202 604 160 ) ( -202 604 128 ) mt_sr_v16 0 0 -180 1 -1\n"
+                                          "( -217 672 160 ) ( -161 672 160 ) ( -161 603 160 ) mt_sr_v16 0 0 -180 1 -1\n"
+                                          "( -161 603 128 ) ( -161 672 128 ) ( -217 672 128 ) mt_sr_v16 0 0 -180 1 -1\n"
+                                          "}\n"
+                                          "{\n"
+                                          "( 167.63423 -46.88446 472.36551 ) ( 66.06285 -1.98675 573.93711 ) ( 139.12681 -168.36963 500.87299 ) rock_1736 -158 527 166.79401 0.97488 -0.85268\n"
+                                          "( 208 -298.77704 309.53674 ) ( 208 -283.89740 159.77713 ) ( 208 -425.90924 294.65701 ) rock_1736 -261 -291 186.67561 1 1.17558\n"
+                                          "( -495.37965 -970.19919 2420.40004 ) ( -369.12126 -979.60987 2439.22145 ) ( -516.42274 -1026.66357 2533.32892 ) skill_ground -2752 -44 100.55540 0.89744 -0.99664\n"
+                                          "( 208 -103.52284 489.43151 ) ( 208 -63.04567 610.86296 ) ( 80 -103.52284 489.43151 ) rock_1736 208 516 0 -1 0.94868\n"
+                                          "( -450.79344 -2050.77028 440.48261 ) ( -333.56544 -2071.81325 487.37381 ) ( -470.33140 -2177.02858 432.66743 ) skill_ground -2100 -142 261.20348 0.99813 0.93021\n"
+                                          "( -192.25073 -2050.77026 159.49851 ) ( -135.78626 -2071.81323 272.42748 ) ( -201.66146 -2177.02856 140.67705 ) skill_ground -2010 513 188.47871 0.99729 -0.89685\n"
+                                          "( 181.06874 -76.56186 495.11416 ) ( 172.37248 -56.19832 621.18438 ) ( 63.35341 -126.83229 495.11416 ) rock_1736 197 503 0 -0.91965 0.98492\n"
+                                          "( 171.46251 -48.09583 474.98238 ) ( 129.03154 -21.91225 616.98017 ) ( 105.41315 -157.70143 477.82758 ) rock_1736 -71 425 178.51302 0.85658 -1.11429\n"
+                                          "( -37.21422 -6.81390 22.01408 ) ( -12.34518 -24.34492 146.34503 ) ( -92.55376 -122.11616 16.82534 ) skill_ground -6 23 182.57664 0.90171 -0.97651\n"
+                                          "( -975.92228 -1778.45799 1072.52401 ) ( -911.46425 -1772.13654 1182.92865 ) ( -1036.18913 -1883.59588 1113.72975 ) skill_ground -2320 426 158.59875 0.88222 -0.82108\n"
+                                          "( -984.28431 -1006.06166 2136.35663 ) ( -881.58265 -976.76783 2206.91312 ) ( -1039.55007 -1059.19179 2238.85958 ) skill_ground -2580 152 118.33189 0.90978 -0.96784\n"
+                                          "( -495.37960 -2050.77026 672 ) ( -369.12118 -2071.81323 672 ) ( -516.42263 -2177.02856 672 ) skill_ground -2104 -151 260.53769 1 1\n"
+                                          "( 0 -192 512 ) ( 0 -192 640 ) ( 128 -192 512 ) skill_ground 0 512 0 1 1\n"
+                                          "( 0 0 512 ) ( 0 -128 512 ) ( 128 0 512 ) skill_ground 0 0 0 1 -1\n"
+                                          "}\n"
+                                          "{\n"
+                                          "( -1248 -2144 1168 ) ( -1120 -2144 1168 ) ( -1248 -2272 1168 ) rock_1732 1248 2144 0 1 -1\n"
+                                          "( -1248 -2224 1141.33333 ) ( -1248 -2224 1013.33333 ) ( -1120 -2224 1056 ) rock_1732 1391 -309 -33.69007 1.20185 -0.83205\n"
+                                          "( -1408 -2144 1328 ) ( -1408 -2272 1328 ) ( -1408 -2144 1456 ) rock_1732 -1328 2144 90 1 1\n"
+                                          "( -1472 -2256 1434.66667 ) ( -1472 -2256 1562.66667 ) ( -1344 -2256 1349.33334 ) skip 1681 453 -33.69007 1.20185 0.83205\n"
+                                          "( -1248.00004 -2144 1061.33328 ) ( -1248.00004 -2272 1061.33328 ) ( -1120 -2144 976 ) rock_1732 1248 2144 0 1 -1\n"
+                                          "}");
+        }
+        
         static void assertSnapToInteger(const String &data) {
             const BBox3 worldBounds(4096.0);
             World world(MapFormat::Standard, NULL, worldBounds);
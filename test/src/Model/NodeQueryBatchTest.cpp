@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "CollectionUtils.h"
+#include "ParallelTaskRunner.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/CollectContainedNodesVisitor.h"
+#include "Model/CollectTouchingNodesVisitor.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/NodeQueryBatch.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        static Brush* createCuboid(const BrushBuilder& builder, const Vec3& min, const Vec3& size) {
+            return builder.createCuboid(BBox3(min, min + size), "texture");
+        }
+        
+        TEST(NodeQueryBatchTest, findTouchingAndContainedNodes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            // a row of small brushes, alternating between the default layer and a custom layer
+            Layer* layer = world.createLayer("Layer", worldBounds);
+            world.addChild(layer);
+            
+            BrushList row;
+            for (size_t i = 0; i < 100; ++i) {
+                Brush* brush = createCuboid(builder, Vec3(static_cast<FloatType>(i) * 16.0, 0.0, 0.0), Vec3(8.0, 8.0, 8.0));
+                row.push_back(brush);
+                if (i % 2 == 0)
+                    world.defaultLayer()->addChild(brush);
+                else
+                    layer->addChild(brush);
+            }
+            
+            // a group and a brush entity above the row
+            Group* group = world.createGroup("group");
+            group->addChild(createCuboid(builder, Vec3(0.0, 0.0, 32.0), Vec3(8.0, 8.0, 8.0)));
+            group->addChild(createCuboid(builder, Vec3(64.0, 0.0, 32.0), Vec3(8.0, 8.0, 8.0)));
+            layer->addChild(group);
+            
+            Entity* entity = world.createEntity();
+            entity->addChild(createCuboid(builder, Vec3(128.0, 0.0, 32.0), Vec3(8.0, 8.0, 8.0)));
+            world.defaultLayer()->addChild(entity);
+            
+            // the selection: a long flat brush touching the top of the row and two brushes enclosing parts of it
+            BrushList brushes;
+            brushes.push_back(createCuboid(builder, Vec3(-8.0, 0.0, 8.0), Vec3(400.0, 8.0, 8.0)));
+            brushes.push_back(createCuboid(builder, Vec3(-4.0, -4.0, -4.0), Vec3(100.0, 64.0, 64.0)));
+            brushes.push_back(createCuboid(builder, Vec3(120.0, -4.0, 24.0), Vec3(32.0, 32.0, 32.0)));
+            world.defaultLayer()->addChild(brushes[0]);
+            layer->addChild(brushes[1]);
+            world.defaultLayer()->addChild(brushes[2]);
+            
+            const ParallelTaskRunner runner(4);
+            const NodeQueryBatch batch(&world, runner);
+            
+            const NodeList touching = batch.findTouchingNodes(brushes);
+            const NodeList expectedTouching = collectMatchingNodes<CollectTouchingNodesVisitor>(brushes.begin(), brushes.end(), &world);
+            ASSERT_FALSE(touching.empty());
+            ASSERT_EQ(NodeSet(expectedTouching.begin(), expectedTouching.end()), NodeSet(touching.begin(), touching.end()));
+            ASSERT_EQ(touching.size(), NodeSet(touching.begin(), touching.end()).size());
+            
+            const NodeList contained = batch.findContainedNodes(brushes);
+            const NodeList expectedContained = collectMatchingNodes<CollectContainedNodesVisitor>(brushes.begin(), brushes.end(), &world);
+            ASSERT_FALSE(contained.empty());
+            ASSERT_EQ(NodeSet(expectedContained.begin(), expectedContained.end()), NodeSet(contained.begin(), contained.end()));
+            
+            // the result is in map order, so the brushes of the row come first, in the order of the default layer
+            ASSERT_EQ(row[0], contained[0]);
+            ASSERT_EQ(row[2], contained[1]);
+        }
+        
+        TEST(NodeQueryBatchTest, skipHiddenAndLockedNodes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            Layer* hiddenLayer = world.createLayer("Hidden", worldBounds);
+            hiddenLayer->setVisiblityState(Visibility_Hidden);
+            world.addChild(hiddenLayer);
+            
+            Layer* lockedLayer = world.createLayer("Locked", worldBounds);
+            lockedLayer->setLockState(Lock_Locked);
+            world.addChild(lockedLayer);
+            
+            Brush* hidden = createCuboid(builder, Vec3(0.0, 0.0, 0.0), Vec3(8.0, 8.0, 8.0));
+            Brush* shown = createCuboid(builder, Vec3(16.0, 0.0, 0.0), Vec3(8.0, 8.0, 8.0));
+            Brush* locked = createCuboid(builder, Vec3(32.0, 0.0, 0.0), Vec3(8.0, 8.0, 8.0));
+            Brush* unlocked = createCuboid(builder, Vec3(48.0, 0.0, 0.0), Vec3(8.0, 8.0, 8.0));
+            hiddenLayer->addChild(hidden);
+            hiddenLayer->addChild(shown);
+            lockedLayer->addChild(locked);
+            lockedLayer->addChild(unlocked);
+            
+            // nodes can override the state of their layer
+            shown->setVisiblityState(Visibility_Shown);
+            unlocked->setLockState(Lock_Unlocked);
+            
+            BrushList brushes;
+            brushes.push_back(createCuboid(builder, Vec3(-8.0, -8.0, -8.0), Vec3(128.0, 32.0, 32.0)));
+            world.defaultLayer()->addChild(brushes[0]);
+            
+            const ParallelTaskRunner runner(4);
+            const NodeQueryBatch batch(&world, runner);
+            
+            const NodeList contained = batch.findContainedNodes(brushes);
+            ASSERT_EQ(2u, contained.size());
+            ASSERT_EQ(shown, contained[0]);
+            ASSERT_EQ(unlocked, contained[1]);
+        }
+    }
+}
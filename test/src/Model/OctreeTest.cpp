@@ -73,5 +73,150 @@ namespace TrenchBroom {
             octree.addObject(aBounds, a);
             ASSERT_THROW(octree.removeObject(b), OctreeException);
         }
+        
+        TEST(OctreeTest, findObjectsInBounds) {
+            const BBox3f bounds(-128.0f, +128.0f);
+            const float minSize = 32.0f;
+            Octree<float,int> octree(bounds, minSize);
+            
+            const int a = 1;
+            const int b = 2;
+            const BBox3f aBounds(Vec3f(-100.0f, -100.0f, -100.0f), Vec3f(-90.0f, -90.0f, -90.0f));
+            const BBox3f bBounds(Vec3f(  90.0f,   90.0f,   90.0f), Vec3f(100.0f, 100.0f, 100.0f));
+            octree.addObject(aBounds, a);
+            octree.addObject(bBounds, b);
+            
+            const Octree<float,int>::List result = octree.findObjects(BBox3f(Vec3f(-110.0f, -110.0f, -110.0f), Vec3f(-80.0f, -80.0f, -80.0f)));
+            ASSERT_EQ(1u, result.size());
+            ASSERT_EQ(a, result.front());
+            
+            ASSERT_EQ(2u, octree.findObjects(bounds).size());
+        }
+        
+        TEST(OctreeTest, updateObject) {
+            const BBox3f bounds(-128.0f, +128.0f);
+            const float minSize = 32.0f;
+            Octree<float,int> octree(bounds, minSize);
+            
+            const int a = 1;
+            const BBox3f aBounds(Vec3f(-100.0f, -100.0f, -100.0f), Vec3f(-90.0f, -90.0f, -90.0f));
+            const BBox3f bBounds(Vec3f(  90.0f,   90.0f,   90.0f), Vec3f(100.0f, 100.0f, 100.0f));
+            octree.addObject(aBounds, a);
+            
+            octree.updateObject(bBounds, a);
+            ASSERT_FALSE(octree.containsObject(aBounds, a));
+            ASSERT_TRUE(octree.containsObject(bBounds, a));
+            ASSERT_TRUE(octree.findObjects(Vec3f(-95.0f, -95.0f, -95.0f)).empty());
+            ASSERT_EQ(1u, octree.findObjects(Vec3f(95.0f, 95.0f, 95.0f)).size());
+            
+            ASSERT_THROW(octree.updateObject(BBox3f(-129.0f, 2.0f), a), OctreeException);
+            ASSERT_THROW(octree.updateObject(aBounds, 2), OctreeException);
+        }
+        
+        TEST(OctreeTest, straddlingObjectIsStoredInSmallNode) {
+            const BBox3f bounds(-128.0f, +128.0f);
+            const float minSize = 32.0f;
+            Octree<float,int> octree(bounds, minSize);
+            
+            // this object straddles the center of the octree, but it is stored in a small node near the center
+            const int a = 1;
+            octree.addObject(BBox3f(-1.0f, 1.0f), a);
+            
+            ASSERT_TRUE(octree.findObjects(BBox3f(Vec3f(-100.0f, -100.0f, -100.0f), Vec3f(-90.0f, -90.0f, -90.0f))).empty());
+            ASSERT_EQ(1u, octree.findObjects(Vec3f::Null).size());
+        }
+        
+        TEST(OctreeTest, findObjectsWithRay) {
+            const BBox3f bounds(-128.0f, +128.0f);
+            const float minSize = 32.0f;
+            Octree<float,int> octree(bounds, minSize);
+            
+            const int a = 1;
+            const int b = 2;
+            octree.addObject(BBox3f(Vec3f(-100.0f, -100.0f, -100.0f), Vec3f(-90.0f, -90.0f, -90.0f)), a);
+            octree.addObject(BBox3f(Vec3f(  90.0f,   90.0f,   90.0f), Vec3f(100.0f, 100.0f, 100.0f)), b);
+            
+            const Octree<float,int>::List result = octree.findObjects(Ray3f(Vec3f(95.0f, 95.0f, -128.0f), Vec3f::PosZ));
+            ASSERT_EQ(1u, result.size());
+            ASSERT_EQ(b, result.front());
+        }
+        
+        class CollectObjects : public Octree<float,int>::RayVisitor {
+        private:
+            float m_maxDistance;
+        public:
+            std::vector<int> objects;
+            
+            CollectObjects(const float maxDistance) :
+            m_maxDistance(maxDistance) {}
+        private:
+            void doVisit(const int object) { objects.push_back(object); }
+            bool doDone(const float distance) const { return distance > m_maxDistance; }
+        };
+        
+        TEST(OctreeTest, findObjectsWithRayVisitor) {
+            const BBox3f bounds(-128.0f, +128.0f);
+            const float minSize = 32.0f;
+            Octree<float,int> octree(bounds, minSize);
+            
+            const int a = 1;
+            const int b = 2;
+            const int c = 3;
+            octree.addObject(BBox3f(Vec3f(90.0f, 90.0f,  60.0f), Vec3f(100.0f, 100.0f,  70.0f)), c);
+            octree.addObject(BBox3f(Vec3f(90.0f, 90.0f, -20.0f), Vec3f(100.0f, 100.0f, -10.0f)), b);
+            octree.addObject(BBox3f(Vec3f(90.0f, 90.0f, -100.0f), Vec3f(100.0f, 100.0f, -90.0f)), a);
+            
+            const Ray3f ray(Vec3f(95.0f, 95.0f, -128.0f), Vec3f::PosZ);
+            
+            CollectObjects all(std::numeric_limits<float>::max());
+            octree.findObjects(ray, all);
+            ASSERT_EQ(3u, all.objects.size());
+            ASSERT_EQ(a, all.objects[0]);
+            ASSERT_EQ(b, all.objects[1]);
+            ASSERT_EQ(c, all.objects[2]);
+            
+            // the nodes of b and c are entered further away than 50 units
+            CollectObjects nearest(50.0f);
+            octree.findObjects(ray, nearest);
+            ASSERT_EQ(1u, nearest.objects.size());
+            ASSERT_EQ(a, nearest.objects[0]);
+        }
+        
+        TEST(OctreeTest, removeAndUpdateManyObjects) {
+            const BBox3f bounds(-1024.0f, +1024.0f);
+            const float minSize = 16.0f;
+            Octree<float,int> octree(bounds, minSize);
+            
+            // every object is a box whose position and size depend on its number
+            std::vector<BBox3f> objectBounds;
+            for (int i = 0; i < 1000; ++i) {
+                const Vec3f min(static_cast<float>((i * 37) % 2000 - 1000),
+                                static_cast<float>((i * 91) % 2000 - 1000),
+                                static_cast<float>((i * 53) % 2000 - 1000));
+                const float size = static_cast<float>(1 + (i * 7) % 23);
+                objectBounds.push_back(BBox3f(min, min + Vec3f(size, size, size)));
+                octree.addObject(objectBounds.back(), i);
+            }
+            
+            // remove every third object and move all others
+            for (int i = 0; i < 1000; ++i) {
+                if (i % 3 == 0) {
+                    octree.removeObject(i);
+                } else {
+                    objectBounds[static_cast<size_t>(i)].translate(Vec3f(17.0f, -5.0f, 3.0f));
+                    octree.updateObject(objectBounds[static_cast<size_t>(i)], i);
+                }
+            }
+            
+            for (int i = 0; i < 1000; ++i) {
+                const BBox3f& current = objectBounds[static_cast<size_t>(i)];
+                ASSERT_EQ(i % 3 != 0, octree.containsObject(current, i));
+                
+                const Octree<float,int>::List result = octree.findObjects(current.center());
+                ASSERT_EQ(i % 3 != 0, std::find(result.begin(), result.end(), i) != result.end());
+            }
+            
+            ASSERT_EQ(666u, octree.findObjects(bounds).size());
+        }
     }
 }
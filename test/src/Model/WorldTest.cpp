@@ -0,0 +1,162 @@
+/*
+ Copyright (C) 2010-2014 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+#include "Model/PickResult.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        TEST(WorldTest, findNodesInManyLayers) {
+            const BBox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            // one cube per layer, placed next to each other along the X axis
+            BrushList brushes;
+            LayerList layers;
+            for (size_t i = 0; i < 6; ++i) {
+                const Vec3 center(static_cast<FloatType>(i) * 256.0, 0.0, 0.0);
+                Brush* brush = builder.createCuboid(BBox3(center - Vec3(64.0, 64.0, 64.0), center + Vec3(64.0, 64.0, 64.0)), "texture");
+                brushes.push_back(brush);
+                
+                if (i == 0) {
+                    world.defaultLayer()->addChild(brush);
+                } else {
+                    Layer* layer = world.createLayer("Layer", worldBounds);
+                    layer->addChild(brush);
+                    world.addChild(layer);
+                    layers.push_back(layer);
+                }
+            }
+            
+            NodeList contained;
+            world.findNodesContaining(Vec3(512.0, 0.0, 0.0), contained);
+            ASSERT_EQ(1u, contained.size());
+            ASSERT_EQ(brushes[2], contained.front());
+            
+            NodeList intersected;
+            world.findNodesIntersecting(BBox3(Vec3(200.0, -8.0, -8.0), Vec3(800.0, 8.0, 8.0)), intersected);
+            ASSERT_EQ(3u, intersected.size());
+            ASSERT_TRUE(VectorUtils::contains(intersected, brushes[1]));
+            ASSERT_TRUE(VectorUtils::contains(intersected, brushes[2]));
+            ASSERT_TRUE(VectorUtils::contains(intersected, brushes[3]));
+            
+            PickResult pickResult;
+            world.pick(Ray3(Vec3(-1024.0, 0.0, 0.0), Vec3::PosX), pickResult);
+            ASSERT_EQ(6u, pickResult.size());
+            
+            // nodes that leave a layer must also leave the world's index
+            layers[1]->removeChild(brushes[2]);
+            contained.clear();
+            world.findNodesContaining(Vec3(512.0, 0.0, 0.0), contained);
+            ASSERT_TRUE(contained.empty());
+            
+            // removing a layer removes its children from the world's index, the layer then visits its children
+            world.removeChild(layers[0]);
+            world.removeChild(layers[3]);
+            contained.clear();
+            world.findNodesContaining(Vec3(1024.0, 0.0, 0.0), contained);
+            ASSERT_TRUE(contained.empty());
+            
+            layers[3]->findNodesContaining(Vec3(1024.0, 0.0, 0.0), contained);
+            ASSERT_EQ(1u, contained.size());
+            ASSERT_EQ(brushes[4], contained.front());
+            
+            world.addChild(layers[3]);
+            contained.clear();
+            world.findNodesContaining(Vec3(1024.0, 0.0, 0.0), contained);
+            ASSERT_EQ(1u, contained.size());
+            ASSERT_EQ(brushes[4], contained.front());
+            
+            // a layer in the world only finds its own children
+            intersected.clear();
+            layers[2]->findNodesIntersecting(BBox3(Vec3(200.0, -8.0, -8.0), Vec3(800.0, 8.0, 8.0)), intersected);
+            ASSERT_EQ(1u, intersected.size());
+            ASSERT_EQ(brushes[3], intersected.front());
+            
+            delete brushes[2];
+            delete layers[0];
+        }
+        
+        TEST(WorldTest, filterHiddenAndLockedLayerChildren) {
+            const BBox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            Layer* layer = world.createLayer("Layer", worldBounds);
+            world.addChild(layer);
+            
+            // two cubes in the custom layer and one in the default layer, next to each other along the X axis
+            BrushList brushes;
+            for (size_t i = 0; i < 3; ++i) {
+                const Vec3 center(static_cast<FloatType>(i) * 256.0, 0.0, 0.0);
+                Brush* brush = builder.createCuboid(BBox3(center - Vec3(64.0, 64.0, 64.0), center + Vec3(64.0, 64.0, 64.0)), "texture");
+                brushes.push_back(brush);
+                if (i < 2)
+                    layer->addChild(brush);
+                else
+                    world.defaultLayer()->addChild(brush);
+            }
+            
+            const Ray3 ray(Vec3(-1024.0, 0.0, 0.0), Vec3::PosX);
+            const BBox3 bounds(Vec3(-128.0, -8.0, -8.0), Vec3(640.0, 8.0, 8.0));
+            
+            PickResult pickResult;
+            layer->setVisiblityState(Visibility_Hidden);
+            world.pick(ray, pickResult);
+            ASSERT_EQ(1u, pickResult.size());
+            
+            // a node can override the visibility of its layer
+            brushes[1]->setVisiblityState(Visibility_Shown);
+            pickResult = PickResult();
+            world.pick(ray, pickResult);
+            ASSERT_EQ(2u, pickResult.size());
+            
+            NodeList layerChildren;
+            world.findLayerChildrenIntersecting(bounds, NULL, World::Filter_Hidden, layerChildren);
+            ASSERT_EQ(2u, layerChildren.size());
+            ASSERT_FALSE(VectorUtils::contains(layerChildren, brushes[0]));
+            
+            // locked nodes can still be picked, but the lock filter skips them
+            layer->setVisiblityState(Visibility_Shown);
+            layer->setLockState(Lock_Locked);
+            brushes[1]->setLockState(Lock_Unlocked);
+            pickResult = PickResult();
+            world.pick(ray, pickResult);
+            ASSERT_EQ(3u, pickResult.size());
+            
+            layerChildren.clear();
+            world.findLayerChildrenIntersecting(bounds, NULL, World::Filter_Locked, layerChildren);
+            ASSERT_EQ(2u, layerChildren.size());
+            ASSERT_FALSE(VectorUtils::contains(layerChildren, brushes[0]));
+            
+            layerChildren.clear();
+            world.findLayerChildrenIntersecting(bounds, layer, World::Filter_None, layerChildren);
+            ASSERT_EQ(2u, layerChildren.size());
+            ASSERT_FALSE(VectorUtils::contains(layerChildren, brushes[2]));
+        }
+    }
+}
@@ -26,6 +26,8 @@
 #include "MathUtils.h"
 #include "TestUtils.h"
 
+#include <cstdlib>
+
 typedef Polyhedron<double, DefaultPolyhedronPayload, DefaultPolyhedronPayload> Polyhedron3d;
 typedef Polyhedron3d::Vertex Vertex;
 typedef Polyhedron3d::VertexList VertexList;
@@ -78,6 +80,54 @@ TEST(PolyhedronTest, initWith4Points) {
     ASSERT_TRUE(hasTriangleOf(p, p1, p4, p3));
 }
 
+TEST(PolyhedronTest, setTopology) {
+    const Vec3d p1( 0.0, 0.0, 8.0);
+    const Vec3d p2( 8.0, 0.0, 0.0);
+    const Vec3d p3(-8.0, 0.0, 0.0);
+    const Vec3d p4( 0.0, 8.0, 0.0);
+    
+    Vec3d::List positions;
+    positions.push_back(p1);
+    positions.push_back(p2);
+    positions.push_back(p3);
+    positions.push_back(p4);
+    
+    Polyhedron3d::FaceIndexList faces(4);
+    faces[0].push_back(1); faces[0].push_back(2); faces[0].push_back(3);
+    faces[1].push_back(0); faces[1].push_back(2); faces[1].push_back(1);
+    faces[2].push_back(0); faces[2].push_back(1); faces[2].push_back(3);
+    faces[3].push_back(0); faces[3].push_back(3); faces[3].push_back(2);
+    
+    Polyhedron3d p;
+    ASSERT_TRUE(p.setTopology(positions, faces));
+    ASSERT_TRUE(p.closed());
+    ASSERT_EQ(4u, p.vertexCount());
+    ASSERT_EQ(6u, p.edgeCount());
+    ASSERT_EQ(4u, p.faceCount());
+    ASSERT_TRUE(hasVertices(p, positions));
+    ASSERT_EQ(BBox3d(Vec3d(-8.0, 0.0, 0.0), Vec3d(8.0, 8.0, 8.0)), p.bounds());
+    
+    ASSERT_TRUE(hasTriangleOf(p, p2, p3, p4));
+    ASSERT_TRUE(hasTriangleOf(p, p1, p3, p2));
+    ASSERT_TRUE(hasTriangleOf(p, p1, p2, p4));
+    ASSERT_TRUE(hasTriangleOf(p, p1, p4, p3));
+    
+    Polyhedron3d::FaceIndexList open(faces.begin(), faces.end() - 1);
+    ASSERT_FALSE(p.setTopology(positions, open));
+    
+    Polyhedron3d::FaceIndexList flipped(faces);
+    std::swap(flipped[0][0], flipped[0][1]);
+    ASSERT_FALSE(p.setTopology(positions, flipped));
+    
+    Polyhedron3d::FaceIndexList outOfRange(faces);
+    outOfRange[0][0] = 4;
+    ASSERT_FALSE(p.setTopology(positions, outOfRange));
+    
+    // failed attempts leave the polyhedron unchanged
+    ASSERT_EQ(4u, p.faceCount());
+    ASSERT_TRUE(hasTriangleOf(p, p2, p3, p4));
+}
+
 TEST(PolyhedronTest, convexHullWithFailingPoints) {
     const Vec3d p1(-64.0,    -45.5049, -34.4752);
     const Vec3d p2(-64.0,    -43.6929, -48.0);
@@ -1159,6 +1209,133 @@ TEST(PolyhedronTest, crashWhileAddingPoints3) {
     p.addPoint(p15); // Assertion failure here.
 }
 
+TEST(PolyhedronTest, addPointsDropsNearCoincidentPoints) {
+    const Vec3d p1( 0.0,  0.0,  0.0);
+    const Vec3d p2(16.0,  0.0,  0.0);
+    const Vec3d p3( 0.0, 16.0,  0.0);
+    const Vec3d p4( 0.0,  0.0, 16.0);
+    
+    Vec3d::List points;
+    points.push_back(p1);
+    points.push_back(p2);
+    points.push_back(p2 + Vec3d(0.00001, 0.0, -0.00001));
+    points.push_back(p3);
+    points.push_back(p4);
+    points.push_back(p1 - Vec3d(0.00001, 0.00001, 0.00001));
+    points.push_back(p4 + Vec3d(0.0, 0.00001, 0.0));
+    
+    Polyhedron3d p(points);
+    
+    ASSERT_TRUE(p.closed());
+    ASSERT_EQ(4u, p.vertexCount());
+    ASSERT_EQ(4u, p.faceCount());
+    ASSERT_TRUE(hasTriangleOf(p, p2, p3, p4));
+}
+
+TEST(PolyhedronTest, addPointsMatchesAddPoint) {
+    // the points of crashWhileAddingPoints3
+    Vec3d::List points;
+    points.push_back(Vec3d(256, 39, 160));
+    points.push_back(Vec3d(256,  0, 160));
+    points.push_back(Vec3d(256,  0, 64));
+    points.push_back(Vec3d(256, 39, 64));
+    points.push_back(Vec3d(  0,  0, 160));
+    points.push_back(Vec3d(  0, 32, 160));
+    points.push_back(Vec3d(  0,  0, 64));
+    points.push_back(Vec3d(  0, 32, 64));
+    points.push_back(Vec3d(  0,  0, 0));
+    points.push_back(Vec3d(  0, 32, 0));
+    points.push_back(Vec3d(256, 32, 0));
+    points.push_back(Vec3d(256,  0, 0));
+    points.push_back(Vec3d(  0, 39, 64));
+    points.push_back(Vec3d(  0, 39, 160));
+    points.push_back(Vec3d(  0, 39, 0));
+    
+    Polyhedron3d expected;
+    for (size_t i = 0; i < points.size(); ++i)
+        expected.addPoint(points[i]);
+    
+    Polyhedron3d p;
+    p.addPoints(points);
+    
+    ASSERT_TRUE(p.closed());
+    ASSERT_EQ(expected.vertexCount(), p.vertexCount());
+    ASSERT_EQ(expected.edgeCount(), p.edgeCount());
+    ASSERT_EQ(expected.faceCount(), p.faceCount());
+    
+    const VertexList& vertices = expected.vertices();
+    VertexList::const_iterator it, end;
+    for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
+        ASSERT_TRUE(p.hasVertex((*it)->position()));
+    ASSERT_EQ(expected.bounds().min, p.bounds().min);
+    ASSERT_EQ(expected.bounds().max, p.bounds().max);
+}
+
+TEST(PolyhedronTest, addPointsToCubeWithInnerPoints) {
+    std::srand(1);
+    
+    Vec3d::List points;
+    for (size_t i = 0; i < 1000; ++i) {
+        Vec3d point;
+        for (size_t j = 0; j < 3; ++j)
+            point[j] = static_cast<double>(std::rand() % 1024) / 32.0 - 16.0;
+        points.push_back(point);
+    }
+    
+    const BBox3d bounds(Vec3d(-16.0, -16.0, -16.0), Vec3d(16.0, 16.0, 16.0));
+    const Vec3d::List corners = bBoxVertices(bounds);
+    points.insert(points.begin() + 500, corners.begin(), corners.end());
+    
+    Polyhedron3d p(points);
+    
+    ASSERT_TRUE(p.closed());
+    ASSERT_EQ(8u, p.vertexCount());
+    ASSERT_EQ(12u, p.edgeCount());
+    ASSERT_EQ(6u, p.faceCount());
+    ASSERT_TRUE(hasVertices(p, corners));
+    ASSERT_EQ(bounds.min, p.bounds().min);
+    ASSERT_EQ(bounds.max, p.bounds().max);
+}
+
+TEST(PolyhedronTest, addPointsOnSphere) {
+    std::srand(1);
+    
+    Vec3d::List points;
+    for (size_t i = 0; i < 2000; ++i) {
+        Vec3d direction;
+        for (size_t j = 0; j < 3; ++j)
+            direction[j] = static_cast<double>(std::rand()) / static_cast<double>(RAND_MAX) - 0.5;
+        if (!direction.null())
+            points.push_back(direction.normalized() * 512.0);
+    }
+    
+    Polyhedron3d p(points);
+    
+    ASSERT_TRUE(p.closed());
+    ASSERT_TRUE(p.polyhedron());
+    
+    // every input point must be contained in the hull
+    const FaceList& faces = p.faces();
+    FaceList::const_iterator fIt, fEnd;
+    for (fIt = faces.begin(), fEnd = faces.end(); fIt != fEnd; ++fIt) {
+        const Face* face = *fIt;
+        const Plane3d plane(face->origin(), face->normal());
+        for (size_t i = 0; i < points.size(); ++i)
+            ASSERT_NE(Math::PointStatus::PSAbove, plane.pointStatus(points[i]));
+    }
+    
+    // and every vertex must be one of the input points
+    const VertexList& vertices = p.vertices();
+    VertexList::const_iterator vIt, vEnd;
+    for (vIt = vertices.begin(), vEnd = vertices.end(); vIt != vEnd; ++vIt) {
+        const Vec3d& position = (*vIt)->position();
+        bool found = false;
+        for (size_t i = 0; i < points.size() && !found; ++i)
+            found = position.equals(points[i], Math::Constants<double>::pointStatusEpsilon());
+        ASSERT_TRUE(found);
+    }
+}
+
 TEST(PolyhedronTest, moveSingleVertex) {
     const Vec3d p1(0.0, 0.0, 0.0);
     const Vec3d p2(32.0, -16.0, 8.0);
@@ -2857,6 +3034,61 @@ TEST(PolyhedronTest, mergeRemainingFragments) {
     ASSERT_EQ(7u, result.size());
 }
 
+TEST(PolyhedronTest, subtractBatchHulls) {
+    // the polyhedra of mergeRemainingFragments, with enough inner points to build their hulls in a batch
+    Vec3d::List minuendVertices;
+    minuendVertices.push_back(Vec3d(32, -64, 16));
+    minuendVertices.push_back(Vec3d(64, -32, 16));
+    minuendVertices.push_back(Vec3d(64, 32, 16));
+    minuendVertices.push_back(Vec3d(32, 64, 16));
+    minuendVertices.push_back(Vec3d(-64, 64, 16));
+    minuendVertices.push_back(Vec3d(-64, -64, 16));
+    minuendVertices.push_back(Vec3d(64, 32, -16));
+    minuendVertices.push_back(Vec3d(64, -32, -16));
+    minuendVertices.push_back(Vec3d(32, -64, -16));
+    minuendVertices.push_back(Vec3d(-64, -64, -16));
+    minuendVertices.push_back(Vec3d(-64, 64, -16));
+    minuendVertices.push_back(Vec3d(32, 64, -16));
+    
+    Vec3d::List subtrahendVertices;
+    subtrahendVertices.push_back(Vec3d(16, -32, 32));
+    subtrahendVertices.push_back(Vec3d(32, -0, 32));
+    subtrahendVertices.push_back(Vec3d(16, 32, 32));
+    subtrahendVertices.push_back(Vec3d(-16, 48, 32));
+    subtrahendVertices.push_back(Vec3d(-64, 48, 32));
+    subtrahendVertices.push_back(Vec3d(-64, -48, 32));
+    subtrahendVertices.push_back(Vec3d(-16, -48, 32));
+    subtrahendVertices.push_back(Vec3d(-64, -48, -32));
+    subtrahendVertices.push_back(Vec3d(-64, 48, -32));
+    subtrahendVertices.push_back(Vec3d(-16, 48, -32));
+    subtrahendVertices.push_back(Vec3d(16, 32, -32));
+    subtrahendVertices.push_back(Vec3d(32, -0, -32));
+    subtrahendVertices.push_back(Vec3d(16, -32, -32));
+    subtrahendVertices.push_back(Vec3d(-16, -48, -32));
+    
+    for (size_t i = 0; i < 8; ++i) {
+        const double offset = static_cast<double>(i) - 4.0;
+        minuendVertices.push_back(Vec3d(offset, offset, 0.0));
+        subtrahendVertices.push_back(Vec3d(offset, offset, 0.0));
+    }
+    
+    const Polyhedron3d minuend(minuendVertices);
+    const Polyhedron3d subtrahend(subtrahendVertices);
+    ASSERT_EQ(12u, minuend.vertexCount());
+    ASSERT_EQ(14u, subtrahend.vertexCount());
+    
+    const Polyhedron3d::SubtractResult result = minuend.subtract(subtrahend);
+    ASSERT_FALSE(result.empty());
+    
+    Polyhedron3d::SubtractResult::const_iterator it, end;
+    for (it = result.begin(), end = result.end(); it != end; ++it) {
+        const Polyhedron3d& fragment = *it;
+        ASSERT_TRUE(fragment.closed());
+        ASSERT_TRUE(minuend.contains(fragment));
+        ASSERT_FALSE(fragment.intersect(subtrahend).polyhedron());
+    }
+}
+
 bool hasVertex(const Polyhedron3d& p, const Vec3d& point) {
     return p.hasVertex(point);
 }
@@ -21,6 +21,11 @@
 
 #include "StringUtils.h"
 
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 namespace StringUtils {
     TEST(StringUtilsTest, trim) {
         String result;
@@ -226,4 +231,116 @@ namespace StringUtils {
         ASSERT_EQ(String("asdf\\"), StringUtils::unescape("asdf\\", ""));
         ASSERT_EQ(String("asdf\\"), StringUtils::unescape("asdf\\\\", ""));
     }
+    
+    inline void assertSameDouble(const char* str) {
+        const double expected = std::atof(str);
+        const double actual = stringToDouble(str, str + std::strlen(str));
+        ASSERT_EQ(0, std::memcmp(&expected, &actual, sizeof(double))) << "for input '" << str << "'";
+    }
+    
+    TEST(StringUtilsTest, stringToDouble) {
+        const char* inputs[] = {
+            "0", "-0", "+0", "0.0", "-0.0", ".5", "-.5", "5.", "1", "-1", "64", "-712", "8192",
+            "0.1", "0.2", "0.3", "-0.7071067811865476", "1.0000000000000002", "123456789012345",
+            "1234567890123456", "12345678901234567890", "0.000001", "1e10", "1e22", "1e23", "1e-22", "1e-23",
+            "2.5e-3", "-4.2e+5", "1E5", "1e", "1e+", "-", "+", ".", "", "1.5abc", "0x10", "inf", "nan",
+            "179769313486231570000000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+            "4.9406564584124654e-324", "1e400", "-1e400", "0.000000000000000000000000000001"
+        };
+        
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i)
+            assertSameDouble(inputs[i]);
+        
+        char buffer[64];
+        std::srand(1);
+        for (size_t i = 0; i < 100000; ++i) {
+            const int integral = std::rand() % 100000 - 50000;
+            const int fractional = std::rand() % 1000000;
+            std::sprintf(buffer, "%d.%06d", integral, fractional);
+            assertSameDouble(buffer);
+            std::sprintf(buffer, "%.17g", static_cast<double>(std::rand()) / static_cast<double>(RAND_MAX) * 8192.0);
+            assertSameDouble(buffer);
+        }
+    }
+    
+    TEST(StringUtilsTest, stringToInt) {
+        const char* inputs[] = { "0", "-0", "1", "-1", "+7", "123456789", "-123456789", "2147483647", "-2147483648", "12.5", "-", "", " 3", "abc" };
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+            const char* str = inputs[i];
+            ASSERT_EQ(std::atoi(str), stringToInt(str, str + std::strlen(str))) << "for input '" << str << "'";
+        }
+    }
+    
+    TEST(StringUtilsTest, appendInt) {
+        const int inputs[] = { 0, 1, -1, 9, 10, -10, 123456789, 2147483647, -2147483647 - 1 };
+        char buffer[64];
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+            std::sprintf(buffer, "%d", inputs[i]);
+            String str("x");
+            appendInt(str, inputs[i]);
+            ASSERT_EQ(String("x") + buffer, str);
+        }
+    }
+    
+    inline void assertSameFormat(const double value, const int precision) {
+        char buffer[64];
+        std::sprintf(buffer, "%.*g", precision, value);
+        String str;
+        appendDouble(str, value, precision);
+        ASSERT_EQ(String(buffer), str) << "for value " << buffer << " and precision " << precision;
+    }
+    
+    TEST(StringUtilsTest, appendDouble) {
+        const double inputs[] = {
+            0.0, -0.0, 1.0, -1.0, 0.5, -0.25, 64.0, -712.0, 8192.0, 99999.0, 999999.0, 1000000.0, -1000000.0,
+            123456789.0, 999999999.0, 1000000000.0, 1e17, 1e18, 0.1, 1.0 / 3.0, -0.7071067811865476, 1e-5, 1e-300,
+            1.7976931348623157e308, 4.9406564584124654e-324
+        };
+        const int precisions[] = { 1, 6, 17 };
+        
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+            for (size_t j = 0; j < sizeof(precisions) / sizeof(precisions[0]); ++j)
+                assertSameFormat(inputs[i], precisions[j]);
+        }
+        
+        std::srand(1);
+        for (size_t i = 0; i < 100000; ++i) {
+            const double integral = static_cast<double>(std::rand() % 100000 - 50000);
+            assertSameFormat(integral, 6);
+            assertSameFormat(integral, 17);
+            const double fraction = static_cast<double>(std::rand()) / static_cast<double>(RAND_MAX) * 8192.0;
+            assertSameFormat(fraction, 6);
+            assertSameFormat(fraction, 17);
+        }
+    }
+    
+    inline double stringToDouble(const char* str) {
+        return stringToDouble(str, str + std::strlen(str));
+    }
+    
+    TEST(StringUtilsTest, convertIndependentOfLocale) {
+        // the test is skipped if no locale with a decimal comma is installed
+        const char* locales[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "German" };
+        const String previousLocale = std::setlocale(LC_NUMERIC, NULL);
+        size_t i = 0;
+        while (i < sizeof(locales) / sizeof(locales[0]) && std::setlocale(LC_NUMERIC, locales[i]) == NULL)
+            ++i;
+        if (i == sizeof(locales) / sizeof(locales[0]))
+            return;
+        
+        // the numbers are converted before the locale is restored, because a failed assertion returns immediately
+        const double exact = stringToDouble("-2.5");
+        const double longMantissa = stringToDouble("1234567890.1234567890");
+        const double smallExponent = stringToDouble("1.5e-30");
+        const double comma = stringToDouble("1,5");
+        String formatted;
+        appendDouble(formatted, 0.1, 17);
+        std::setlocale(LC_NUMERIC, previousLocale.c_str());
+        
+        ASSERT_EQ(-2.5, exact);
+        ASSERT_EQ(std::atof("1234567890.1234567890"), longMantissa);
+        ASSERT_EQ(std::atof("1.5e-30"), smallExponent);
+        ASSERT_EQ(1.0, comma);
+        ASSERT_EQ(String("0.10000000000000001"), formatted);
+    }
 }
@@ -23,6 +23,8 @@
 #include "MathUtils.h"
 #include "TestUtils.h"
 
+#include <cstdlib>
+
 TEST(VecTest, parseVec3fWithValidString) {
     ASSERT_EQ(Vec3f(1.0f, 3.0f, 3.5f), Vec3f::parse("1.0 3 3.5"));
 }
@@ -327,6 +329,74 @@ TEST(VecTest, vec3fCrossProduct) {
     ASSERT_VEC_EQ(c1, c2);
 }
 
+template <typename T, size_t S>
+Vec<T,S> randomVec() {
+    Vec<T,S> result;
+    for (size_t i = 0; i < S; ++i)
+        result[i] = static_cast<T>(std::rand()) / static_cast<T>(RAND_MAX) * static_cast<T>(2000.0) - static_cast<T>(1000.0);
+    return result;
+}
+
+template <typename T, size_t S>
+void assertArithmeticMatchesReference() {
+    for (size_t i = 0; i < 100; ++i) {
+        const Vec<T,S> l = randomVec<T,S>();
+        const Vec<T,S> r = randomVec<T,S>();
+        const T f = r[0];
+        
+        Vec<T,S> sum, difference, product;
+        T dot = static_cast<T>(0.0);
+        for (size_t j = 0; j < S; ++j) {
+            sum[j] = l[j] + r[j];
+            difference[j] = l[j] - r[j];
+            product[j] = l[j] * f;
+            dot += l[j] * r[j];
+        }
+        
+        ASSERT_EQ(sum, l + r);
+        ASSERT_EQ(difference, l - r);
+        ASSERT_EQ(product, l * f);
+        ASSERT_EQ(dot, l.dot(r));
+        
+        Vec<T,S> a = l;
+        a += r;
+        ASSERT_EQ(sum, a);
+        a = l;
+        a -= r;
+        ASSERT_EQ(difference, a);
+        a = l;
+        a *= f;
+        ASSERT_EQ(product, a);
+    }
+}
+
+template <typename T>
+void assertCrossProductMatchesReference() {
+    for (size_t i = 0; i < 100; ++i) {
+        const Vec<T,3> l = randomVec<T,3>();
+        const Vec<T,3> r = randomVec<T,3>();
+        const Vec<T,3> c(l[1] * r[2] - l[2] * r[1],
+                         l[2] * r[0] - l[0] * r[2],
+                         l[0] * r[1] - l[1] * r[0]);
+        ASSERT_EQ(c, crossed(l, r));
+    }
+}
+
+TEST(VecTest, arithmeticIsExact) {
+    std::srand(1);
+    assertArithmeticMatchesReference<float, 3>();
+    assertArithmeticMatchesReference<float, 4>();
+    assertArithmeticMatchesReference<double, 3>();
+    assertArithmeticMatchesReference<double, 4>();
+    assertArithmeticMatchesReference<float, 2>();
+}
+
+TEST(VecTest, crossProductIsExact) {
+    std::srand(1);
+    assertCrossProductMatchesReference<float>();
+    assertCrossProductMatchesReference<double>();
+}
+
 TEST(VecTest, angleBetween) {
     ASSERT_FLOAT_EQ(angleBetween(Vec3f::PosX, Vec3f::PosX, Vec3f::PosZ), 0.0f);
     ASSERT_FLOAT_EQ(angleBetween(Vec3f::PosY, Vec3f::PosX, Vec3f::PosZ), Math::Cf::piOverTwo());